@@ -24,6 +24,14 @@ Buffer::Buffer(BufferUsageFlags usage, int64_t size, bool onGpu)
     {
         vkUsage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     }
+    if (usage & BufferUsageIndexRead)
+    {
+        vkUsage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    }
+    if (usage & BufferUsageIndirectRead)
+    {
+        vkUsage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    }
 
     VkMemoryPropertyFlags memProperty = onGpu ?
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT :
@@ -129,6 +137,26 @@ BufferPtr Buffer::CreateStructured(int64_t size, bool isWritable)
     return std::make_shared<Buffer>(usage, size, true);
 }
 
+BufferPtr Buffer::CreateIndex(int64_t size, bool isWritable)
+{
+    Assert(size > 0);
+
+    BufferUsageFlags usage = BufferUsageTransferDst | BufferUsageStorageRead | BufferUsageIndexRead;
+    if (isWritable)
+    {
+        usage |= BufferUsageStorageWrite;
+    }
+
+    return std::make_shared<Buffer>(usage, size, true);
+}
+
+BufferPtr Buffer::CreateIndirect(int64_t size)
+{
+    Assert(size > 0);
+
+    return std::make_shared<Buffer>(BufferUsageTransferDst | BufferUsageStorageRead | BufferUsageStorageWrite | BufferUsageIndirectRead, size, true);
+}
+
 void Buffer::BindDescriptor()
 {
     VkBufferDeviceAddressInfo addressInfo{ .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
@@ -15,7 +15,9 @@ enum BufferUsageFlagBits : uint32_t
     BufferUsageTransferSrc  = 1,
     BufferUsageTransferDst  = 2,
     BufferUsageStorageRead  = 8,
-    BufferUsageStorageWrite = 16
+    BufferUsageStorageWrite = 16,
+    BufferUsageIndexRead    = 32,
+    BufferUsageIndirectRead = 64
 };
 using BufferUsageFlags = uint32_t;
 
@@ -62,6 +64,10 @@ public:
 
     static BufferPtr CreateStaging(int64_t size);
     static BufferPtr CreateStructured(int64_t size, bool isWritable);
+    // Bound as an index buffer and readable from shaders
+    static BufferPtr CreateIndex(int64_t size, bool isWritable = false);
+    // Indirect draw arguments, written by shaders
+    static BufferPtr CreateIndirect(int64_t size);
 
 private:
     void BindDescriptor();
@@ -116,6 +116,21 @@ void BoundResources::Reset()
 
     isPsoGraphicsDirty = true;
     isPsoComputeDirty = true;
+
+    indexBuffer = nullptr;
+    isIndexBufferDirty = true;
+}
+
+void BoundResources::SetIndexBuffer(const BufferPtr& buffer, IndexType type)
+{
+    if (indexBuffer == buffer && indexType == type)
+    {
+        return;
+    }
+
+    indexBuffer = buffer;
+    indexType = type;
+    isIndexBufferDirty = true;
 }
 
 void BoundResources::SetPsoGraphics(const PSOGraphics* pso)
@@ -381,6 +396,16 @@ void CommandBuffer::BindPsoCompute(const PSOCompute* pso)
     m_boundRes.SetPsoCompute(pso);
 }
 
+// Binding is deferred to the next indexed draw, so rebinding the same buffer is free
+void CommandBuffer::BindIndexBuffer(BufferPtr buffer, IndexType indexType)
+{
+    Assert(buffer);
+
+    AddBufferUsage(buffer, BufferUsageIndexRead);
+
+    m_boundRes.SetIndexBuffer(buffer, indexType);
+}
+
 void CommandBuffer::SetViewport(float x, float y, float width, float height, float minDepth, float maxDepth)
 {
     m_stateGraphicsDynamic.viewport.x = x;
@@ -436,6 +461,85 @@ void CommandBuffer::Draw(uint32_t vtxCount, uint32_t instanceCount, uint32_t fir
     vkCmdDraw(m_commandBuffer.GetVkCommandBuffer(), vtxCount, instanceCount, firstVertex, firstInstance);
 }
 
+void CommandBuffer::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    ProfileFunction();
+
+    ValidateIsInRecordingState();
+
+    Assert(m_renderPassState.isRenderingBegan, "Begin render pass first");
+
+    if (!m_boundRes.HasPsoGraphics())
+    {
+        LogError("Graphics PSO must be bound");
+        return;
+    }
+
+    if (!m_boundRes.indexBuffer)
+    {
+        LogError("Index buffer must be bound");
+        return;
+    }
+
+    if (m_boundRes.isPsoGraphicsDirty)
+    {
+        ProfileScope("Binding Graphics Pipeline");
+        vkCmdBindPipeline(m_commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_boundRes.psoGraphics->GetPipeline());
+        m_boundRes.isPsoGraphicsDirty = false;
+    }
+
+    if (m_boundRes.isIndexBufferDirty)
+    {
+        vkCmdBindIndexBuffer(m_commandBuffer.GetVkCommandBuffer(), m_boundRes.indexBuffer->GetBuffer().GetVkBuffer(), 0, (VkIndexType)m_boundRes.indexType);
+        m_boundRes.isIndexBufferDirty = false;
+    }
+
+    SetDynamicStates();
+
+    vkCmdDrawIndexed(m_commandBuffer.GetVkCommandBuffer(), indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+void CommandBuffer::DrawIndexedIndirect(BufferPtr argsBuffer, uint32_t offset)
+{
+    ProfileFunction();
+
+    ValidateIsInRecordingState();
+
+    Assert(m_renderPassState.isRenderingBegan, "Begin render pass first");
+    Assert(argsBuffer);
+
+    if (!m_boundRes.HasPsoGraphics())
+    {
+        LogError("Graphics PSO must be bound");
+        return;
+    }
+
+    if (!m_boundRes.indexBuffer)
+    {
+        LogError("Index buffer must be bound");
+        return;
+    }
+
+    AddBufferUsage(argsBuffer, BufferUsageIndirectRead);
+
+    if (m_boundRes.isPsoGraphicsDirty)
+    {
+        ProfileScope("Binding Graphics Pipeline");
+        vkCmdBindPipeline(m_commandBuffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_boundRes.psoGraphics->GetPipeline());
+        m_boundRes.isPsoGraphicsDirty = false;
+    }
+
+    if (m_boundRes.isIndexBufferDirty)
+    {
+        vkCmdBindIndexBuffer(m_commandBuffer.GetVkCommandBuffer(), m_boundRes.indexBuffer->GetBuffer().GetVkBuffer(), 0, (VkIndexType)m_boundRes.indexType);
+        m_boundRes.isIndexBufferDirty = false;
+    }
+
+    SetDynamicStates();
+
+    vkCmdDrawIndexedIndirect(m_commandBuffer.GetVkCommandBuffer(), argsBuffer->GetBuffer().GetVkBuffer(), offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+}
+
 void CommandBuffer::DrawMeshTasks(uint32_t x, uint32_t y, uint32_t z)
 {
     ProfileFunction();
@@ -505,7 +609,7 @@ void CommandBuffer::CopyToBuffer(BufferPtr buffer, const void* data, size_t size
 
     VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2 };
     region.srcOffset = 0;
-    region.dstOffset = 0;
+    region.dstOffset = upload.offset;
     region.size = size;
 
     VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2 };
@@ -517,6 +621,59 @@ void CommandBuffer::CopyToBuffer(BufferPtr buffer, const void* data, size_t size
     vkCmdCopyBuffer2(m_commandBuffer.GetVkCommandBuffer(), &copyInfo);
 }
 
+// Packs all uploads into one staging buffer instead of allocating one per copy
+void CommandBuffer::CopyToBuffers(const std::vector<BufferUpload>& uploads)
+{
+    ValidateIsInRecordingState();
+
+    const size_t alignment = 16;
+
+    size_t stagingSize = 0;
+    for (const BufferUpload& upload : uploads)
+    {
+        Assert(upload.buffer.get() && upload.data && upload.size && upload.offset + upload.size <= (size_t)upload.buffer->GetSize());
+
+        stagingSize = (stagingSize + alignment - 1) & ~(alignment - 1);
+        stagingSize += upload.size;
+    }
+
+    if (stagingSize == 0)
+    {
+        return;
+    }
+
+    BufferPtr stagingBuffer = GetStagingBuffer(stagingSize);
+
+    uint8_t* stagingBufferPtr = (uint8_t*)stagingBuffer->Map();
+
+    size_t offset = 0;
+    for (const BufferUpload& upload : uploads)
+    {
+        offset = (offset + alignment - 1) & ~(alignment - 1);
+
+        memcpy(stagingBufferPtr + offset, upload.data, upload.size);
+
+        AddBufferUsage(upload.buffer, BufferUsageTransferDst);
+
+        VkBufferCopy2 region{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2 };
+        region.srcOffset = offset;
+        region.dstOffset = 0;
+        region.size = upload.size;
+
+        VkCopyBufferInfo2 copyInfo{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2 };
+        copyInfo.srcBuffer = stagingBuffer->GetBuffer().GetVkBuffer();
+        copyInfo.dstBuffer = upload.buffer->GetBuffer().GetVkBuffer();
+        copyInfo.regionCount = 1;
+        copyInfo.pRegions = &region;
+
+        vkCmdCopyBuffer2(m_commandBuffer.GetVkCommandBuffer(), &copyInfo);
+
+        offset += upload.size;
+    }
+
+    stagingBuffer->Unmap();
+}
+
 void CommandBuffer::CopyToTexture(TexturePtr texture, const void* ptr, size_t sizeBytes)
 {
     Assert(texture.get());
@@ -667,6 +824,26 @@ void CommandBuffer::RegisterUAVUsageBuffer(BufferPtr buffer)
     AddBufferUsage(buffer, BufferUsageStorageRead | BufferUsageStorageWrite, ShaderStageAll);
 }
 
+void CommandBuffer::RegisterIndexUsageBuffer(BufferPtr buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    AddBufferUsage(buffer, BufferUsageIndexRead);
+}
+
+void CommandBuffer::RegisterIndirectUsageBuffer(BufferPtr buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    AddBufferUsage(buffer, BufferUsageIndirectRead);
+}
+
 void CommandBuffer::RegisterUAVUsageTexture(TexturePtr texture)
 {
     if (!texture)
@@ -3,6 +3,7 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "VulkanImpl/VulkanCommandBuffer.h"
 
@@ -22,6 +23,15 @@
 
 class RenderDriver;
 
+struct BufferUpload
+{
+    BufferPtr buffer;
+    const void* data = nullptr;
+    size_t size = 0;
+    // In bytes from the start of the buffer
+    size_t offset = 0;
+};
+
 namespace
 {
     struct RenderPassState
@@ -60,9 +70,14 @@ namespace
         const PSOCompute* psoCompute = nullptr;
         bool isPsoGraphicsDirty = true;
         bool isPsoComputeDirty = true;
+        BufferPtr indexBuffer;
+        IndexType indexType = IndexType::Uint32;
+        bool isIndexBufferDirty = true;
 
         void Reset();
 
+        void SetIndexBuffer(const BufferPtr& buffer, IndexType type);
+
         void SetPsoGraphics(const PSOGraphics* pso);
         bool HasPsoGraphics();
 
@@ -147,7 +162,12 @@ public:
 
     void PushConstants(const void* data, size_t size);
 
+    void BindIndexBuffer(BufferPtr buffer, IndexType indexType);
+
     void Draw(uint32_t vtxCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+    // One VkDrawIndexedIndirectCommand at the offset, written on the GPU
+    void DrawIndexedIndirect(BufferPtr argsBuffer, uint32_t offset = 0);
     void DrawMeshTasks(uint32_t x, uint32_t y, uint32_t z);
 
     void Dispatch(int x, int y, int z);
@@ -155,12 +175,16 @@ public:
     void ResetBindAndRenderStates();
 
     void CopyToBuffer(BufferPtr buffer, const void* data, size_t size);
+    void CopyToBuffers(const std::vector<BufferUpload>& uploads);
     void CopyToTexture(TexturePtr texture, const void* ptr, size_t sizeBytes);
     void GenerateMipmaps(TexturePtr texture);
 
     void RegisterSRVUsageBuffer(BufferPtr buffer);
     void RegisterSRVUsageTexture(TexturePtr texture);
     void RegisterUAVUsageBuffer(BufferPtr buffer);
+    // Buffers written on the GPU must be registered before the render pass that draws with them
+    void RegisterIndexUsageBuffer(BufferPtr buffer);
+    void RegisterIndirectUsageBuffer(BufferPtr buffer);
     void RegisterUAVUsageTexture(TexturePtr texture);
 
     void MarkerBegin(const char* markerName = nullptr);
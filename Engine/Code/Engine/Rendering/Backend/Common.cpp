@@ -20,6 +20,8 @@ size_t GetFormatSize(Format format)
         return 4 * 2;
     case Format::R32_UINT:
         return 1 * 4;
+    case Format::R32_SFLOAT:
+        return 1 * 4;
     case Format::RG32_SFLOAT:
         return 2 * 4;
     case Format::RGBA32_SFLOAT:
@@ -12,6 +12,7 @@ enum class Format : uint32_t
     RG16_SFLOAT = 83,
     RGBA16_SFLOAT = 97,
     R32_UINT = 98,
+    R32_SFLOAT = 100,
     RG32_SFLOAT = 103,
     RGBA32_SFLOAT = 109,
     B10G11R11_UFLOAT = 122,
@@ -22,6 +23,12 @@ size_t GetFormatSize(Format format);
 
 bool IsFormatHasDepth(Format format);
 
+enum class IndexType : uint32_t
+{
+    Uint16 = 0,
+    Uint32 = 1
+};
+
 enum class CompareOp : uint8_t
 {
     Never = 0,
@@ -5,6 +5,9 @@
 #include "Buffer.h"
 #include "Texture.h"
 
+// Enough for 65536 pixels, mirrors the array size of hiZTextures in PerFrameData
+const inline static uint32_t HI_Z_MAX_LEVEL_COUNT = 16;
+
 struct CommonRenderResources
 {
     BufferPtr perFrameBuffer;
@@ -12,6 +15,8 @@ struct CommonRenderResources
     TexturePtr depthTarget;
     std::vector<TexturePtr> bloomTextures;
     std::vector<TexturePtr> hdrTargetHalfs;
+    // Farthest depth of the depth target, each level halves the one before, rounding up
+    std::vector<TexturePtr> hiZTextures;
     TexturePtr skybox;
     TexturePtr convolutedSkybox;
     TexturePtr brdfLut;
@@ -14,10 +14,10 @@ void GPUQueryPipelineStatistics::Create()
         VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
         VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
         VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
-        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
-        //VK_QUERY_PIPELINE_STATISTIC_TASK_SHADER_INVOCATIONS_BIT_EXT |
-        //VK_QUERY_PIPELINE_STATISTIC_MESH_SHADER_INVOCATIONS_BIT_EXT;
-    pipelineStatsQueryPoolInfo.queryCount = m_pipelineStatsQueryCount = 7;
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_TASK_SHADER_INVOCATIONS_BIT_EXT |
+        VK_QUERY_PIPELINE_STATISTIC_MESH_SHADER_INVOCATIONS_BIT_EXT;
+    pipelineStatsQueryPoolInfo.queryCount = m_pipelineStatsQueryCount = 9;
 
     VK_VALIDATE(vkCreateQueryPool(VkContext::Get()->GetVkDevice(), &pipelineStatsQueryPoolInfo, nullptr, &m_pipelineStatsPool));
 }
@@ -52,9 +52,9 @@ std::vector<PipelineStatistics> GPUQueryPipelineStatistics::GetResults()
         "Primitives processed",
         "Primitives output   ",
         "FS invocations      ",
-        "CS invocations      "
-        //"TS invocations      ",
-        //"MS invocations      "
+        "CS invocations      ",
+        "TS invocations      ",
+        "MS invocations      "
     };
 
     int i = 0;
@@ -4,13 +4,14 @@
 #include "VulkanImpl/VulkanValidation.h"
 
 #include "DescriptorBindingTable.h"
+#include "PSOUsageLog.h"
 
 std::unordered_map<void*, std::unique_ptr<PSOCompute>> PSOCompute::s_psoCache;
 
 PSOCompute::PSOCompute(const Shader* shader)
     : m_shader(shader)
 {
-    CreatePipeline();
+    m_pipeline = CreatePipeline(m_shader);
 }
 
 PSOCompute::~PSOCompute()
@@ -58,6 +59,8 @@ const PSOCompute* PSOCompute::Get(const Shader* shader)
 
     if (pso->m_pipeline)
     {
+        PSOUsageLog::RecordCompute(shader);
+
         const PSOCompute* retValue = pso.get();
         s_psoCache.emplace((void*)shader, std::move(pso));
         return retValue;
@@ -66,23 +69,62 @@ const PSOCompute* PSOCompute::Get(const Shader* shader)
     return nullptr;
 }
 
-void PSOCompute::RecreateOnShaderChanged(const std::unordered_set<const Shader*>& changedShaders)
+std::vector<PSOComputeRecreation> PSOCompute::GatherRecreations(const std::vector<ShaderRecompilation>& recompilations)
+{
+    std::unordered_set<const Shader*> shaders;
+    for (const ShaderRecompilation& recompilation : recompilations)
+    {
+        shaders.insert(recompilation.shader);
+    }
+
+    std::vector<PSOComputeRecreation> recreations;
+    for (auto& [shader, pso] : s_psoCache)
+    {
+        if (shaders.contains(pso->GetShader()))
+        {
+            recreations.push_back({ pso.get(), VK_NULL_HANDLE });
+        }
+    }
+
+    return recreations;
+}
+
+void PSOCompute::Recreate(std::vector<PSOComputeRecreation>& recreations, const std::vector<ShaderRecompilation>& recompilations)
 {
-    for (auto& [hash, pso] : s_psoCache)
+    ProfileFunction();
+
+    for (PSOComputeRecreation& recreation : recreations)
+    {
+        auto it = std::find_if(recompilations.begin(), recompilations.end(), [&](const ShaderRecompilation& recompilation)
+            {
+                return recompilation.shader == recreation.pso->GetShader();
+            });
+
+        if (it != recompilations.end() && it->recompiled)
+        {
+            recreation.pipeline = recreation.pso->CreatePipeline(it->recompiled.get());
+        }
+    }
+}
+
+void PSOCompute::ApplyRecreations(std::vector<PSOComputeRecreation>& recreations, std::vector<VkPipeline>& retiredPipelines)
+{
+    for (PSOComputeRecreation& recreation : recreations)
     {
-        if (!changedShaders.contains(pso->GetShader()))
+        if (!recreation.pipeline)
         {
             continue;
         }
 
-        if (pso->m_pipeline)
+        if (recreation.pso->m_pipeline)
         {
-            vkDestroyPipeline(VkContext::Get()->GetVkDevice(), pso->m_pipeline, nullptr);
-            pso->m_pipeline = VK_NULL_HANDLE;
+            retiredPipelines.push_back(recreation.pso->m_pipeline);
         }
 
-        pso->CreatePipeline();
+        recreation.pso->m_pipeline = recreation.pipeline;
     }
+
+    recreations.clear();
 }
 
 void PSOCompute::DestroyCache()
@@ -90,12 +132,15 @@ void PSOCompute::DestroyCache()
     s_psoCache.clear();
 }
 
-void PSOCompute::CreatePipeline()
+VkPipeline PSOCompute::CreatePipeline(const Shader* shader) const
 {
     VkComputePipelineCreateInfo pipelineCreateInfo{ .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
     pipelineCreateInfo.flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
-    pipelineCreateInfo.stage = m_shader->GetComputeStage()->GetVkShader()->GetPipelineStageCreateInfo();
+    pipelineCreateInfo.stage = shader->GetComputeStage()->GetVkShader()->GetPipelineStageCreateInfo();
     pipelineCreateInfo.layout = DescriptorBindingTable::Get()->GetPipelineLayout();
 
-    VK_VALIDATE(vkCreateComputePipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_pipeline));
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_VALIDATE(vkCreateComputePipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline));
+
+    return pipeline;
 }
\ No newline at end of file
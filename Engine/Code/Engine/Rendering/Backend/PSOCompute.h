@@ -2,6 +2,14 @@
 
 #include "Shader.h"
 
+class PSOCompute;
+
+struct PSOComputeRecreation
+{
+    PSOCompute* pso = nullptr;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
 class PSOCompute
 {
 public:
@@ -15,12 +23,15 @@ public:
     const Shader* GetShader() const;
 
     static const PSOCompute* Get(const Shader* shader);
-    static void RecreateOnShaderChanged(const std::unordered_set<const Shader*>& changedShaders);
+
+    static std::vector<PSOComputeRecreation> GatherRecreations(const std::vector<ShaderRecompilation>& recompilations);
+    static void Recreate(std::vector<PSOComputeRecreation>& recreations, const std::vector<ShaderRecompilation>& recompilations);
+    static void ApplyRecreations(std::vector<PSOComputeRecreation>& recreations, std::vector<VkPipeline>& retiredPipelines);
 
     static void DestroyCache();
 
 private:
-    void CreatePipeline();
+    VkPipeline CreatePipeline(const Shader* shader) const;
 
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
@@ -1,19 +1,44 @@
 #include "PSOGraphics.h"
 
+#include <algorithm>
+
 #include "VulkanImpl/VkContext.h"
 #include "VulkanImpl/VulkanValidation.h"
 
 #include "DescriptorBindingTable.h"
-
-std::unordered_map<uint32_t, std::unique_ptr<PSOGraphics>> PSOGraphics::s_psoCache;
-
-PSOGraphics::PSOGraphics(const PipelineGraphicsState& state)
+#include "PSOUsageLog.h"
+
+std::unordered_multimap<uint64_t, std::unique_ptr<PSOGraphics>> PSOGraphics::s_psoCache;
+
+std::vector<std::thread> PSOGraphics::s_compileThreads;
+std::mutex PSOGraphics::s_compileMutex;
+std::condition_variable PSOGraphics::s_compileCondition;
+std::condition_variable PSOGraphics::s_pendingCondition;
+std::deque<PSOGraphics*> PSOGraphics::s_compileQueue;
+std::deque<PSOGraphicsOptimization> PSOGraphics::s_optimizeQueue;
+std::vector<PSOGraphicsOptimization> PSOGraphics::s_optimizedPipelines;
+bool PSOGraphics::s_isCompileThreadStopping = false;
+std::atomic<int> PSOGraphics::s_pendingCount = 0;
+std::atomic<int> PSOGraphics::s_optimizePendingCount = 0;
+std::atomic<int> PSOGraphics::s_hitchesAvoidedCount = 0;
+
+std::array<std::unordered_multimap<uint64_t, PSOGraphicsLibrary>, GraphicsLibraryPartCount> PSOGraphics::s_libraryCache;
+std::mutex PSOGraphics::s_libraryMutex;
+
+PSOGraphics::PSOGraphics(const PipelineGraphicsState& state, bool isDeferCreation)
     : m_state(state)
 {
     const auto& renderingState = m_state.GetRenderingState().state;
     Assert(renderingState.colorAttachmentCount == m_state.GetBlendState().state.attachmentCount || renderingState.depthAttachmentFormat != VK_FORMAT_UNDEFINED, "Blend attachment count is zero");
 
-    CreatePipeline();
+    if (!isDeferCreation)
+    {
+        PSOGraphicsOptimization optimization{};
+        m_pipeline = CreatePipeline(m_state.GetShader(), &optimization);
+        m_isReady = m_pipeline != VK_NULL_HANDLE;
+
+        QueueOptimization(optimization);
+    }
 }
 
 PSOGraphics::~PSOGraphics()
@@ -25,6 +50,11 @@ PSOGraphics::~PSOGraphics()
     }
 }
 
+bool PSOGraphics::IsReady() const
+{
+    return m_isReady;
+}
+
 VkPipeline PSOGraphics::GetPipeline() const
 {
     return m_pipeline;
@@ -39,12 +69,11 @@ const PSOGraphics* PSOGraphics::Get(const PipelineGraphicsState& state)
 {
     ProfileFunction();
 
-    uint32_t hash = state.CalculateHash();
+    uint64_t hash = state.CalculateHash();
 
-    auto it = s_psoCache.find(hash);
-    if (it != s_psoCache.end())
+    if (const PSOGraphics* pso = Find(state, hash))
     {
-        return it->second.get();
+        return pso;
     }
 
     if (!state.GetShader())
@@ -57,6 +86,8 @@ const PSOGraphics* PSOGraphics::Get(const PipelineGraphicsState& state)
     
     if (pso->m_pipeline)
     {
+        PSOUsageLog::RecordGraphics(state);
+
         const PSOGraphics* retValue = pso.get();
         s_psoCache.emplace(hash, std::move(pso));
         return retValue;
@@ -65,53 +96,371 @@ const PSOGraphics* PSOGraphics::Get(const PipelineGraphicsState& state)
     return nullptr;
 }
 
+// Returns the cached PSO right away. A PSO seen for the first time is returned in a not ready state
+// while its shader and pipeline are created on the compile threads, callers are expected to skip the draw.
+const PSOGraphics* PSOGraphics::GetAsync(const PipelineGraphicsState& state)
+{
+    ProfileFunction();
+
+    uint64_t hash = state.CalculateHash();
+
+    if (const PSOGraphics* pso = Find(state, hash))
+    {
+        return pso;
+    }
+
+    if (!state.GetShader())
+    {
+        LogError("PSOGraphics creation failed. Shader must be bount")
+        return nullptr;
+    }
+
+    std::unique_ptr<PSOGraphics> pso = std::make_unique<PSOGraphics>(state, true);
+    PSOGraphics* retValue = pso.get();
+    s_psoCache.emplace(hash, std::move(pso));
+
+    QueueCompile(retValue);
+
+    return retValue;
+}
+
+void PSOGraphics::QueueCompile(PSOGraphics* pso)
+{
+    StartCompileThreads();
+
+    {
+        std::lock_guard<std::mutex> lock(s_compileMutex);
+        s_compileQueue.push_back(pso);
+        s_pendingCount++;
+    }
+    s_compileCondition.notify_one();
+}
+
+// States are compared in full, so two states colliding on the hash get their own PSOs
+PSOGraphics* PSOGraphics::Find(const PipelineGraphicsState& state, uint64_t hash)
+{
+    auto [begin, end] = s_psoCache.equal_range(hash);
+    for (auto it = begin; it != end; it++)
+    {
+        if (it->second->m_state == state)
+        {
+            return it->second.get();
+        }
+    }
+
+    return nullptr;
+}
+
+int PSOGraphics::GetPendingCount()
+{
+    return s_pendingCount;
+}
+
+int PSOGraphics::GetHitchesAvoidedCount()
+{
+    return s_hitchesAvoidedCount;
+}
+
+void PSOGraphics::WaitForPending()
+{
+    ProfileStall("PSOGraphics::WaitForPending");
+
+    std::unique_lock<std::mutex> lock(s_compileMutex);
+    s_pendingCondition.wait(lock, [] { return s_pendingCount == 0 && s_optimizePendingCount == 0; });
+}
+
+// Swaps fast-linked pipelines for their optimized versions once the compile threads have linked them
+void PSOGraphics::ApplyOptimizations(std::vector<VkPipeline>& retiredPipelines)
+{
+    ProfileFunction();
+
+    std::vector<PSOGraphicsOptimization> optimizations;
+    {
+        std::lock_guard<std::mutex> lock(s_compileMutex);
+        optimizations.swap(s_optimizedPipelines);
+    }
+
+    for (const PSOGraphicsOptimization& optimization : optimizations)
+    {
+        if (!optimization.optimizedPipeline)
+        {
+            continue;
+        }
+
+        // The PSO was recreated by a shader reload while the optimized link was in flight
+        if (optimization.pso->m_pipeline != optimization.linkedPipeline)
+        {
+            retiredPipelines.push_back(optimization.optimizedPipeline);
+            continue;
+        }
+
+        retiredPipelines.push_back(optimization.pso->m_pipeline);
+        optimization.pso->m_pipeline = optimization.optimizedPipeline;
+    }
+}
+
 void PSOGraphics::DestroyCache()
 {
+    StopCompileThreads();
+
+    VkDevice device = VkContext::Get()->GetVkDevice();
+
+    for (const PSOGraphicsOptimization& optimization : s_optimizedPipelines)
+    {
+        if (optimization.optimizedPipeline)
+        {
+            vkDestroyPipeline(device, optimization.optimizedPipeline, nullptr);
+        }
+    }
+    s_optimizedPipelines.clear();
+
     s_psoCache.clear();
+
+    for (auto& libraries : s_libraryCache)
+    {
+        for (auto& [hash, library] : libraries)
+        {
+            vkDestroyPipeline(device, library.pipeline, nullptr);
+        }
+        libraries.clear();
+    }
 }
 
-void PSOGraphics::RecreateOnShaderChanged(const std::unordered_set<const Shader*>& changedShaders)
+std::vector<PSOGraphicsRecreation> PSOGraphics::GatherRecreations(const std::vector<ShaderRecompilation>& recompilations)
 {
+    ProfileFunction();
+
+    std::unordered_set<const Shader*> shaders;
+    for (const ShaderRecompilation& recompilation : recompilations)
+    {
+        shaders.insert(recompilation.shader);
+    }
+
+    std::vector<PSOGraphicsRecreation> recreations;
     for (auto& [hash, pso] : s_psoCache)
     {
-        if (!changedShaders.contains(pso->GetShader()))
+        if (pso->IsReady() && shaders.contains(pso->GetShader()))
+        {
+            recreations.push_back({ pso.get(), VK_NULL_HANDLE });
+        }
+    }
+
+    return recreations;
+}
+
+// Runs on the shader reload thread. Pipelines are created from the recompiled stages while the old ones keep rendering.
+void PSOGraphics::Recreate(std::vector<PSOGraphicsRecreation>& recreations, const std::vector<ShaderRecompilation>& recompilations)
+{
+    ProfileFunction();
+
+    std::unordered_map<const Shader*, const Shader*> recompiledShaders;
+    for (const ShaderRecompilation& recompilation : recompilations)
+    {
+        if (recompilation.recompiled)
+        {
+            recompiledShaders.emplace(recompilation.shader, recompilation.recompiled.get());
+        }
+    }
+
+    for (PSOGraphicsRecreation& recreation : recreations)
+    {
+        auto it = recompiledShaders.find(recreation.pso->GetShader());
+        if (it != recompiledShaders.end())
+        {
+            recreation.pipeline = recreation.pso->CreatePipeline(it->second, nullptr);
+        }
+    }
+}
+
+void PSOGraphics::ApplyRecreations(std::vector<PSOGraphicsRecreation>& recreations, const std::unordered_set<const Shader*>& changedShaders, std::vector<VkPipeline>& retiredPipelines)
+{
+    ProfileFunction();
+
+    DestroyLibraries(changedShaders, retiredPipelines);
+
+    std::unordered_set<const PSOGraphics*> recreatedPsos;
+    for (PSOGraphicsRecreation& recreation : recreations)
+    {
+        if (!recreation.pipeline)
         {
             continue;
         }
 
+        PSOGraphics* pso = recreation.pso;
         if (pso->m_pipeline)
         {
-            vkDestroyPipeline(VkContext::Get()->GetVkDevice(), pso->m_pipeline, nullptr);
-            pso->m_pipeline = VK_NULL_HANDLE;
+            retiredPipelines.push_back(pso->m_pipeline);
         }
 
-        pso->CreatePipeline();
+        pso->m_pipeline = recreation.pipeline;
+        pso->m_isReady = true;
+
+        recreatedPsos.insert(pso);
+    }
+    recreations.clear();
+
+    // PSOs created after the reload started or failed before still use the old stages
+    for (auto& [hash, pso] : s_psoCache)
+    {
+        if (recreatedPsos.contains(pso.get()) || !changedShaders.contains(pso->GetShader()))
+        {
+            continue;
+        }
+
+        // Pending creations were waited for, so this one failed. Its shader compiles now, the compile threads retry it.
+        if (!pso->m_pipeline)
+        {
+            QueueCompile(pso.get());
+            continue;
+        }
+
+        retiredPipelines.push_back(pso->m_pipeline);
+
+        PSOGraphicsOptimization optimization{};
+        pso->m_pipeline = pso->CreatePipeline(pso->GetShader(), &optimization);
+        pso->m_isReady = pso->m_pipeline != VK_NULL_HANDLE;
+
+        QueueOptimization(optimization);
     }
 }
 
-void PSOGraphics::CreatePipeline()
+void PSOGraphics::StartCompileThreads()
 {
-    Assert(m_state.GetShader());
+    if (!s_compileThreads.empty())
+    {
+        return;
+    }
 
-    std::array<VkPipelineShaderStageCreateInfo, 3> shaderStages;
-    int shaderStagesCount = 0;
+    uint32_t threadsCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
 
-    if (m_state.GetShader()->GetTaskStage())
+    s_isCompileThreadStopping = false;
+    for (uint32_t i = 0; i < threadsCount; i++)
     {
-        shaderStages[shaderStagesCount++] = m_state.GetShader()->GetTaskStage()->GetVkShader()->GetPipelineStageCreateInfo();
+        s_compileThreads.emplace_back(&PSOGraphics::CompileThreadLoop);
     }
-    if (m_state.GetShader()->GetMeshStage())
+}
+
+void PSOGraphics::StopCompileThreads()
+{
+    if (s_compileThreads.empty())
     {
-        shaderStages[shaderStagesCount++] = m_state.GetShader()->GetMeshStage()->GetVkShader()->GetPipelineStageCreateInfo();
+        return;
     }
-    else if (m_state.GetShader()->GetVertexStage())
+
     {
-        shaderStages[shaderStagesCount++] = m_state.GetShader()->GetVertexStage()->GetVkShader()->GetPipelineStageCreateInfo();
+        std::lock_guard<std::mutex> lock(s_compileMutex);
+        s_isCompileThreadStopping = true;
+        s_compileQueue.clear();
+        s_optimizeQueue.clear();
     }
-    if (m_state.GetShader()->GetPixelStage())
+    s_compileCondition.notify_all();
+
+    for (std::thread& thread : s_compileThreads)
     {
-        shaderStages[shaderStagesCount++] = m_state.GetShader()->GetPixelStage()->GetVkShader()->GetPipelineStageCreateInfo();
+        thread.join();
     }
+    s_compileThreads.clear();
+
+    s_pendingCount = 0;
+    s_optimizePendingCount = 0;
+    s_pendingCondition.notify_all();
+}
+
+void PSOGraphics::CompileThreadLoop()
+{
+    ProfileSetThreadName("PSO Compile");
+
+    while (true)
+    {
+        PSOGraphics* pso = nullptr;
+        PSOGraphicsOptimization optimization{};
+        {
+            std::unique_lock<std::mutex> lock(s_compileMutex);
+            s_compileCondition.wait(lock, [] { return s_isCompileThreadStopping || !s_compileQueue.empty() || !s_optimizeQueue.empty(); });
+
+            if (s_isCompileThreadStopping)
+            {
+                return;
+            }
+
+            // New PSOs come first, optimizing the ones that already render can wait
+            if (!s_compileQueue.empty())
+            {
+                pso = s_compileQueue.front();
+                s_compileQueue.pop_front();
+            }
+            else
+            {
+                optimization = s_optimizeQueue.front();
+                s_optimizeQueue.pop_front();
+            }
+        }
+
+        if (!pso)
+        {
+            {
+                ProfileScope("PSOGraphics::OptimizedLink");
+
+                optimization.optimizedPipeline = LinkLibraries(optimization, true);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(s_compileMutex);
+                s_optimizedPipelines.push_back(optimization);
+                s_optimizePendingCount--;
+            }
+            s_pendingCondition.notify_all();
+
+            continue;
+        }
+
+        {
+            ProfileScope("PSOGraphics::AsyncCreate");
+
+            Shader* shader = pso->m_state.GetShader();
+            shader->EnsureCompiled();
+
+            PSOGraphicsOptimization optimization{};
+            if (shader->GetVertexStage() || shader->GetMeshStage())
+            {
+                pso->m_pipeline = pso->CreatePipeline(shader, &optimization);
+            }
+            pso->m_isReady = pso->m_pipeline != VK_NULL_HANDLE;
+
+            QueueOptimization(optimization);
+        }
+
+        // Only created PSOs are logged, a failing one would otherwise be prewarmed on every launch
+        if (pso->m_isReady)
+        {
+            PSOUsageLog::RecordGraphics(pso->m_state);
+            s_hitchesAvoidedCount++;
+        }
+        else
+        {
+            LogError("PSOGraphics async creation failed for shader {}", pso->GetShader()->GetName());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_compileMutex);
+            s_pendingCount--;
+        }
+        s_pendingCondition.notify_all();
+    }
+}
+
+// Without an optimization to fill the pipeline is created monolithic
+VkPipeline PSOGraphics::CreatePipeline(const Shader* shader, PSOGraphicsOptimization* optimization)
+{
+    Assert(shader);
+
+    if (optimization && IsLibrarySupported())
+    {
+        return LinkPipeline(shader, *optimization);
+    }
+
+    std::array<VkPipelineShaderStageCreateInfo, 3> shaderStages;
+    uint32_t shaderStagesCount = GetShaderStages(shader, shaderStages);
 
     VkPipelineVertexInputStateCreateInfo vertexInputState = CreateVertexInputState();
     VkPipelineViewportStateCreateInfo viewportState = CreateViewportState();
@@ -133,7 +482,281 @@ void PSOGraphics::CreatePipeline()
     pipelineCreateInfo.pDynamicState = &dynamicStatesState;
     pipelineCreateInfo.layout = DescriptorBindingTable::Get()->GetPipelineLayout();
 
-    VK_VALIDATE(vkCreateGraphicsPipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_pipeline));
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_VALIDATE(vkCreateGraphicsPipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline));
+
+    return pipeline;
+}
+
+// Fast-links the pipeline from independently compiled parts, so a new state combination only compiles the parts it doesn't share.
+// The caller stores the pipeline in the PSO first, then queues the optimization, the link time optimized pipeline
+// is built on the compile threads and swapped in by ApplyOptimizations.
+VkPipeline PSOGraphics::LinkPipeline(const Shader* shader, PSOGraphicsOptimization& optimization)
+{
+    ProfileFunction();
+
+    optimization = {};
+    optimization.pso = this;
+
+    // Mesh shading pipelines have no vertex input interface
+    if (!shader->GetMeshStage())
+    {
+        optimization.libraries[optimization.libraryCount++] = GetLibrary(GraphicsLibraryPartVertexInput, shader);
+    }
+    optimization.libraries[optimization.libraryCount++] = GetLibrary(GraphicsLibraryPartPreRasterization, shader);
+    optimization.libraries[optimization.libraryCount++] = GetLibrary(GraphicsLibraryPartFragmentShader, shader);
+    optimization.libraries[optimization.libraryCount++] = GetLibrary(GraphicsLibraryPartFragmentOutput, shader);
+
+    for (uint32_t i = 0; i < optimization.libraryCount; i++)
+    {
+        if (!optimization.libraries[i])
+        {
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    optimization.linkedPipeline = LinkLibraries(optimization, false);
+
+    return optimization.linkedPipeline;
+}
+
+// The linked pipeline must already be stored in the PSO, ApplyOptimizations only swaps it while it is still in use
+void PSOGraphics::QueueOptimization(const PSOGraphicsOptimization& optimization)
+{
+    if (!optimization.linkedPipeline)
+    {
+        return;
+    }
+
+    StartCompileThreads();
+
+    {
+        std::lock_guard<std::mutex> lock(s_compileMutex);
+        s_optimizeQueue.push_back(optimization);
+        s_optimizePendingCount++;
+    }
+    s_compileCondition.notify_one();
+}
+
+VkPipeline PSOGraphics::GetLibrary(GraphicsLibraryPart part, const Shader* shader)
+{
+    uint64_t hash = 0;
+    const Shader* libraryShader = nullptr;
+
+    switch (part)
+    {
+    case GraphicsLibraryPartVertexInput:
+        hash = m_state.CalculateVertexInputHash();
+        break;
+    case GraphicsLibraryPartPreRasterization:
+        hash = m_state.CalculatePreRasterizationHash();
+        libraryShader = shader;
+        break;
+    case GraphicsLibraryPartFragmentShader:
+        hash = m_state.CalculateFragmentShaderHash();
+        libraryShader = shader;
+        break;
+    case GraphicsLibraryPartFragmentOutput:
+        hash = m_state.CalculateFragmentOutputHash();
+        break;
+    default:
+        Assert(false, "Unknown graphics pipeline library part");
+        return VK_NULL_HANDLE;
+    }
+
+    auto findLibrary = [this, part, hash]() -> VkPipeline
+        {
+            auto [begin, end] = s_libraryCache[part].equal_range(hash);
+            for (auto it = begin; it != end; it++)
+            {
+                if (IsLibraryPartEqual(part, it->second.state, m_state))
+                {
+                    return it->second.pipeline;
+                }
+            }
+
+            return VK_NULL_HANDLE;
+        };
+
+    {
+        std::lock_guard<std::mutex> lock(s_libraryMutex);
+
+        if (VkPipeline library = findLibrary())
+        {
+            return library;
+        }
+    }
+
+    VkPipeline library = CreateLibrary(part, shader);
+    if (!library)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lock(s_libraryMutex);
+
+    // Another compile thread may have created the same part meanwhile
+    if (VkPipeline existingLibrary = findLibrary())
+    {
+        vkDestroyPipeline(VkContext::Get()->GetVkDevice(), library, nullptr);
+        return existingLibrary;
+    }
+
+    s_libraryCache[part].emplace(hash, PSOGraphicsLibrary{ library, libraryShader, m_state });
+
+    return library;
+}
+
+VkPipeline PSOGraphics::CreateLibrary(GraphicsLibraryPart part, const Shader* shader)
+{
+    ProfileFunction();
+
+    std::array<VkPipelineShaderStageCreateInfo, 3> shaderStages;
+    uint32_t shaderStagesCount = GetShaderStages(shader, shaderStages);
+    bool hasPixelStage = shader->GetPixelStage() != nullptr;
+
+    VkPipelineVertexInputStateCreateInfo vertexInputState = CreateVertexInputState();
+    VkPipelineViewportStateCreateInfo viewportState = CreateViewportState();
+    VkPipelineMultisampleStateCreateInfo multisampleState = CreateMultisampleState();
+    VkPipelineDynamicStateCreateInfo dynamicStatesState = CreateDynamicStatesState();
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{ .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+    libraryCreateInfo.pNext = m_state.GetRenderingState().GetPtr();
+
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo{ .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineCreateInfo.pNext = &libraryCreateInfo;
+    pipelineCreateInfo.flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    pipelineCreateInfo.pDynamicState = &dynamicStatesState;
+
+    switch (part)
+    {
+    case GraphicsLibraryPartVertexInput:
+        libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+        pipelineCreateInfo.pVertexInputState = &vertexInputState;
+        pipelineCreateInfo.pInputAssemblyState = m_state.GetInputAssemblyState().GetPtr();
+        break;
+    case GraphicsLibraryPartPreRasterization:
+        libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+        pipelineCreateInfo.stageCount = hasPixelStage ? shaderStagesCount - 1 : shaderStagesCount;
+        pipelineCreateInfo.pStages = shaderStages.data();
+        pipelineCreateInfo.pViewportState = &viewportState;
+        pipelineCreateInfo.pRasterizationState = m_state.GetRasterizationState().GetPtr();
+        pipelineCreateInfo.layout = DescriptorBindingTable::Get()->GetPipelineLayout();
+        break;
+    case GraphicsLibraryPartFragmentShader:
+        libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+        pipelineCreateInfo.stageCount = hasPixelStage ? 1 : 0;
+        pipelineCreateInfo.pStages = hasPixelStage ? &shaderStages[shaderStagesCount - 1] : nullptr;
+        pipelineCreateInfo.pMultisampleState = &multisampleState;
+        pipelineCreateInfo.pDepthStencilState = m_state.GetDepthStencilState().GetPtr();
+        pipelineCreateInfo.layout = DescriptorBindingTable::Get()->GetPipelineLayout();
+        break;
+    case GraphicsLibraryPartFragmentOutput:
+        libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+        pipelineCreateInfo.pMultisampleState = &multisampleState;
+        pipelineCreateInfo.pColorBlendState = m_state.GetBlendState().GetPtr();
+        break;
+    default:
+        break;
+    }
+
+    VkPipeline library = VK_NULL_HANDLE;
+    VK_VALIDATE(vkCreateGraphicsPipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &library));
+
+    return library;
+}
+
+// Stages are ordered so the pixel stage, if present, is always the last one
+uint32_t PSOGraphics::GetShaderStages(const Shader* shader, std::array<VkPipelineShaderStageCreateInfo, 3>& shaderStages) const
+{
+    uint32_t shaderStagesCount = 0;
+
+    if (shader->GetTaskStage())
+    {
+        shaderStages[shaderStagesCount++] = shader->GetTaskStage()->GetVkShader()->GetPipelineStageCreateInfo();
+    }
+    if (shader->GetMeshStage())
+    {
+        shaderStages[shaderStagesCount++] = shader->GetMeshStage()->GetVkShader()->GetPipelineStageCreateInfo();
+    }
+    else if (shader->GetVertexStage())
+    {
+        shaderStages[shaderStagesCount++] = shader->GetVertexStage()->GetVkShader()->GetPipelineStageCreateInfo();
+    }
+    if (shader->GetPixelStage())
+    {
+        shaderStages[shaderStagesCount++] = shader->GetPixelStage()->GetVkShader()->GetPipelineStageCreateInfo();
+    }
+
+    for (uint32_t i = 0; i < shaderStagesCount; i++)
+    {
+        shaderStages[i].pSpecializationInfo = m_state.GetSpecializationState().GetPtr();
+    }
+
+    return shaderStagesCount;
+}
+
+bool PSOGraphics::IsLibraryPartEqual(GraphicsLibraryPart part, const PipelineGraphicsState& state, const PipelineGraphicsState& other)
+{
+    switch (part)
+    {
+    case GraphicsLibraryPartVertexInput:
+        return state.IsVertexInputEqual(other);
+    case GraphicsLibraryPartPreRasterization:
+        return state.IsPreRasterizationEqual(other);
+    case GraphicsLibraryPartFragmentShader:
+        return state.IsFragmentShaderEqual(other);
+    case GraphicsLibraryPartFragmentOutput:
+        return state.IsFragmentOutputEqual(other);
+    default:
+        return false;
+    }
+}
+
+bool PSOGraphics::IsLibrarySupported()
+{
+    return VkContext::Get()->GetDevice().IsGraphicsPipelineLibraryEnabled();
+}
+
+void PSOGraphics::DestroyLibraries(const std::unordered_set<const Shader*>& shaders, std::vector<VkPipeline>& retiredPipelines)
+{
+    std::lock_guard<std::mutex> lock(s_libraryMutex);
+
+    for (auto& libraries : s_libraryCache)
+    {
+        std::erase_if(libraries, [&shaders, &retiredPipelines](const auto& item)
+            {
+                if (item.second.shader && shaders.contains(item.second.shader))
+                {
+                    retiredPipelines.push_back(item.second.pipeline);
+                    return true;
+                }
+
+                return false;
+            });
+    }
+}
+
+VkPipeline PSOGraphics::LinkLibraries(const PSOGraphicsOptimization& optimization, bool isOptimize)
+{
+    VkPipelineLibraryCreateInfoKHR libraryInfo{ .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+    libraryInfo.libraryCount = optimization.libraryCount;
+    libraryInfo.pLibraries = optimization.libraries.data();
+
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo{ .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineCreateInfo.pNext = &libraryInfo;
+    pipelineCreateInfo.flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    pipelineCreateInfo.layout = DescriptorBindingTable::Get()->GetPipelineLayout();
+
+    if (isOptimize)
+    {
+        pipelineCreateInfo.flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+    }
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_VALIDATE(vkCreateGraphicsPipelines(VkContext::Get()->GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline));
+
+    return pipeline;
 }
 
 VkPipelineVertexInputStateCreateInfo PSOGraphics::CreateVertexInputState()
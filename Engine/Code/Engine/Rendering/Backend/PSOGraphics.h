@@ -1,25 +1,94 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "PipelineGraphicsState.h"
 
+class PSOGraphics;
+
+struct PSOGraphicsRecreation
+{
+    PSOGraphics* pso = nullptr;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
+enum GraphicsLibraryPart
+{
+    GraphicsLibraryPartVertexInput = 0,
+    GraphicsLibraryPartPreRasterization,
+    GraphicsLibraryPartFragmentShader,
+    GraphicsLibraryPartFragmentOutput,
+    GraphicsLibraryPartCount
+};
+
+struct PSOGraphicsLibrary
+{
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const Shader* shader = nullptr;
+    PipelineGraphicsState state{};
+};
+
+struct PSOGraphicsOptimization
+{
+    PSOGraphics* pso = nullptr;
+    VkPipeline linkedPipeline = VK_NULL_HANDLE;
+    VkPipeline optimizedPipeline = VK_NULL_HANDLE;
+    std::array<VkPipeline, GraphicsLibraryPartCount> libraries{};
+    uint32_t libraryCount = 0;
+};
+
 class PSOGraphics
 {
 public:
     NON_COPYABLE_MOVABLE(PSOGraphics);
 
-    PSOGraphics(const PipelineGraphicsState& state);
+    PSOGraphics(const PipelineGraphicsState& state, bool isDeferCreation = false);
     ~PSOGraphics();
 
+    bool IsReady() const;
+
     VkPipeline GetPipeline() const;
     const Shader* GetShader() const;
 
     static const PSOGraphics* Get(const PipelineGraphicsState& state);
+    static const PSOGraphics* GetAsync(const PipelineGraphicsState& state);
+
+    static int GetPendingCount();
+    static int GetHitchesAvoidedCount();
+    static void WaitForPending();
+
+    static void ApplyOptimizations(std::vector<VkPipeline>& retiredPipelines);
 
     static void DestroyCache();
-    static void RecreateOnShaderChanged(const std::unordered_set<const Shader*>& changedShaders);
+
+    static std::vector<PSOGraphicsRecreation> GatherRecreations(const std::vector<ShaderRecompilation>& recompilations);
+    static void Recreate(std::vector<PSOGraphicsRecreation>& recreations, const std::vector<ShaderRecompilation>& recompilations);
+    static void ApplyRecreations(std::vector<PSOGraphicsRecreation>& recreations, const std::unordered_set<const Shader*>& changedShaders, std::vector<VkPipeline>& retiredPipelines);
 
 private:
-    void CreatePipeline();
+    static PSOGraphics* Find(const PipelineGraphicsState& state, uint64_t hash);
+
+    VkPipeline CreatePipeline(const Shader* shader, PSOGraphicsOptimization* optimization);
+    VkPipeline LinkPipeline(const Shader* shader, PSOGraphicsOptimization& optimization);
+    VkPipeline GetLibrary(GraphicsLibraryPart part, const Shader* shader);
+    VkPipeline CreateLibrary(GraphicsLibraryPart part, const Shader* shader);
+    uint32_t GetShaderStages(const Shader* shader, std::array<VkPipelineShaderStageCreateInfo, 3>& shaderStages) const;
+
+    static bool IsLibraryPartEqual(GraphicsLibraryPart part, const PipelineGraphicsState& state, const PipelineGraphicsState& other);
+    static bool IsLibrarySupported();
+    static void DestroyLibraries(const std::unordered_set<const Shader*>& shaders, std::vector<VkPipeline>& retiredPipelines);
+    static VkPipeline LinkLibraries(const PSOGraphicsOptimization& optimization, bool isOptimize);
+
+    static void QueueCompile(PSOGraphics* pso);
+    static void QueueOptimization(const PSOGraphicsOptimization& optimization);
+    static void StartCompileThreads();
+    static void StopCompileThreads();
+    static void CompileThreadLoop();
 
     VkPipelineVertexInputStateCreateInfo CreateVertexInputState();
     VkPipelineViewportStateCreateInfo CreateViewportState();
@@ -29,6 +98,22 @@ private:
 private:
     PipelineGraphicsState m_state{};
     VkPipeline m_pipeline = VK_NULL_HANDLE;
+    std::atomic<bool> m_isReady = false;
+
+    static std::unordered_multimap<uint64_t, std::unique_ptr<PSOGraphics>> s_psoCache;
+
+    static std::vector<std::thread> s_compileThreads;
+    static std::mutex s_compileMutex;
+    static std::condition_variable s_compileCondition;
+    static std::condition_variable s_pendingCondition;
+    static std::deque<PSOGraphics*> s_compileQueue;
+    static std::deque<PSOGraphicsOptimization> s_optimizeQueue;
+    static std::vector<PSOGraphicsOptimization> s_optimizedPipelines;
+    static bool s_isCompileThreadStopping;
+    static std::atomic<int> s_pendingCount;
+    static std::atomic<int> s_optimizePendingCount;
+    static std::atomic<int> s_hitchesAvoidedCount;
 
-    static std::unordered_map<uint32_t, std::unique_ptr<PSOGraphics>> s_psoCache;
+    static std::array<std::unordered_multimap<uint64_t, PSOGraphicsLibrary>, GraphicsLibraryPartCount> s_libraryCache;
+    static std::mutex s_libraryMutex;
 };
\ No newline at end of file
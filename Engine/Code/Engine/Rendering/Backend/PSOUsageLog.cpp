@@ -0,0 +1,236 @@
+#include "PSOUsageLog.h"
+
+#include <fstream>
+
+#include "PSOCompute.h"
+#include "PSOGraphics.h"
+
+std::vector<std::string> PSOUsageLog::s_records;
+std::unordered_set<std::string> PSOUsageLog::s_recordedKeys;
+std::mutex PSOUsageLog::s_mutex;
+int PSOUsageLog::s_prewarmedCount = 0;
+
+template<typename T>
+static void WriteValue(std::string& record, const T& value)
+{
+    record.append((const char*)&value, sizeof(T));
+}
+
+static void WriteString(std::string& record, const std::string& string)
+{
+    WriteValue(record, (uint32_t)string.size());
+    record += string;
+}
+
+template<typename T>
+static bool ReadValue(const uint8_t*& data, const uint8_t* end, T& value)
+{
+    if ((size_t)(end - data) < sizeof(T))
+    {
+        return false;
+    }
+
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+
+    return true;
+}
+
+static bool ReadString(const uint8_t*& data, const uint8_t* end, std::string& string)
+{
+    uint32_t size = 0;
+    if (!ReadValue(data, end, size) || (size_t)(end - data) < size)
+    {
+        return false;
+    }
+
+    string.assign((const char*)data, size);
+    data += size;
+
+    return true;
+}
+
+void PSOUsageLog::RecordGraphics(const PipelineGraphicsState& state)
+{
+    std::string record;
+    WriteShader(record, ShaderType::Graphics, state.GetShader());
+
+    std::vector<uint8_t> stateData;
+    state.Serialize(stateData);
+    record.append((const char*)stateData.data(), stateData.size());
+
+    Record(std::move(record));
+}
+
+void PSOUsageLog::RecordCompute(const Shader* shader)
+{
+    std::string record;
+    WriteShader(record, ShaderType::Compute, shader);
+
+    Record(std::move(record));
+}
+
+// Graphics PSOs are queued to the PSO compile threads, compute PSOs are few and created right away
+void PSOUsageLog::Prewarm(const std::filesystem::path& path)
+{
+    ProfileFunction();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    PSOUsageLogHeader header{};
+    if (data.size() < sizeof(header))
+    {
+        LogError("PSO usage log {} is corrupted", path.string());
+        return;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != PSO_USAGE_LOG_MAGIC || header.version != PSO_USAGE_LOG_VERSION)
+    {
+        Log("PSO usage log {} has unsupported format and is ignored", path.string());
+        return;
+    }
+
+    const uint8_t* current = data.data() + sizeof(header);
+    const uint8_t* end = data.data() + data.size();
+
+    for (uint32_t i = 0; i < header.recordCount; i++)
+    {
+        uint32_t recordSize = 0;
+        if (!ReadValue(current, end, recordSize) || (size_t)(end - current) < recordSize)
+        {
+            LogError("PSO usage log {} is corrupted", path.string());
+            return;
+        }
+
+        // Recorded again once created, so records that stopped compiling drop out of the log
+        if (Replay(current, current + recordSize))
+        {
+            s_prewarmedCount++;
+        }
+
+        current += recordSize;
+    }
+
+    Log("Prewarming {} PSOs from {}", s_prewarmedCount, path.string());
+}
+
+void PSOUsageLog::Save(const std::filesystem::path& path)
+{
+    ProfileFunction();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        LogError("Failed to open {} for writing", path.string());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    PSOUsageLogHeader header{};
+    header.recordCount = (uint32_t)s_records.size();
+    file.write((const char*)&header, sizeof(header));
+
+    for (const std::string& record : s_records)
+    {
+        uint32_t recordSize = (uint32_t)record.size();
+        file.write((const char*)&recordSize, sizeof(recordSize));
+        file.write(record.data(), record.size());
+    }
+}
+
+int PSOUsageLog::GetPrewarmedCount()
+{
+    return s_prewarmedCount;
+}
+
+void PSOUsageLog::WriteShader(std::string& record, ShaderType type, const Shader* shader)
+{
+    WriteValue(record, type);
+    WriteString(record, shader->GetName());
+
+    const std::vector<std::string>& defines = shader->GetDefines().Get();
+    WriteValue(record, (uint32_t)defines.size());
+    for (const std::string& define : defines)
+    {
+        WriteString(record, define);
+    }
+
+    WriteValue(record, (uint8_t)shader->IsMeshShader());
+}
+
+void PSOUsageLog::Record(std::string record)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (s_recordedKeys.contains(record))
+    {
+        return;
+    }
+
+    s_recordedKeys.insert(record);
+    s_records.push_back(std::move(record));
+}
+
+bool PSOUsageLog::Replay(const uint8_t* data, const uint8_t* end)
+{
+    ShaderType type = ShaderType::None;
+    std::string shaderName;
+    uint32_t definesCount = 0;
+    if (!ReadValue(data, end, type) || !ReadString(data, end, shaderName) || !ReadValue(data, end, definesCount))
+    {
+        return false;
+    }
+
+    ShaderDefines defines;
+    for (uint32_t i = 0; i < definesCount; i++)
+    {
+        std::string define;
+        if (!ReadString(data, end, define))
+        {
+            return false;
+        }
+        defines.Add(define);
+    }
+
+    uint8_t isMeshShader = 0;
+    if (!ReadValue(data, end, isMeshShader))
+    {
+        return false;
+    }
+
+    // Shaders removed since the log was written
+    if (!std::filesystem::exists(shaderName))
+    {
+        return false;
+    }
+
+    if (type == ShaderType::Graphics)
+    {
+        PipelineGraphicsState state{};
+        if (!state.Deserialize(data, end))
+        {
+            return false;
+        }
+
+        state.SetShader(Shader::GetGraphicsDeferred(shaderName, defines, isMeshShader != 0));
+
+        return PSOGraphics::GetAsync(state) != nullptr;
+    }
+
+    if (type == ShaderType::Compute)
+    {
+        Shader* shader = Shader::GetCompute(shaderName, defines);
+
+        return shader && PSOCompute::Get(shader) != nullptr;
+    }
+
+    return false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "PipelineGraphicsState.h"
+
+// Binary log of the pipeline states created during a session, replayed on the next launch to create them before the first frame.
+// Layout: header | records, where a record is its size, type, shader name, defines and, for graphics, the serialized state.
+
+const inline static uint32_t PSO_USAGE_LOG_MAGIC = 0x474F4C50; // "PLOG"
+const inline static uint32_t PSO_USAGE_LOG_VERSION = 1;
+
+struct PSOUsageLogHeader
+{
+    uint32_t magic = PSO_USAGE_LOG_MAGIC;
+    uint32_t version = PSO_USAGE_LOG_VERSION;
+    uint32_t recordCount = 0;
+};
+
+class PSOUsageLog
+{
+public:
+    static void RecordGraphics(const PipelineGraphicsState& state);
+    static void RecordCompute(const Shader* shader);
+
+    static void Prewarm(const std::filesystem::path& path);
+    static void Save(const std::filesystem::path& path);
+
+    static int GetPrewarmedCount();
+
+private:
+    static void WriteShader(std::string& record, ShaderType type, const Shader* shader);
+    static void Record(std::string record);
+    static bool Replay(const uint8_t* data, const uint8_t* end);
+
+private:
+    static std::vector<std::string> s_records;
+    static std::unordered_set<std::string> s_recordedKeys;
+    // Graphics PSOs are recorded by the compile threads
+    static std::mutex s_mutex;
+    static int s_prewarmedCount;
+};
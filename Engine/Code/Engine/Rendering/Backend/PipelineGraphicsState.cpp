@@ -4,7 +4,26 @@
 
 #include <Framework/Hash.h>
 
-#define CALCULATE_HASH(x) hash = JenkinsHashContinue(hash, &x, sizeof(x));
+#define CALCULATE_HASH(x) hash = Hash64(&x, sizeof(x), hash);
+
+static void WriteBytes(std::vector<uint8_t>& data, const void* ptr, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)ptr;
+    data.insert(data.end(), bytes, bytes + size);
+}
+
+static bool ReadBytes(const uint8_t*& data, const uint8_t* end, void* ptr, size_t size)
+{
+    if ((size_t)(end - data) < size)
+    {
+        return false;
+    }
+
+    memcpy(ptr, data, size);
+    data += size;
+
+    return true;
+}
 
 PipelineRenderingState::PipelineRenderingState()
 {
@@ -36,7 +55,7 @@ bool PipelineRenderingState::operator==(const PipelineRenderingState& other) con
     }
 
     constexpr int offset2 = offsetof(VkPipelineRenderingCreateInfo, depthAttachmentFormat);
-    constexpr int size2 = offsetof(VkPipelineRenderingCreateInfo, stencilAttachmentFormat) - offset2;
+    constexpr int size2 = sizeof(VkPipelineRenderingCreateInfo) - offset2;
 
     if (0 != memcmp((char*)&state + offset2, (char*)&other.state + offset2, size2))
     {
@@ -82,10 +101,7 @@ uint64_t PipelineRenderingState::CalculateHash(uint64_t hash) const
     CALCULATE_HASH(state.viewMask);
     CALCULATE_HASH(state.colorAttachmentCount);
 
-    for (size_t i = 0; i < state.colorAttachmentCount; i++)
-    {
-        CALCULATE_HASH(formats[i]);
-    }
+    hash = Hash64(formats.data(), state.colorAttachmentCount * sizeof(VkFormat), hash);
 
     CALCULATE_HASH(state.depthAttachmentFormat);
     CALCULATE_HASH(state.stencilAttachmentFormat);
@@ -193,7 +209,7 @@ uint64_t PipelineRasterizationState::CalculateHash(uint64_t hash) const
     constexpr size_t offset = offsetof(VkPipelineRasterizationStateCreateInfo, depthClampEnable);
     constexpr size_t size = sizeof(VkPipelineRasterizationStateCreateInfo) - offset;
 
-    hash = JenkinsHashContinue(hash, &state.depthClampEnable, size);
+    hash = Hash64(&state.depthClampEnable, size, hash);
 
     return hash;
 }
@@ -208,7 +224,7 @@ PipelineDepthStencilState::PipelineDepthStencilState()
 bool PipelineDepthStencilState::operator==(const PipelineDepthStencilState& other) const
 {
     constexpr int offset = offsetof(VkPipelineDepthStencilStateCreateInfo, depthTestEnable);
-    constexpr int size = sizeof(VkPipelineRasterizationStateCreateInfo) - offset;
+    constexpr int size = sizeof(VkPipelineDepthStencilStateCreateInfo) - offset;
 
     return 0 == memcmp((char*)&state + offset, (char*)&other.state + offset, size);
 }
@@ -269,7 +285,7 @@ uint64_t PipelineDepthStencilState::CalculateHash(uint64_t hash) const
     constexpr size_t offset = offsetof(VkPipelineDepthStencilStateCreateInfo, depthTestEnable);
     constexpr size_t size = sizeof(VkPipelineDepthStencilStateCreateInfo) - offset;
 
-    hash = JenkinsHashContinue(hash, &state.depthTestEnable, size);
+    hash = Hash64(&state.depthTestEnable, size, hash);
 
     return hash;
 }
@@ -295,48 +311,21 @@ PipelineBlendState& PipelineBlendState::operator=(const PipelineBlendState& othe
 
 bool PipelineBlendState::operator==(const PipelineBlendState& other) const
 {
-    if (state.attachmentCount != other.state.attachmentCount)
-    {
-        return false;
-    }
+    constexpr int offset = offsetof(VkPipelineColorBlendStateCreateInfo, logicOpEnable);
+    constexpr int size = offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments) - offset;
 
-    if (state.logicOpEnable == VK_TRUE && other.state.logicOpEnable == VK_TRUE)
-    {
-        if (state.logicOp != other.state.logicOp)
-        {
-            return false;
-        }
-    }
-    else
+    if (0 != memcmp((char*)&state + offset, (char*)&other.state + offset, size))
     {
-        if (state.logicOpEnable != other.state.logicOpEnable)
-        {
-            return false;
-        }
+        return false;
     }
 
-    for (int i = 0; i < (int)state.attachmentCount; i++)
+    if (0 != memcmp(state.blendConstants, other.state.blendConstants, sizeof(state.blendConstants)))
     {
-        if (blendAttachments[i].blendEnable == VK_TRUE && other.blendAttachments[i].blendEnable == VK_TRUE)
-        {
-            constexpr int offset = offsetof(VkPipelineColorBlendAttachmentState, srcColorBlendFactor);
-            constexpr int size = sizeof(VkPipelineColorBlendAttachmentState) - offset;
-
-            if (0 != memcmp((char*)&blendAttachments[i] + offset, (char*)&other.blendAttachments[i] + offset, size))
-            {
-                return false;
-            }
-        }
-        else
-        {
-            if (blendAttachments[i].blendEnable != other.blendAttachments[i].blendEnable)
-            {
-                return false;
-            }
-        }
+        return false;
     }
 
-    return true;
+    // Write mask and factors are baked into the pipeline even with blending disabled, so the attachments must match exactly
+    return 0 == memcmp(blendAttachments.data(), other.blendAttachments.data(), state.attachmentCount * sizeof(VkPipelineColorBlendAttachmentState));
 }
 
 bool PipelineBlendState::operator!=(const PipelineBlendState& other) const
@@ -403,13 +392,10 @@ uint64_t PipelineBlendState::CalculateHash(uint64_t hash) const
     constexpr size_t offset = offsetof(VkPipelineColorBlendStateCreateInfo, logicOpEnable);
     constexpr size_t size = offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments) - offset;
 
-    hash = JenkinsHashContinue(hash, &state.logicOpEnable, size);
+    hash = Hash64(&state.logicOpEnable, size, hash);
+    hash = Hash64(blendAttachments.data(), state.attachmentCount * sizeof(VkPipelineColorBlendAttachmentState), hash);
+    CALCULATE_HASH(state.blendConstants);
 
-    for (size_t i = 0; i < state.attachmentCount; i++)
-    {
-        CALCULATE_HASH(blendAttachments[i]);
-    }
-    
     return hash;
 }
 
@@ -420,6 +406,110 @@ void PipelineBlendState::CopyFrom(const PipelineBlendState& other)
     state.pAttachments = blendAttachments.data();
 }
 
+PipelineSpecializationState::PipelineSpecializationState()
+{
+    state.pMapEntries = entries.data();
+    state.pData = data.data();
+
+    Reset();
+}
+
+PipelineSpecializationState::PipelineSpecializationState(const PipelineSpecializationState& other)
+{
+    CopyFrom(other);
+}
+
+PipelineSpecializationState& PipelineSpecializationState::operator=(const PipelineSpecializationState& other)
+{
+    CopyFrom(other);
+    return *this;
+}
+
+bool PipelineSpecializationState::operator==(const PipelineSpecializationState& other) const
+{
+    if (state.mapEntryCount != other.state.mapEntryCount)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < (int)state.mapEntryCount; i++)
+    {
+        if (entries[i].constantID != other.entries[i].constantID || data[i] != other.data[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PipelineSpecializationState::operator!=(const PipelineSpecializationState& other) const
+{
+    return !(*this == other);
+}
+
+void PipelineSpecializationState::SetConstant(uint32_t constantId, uint32_t value)
+{
+    for (uint32_t i = 0; i < state.mapEntryCount; i++)
+    {
+        if (entries[i].constantID == constantId)
+        {
+            data[i] = value;
+            return;
+        }
+    }
+
+    Assert(state.mapEntryCount < MAX_SPECIALIZATION_CONSTANTS_COUNT);
+
+    VkSpecializationMapEntry& entry = entries[state.mapEntryCount];
+    entry.constantID = constantId;
+    entry.offset = state.mapEntryCount * sizeof(uint32_t);
+    entry.size = sizeof(uint32_t);
+
+    data[state.mapEntryCount] = value;
+
+    state.mapEntryCount++;
+    state.dataSize = state.mapEntryCount * sizeof(uint32_t);
+}
+
+void PipelineSpecializationState::SetConstant(uint32_t constantId, bool value)
+{
+    SetConstant(constantId, (uint32_t)(value ? VK_TRUE : VK_FALSE));
+}
+
+void PipelineSpecializationState::Reset()
+{
+    state.mapEntryCount = 0;
+    state.dataSize = 0;
+}
+
+const VkSpecializationInfo* PipelineSpecializationState::GetPtr() const
+{
+    return state.mapEntryCount > 0 ? &state : nullptr;
+}
+
+uint64_t PipelineSpecializationState::CalculateHash(uint64_t hash) const
+{
+    CALCULATE_HASH(state.mapEntryCount);
+
+    for (size_t i = 0; i < state.mapEntryCount; i++)
+    {
+        CALCULATE_HASH(entries[i].constantID);
+        CALCULATE_HASH(data[i]);
+    }
+
+    return hash;
+}
+
+void PipelineSpecializationState::CopyFrom(const PipelineSpecializationState& other)
+{
+    memcpy(&state, &other.state, sizeof(state));
+    memcpy(entries.data(), other.entries.data(), sizeof(entries));
+    memcpy(data.data(), other.data.data(), sizeof(data));
+    state.pMapEntries = entries.data();
+    state.pData = data.data();
+}
+
 PipelineGraphicsState::PipelineGraphicsState()
 {
     Reset();
@@ -444,10 +534,18 @@ bool PipelineGraphicsState::operator==(const PipelineGraphicsState& other) const
     {
         return false;
     }
+    if (m_depthStencilState != other.m_depthStencilState)
+    {
+        return false;
+    }
     if (m_blendState != other.m_blendState)
     {
         return false;
     }
+    if (m_specializationState != other.m_specializationState)
+    {
+        return false;
+    }
 
     return true;
 }
@@ -504,6 +602,16 @@ PipelineBlendState& PipelineGraphicsState::GetBlendState()
     return m_blendState;
 }
 
+PipelineSpecializationState& PipelineGraphicsState::GetSpecializationState()
+{
+    return m_specializationState;
+}
+
+const PipelineSpecializationState& PipelineGraphicsState::GetSpecializationState() const
+{
+    return m_specializationState;
+}
+
 void PipelineGraphicsState::Reset()
 {
     m_shader = nullptr;
@@ -513,11 +621,12 @@ void PipelineGraphicsState::Reset()
     m_rasterizationState.Reset();
     m_depthStencilState.Reset();
     m_blendState.Reset();
+    m_specializationState.Reset();
 
     m_isShaderDirty = true;
 }
 
-uint32_t PipelineGraphicsState::CalculateHash() const
+uint64_t PipelineGraphicsState::CalculateHash() const
 {
     ProfileFunction();
 
@@ -529,10 +638,169 @@ uint32_t PipelineGraphicsState::CalculateHash() const
     hash = m_rasterizationState.CalculateHash(hash);
     hash = m_depthStencilState.CalculateHash(hash);
     hash = m_blendState.CalculateHash(hash);
+    hash = m_specializationState.CalculateHash(hash);
 
-    hash = JenkinsHashEnd(hash);
+    return hash;
+}
+
+uint64_t PipelineGraphicsState::CalculateVertexInputHash() const
+{
+    uint64_t hash = 0;
+    hash = m_inputAssemblyState.CalculateHash(hash);
+
+    return hash;
+}
+
+uint64_t PipelineGraphicsState::CalculatePreRasterizationHash() const
+{
+    uint64_t hash = 0;
+    CALCULATE_HASH(m_shader);
+    CALCULATE_HASH(m_renderingState.state.viewMask);
+
+    hash = m_rasterizationState.CalculateHash(hash);
+    hash = m_specializationState.CalculateHash(hash);
+
+    return hash;
+}
+
+uint64_t PipelineGraphicsState::CalculateFragmentShaderHash() const
+{
+    uint64_t hash = 0;
+    CALCULATE_HASH(m_shader);
+    CALCULATE_HASH(m_renderingState.state.viewMask);
+
+    hash = m_depthStencilState.CalculateHash(hash);
+    hash = m_specializationState.CalculateHash(hash);
+
+    return hash;
+}
+
+uint64_t PipelineGraphicsState::CalculateFragmentOutputHash() const
+{
+    uint64_t hash = 0;
+    hash = m_renderingState.CalculateHash(hash);
+    hash = m_blendState.CalculateHash(hash);
+
+    return hash;
+}
+
+bool PipelineGraphicsState::IsVertexInputEqual(const PipelineGraphicsState& other) const
+{
+    return m_inputAssemblyState == other.m_inputAssemblyState;
+}
 
-    return (uint32_t)hash;
+bool PipelineGraphicsState::IsPreRasterizationEqual(const PipelineGraphicsState& other) const
+{
+    return m_shader == other.m_shader &&
+        m_renderingState.state.viewMask == other.m_renderingState.state.viewMask &&
+        m_rasterizationState == other.m_rasterizationState &&
+        m_specializationState == other.m_specializationState;
+}
+
+bool PipelineGraphicsState::IsFragmentShaderEqual(const PipelineGraphicsState& other) const
+{
+    return m_shader == other.m_shader &&
+        m_renderingState.state.viewMask == other.m_renderingState.state.viewMask &&
+        m_depthStencilState == other.m_depthStencilState &&
+        m_specializationState == other.m_specializationState;
+}
+
+bool PipelineGraphicsState::IsFragmentOutputEqual(const PipelineGraphicsState& other) const
+{
+    return m_renderingState == other.m_renderingState && m_blendState == other.m_blendState;
+}
+
+void PipelineGraphicsState::Serialize(std::vector<uint8_t>& data) const
+{
+    const VkPipelineRenderingCreateInfo& rendering = m_renderingState.state;
+    WriteBytes(data, &rendering.viewMask, sizeof(rendering.viewMask));
+    WriteBytes(data, &rendering.colorAttachmentCount, sizeof(rendering.colorAttachmentCount));
+    WriteBytes(data, m_renderingState.formats.data(), rendering.colorAttachmentCount * sizeof(VkFormat));
+    WriteBytes(data, &rendering.depthAttachmentFormat, sizeof(rendering.depthAttachmentFormat));
+    WriteBytes(data, &rendering.stencilAttachmentFormat, sizeof(rendering.stencilAttachmentFormat));
+
+    WriteBytes(data, &m_inputAssemblyState.state.topology, sizeof(m_inputAssemblyState.state.topology));
+    WriteBytes(data, &m_inputAssemblyState.state.primitiveRestartEnable, sizeof(m_inputAssemblyState.state.primitiveRestartEnable));
+
+    constexpr size_t rasterizationOffset = offsetof(VkPipelineRasterizationStateCreateInfo, depthClampEnable);
+    WriteBytes(data, &m_rasterizationState.state.depthClampEnable, sizeof(VkPipelineRasterizationStateCreateInfo) - rasterizationOffset);
+
+    constexpr size_t depthStencilOffset = offsetof(VkPipelineDepthStencilStateCreateInfo, depthTestEnable);
+    WriteBytes(data, &m_depthStencilState.state.depthTestEnable, sizeof(VkPipelineDepthStencilStateCreateInfo) - depthStencilOffset);
+
+    constexpr size_t blendOffset = offsetof(VkPipelineColorBlendStateCreateInfo, logicOpEnable);
+    constexpr size_t blendSize = offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments) - blendOffset;
+    WriteBytes(data, &m_blendState.state.logicOpEnable, blendSize);
+    WriteBytes(data, m_blendState.blendAttachments.data(), m_blendState.state.attachmentCount * sizeof(VkPipelineColorBlendAttachmentState));
+    WriteBytes(data, m_blendState.state.blendConstants, sizeof(m_blendState.state.blendConstants));
+
+    const VkSpecializationInfo& specialization = m_specializationState.state;
+    WriteBytes(data, &specialization.mapEntryCount, sizeof(specialization.mapEntryCount));
+    for (uint32_t i = 0; i < specialization.mapEntryCount; i++)
+    {
+        WriteBytes(data, &m_specializationState.entries[i].constantID, sizeof(uint32_t));
+        WriteBytes(data, &m_specializationState.data[i], sizeof(uint32_t));
+    }
+}
+
+bool PipelineGraphicsState::Deserialize(const uint8_t*& data, const uint8_t* end)
+{
+    Reset();
+
+    VkPipelineRenderingCreateInfo& rendering = m_renderingState.state;
+    if (!ReadBytes(data, end, &rendering.viewMask, sizeof(rendering.viewMask)) ||
+        !ReadBytes(data, end, &rendering.colorAttachmentCount, sizeof(rendering.colorAttachmentCount)) ||
+        rendering.colorAttachmentCount > MAX_RENDER_TARGETS_COUNT ||
+        !ReadBytes(data, end, m_renderingState.formats.data(), rendering.colorAttachmentCount * sizeof(VkFormat)) ||
+        !ReadBytes(data, end, &rendering.depthAttachmentFormat, sizeof(rendering.depthAttachmentFormat)) ||
+        !ReadBytes(data, end, &rendering.stencilAttachmentFormat, sizeof(rendering.stencilAttachmentFormat)))
+    {
+        return false;
+    }
+
+    if (!ReadBytes(data, end, &m_inputAssemblyState.state.topology, sizeof(m_inputAssemblyState.state.topology)) ||
+        !ReadBytes(data, end, &m_inputAssemblyState.state.primitiveRestartEnable, sizeof(m_inputAssemblyState.state.primitiveRestartEnable)))
+    {
+        return false;
+    }
+
+    constexpr size_t rasterizationOffset = offsetof(VkPipelineRasterizationStateCreateInfo, depthClampEnable);
+    constexpr size_t depthStencilOffset = offsetof(VkPipelineDepthStencilStateCreateInfo, depthTestEnable);
+    if (!ReadBytes(data, end, &m_rasterizationState.state.depthClampEnable, sizeof(VkPipelineRasterizationStateCreateInfo) - rasterizationOffset) ||
+        !ReadBytes(data, end, &m_depthStencilState.state.depthTestEnable, sizeof(VkPipelineDepthStencilStateCreateInfo) - depthStencilOffset))
+    {
+        return false;
+    }
+
+    constexpr size_t blendOffset = offsetof(VkPipelineColorBlendStateCreateInfo, logicOpEnable);
+    constexpr size_t blendSize = offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments) - blendOffset;
+    if (!ReadBytes(data, end, &m_blendState.state.logicOpEnable, blendSize) ||
+        m_blendState.state.attachmentCount > MAX_RENDER_TARGETS_COUNT ||
+        !ReadBytes(data, end, m_blendState.blendAttachments.data(), m_blendState.state.attachmentCount * sizeof(VkPipelineColorBlendAttachmentState)) ||
+        !ReadBytes(data, end, m_blendState.state.blendConstants, sizeof(m_blendState.state.blendConstants)))
+    {
+        return false;
+    }
+
+    uint32_t constantsCount = 0;
+    if (!ReadBytes(data, end, &constantsCount, sizeof(constantsCount)) || constantsCount > MAX_SPECIALIZATION_CONSTANTS_COUNT)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < constantsCount; i++)
+    {
+        uint32_t constantId = 0;
+        uint32_t value = 0;
+        if (!ReadBytes(data, end, &constantId, sizeof(constantId)) || !ReadBytes(data, end, &value, sizeof(value)))
+        {
+            return false;
+        }
+
+        m_specializationState.SetConstant(constantId, value);
+    }
+
+    return true;
 }
 
 void PipelineGraphicsDynamicState::Reset()
@@ -106,6 +106,33 @@ private:
     void CopyFrom(const PipelineBlendState& other);
 };
 
+// Values for [[vk::constant_id]] constants, applied to every stage. Variants share one SPIR-V module and differ only here.
+struct PipelineSpecializationState
+{
+    VkSpecializationInfo state{};
+    std::array<VkSpecializationMapEntry, MAX_SPECIALIZATION_CONSTANTS_COUNT> entries;
+    std::array<uint32_t, MAX_SPECIALIZATION_CONSTANTS_COUNT> data;
+
+    PipelineSpecializationState();
+    PipelineSpecializationState(const PipelineSpecializationState& other);
+    PipelineSpecializationState& operator=(const PipelineSpecializationState& other);
+
+    bool operator==(const PipelineSpecializationState& other) const;
+    bool operator!=(const PipelineSpecializationState& other) const;
+
+    void SetConstant(uint32_t constantId, uint32_t value);
+    void SetConstant(uint32_t constantId, bool value);
+
+    void Reset();
+
+    const VkSpecializationInfo* GetPtr() const;
+
+    inline uint64_t CalculateHash(uint64_t hash) const;
+
+private:
+    void CopyFrom(const PipelineSpecializationState& other);
+};
+
 class PipelineGraphicsState
 {
 public:
@@ -125,10 +152,27 @@ public:
     PipelineRasterizationState& GetRasterizationState();
     PipelineDepthStencilState& GetDepthStencilState();
     PipelineBlendState& GetBlendState();
+    PipelineSpecializationState& GetSpecializationState();
+    const PipelineSpecializationState& GetSpecializationState() const;
 
     void Reset();
 
-    uint32_t CalculateHash() const;
+    uint64_t CalculateHash() const;
+
+    // Hashes and comparisons of the state consumed by each graphics pipeline library part
+    uint64_t CalculateVertexInputHash() const;
+    uint64_t CalculatePreRasterizationHash() const;
+    uint64_t CalculateFragmentShaderHash() const;
+    uint64_t CalculateFragmentOutputHash() const;
+
+    bool IsVertexInputEqual(const PipelineGraphicsState& other) const;
+    bool IsPreRasterizationEqual(const PipelineGraphicsState& other) const;
+    bool IsFragmentShaderEqual(const PipelineGraphicsState& other) const;
+    bool IsFragmentOutputEqual(const PipelineGraphicsState& other) const;
+
+    // Writes and reads everything but the shader, which callers identify by name and defines
+    void Serialize(std::vector<uint8_t>& data) const;
+    bool Deserialize(const uint8_t*& data, const uint8_t* end);
 
 private:
     Shader* m_shader = nullptr;
@@ -138,6 +182,7 @@ private:
     PipelineRasterizationState m_rasterizationState{};
     PipelineDepthStencilState m_depthStencilState{};
     PipelineBlendState m_blendState{};
+    PipelineSpecializationState m_specializationState{};
 
     bool m_isShaderDirty = true;
 };
@@ -3,6 +3,7 @@
 const inline static uint32_t FRAME_COUNT = 3;
 
 #define MAX_RENDER_TARGETS_COUNT 8
+#define MAX_SPECIALIZATION_CONSTANTS_COUNT 16
 
 #define BIND_OFFSET_INDEX_SRV 0
 #define BIND_MAX_INDEX_SRV        (BIND_OFFSET_INDEX_SRV + 1023)
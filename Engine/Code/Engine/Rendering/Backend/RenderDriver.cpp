@@ -55,6 +55,8 @@ void Frame::Destroy()
 #endif
 
     usedCmdBuffers.clear();
+
+    DestroyRetiredPipelines();
 }
 
 void Frame::Reset()
@@ -65,11 +67,22 @@ void Frame::Reset()
     }
     usedCmdBuffers.clear();
 
+    DestroyRetiredPipelines();
+
 #if defined(GPU_PROFILE_ENABLE)
     timestampQueryPool.Reset();
 #endif
 }
 
+void Frame::DestroyRetiredPipelines()
+{
+    for (VkPipeline pipeline : retiredPipelines)
+    {
+        vkDestroyPipeline(VkContext::Get()->GetVkDevice(), pipeline, nullptr);
+    }
+    retiredPipelines.clear();
+}
+
 void FrameData::Create()
 {
     Assert(frameIndex == -1);
@@ -310,6 +323,13 @@ const std::vector<PipelineStatistics>& RenderDriver::GetPipelineStatistics() con
 #endif
 }
 
+// Pipelines may still be referenced by frames in flight, they are destroyed once this frame slot's fence is waited on again
+void RenderDriver::RetirePipelines(const std::vector<VkPipeline>& pipelines)
+{
+    Frame& frame = m_frameData.GetFrame();
+    frame.retiredPipelines.insert(frame.retiredPipelines.end(), pipelines.begin(), pipelines.end());
+}
+
 void RenderDriver::WaitIdle()
 {
     VkContext::Get()->GetDevice().WaitIdle();
@@ -20,6 +20,7 @@ namespace
         VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
         VkFence renderCompleteFence = VK_NULL_HANDLE;
         std::vector<CommandBufferPtr> usedCmdBuffers;
+        std::vector<VkPipeline> retiredPipelines;
 #if defined(GPU_PROFILE_ENABLE)
         GPUQueryPoolTimestamp timestampQueryPool;
 #endif
@@ -30,6 +31,8 @@ namespace
         void Destroy();
 
         void Reset();
+
+        void DestroyRetiredPipelines();
     };
 
     struct FrameData
@@ -81,6 +84,8 @@ public:
     const std::vector<GPUZone>& GetGPUZones() const;
     const std::vector<PipelineStatistics>& GetPipelineStatistics() const;
 
+    void RetirePipelines(const std::vector<VkPipeline>& pipelines);
+
     void WaitIdle();
 
     static RenderDriverPtr Create();
@@ -2,60 +2,66 @@
 
 #include "DescriptorBindingTable.h"
 
-std::unordered_map<uint32_t, SamplerInstance> Sampler::s_states;
+std::vector<SamplerInstance> Sampler::s_samplers;
+std::unordered_multimap<uint64_t, uint32_t> Sampler::s_samplerIndices;
 
-Sampler::Sampler(uint32_t hash)
-    : m_hash(hash) {}
+Sampler::Sampler(uint32_t index)
+    : m_index(index) {}
 
 bool Sampler::operator==(const Sampler& sampler) const
 {
-    if (m_hash == -1 || sampler.m_hash == -1)
+    if (m_index == -1 || sampler.m_index == -1)
     {
         return false;
     }
 
-    return m_hash == sampler.m_hash;
+    return m_index == sampler.m_index;
 }
 
 SamplerState Sampler::GetState()
 {
-    Assert(m_hash != -1);
+    Assert(m_index != -1);
 
-    return s_states[m_hash].state;
+    return s_samplers[m_index].state;
 }
 
 int Sampler::GetBindSlot()
 {
-    if (m_hash == -1)
+    if (m_index == -1)
     {
-        LogError("Invalid sampler hash value");
+        LogError("Invalid sampler index value");
         return 0;
     }
 
-    return s_states[m_hash].bindSlot;
+    return s_samplers[m_index].bindSlot;
 }
 
 VkSampler Sampler::GetVkSampler()
 {
-    if (m_hash == -1)
+    if (m_index == -1)
     {
-        LogError("Invalid sampler hash value");
+        LogError("Invalid sampler index value");
         return VK_NULL_HANDLE;
     }
 
-    return s_states[m_hash].sampler;
+    return s_samplers[m_index].sampler;
 }
 
 Sampler Sampler::Get(const SamplerState& state)
 {
-    uint32_t hash = state.CalculateHash();
+    uint64_t hash = state.CalculateHash();
 
-    if (s_states.contains(hash))
+    auto [begin, end] = s_samplerIndices.equal_range(hash);
+    for (auto it = begin; it != end; it++)
     {
-        return hash;
+        if (s_samplers[it->second].state == state)
+        {
+            return it->second;
+        }
     }
 
-    SamplerInstance& samplerInstance = s_states[hash];
+    uint32_t index = (uint32_t)s_samplers.size();
+    SamplerInstance& samplerInstance = s_samplers.emplace_back();
 
     samplerInstance.state = state;
     samplerInstance.sampler = CreateVkSampler(state);
@@ -66,7 +72,9 @@ Sampler Sampler::Get(const SamplerState& state)
 
     samplerInstance.bindSlot = DescriptorBindingTable::Get()->GetSamplerFreeSlot(descriptor);
 
-    return hash;
+    s_samplerIndices.emplace(hash, index);
+
+    return index;
 }
 
 Sampler Sampler::GetNearest()
@@ -104,12 +112,13 @@ Sampler Sampler::GetLinearAnisotropy()
 
 void Sampler::DestroySamplers()
 {
-    for (auto it = s_states.begin(); it != s_states.end(); it++)
+    for (const SamplerInstance& samplerInstance : s_samplers)
     {
-        vkDestroySampler(VkContext::Get()->GetVkDevice(), it->second.sampler, nullptr);
+        vkDestroySampler(VkContext::Get()->GetVkDevice(), samplerInstance.sampler, nullptr);
     }
 
-    s_states.clear();
+    s_samplers.clear();
+    s_samplerIndices.clear();
 }
 
 VkSampler Sampler::CreateVkSampler(const SamplerState& state)
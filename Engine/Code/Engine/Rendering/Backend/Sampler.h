@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include <Framework/Hash.h>
 
@@ -54,9 +55,16 @@ struct SamplerState
     float maxLod = 1000.0f;
     BorderColor borderColor = BorderColor::FloatTransparentBlack;
 
-    inline uint32_t CalculateHash() const
+    bool operator==(const SamplerState& other) const = default;
+
+    // Hashed field by field, the padding between them is never initialized
+    inline uint64_t CalculateHash() const
     {
-        return JenkinsHash(this, sizeof(SamplerState));
+        const uint8_t modes[] = { (uint8_t)magFilter, (uint8_t)minFilter, (uint8_t)mipmapMode, (uint8_t)addressModeU, (uint8_t)addressModeV, (uint8_t)addressModeW, (uint8_t)anisotropyEnable, (uint8_t)borderColor };
+        const float values[] = { mipLodBias, maxAnisotropy, minLod, maxLod };
+
+        uint64_t hash = Hash64(modes, sizeof(modes));
+        return Hash64(values, sizeof(values), hash);
     }
 };
 
@@ -70,7 +78,7 @@ struct SamplerInstance
 class Sampler
 {
 public:
-    Sampler(uint32_t hash = -1);
+    Sampler(uint32_t index = -1);
 
     bool operator==(const Sampler& sampler) const;
 
@@ -92,7 +100,8 @@ private:
     static void GetDescriptor(VkSampler sampler, void* descriptor);
 
 private:
-    uint32_t m_hash = -1;
+    uint32_t m_index = -1;
 
-    static std::unordered_map<uint32_t, SamplerInstance> s_states;
+    static std::vector<SamplerInstance> s_samplers;
+    static std::unordered_multimap<uint64_t, uint32_t> s_samplerIndices;
 };
\ No newline at end of file
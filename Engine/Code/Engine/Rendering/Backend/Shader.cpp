@@ -1,12 +1,18 @@
 #include "Shader.h"
 
+#include <algorithm>
+
 #include <Framework/Common.h>
 
 #include "VulkanImpl/VkContext.h"
 #include "VulkanImpl/VulkanValidation.h"
 
 std::vector<ShaderPtr> Shader::s_shaderCache;
-ShaderCompiler Shader::s_compiler;
+std::unordered_map<std::string, Shader*> Shader::s_shaderLookup;
+std::unique_ptr<ShaderCompiler> Shader::s_compiler;
+std::mutex Shader::s_compilerMutex;
+ShaderPackPtr Shader::s_shaderPack;
+std::unordered_set<std::string> Shader::s_changedSources;
 
 ShaderStage::ShaderStage(std::vector<uint8_t> spvCode, const std::string& entryPoint, ShaderStageFlags stage)
     : m_spirvCode(std::move(spvCode)), m_stageType(stage), m_entryPoint(entryPoint), m_vkShader(m_spirvCode, m_entryPoint.c_str(), stage) {}
@@ -63,6 +69,11 @@ ShaderType Shader::GetType() const
     return m_type;
 }
 
+bool Shader::IsMeshShader() const
+{
+    return m_isMeshShader;
+}
+
 const ShaderDefines& Shader::GetDefines() const
 {
     return m_defines;
@@ -98,6 +109,51 @@ const ShaderStage* Shader::GetComputeStage() const
     return m_csStage.get();
 }
 
+bool Shader::IsCompiled() const
+{
+    return m_isCompiled;
+}
+
+bool Shader::IsCompileFailed() const
+{
+    return m_isCompileFailed;
+}
+
+void Shader::EnsureCompiled()
+{
+    ProfileFunction();
+
+    if (m_isCompiled || m_isCompileFailed)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_compileMutex);
+    if (m_isCompiled || m_isCompileFailed)
+    {
+        return;
+    }
+
+    ShaderPtr compiled = CompileShader(m_name, m_defines, m_type, m_isMeshShader);
+    if (!compiled)
+    {
+        m_isCompileFailed = true;
+        return;
+    }
+
+    m_tsStage = std::move(compiled->m_tsStage);
+    m_msStage = std::move(compiled->m_msStage);
+    m_vsStage = std::move(compiled->m_vsStage);
+    m_psStage = std::move(compiled->m_psStage);
+    m_csStage = std::move(compiled->m_csStage);
+
+    // Kept on failure too, so a fix in an included file is picked up by hot reload
+    m_dependencies = std::move(compiled->m_dependencies);
+
+    m_isCompiled = compiled->m_isCompiled.load();
+    m_isCompileFailed = compiled->m_isCompileFailed.load();
+}
+
 Shader* Shader::GetGraphics(const std::string& shaderName, const ShaderDefines& defines, bool isMeshShader)
 {
     ProfileFunction();
@@ -105,14 +161,14 @@ Shader* Shader::GetGraphics(const std::string& shaderName, const ShaderDefines&
     Shader* shader = FindShader(shaderName, defines, ShaderType::Graphics);
     if (shader)
     {
+        shader->EnsureCompiled();
         return shader;
     }
 
     std::unique_ptr<Shader> newShader = CompileShader(shaderName, defines, ShaderType::Graphics, isMeshShader);
     if (newShader)
     {
-        s_shaderCache.push_back(std::move(newShader));
-        return s_shaderCache.back().get();
+        return AddShader(std::move(newShader));
     }
     else
     {
@@ -120,6 +176,25 @@ Shader* Shader::GetGraphics(const std::string& shaderName, const ShaderDefines&
     }
 }
 
+// Registers the shader without compiling it. Compilation happens on the first EnsureCompiled call,
+// which lets PSOGraphics::GetAsync move DXC work off the render thread.
+Shader* Shader::GetGraphicsDeferred(const std::string& shaderName, const ShaderDefines& defines, bool isMeshShader)
+{
+    ProfileFunction();
+
+    Shader* shader = FindShader(shaderName, defines, ShaderType::Graphics);
+    if (shader)
+    {
+        return shader;
+    }
+
+    std::unique_ptr<Shader> newShader = std::make_unique<Shader>(shaderName, defines);
+    newShader->m_type = ShaderType::Graphics;
+    newShader->m_isMeshShader = isMeshShader;
+
+    return AddShader(std::move(newShader));
+}
+
 Shader* Shader::GetCompute(const std::string& shaderName, const ShaderDefines& defines)
 {
     ProfileFunction();
@@ -133,8 +208,7 @@ Shader* Shader::GetCompute(const std::string& shaderName, const ShaderDefines& d
     std::unique_ptr<Shader> newShader = CompileShader(shaderName, defines, ShaderType::Compute, false);
     if (newShader)
     {
-        s_shaderCache.push_back(std::move(newShader));
-        return s_shaderCache.back().get();
+        return AddShader(std::move(newShader));
     }
     else
     {
@@ -142,9 +216,9 @@ Shader* Shader::GetCompute(const std::string& shaderName, const ShaderDefines& d
     }
 }
 
-std::unordered_set<const Shader*> Shader::RecreateOnShaderChanges(const std::unordered_set<std::string>& changedShaderNames)
+std::vector<ShaderRecompilation> Shader::GatherRecompilations(const std::unordered_set<std::string>& changedShaderNames)
 {
-    s_compiler.ReloadShaders(changedShaderNames);
+    ProfileFunction();
 
     auto isSetIntersects = [](const std::unordered_set<std::string>& set1, const std::unordered_set<std::string>& set2)
         {
@@ -158,17 +232,74 @@ std::unordered_set<const Shader*> Shader::RecreateOnShaderChanges(const std::uno
             return false;
         };
 
-    std::unordered_set<const Shader*> changedShaders;
+    if (s_shaderPack)
+    {
+        std::lock_guard<std::mutex> lock(s_compilerMutex);
+        s_changedSources.insert(changedShaderNames.begin(), changedShaderNames.end());
+    }
+
+    std::vector<ShaderRecompilation> recompilations;
 
     for (ShaderPtr& shader : s_shaderCache)
     {
+        if (!shader->IsCompiled() && !shader->IsCompileFailed())
+        {
+            continue;
+        }
+
         if (!changedShaderNames.contains(shader->GetName()) && !isSetIntersects(shader->GetDependencies(), changedShaderNames))
         {
             continue;
         }
 
-        ShaderPtr recompiled = CompileShader(shader->GetName(), shader->GetDefines(), shader->GetType(), shader->GetTaskStage() || shader->GetMeshStage());
+        recompilations.push_back({ shader.get(), nullptr });
+    }
+
+    return recompilations;
+}
+
+// Safe to call from a background thread, only the cache snapshot gathered on the main thread is touched
+void Shader::Recompile(std::vector<ShaderRecompilation>& recompilations, const std::unordered_set<std::string>& changedShaderNames)
+{
+    ProfileFunction();
+
+    {
+        std::lock_guard<std::mutex> lock(s_compilerMutex);
+        GetCompiler().ReloadShaders(changedShaderNames);
+    }
+
+    for (ShaderRecompilation& recompilation : recompilations)
+    {
+        const Shader* shader = recompilation.shader;
+
+        ShaderPtr recompiled = CompileShader(shader->GetName(), shader->GetDefines(), shader->GetType(), shader->m_isMeshShader, false);
+        if (!recompiled || !recompiled->HasMainStage() || !recompiled->HasStagesOf(*shader))
+        {
+            LogError("Failed to recompile shader {}, keeping the previous version", shader->GetName());
+            continue;
+        }
+
+        recompilation.recompiled = std::move(recompiled);
+    }
+}
+
+std::unordered_set<const Shader*> Shader::ApplyRecompilations(std::vector<ShaderRecompilation>& recompilations)
+{
+    ProfileFunction();
 
+    std::unordered_set<const Shader*> changedShaders;
+
+    for (ShaderRecompilation& recompilation : recompilations)
+    {
+        if (!recompilation.recompiled)
+        {
+            continue;
+        }
+
+        Shader* shader = recompilation.shader;
+        ShaderPtr& recompiled = recompilation.recompiled;
+
+        // Pipelines are already created from the new stages, old shader modules aren't referenced anymore
         shader->m_tsStage = std::move(recompiled->m_tsStage);
         shader->m_msStage = std::move(recompiled->m_msStage);
         shader->m_vsStage = std::move(recompiled->m_vsStage);
@@ -177,18 +308,56 @@ std::unordered_set<const Shader*> Shader::RecreateOnShaderChanges(const std::uno
 
         shader->m_dependencies = std::move(recompiled->m_dependencies);
 
-        changedShaders.insert(shader.get());
+        shader->m_isCompiled = true;
+        shader->m_isCompileFailed = false;
+
+        changedShaders.insert(shader);
     }
 
+    recompilations.clear();
+
     return changedShaders;
 }
 
+// Shaders found in the pack are created from its precompiled SPIR-V, DXC is only used for the rest and for hot reload.
+void Shader::LoadPack(const std::filesystem::path& path)
+{
+    ProfileFunction();
+
+    ShaderPackPtr pack = ShaderPack::Load(path);
+    if (!pack)
+    {
+        LogInfo("Shader pack {} not found, shaders will be compiled at runtime", path.string());
+        return;
+    }
+
+#if !defined(RELEASE_BUILD)
+    std::error_code error;
+    std::filesystem::file_time_type packWriteTime = std::filesystem::last_write_time(path, error);
+    for (const auto& file : std::filesystem::recursive_directory_iterator("assets/shaders", error))
+    {
+        if (file.is_regular_file() && file.last_write_time() > packWriteTime)
+        {
+            LogWarning("Shader pack {} is older than {}, ignoring it", path.string(), file.path().string());
+            return;
+        }
+    }
+#endif
+
+    LogInfo("Shader pack {} loaded, {} stages", path.string(), pack->GetEntryCount());
+
+    s_shaderPack = std::move(pack);
+}
+
 void Shader::ClearCache()
 {
     s_shaderCache.clear();
+    s_shaderLookup.clear();
+    s_shaderPack.reset();
+    s_changedSources.clear();
 }
 
-std::unique_ptr<Shader> Shader::CompileShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type, bool isMeshShader)
+std::unique_ptr<Shader> Shader::CompileShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type, bool isMeshShader, bool isAllowPack)
 {
     ProfileFunction();
 
@@ -199,37 +368,42 @@ std::unique_ptr<Shader> Shader::CompileShader(const std::string& shaderName, con
     const char* csStageEntry = "MainCS";
 
     std::unique_ptr<Shader> shader = std::make_unique<Shader>(shaderName, defines);
+    shader->m_isMeshShader = isMeshShader;
+
+    std::lock_guard<std::mutex> lock(s_compilerMutex);
 
     if (type == ShaderType::Graphics)
     {
         if (isMeshShader)
         {
-            std::vector<uint8_t> tsSpirv = s_compiler.CompileToSpirv(shaderName, ShaderStageTask, tsStageEntry, defines, shader->m_dependencies);
+            std::vector<uint8_t> tsSpirv = RetrieveSpirv(shaderName, ShaderStageTask, tsStageEntry, defines, shader->m_dependencies, isAllowPack);
             if (!tsSpirv.empty())
             {
                 shader->m_tsStage = ShaderStage::Create(std::move(tsSpirv), tsStageEntry, ShaderStageTask);
             }
 
-            std::vector<uint8_t> msSpirv = s_compiler.CompileToSpirv(shaderName, ShaderStageMesh, msStageEntry, defines, shader->m_dependencies);
+            std::vector<uint8_t> msSpirv = RetrieveSpirv(shaderName, ShaderStageMesh, msStageEntry, defines, shader->m_dependencies, isAllowPack);
             shader->m_msStage = ShaderStage::Create(std::move(msSpirv), msStageEntry, ShaderStageMesh);
         }
         else
         {
-            std::vector<uint8_t> vsSpirv = s_compiler.CompileToSpirv(shaderName, ShaderStageVertex, vsStageEntry, defines, shader->m_dependencies);
+            std::vector<uint8_t> vsSpirv = RetrieveSpirv(shaderName, ShaderStageVertex, vsStageEntry, defines, shader->m_dependencies, isAllowPack);
             shader->m_vsStage = ShaderStage::Create(std::move(vsSpirv), vsStageEntry, ShaderStageVertex);
         }
 
-        std::vector<uint8_t> psSpirv = s_compiler.CompileToSpirv(shaderName, ShaderStagePixel, psStageEntry, defines, shader->m_dependencies);
+        std::vector<uint8_t> psSpirv = RetrieveSpirv(shaderName, ShaderStagePixel, psStageEntry, defines, shader->m_dependencies, isAllowPack);
         if (!psSpirv.empty())
         {
             shader->m_psStage = ShaderStage::Create(std::move(psSpirv), psStageEntry, ShaderStagePixel);
         }
 
         shader->m_type = ShaderType::Graphics;
+        shader->m_isCompiled = shader->HasMainStage();
+        shader->m_isCompileFailed = !shader->m_isCompiled;
     }
     else if (type == ShaderType::Compute)
     {
-        std::vector<uint8_t> csSpirv = s_compiler.CompileToSpirv(shaderName, ShaderStageCompute, csStageEntry, defines, shader->m_dependencies);
+        std::vector<uint8_t> csSpirv = RetrieveSpirv(shaderName, ShaderStageCompute, csStageEntry, defines, shader->m_dependencies, isAllowPack);
         if (csSpirv.empty())
         {
             return nullptr;
@@ -237,6 +411,8 @@ std::unique_ptr<Shader> Shader::CompileShader(const std::string& shaderName, con
 
         shader->m_csStage = ShaderStage::Create(std::move(csSpirv), csStageEntry, ShaderStageCompute);
         shader->m_type = ShaderType::Compute;
+        shader->m_isCompiled = shader->HasMainStage();
+        shader->m_isCompileFailed = !shader->m_isCompiled;
     }
     else
     {
@@ -246,27 +422,89 @@ std::unique_ptr<Shader> Shader::CompileShader(const std::string& shaderName, con
     return shader;
 }
 
-Shader* Shader::FindShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type)
+std::vector<uint8_t> Shader::RetrieveSpirv(const std::string& shaderName, ShaderStageFlags stage, const char* entryPoint, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies, bool isAllowPack)
 {
-    auto it = std::find_if(s_shaderCache.begin(), s_shaderCache.end(), [&](const std::unique_ptr<Shader>& shader)
+    if (isAllowPack && s_shaderPack)
+    {
+        ShaderPackStage packStage;
+        if (s_shaderPack->Find(shaderName, defines, stage, packStage) && packStage.entryPoint == entryPoint && !IsPackStageStale(shaderName, packStage))
         {
-            if (shader->GetType() != type)
-            {
-                return false;
-            }
+            dependencies.insert(packStage.dependencies.begin(), packStage.dependencies.end());
+            return std::vector<uint8_t>(packStage.spirv, packStage.spirv + packStage.spirvSize);
+        }
+    }
 
-            if (shader->GetName() != shaderName)
-            {
-                return false;
-            }
+    return GetCompiler().CompileToSpirv(shaderName, stage, entryPoint, defines, dependencies);
+}
 
-            if (shader->GetDefines() != defines)
-            {
-                return false;
-            }
+// Hot reload only recompiles shaders already in use, permutations created later must not come from the outdated pack
+bool Shader::IsPackStageStale(const std::string& shaderName, const ShaderPackStage& packStage)
+{
+    if (s_changedSources.contains(shaderName))
+    {
+        return true;
+    }
 
-            return true;
+    return std::any_of(packStage.dependencies.begin(), packStage.dependencies.end(), [](const std::string& dependency)
+        {
+            return s_changedSources.contains(dependency);
         });
+}
+
+ShaderCompiler& Shader::GetCompiler()
+{
+    if (!s_compiler)
+    {
+        s_compiler = std::make_unique<ShaderCompiler>();
+    }
+
+    return *s_compiler;
+}
+
+Shader* Shader::FindShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type)
+{
+    auto it = s_shaderLookup.find(MakeCacheKey(shaderName, defines, type));
+
+    return it != s_shaderLookup.end() ? it->second : nullptr;
+}
+
+Shader* Shader::AddShader(std::unique_ptr<Shader> shader)
+{
+    Shader* retValue = shader.get();
+
+    s_shaderLookup.emplace(MakeCacheKey(shader->GetName(), shader->GetDefines(), shader->GetType()), retValue);
+    s_shaderCache.push_back(std::move(shader));
+
+    return retValue;
+}
+
+bool Shader::HasMainStage() const
+{
+    return m_vsStage || m_msStage || m_csStage;
+}
+
+// A stage that existed before and is missing now failed to compile, pipelines must not silently lose it
+bool Shader::HasStagesOf(const Shader& other) const
+{
+    return (!other.m_tsStage || m_tsStage) &&
+        (!other.m_msStage || m_msStage) &&
+        (!other.m_vsStage || m_vsStage) &&
+        (!other.m_psStage || m_psStage) &&
+        (!other.m_csStage || m_csStage);
+}
+
+// The key holds everything a shader is identified by, so lookups never depend on hash uniqueness
+std::string Shader::MakeCacheKey(const std::string& shaderName, const ShaderDefines& defines, ShaderType type)
+{
+    std::string key = shaderName;
+    key += '|';
+    for (const std::string& define : defines.Get())
+    {
+        key += define;
+        key += ';';
+    }
+    key += '|';
+    key += std::to_string((int)type);
 
-    return it != s_shaderCache.end() ? it->get() : nullptr;
+    return key;
 }
\ No newline at end of file
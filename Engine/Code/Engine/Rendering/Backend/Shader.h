@@ -3,7 +3,10 @@
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include <Framework/Common.h>
@@ -11,6 +14,7 @@
 #include "VulkanImpl/VulkanShader.h"
 
 #include "ShaderCompiler.h"
+#include "ShaderPack.h"
 
 enum class ShaderType : uint8_t
 {
@@ -45,6 +49,12 @@ private:
 class Shader;
 using ShaderPtr = std::unique_ptr<Shader>;
 
+struct ShaderRecompilation
+{
+    Shader* shader = nullptr;
+    ShaderPtr recompiled;
+};
+
 class Shader
 {
 public:
@@ -55,6 +65,7 @@ public:
 
     const std::string& GetName() const;
     ShaderType GetType() const;
+    bool IsMeshShader() const;
 
     const ShaderDefines& GetDefines() const;
     const std::unordered_set<std::string>& GetDependencies() const;
@@ -65,20 +76,43 @@ public:
     const ShaderStage* GetPixelStage() const;
     const ShaderStage* GetComputeStage() const;
 
+    bool IsCompiled() const;
+    // Failed shaders aren't compiled again until hot reload sees a change in their sources
+    bool IsCompileFailed() const;
+    void EnsureCompiled();
+
     static Shader* GetGraphics(const std::string& shaderName, const ShaderDefines& defines = {}, bool isMeshShader = false);
+    static Shader* GetGraphicsDeferred(const std::string& shaderName, const ShaderDefines& defines = {}, bool isMeshShader = false);
     static Shader* GetCompute(const std::string& shaderName, const ShaderDefines& defines = {});
-    static std::unordered_set<const Shader*> RecreateOnShaderChanges(const std::unordered_set<std::string>& changedShaderNames);
 
+    static std::vector<ShaderRecompilation> GatherRecompilations(const std::unordered_set<std::string>& changedShaderNames);
+    static void Recompile(std::vector<ShaderRecompilation>& recompilations, const std::unordered_set<std::string>& changedShaderNames);
+    static std::unordered_set<const Shader*> ApplyRecompilations(std::vector<ShaderRecompilation>& recompilations);
+
+    static void LoadPack(const std::filesystem::path& path);
     static void ClearCache();
 
 private:
-    static std::unique_ptr<Shader> CompileShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type, bool isMeshShader);
+    bool HasMainStage() const;
+    bool HasStagesOf(const Shader& other) const;
+
+    static std::unique_ptr<Shader> CompileShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type, bool isMeshShader, bool isAllowPack = true);
+    static std::vector<uint8_t> RetrieveSpirv(const std::string& shaderName, ShaderStageFlags stage, const char* entryPoint, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies, bool isAllowPack);
+    static bool IsPackStageStale(const std::string& shaderName, const ShaderPackStage& packStage);
+    static ShaderCompiler& GetCompiler();
     static Shader* FindShader(const std::string& shaderName, const ShaderDefines& defines, ShaderType type);
+    static Shader* AddShader(std::unique_ptr<Shader> shader);
+    static std::string MakeCacheKey(const std::string& shaderName, const ShaderDefines& defines, ShaderType type);
 
 private:
     std::string m_name;
-    ShaderType m_type;
+    ShaderType m_type = ShaderType::None;
     ShaderDefines m_defines;
+    bool m_isMeshShader = false;
+
+    std::atomic<bool> m_isCompiled = false;
+    std::atomic<bool> m_isCompileFailed = false;
+    std::mutex m_compileMutex;
 
     std::unique_ptr<ShaderStage> m_tsStage;
     std::unique_ptr<ShaderStage> m_msStage;
@@ -89,5 +123,10 @@ private:
     std::unordered_set<std::string> m_dependencies;
 
     static std::vector<ShaderPtr> s_shaderCache;
-    static ShaderCompiler s_compiler;
+    static std::unordered_map<std::string, Shader*> s_shaderLookup;
+    static std::unique_ptr<ShaderCompiler> s_compiler;
+    static std::mutex s_compilerMutex;
+    static ShaderPackPtr s_shaderPack;
+    // Sources edited since the pack was built, pack entries depending on them are stale
+    static std::unordered_set<std::string> s_changedSources;
 };
\ No newline at end of file
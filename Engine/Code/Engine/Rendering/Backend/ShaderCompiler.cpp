@@ -1,24 +1,19 @@
 #include "ShaderCompiler.h"
 
+#include <chrono>
+#include <thread>
 #include <unordered_set>
 
-#include <d3d12shader.h>
-
+// wchar_t is 2 bytes on Windows and 4 bytes on Linux, so convert per character instead of per byte
 static std::string WCharPtrToString(const wchar_t* string)
 {
     std::string result;
 
-    int i = 0;
-    const char* data = (const char*)string;
-    while (data[i] != 0)
+    for (int i = 0; string[i] != 0; i++)
     {
-        if (data[i + 1] != 0)
-        {
-            __debugbreak();
-        }
+        Assert(string[i] < 128, "Only ASCII shader paths are supported");
 
-        result += data[i];
-        i += 2;
+        result += (char)string[i];
     }
 
     return result;
@@ -60,7 +55,7 @@ public:
         return S_OK;
     }
 
-    HRESULT QueryInterface(REFIID riid, void** ppvObject)
+    HRESULT QueryInterface(REFIID riid, void** ppvObject) override
     {
         return S_FALSE;
     }
@@ -119,7 +114,10 @@ IDxcBlob* ShaderLoader::GetHLSLFile(const std::string& shaderPath)
         return nullptr;
     }
 
-    m_sources.emplace(shaderPath, hlslBlob);
+    m_sources.emplace(shaderPath, DxcPtr<IDxcBlob>::Attach(hlslBlob));
+
+    // The returned reference is owned by the caller, DXC releases include sources after use
+    hlslBlob->AddRef();
 
     return hlslBlob;
 }
@@ -143,12 +141,15 @@ ShaderCompiler::ShaderCompiler()
     m_hlslFileLoader.Create(m_utils.Get());
 }
 
-#include <stdio.h>
-
-std::vector<uint8_t> ShaderCompiler::CompileToSpirv(const std::string& shaderPath, ShaderStageFlags stage, std::string_view entry, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies)
+std::vector<uint8_t> ShaderCompiler::CompileToSpirv(const std::string& shaderPath, ShaderStageFlags stage, std::string_view entry, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies, bool* isEntryPointMissing)
 {
     ProfileFunction();
 
+    if (isEntryPointMissing)
+    {
+        *isEntryPointMissing = false;
+    }
+
     IDxcBlob* hlslBlob = m_hlslFileLoader.GetHLSLFile(shaderPath);
 
     if (!hlslBlob)
@@ -214,35 +215,46 @@ std::vector<uint8_t> ShaderCompiler::CompileToSpirv(const std::string& shaderPat
 
     IncludeHandler includeHandler(m_hlslFileLoader, shaderPath);
 
-    ComPtr<IDxcResult> compileResult;
+    DxcPtr<IDxcResult> compileResult;
     HRESULT hr = m_compiler->Compile(&hlslBuffer, arguments.data(), (UINT32)arguments.size(), &includeHandler, IID_PPV_ARGS(compileResult.GetAddressOf()));
 
-    ComPtr<IDxcBlobUtf8> errors;
+    DxcPtr<IDxcBlobUtf8> errors;
     compileResult->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(errors.GetAddressOf()), nullptr);
 
-    if (FAILED(hr) || (errors && errors->GetStringLength()))
+    std::string_view errorText = errors ? std::string_view((const char*)errors->GetBufferPointer(), errors->GetStringLength()) : std::string_view();
+
+    // DXC reports an entry point that isn't defined after preprocessing, including the included files, with this error
+    if (isEntryPointMissing && errorText.find("missing entry point definition") != std::string_view::npos)
+    {
+        *isEntryPointMissing = true;
+    }
+    else if (FAILED(hr) || !errorText.empty())
     {
         LogAlways("Compilation error {} for '{}:{}'", hr, shaderPath, entry);
-        LogAlways("{}", (char*)errors->GetBufferPointer());
+        LogAlways("{}", errorText);
     }
 
+    // Recorded on failure too, hot reload retries a failed shader when one of its includes changes
+    auto newDependencies = includeHandler.GetFileDependencies();
+    dependencies.insert(newDependencies.begin(), newDependencies.end());
+
     HRESULT status = 0;
     compileResult->GetStatus(&status);
     if (FAILED(status))
     {
-        LogAlways("Failed to compile shader {}", shaderPath);
+        if (!isEntryPointMissing || !*isEntryPointMissing)
+        {
+            LogAlways("Failed to compile shader {}", shaderPath);
+        }
         return {};
     }
 
-    ComPtr<IDxcBlob> spirvBlob;
+    DxcPtr<IDxcBlob> spirvBlob;
     compileResult->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(spirvBlob.GetAddressOf()), nullptr);
 
     std::vector<uint8_t> spirvCode(spirvBlob->GetBufferSize());
     memcpy(spirvCode.data(), spirvBlob->GetBufferPointer(), spirvBlob->GetBufferSize());
 
-    auto newDependencies = includeHandler.GetFileDependencies();
-    dependencies.insert(newDependencies.begin(), newDependencies.end());
-
     return spirvCode;
 }
 
@@ -4,16 +4,69 @@
 
 #include "ShaderUtils.h"
 
+#if defined(_WIN32)
 #include <combaseapi.h>
+#endif
 #include <dxc/dxcapi.h>
 
 #include <map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include <wrl/client.h>
+// Minimal owning COM pointer. Used instead of WRL ComPtr so DXC works with the portable
+// libdxcompiler API on Linux, where only the WinAdapter declarations are available.
+template<typename T>
+class DxcPtr
+{
+public:
+    DxcPtr() = default;
+    DxcPtr(const DxcPtr&) = delete;
+    DxcPtr& operator=(const DxcPtr&) = delete;
+
+    DxcPtr(DxcPtr&& other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)) {}
+
+    DxcPtr& operator=(DxcPtr&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_ptr = std::exchange(other.m_ptr, nullptr);
+        }
+        return *this;
+    }
+
+    ~DxcPtr()
+    {
+        Reset();
+    }
 
-using Microsoft::WRL::ComPtr;
+    T* Get() const { return m_ptr; }
+    T** GetAddressOf() { Reset(); return &m_ptr; }
+    T* operator->() const { return m_ptr; }
+    operator bool() const { return m_ptr != nullptr; }
+
+    void Reset()
+    {
+        if (m_ptr)
+        {
+            m_ptr->Release();
+            m_ptr = nullptr;
+        }
+    }
+
+    // Takes ownership of a pointer that was already AddRef'ed by DXC
+    static DxcPtr Attach(T* ptr)
+    {
+        DxcPtr result;
+        result.m_ptr = ptr;
+        return result;
+    }
+
+private:
+    T* m_ptr = nullptr;
+};
 
 class ShaderLoader
 {
@@ -25,7 +78,7 @@ public:
     void ReloadShaders(const std::unordered_set<std::string>& changedShaders);
 
 private:
-    std::map<std::string, ComPtr<IDxcBlob>> m_sources;
+    std::map<std::string, DxcPtr<IDxcBlob>> m_sources;
     IDxcUtils* m_utils;
 };
 
@@ -36,12 +89,14 @@ public:
 
     ShaderCompiler();
 
-    std::vector<uint8_t> CompileToSpirv(const std::string& shaderPath, ShaderStageFlags stage, std::string_view entry, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies);
+    // Optional stages are probed by compiling them. When isEntryPointMissing is given, an entry point the preprocessed source
+    // doesn't define is reported through it instead of logged as an error.
+    std::vector<uint8_t> CompileToSpirv(const std::string& shaderPath, ShaderStageFlags stage, std::string_view entry, const ShaderDefines& defines, std::unordered_set<std::string>& dependencies, bool* isEntryPointMissing = nullptr);
 
     void ReloadShaders(const std::unordered_set<std::string>& changedShaders);
 
 private:
     ShaderLoader m_hlslFileLoader;
-    ComPtr<IDxcUtils> m_utils;
-    ComPtr<IDxcCompiler3> m_compiler;
+    DxcPtr<IDxcUtils> m_utils;
+    DxcPtr<IDxcCompiler3> m_compiler;
 };
\ No newline at end of file
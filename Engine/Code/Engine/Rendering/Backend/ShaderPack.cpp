@@ -0,0 +1,313 @@
+#include "ShaderPack.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <sstream>
+
+#include <Framework/Hash.h>
+
+bool ShaderPack::Find(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage, ShaderPackStage& outStage) const
+{
+    ProfileFunction();
+
+    if (!m_header || m_header->bucketCount == 0)
+    {
+        return false;
+    }
+
+    std::string key = MakeKey(shaderName, defines, stage);
+    uint32_t hash = JenkinsHash(key.data(), key.size());
+
+    uint32_t mask = m_header->bucketCount - 1;
+    for (uint32_t i = 0; i < m_header->bucketCount; i++)
+    {
+        const ShaderPackBucket& bucket = m_buckets[(hash + i) & mask];
+        if (bucket.entryIndex == SHADER_PACK_EMPTY_BUCKET)
+        {
+            return false;
+        }
+
+        if (bucket.hash != hash)
+        {
+            continue;
+        }
+
+        const ShaderPackEntry& entry = m_entries[bucket.entryIndex];
+        if (GetString(entry.keyOffset, entry.keySize) != key)
+        {
+            continue;
+        }
+
+        outStage.entryPoint = GetString(entry.entryPointOffset, entry.entryPointSize);
+        outStage.spirv = m_file->GetData() + m_header->blobsOffset + entry.spirvOffset;
+        outStage.spirvSize = entry.spirvSize;
+
+        outStage.dependencies.clear();
+        std::string_view dependencies = GetString(entry.dependenciesOffset, entry.dependenciesSize);
+        while (!dependencies.empty())
+        {
+            size_t separator = dependencies.find('\n');
+            outStage.dependencies.emplace(dependencies.substr(0, separator));
+            dependencies = separator == std::string_view::npos ? std::string_view() : dependencies.substr(separator + 1);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t ShaderPack::GetEntryCount() const
+{
+    return m_header ? m_header->entryCount : 0;
+}
+
+ShaderPackPtr ShaderPack::Load(const std::filesystem::path& path)
+{
+    ProfileFunction();
+
+    MappedFilePtr file = MappedFile::Open(path);
+    if (!file)
+    {
+        return nullptr;
+    }
+
+    if (file->GetSize() < sizeof(ShaderPackHeader))
+    {
+        LogError("Shader pack {} is corrupted", path.string());
+        return nullptr;
+    }
+
+    const ShaderPackHeader* header = (const ShaderPackHeader*)file->GetData();
+    if (header->magic != SHADER_PACK_MAGIC || header->version != SHADER_PACK_VERSION)
+    {
+        LogError("Shader pack {} has unsupported format", path.string());
+        return nullptr;
+    }
+
+    uint64_t fileSize = file->GetSize();
+    auto isInRange = [fileSize](uint64_t offset, uint64_t size)
+        {
+            return offset <= fileSize && size <= fileSize - offset;
+        };
+
+    if (!std::has_single_bit(header->bucketCount) ||
+        !isInRange(header->bucketsOffset, (uint64_t)header->bucketCount * sizeof(ShaderPackBucket)) ||
+        !isInRange(header->entriesOffset, (uint64_t)header->entryCount * sizeof(ShaderPackEntry)) ||
+        !isInRange(header->stringsOffset, header->blobsOffset - header->stringsOffset) ||
+        header->blobsOffset > fileSize)
+    {
+        LogError("Shader pack {} is corrupted", path.string());
+        return nullptr;
+    }
+
+    // Strings and blobs are read straight from the mapping, so every range the entries point at must lie in the file
+    uint64_t stringsSize = header->blobsOffset - header->stringsOffset;
+    uint64_t blobsSize = fileSize - header->blobsOffset;
+    auto isStringValid = [stringsSize](uint32_t offset, uint32_t size)
+        {
+            return (uint64_t)offset + size <= stringsSize;
+        };
+
+    const ShaderPackBucket* buckets = (const ShaderPackBucket*)(file->GetData() + header->bucketsOffset);
+    for (uint32_t i = 0; i < header->bucketCount; i++)
+    {
+        if (buckets[i].entryIndex != SHADER_PACK_EMPTY_BUCKET && buckets[i].entryIndex >= header->entryCount)
+        {
+            LogError("Shader pack {} is corrupted", path.string());
+            return nullptr;
+        }
+    }
+
+    const ShaderPackEntry* entries = (const ShaderPackEntry*)(file->GetData() + header->entriesOffset);
+    for (uint32_t i = 0; i < header->entryCount; i++)
+    {
+        const ShaderPackEntry& entry = entries[i];
+        if (!isStringValid(entry.keyOffset, entry.keySize) ||
+            !isStringValid(entry.entryPointOffset, entry.entryPointSize) ||
+            !isStringValid(entry.dependenciesOffset, entry.dependenciesSize) ||
+            entry.spirvOffset > blobsSize || entry.spirvSize > blobsSize - entry.spirvOffset)
+        {
+            LogError("Shader pack {} is corrupted", path.string());
+            return nullptr;
+        }
+    }
+
+    ShaderPackPtr pack = std::make_unique<ShaderPack>();
+    pack->m_header = header;
+    pack->m_buckets = buckets;
+    pack->m_entries = entries;
+    pack->m_file = std::move(file);
+
+    return pack;
+}
+
+std::string ShaderPack::MakeKey(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage)
+{
+    std::string key = shaderName;
+    key += '|';
+    for (const std::string& define : defines.Get())
+    {
+        key += define;
+        key += ';';
+    }
+    key += '|';
+    key += std::to_string(stage);
+
+    return key;
+}
+
+std::vector<ShaderDefines> ShaderPack::GetPermutations(const std::string& source)
+{
+    const std::string_view permutationsTag = "// Permutations:";
+
+    std::vector<std::string> permutationDefines;
+
+    size_t tagOffset = source.find(permutationsTag);
+    if (tagOffset != std::string::npos)
+    {
+        size_t lineEnd = source.find('\n', tagOffset);
+        std::istringstream line(source.substr(tagOffset + permutationsTag.size(), lineEnd - tagOffset - permutationsTag.size()));
+
+        std::string define;
+        while (line >> define)
+        {
+            permutationDefines.push_back(define);
+        }
+    }
+
+    std::vector<ShaderDefines> permutations(1u << permutationDefines.size());
+    for (uint32_t permutation = 0; permutation < (uint32_t)permutations.size(); permutation++)
+    {
+        for (size_t i = 0; i < permutationDefines.size(); i++)
+        {
+            if (permutation & (1u << i))
+            {
+                permutations[permutation].Add(permutationDefines[i]);
+            }
+        }
+    }
+
+    return permutations;
+}
+
+std::vector<ShaderPackedStage> ShaderPack::GetStages(const std::string& source, const ShaderDefines& defines)
+{
+    if (source.find("Main") == std::string::npos)
+    {
+        return {};
+    }
+
+    if (source.find("MainCS") != std::string::npos)
+    {
+        return { { ShaderStageCompute, "MainCS", true } };
+    }
+
+    bool isMeshShader = std::find(defines.Get().begin(), defines.Get().end(), "USE_MESH_SHADING") != defines.Get().end();
+    if (isMeshShader)
+    {
+        return { { ShaderStageTask, "MainTS", false }, { ShaderStageMesh, "MainMS", true }, { ShaderStagePixel, "MainPS", false } };
+    }
+
+    return { { ShaderStageVertex, "MainVS", true }, { ShaderStagePixel, "MainPS", false } };
+}
+
+std::string_view ShaderPack::GetString(uint32_t offset, uint32_t size) const
+{
+    return std::string_view((const char*)m_file->GetData() + m_header->stringsOffset + offset, size);
+}
+
+void ShaderPackWriter::Add(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage, std::string_view entryPoint, std::vector<uint8_t> spirv, const std::unordered_set<std::string>& dependencies)
+{
+    Stage& newStage = m_stages.emplace_back();
+    newStage.key = ShaderPack::MakeKey(shaderName, defines, stage);
+    newStage.entryPoint = entryPoint;
+    newStage.stage = stage;
+    newStage.spirv = std::move(spirv);
+
+    for (const std::string& dependency : dependencies)
+    {
+        if (!newStage.dependencies.empty())
+        {
+            newStage.dependencies += '\n';
+        }
+        newStage.dependencies += dependency;
+    }
+}
+
+bool ShaderPackWriter::Write(const std::filesystem::path& path) const
+{
+    ProfileFunction();
+
+    ShaderPackHeader header{};
+    header.entryCount = (uint32_t)m_stages.size();
+    header.bucketCount = std::bit_ceil(std::max(1u, header.entryCount * 2));
+
+    std::vector<ShaderPackBucket> buckets(header.bucketCount);
+    std::vector<ShaderPackEntry> entries(m_stages.size());
+    std::string strings;
+    uint64_t blobsSize = 0;
+
+    auto addString = [&strings](std::string_view string, uint32_t& offset, uint32_t& size)
+        {
+            offset = (uint32_t)strings.size();
+            size = (uint32_t)string.size();
+            strings += string;
+        };
+
+    for (uint32_t i = 0; i < (uint32_t)m_stages.size(); i++)
+    {
+        const Stage& stage = m_stages[i];
+        ShaderPackEntry& entry = entries[i];
+
+        addString(stage.key, entry.keyOffset, entry.keySize);
+        addString(stage.entryPoint, entry.entryPointOffset, entry.entryPointSize);
+        addString(stage.dependencies, entry.dependenciesOffset, entry.dependenciesSize);
+
+        entry.stage = stage.stage;
+        entry.spirvOffset = blobsSize;
+        entry.spirvSize = stage.spirv.size();
+
+        blobsSize += (stage.spirv.size() + 3) & ~3ull;
+
+        uint32_t hash = JenkinsHash(stage.key.data(), stage.key.size());
+        uint32_t mask = header.bucketCount - 1;
+        uint32_t bucketIndex = hash & mask;
+        while (buckets[bucketIndex].entryIndex != SHADER_PACK_EMPTY_BUCKET)
+        {
+            bucketIndex = (bucketIndex + 1) & mask;
+        }
+
+        buckets[bucketIndex].hash = hash;
+        buckets[bucketIndex].entryIndex = i;
+    }
+
+    header.bucketsOffset = sizeof(ShaderPackHeader);
+    header.entriesOffset = header.bucketsOffset + buckets.size() * sizeof(ShaderPackBucket);
+    header.stringsOffset = header.entriesOffset + entries.size() * sizeof(ShaderPackEntry);
+    header.blobsOffset = (header.stringsOffset + strings.size() + 3) & ~3ull;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        LogError("Failed to open {} for writing", path.string());
+        return false;
+    }
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)buckets.data(), buckets.size() * sizeof(ShaderPackBucket));
+    file.write((const char*)entries.data(), entries.size() * sizeof(ShaderPackEntry));
+    file.write(strings.data(), strings.size());
+
+    const char zeros[4]{};
+    file.write(zeros, header.blobsOffset - header.stringsOffset - strings.size());
+
+    for (const Stage& stage : m_stages)
+    {
+        file.write((const char*)stage.spirv.data(), stage.spirv.size());
+        file.write(zeros, ((stage.spirv.size() + 3) & ~3ull) - stage.spirv.size());
+    }
+
+    return file.good();
+}
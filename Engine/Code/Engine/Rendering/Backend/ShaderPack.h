@@ -0,0 +1,126 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <Framework/Common.h>
+#include <Framework/MappedFile.h>
+
+#include "ShaderUtils.h"
+
+// Binary layout of the pack produced by the ShaderPacker tool:
+// header | buckets | entries | strings | spirv blobs
+// Buckets form an open addressing hash table over the entries, keyed by name, defines and stage.
+
+const inline static uint32_t SHADER_PACK_MAGIC = 0x4B415053; // "SPAK"
+const inline static uint32_t SHADER_PACK_VERSION = 2;
+const inline static uint32_t SHADER_PACK_EMPTY_BUCKET = UINT32_MAX;
+
+struct ShaderPackHeader
+{
+    uint32_t magic = SHADER_PACK_MAGIC;
+    uint32_t version = SHADER_PACK_VERSION;
+    uint32_t entryCount = 0;
+    uint32_t bucketCount = 0;
+    uint64_t bucketsOffset = 0;
+    uint64_t entriesOffset = 0;
+    uint64_t stringsOffset = 0;
+    uint64_t blobsOffset = 0;
+};
+
+struct ShaderPackBucket
+{
+    uint32_t hash = 0;
+    uint32_t entryIndex = SHADER_PACK_EMPTY_BUCKET;
+};
+
+struct ShaderPackEntry
+{
+    uint32_t keyOffset = 0;
+    uint32_t keySize = 0;
+    uint32_t entryPointOffset = 0;
+    uint32_t entryPointSize = 0;
+    uint32_t dependenciesOffset = 0;
+    uint32_t dependenciesSize = 0;
+    uint32_t stage = ShaderStageNone;
+    uint32_t padding = 0;
+    uint64_t spirvOffset = 0;
+    uint64_t spirvSize = 0;
+};
+
+struct ShaderPackStage
+{
+    std::string_view entryPoint;
+    const uint8_t* spirv = nullptr;
+    size_t spirvSize = 0;
+    std::unordered_set<std::string> dependencies;
+};
+
+// Stage compiled for a packed permutation. Optional stages are packed empty when the compiler finds no such entry point.
+struct ShaderPackedStage
+{
+    ShaderStageFlags stage = ShaderStageNone;
+    const char* entryPoint = nullptr;
+    bool isRequired = false;
+};
+
+class ShaderPack;
+using ShaderPackPtr = std::unique_ptr<ShaderPack>;
+
+class ShaderPack
+{
+public:
+    NON_COPYABLE_MOVABLE(ShaderPack);
+
+    ShaderPack() = default;
+    ~ShaderPack() = default;
+
+    bool Find(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage, ShaderPackStage& outStage) const;
+
+    uint32_t GetEntryCount() const;
+
+    static ShaderPackPtr Load(const std::filesystem::path& path);
+
+    static std::string MakeKey(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage);
+
+    // Permutations are declared in the shader source with a line like:
+    // // Permutations: USE_UV USE_VERTEX_COLOR
+    // Every subset of the listed defines is a permutation, the first one has none.
+    static std::vector<ShaderDefines> GetPermutations(const std::string& source);
+    // Stages the ShaderPacker tool compiles for a permutation, none for sources without entry points like the included ones.
+    // USE_MESH_SHADING switches the permutation to the task/mesh pipeline.
+    static std::vector<ShaderPackedStage> GetStages(const std::string& source, const ShaderDefines& defines);
+
+private:
+    std::string_view GetString(uint32_t offset, uint32_t size) const;
+
+private:
+    MappedFilePtr m_file;
+    const ShaderPackHeader* m_header = nullptr;
+    const ShaderPackBucket* m_buckets = nullptr;
+    const ShaderPackEntry* m_entries = nullptr;
+};
+
+class ShaderPackWriter
+{
+public:
+    void Add(const std::string& shaderName, const ShaderDefines& defines, ShaderStageFlags stage, std::string_view entryPoint, std::vector<uint8_t> spirv, const std::unordered_set<std::string>& dependencies);
+
+    bool Write(const std::filesystem::path& path) const;
+
+private:
+    struct Stage
+    {
+        std::string key;
+        std::string entryPoint;
+        std::string dependencies;
+        ShaderStageFlags stage = ShaderStageNone;
+        std::vector<uint8_t> spirv;
+    };
+
+    std::vector<Stage> m_stages;
+};
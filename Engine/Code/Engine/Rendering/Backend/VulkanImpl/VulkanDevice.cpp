@@ -46,6 +46,7 @@ void VulkanDevice::Create(VulkanPhysicalDevice& physicalDevice, VkSurfaceKHR sur
     m_enabledFeatures13.pNext = &dynamicVertexInputFeature;
     dynamicVertexInputFeature.pNext = &meshShaderFeature;
     meshShaderFeature.pNext = &descriptorBufferFeature;
+    descriptorBufferFeature.pNext = IsGraphicsPipelineLibraryEnabled() ? &m_enabledFeaturesGraphicsPipelineLibrary : nullptr;
 
     VkDeviceCreateInfo deviceCreateInfo = { .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
     deviceCreateInfo.pNext = &m_enabledFeatures;
@@ -121,6 +122,11 @@ const VkPhysicalDeviceVulkan13Features& VulkanDevice::GetEnabledFeatures13() con
     return m_enabledFeatures13;
 }
 
+bool VulkanDevice::IsGraphicsPipelineLibraryEnabled() const
+{
+    return m_enabledFeaturesGraphicsPipelineLibrary.graphicsPipelineLibrary == VK_TRUE;
+}
+
 void VulkanDevice::WaitIdle() const
 {
     Assert(m_device);
@@ -168,6 +174,7 @@ void VulkanDevice::GatherEnabledFeatures(VulkanPhysicalDevice& physicalDevice)
     m_enabledFeatures11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
     m_enabledFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
     m_enabledFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    m_enabledFeaturesGraphicsPipelineLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
 
     const VkPhysicalDeviceFeatures& supportedFeatures = physicalDevice.GetFeatures();
     const VkPhysicalDeviceVulkan11Features& supportedFeatures11 = physicalDevice.GetFeatures11();
@@ -199,6 +206,7 @@ void VulkanDevice::GatherEnabledFeatures(VulkanPhysicalDevice& physicalDevice)
     m_enabledFeatures13.synchronization2 = supportedFeatures13.synchronization2;
     m_enabledFeatures13.maintenance4 = supportedFeatures13.maintenance4;
     m_enabledFeatures13.shaderDemoteToHelperInvocation = supportedFeatures13.shaderDemoteToHelperInvocation;
+    m_enabledFeaturesGraphicsPipelineLibrary.graphicsPipelineLibrary = physicalDevice.GetGraphicsPipelineLibraryFeatures().graphicsPipelineLibrary;
 }
 
 VkDeviceQueueCreateInfo VulkanDevice::CreateQueueCreateInfo(uint32_t queue) const
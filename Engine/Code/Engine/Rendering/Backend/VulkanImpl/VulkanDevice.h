@@ -16,6 +16,7 @@ public:
     VkQueue GetPresentQueue() const;
     const VkPhysicalDeviceFeatures& GetEnabledFeatures() const;
     const VkPhysicalDeviceVulkan13Features& GetEnabledFeatures13() const;
+    bool IsGraphicsPipelineLibraryEnabled() const;
 
     void WaitIdle() const;
 
@@ -35,4 +36,5 @@ private:
     VkPhysicalDeviceVulkan11Features m_enabledFeatures11{};
     VkPhysicalDeviceVulkan12Features m_enabledFeatures12{};
     VkPhysicalDeviceVulkan13Features m_enabledFeatures13{};
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_enabledFeaturesGraphicsPipelineLibrary{};
 };
\ No newline at end of file
@@ -35,6 +35,14 @@ VkPipelineStageFlags2 BufferUsageToPipelineStages(BufferUsageFlags usage, Shader
     {
         stages |= ShaderStageFlagsToVulkan();
     }
+    if (usage & BufferUsageIndexRead)
+    {
+        stages |= VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+    }
+    if (usage & BufferUsageIndirectRead)
+    {
+        stages |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+    }
 
     return stages;
 }
@@ -64,6 +72,14 @@ VkAccessFlags2 BufferUsageToAccess(BufferUsageFlags usage)
     {
         access |= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
     }
+    if (usage & BufferUsageIndexRead)
+    {
+        access |= VK_ACCESS_2_INDEX_READ_BIT;
+    }
+    if (usage & BufferUsageIndirectRead)
+    {
+        access |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+    }
 
     return access;
 }
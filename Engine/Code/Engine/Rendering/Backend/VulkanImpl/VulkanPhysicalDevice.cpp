@@ -9,6 +9,7 @@ void VulkanPhysicalDevice::Create(VkInstance instance)
 {
     GatherExtensions();
     PickPhysicalDevice(instance);
+    GatherOptionalExtensions();
 
     RetrieveFeatures();
 }
@@ -60,6 +61,13 @@ const VkPhysicalDeviceVulkan13Features& VulkanPhysicalDevice::GetFeatures13() co
     return m_features13;
 }
 
+const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT& VulkanPhysicalDevice::GetGraphicsPipelineLibraryFeatures() const
+{
+    Assert(m_physicalDevice, "Pick physical device first before querying its features");
+
+    return m_featuresGraphicsPipelineLibrary;
+}
+
 const std::vector<const char*>& VulkanPhysicalDevice::GetExtensions()
 {
     Assert(m_physicalDevice, "No appropriate physical device found");
@@ -67,6 +75,19 @@ const std::vector<const char*>& VulkanPhysicalDevice::GetExtensions()
     return m_extensions;
 }
 
+bool VulkanPhysicalDevice::IsExtensionEnabled(const char* extension) const
+{
+    for (const char* enabledExtension : m_extensions)
+    {
+        if (!strcmp(enabledExtension, extension))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void VulkanPhysicalDevice::GatherExtensions()
 {
     m_extensions =
@@ -144,6 +165,42 @@ void VulkanPhysicalDevice::PickPhysicalDevice(VkInstance instance)
     Assert(m_physicalDevice, "No appropriate GPU found");
 }
 
+void VulkanPhysicalDevice::GatherOptionalExtensions()
+{
+    // Graphics pipeline library is only a faster path for pipeline creation, so devices without it are still accepted
+    const std::vector<const char*> pipelineLibraryExtensions =
+    {
+        VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+        VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
+    };
+
+    uint32_t extensionsCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, "", &extensionsCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionsCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, "", &extensionsCount, availableExtensions.data());
+
+    bool extensionsSupported = true;
+    for (const char* optionalExtension : pipelineLibraryExtensions)
+    {
+        bool extensionSupported = false;
+        for (const VkExtensionProperties& availableExtension : availableExtensions)
+        {
+            if (!strcmp(optionalExtension, availableExtension.extensionName))
+            {
+                extensionSupported = true;
+                break;
+            }
+        }
+
+        extensionsSupported &= extensionSupported;
+    }
+
+    if (extensionsSupported)
+    {
+        m_extensions.insert(m_extensions.end(), pipelineLibraryExtensions.begin(), pipelineLibraryExtensions.end());
+    }
+}
+
 void VulkanPhysicalDevice::RetrieveFeatures()
 {
     VkPhysicalDeviceFeatures2 features2{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
@@ -158,6 +215,14 @@ void VulkanPhysicalDevice::RetrieveFeatures()
     m_features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
     m_features13.pNext = nullptr;
 
+    m_featuresGraphicsPipelineLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    m_featuresGraphicsPipelineLibrary.pNext = nullptr;
+
+    if (IsExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+    {
+        m_features13.pNext = &m_featuresGraphicsPipelineLibrary;
+    }
+
     vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
 
     m_featuresCore = features2.features;
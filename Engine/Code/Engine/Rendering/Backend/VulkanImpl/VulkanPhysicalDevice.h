@@ -14,11 +14,14 @@ public:
     const VkPhysicalDeviceVulkan11Features& GetFeatures11() const;
     const VkPhysicalDeviceVulkan12Features& GetFeatures12() const;
     const VkPhysicalDeviceVulkan13Features& GetFeatures13() const;
+    const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT& GetGraphicsPipelineLibraryFeatures() const;
     const std::vector<const char*>& GetExtensions();
+    bool IsExtensionEnabled(const char* extension) const;
 
 private:
     void GatherExtensions();
     void PickPhysicalDevice(VkInstance instance);
+    void GatherOptionalExtensions();
     void RetrieveFeatures();
 
 private:
@@ -29,5 +32,6 @@ private:
     VkPhysicalDeviceVulkan11Features m_features11{};
     VkPhysicalDeviceVulkan12Features m_features12{};
     VkPhysicalDeviceVulkan13Features m_features13{};
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_featuresGraphicsPipelineLibrary{};
     std::vector<const char*> m_extensions;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MeshCommon.h"
+
 #include "Backend/Buffer.h"
 #include "Backend/Texture.h"
 
@@ -7,19 +9,6 @@
 
 #include <string>
 
-enum class AlphaMode : int
-{
-    Opaque = 0,
-    Blend = 1,
-    Mask = 2
-};
-
-enum class Workflow : int
-{
-    MetallicRoughness = 1,
-    SpecularGlossiness = 2
-};
-
 struct MaterialProps
 {
     glm::vec4 albedo = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
@@ -1,44 +1,57 @@
 #pragma once
 
 #include "Material.h"
+#include "MeshCommon.h"
+
+#include <functional>
+#include <vector>
 
 #include "Backend/Buffer.h"
 
-enum VertexComponentFlagBits : uint32_t
-{
-    VertexComponentNone = 0,
-    VertexComponentTangentBitangents = 1,
-    VertexComponentUvs = 2,
-    VertexComponentColors = 4
-};
-using VertexComponentFlags = uint32_t;
+struct Mesh;
+using MeshPtr = std::shared_ptr<Mesh>;
 
-struct Meshlet
+// Representations consumed by one render path, positions, attributes and mesh info are always resident
+enum MeshGeometryFlagBits : uint32_t
 {
-    float center[3]{};
-    float radius = 0.0f;
-    float coneApex[3]{};
-    float coneAxis[3]{};
-    float cutoff = 0.0f;
-    uint32_t vertexOffset = 0;
-    uint32_t vertexCount = 0;
-    uint32_t triangleOffset = 0;
-    uint32_t triangleCount = 0;
+    MeshGeometryNone = 0,
+    MeshGeometryIndices = 1,
+    MeshGeometryMeshlets = 2
 };
-
-struct Mesh;
-using MeshPtr = std::shared_ptr<Mesh>;
+using MeshGeometryFlags = uint32_t;
 
 struct Mesh
 {
     BufferPtr positions;
     BufferPtr indexBuffer;
+    IndexType indexType = IndexType::Uint32;
     BufferPtr meshlets;
     BufferPtr vertices;
     BufferPtr meshletVertices;
     BufferPtr meshletTriangles;
+    BufferPtr infoBuffer;
+    BufferPtr clusterLods;
     int meshletsCount = 0;
+    std::vector<MeshLod> lods;
+    uint32_t clusterCount = 0;
     VertexComponentFlags components = VertexComponentNone;
+    float aabbMin[3]{};
+    float aabbMax[3]{};
+    MeshGeometryFlags geometry = MeshGeometryNone;
+    // Coarsest level of detail for the software occlusion rasterizer, empty when it's too detailed to be an occluder
+    std::vector<glm::vec3> occluderPositions;
+    std::vector<uint32_t> occluderIndices;
+    // Set by the loader, creates and uploads the given representations from the source it keeps
+    std::function<void(Mesh& mesh, MeshGeometryFlags geometry)> createGeometry;
+
+    void RequireGeometry(MeshGeometryFlags required)
+    {
+        MeshGeometryFlags missing = required & ~geometry;
+        if (missing && createGeometry)
+        {
+            createGeometry(*this, missing);
+        }
+    }
 
     static MeshPtr Create()
     {
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+
+// Mesh and material data shared by the runtime and the offline mesh cooker, must not depend on the render backend
+
+enum class AlphaMode : int
+{
+    Opaque = 0,
+    Blend = 1,
+    Mask = 2
+};
+
+enum class Workflow : int
+{
+    MetallicRoughness = 1,
+    SpecularGlossiness = 2
+};
+
+enum VertexComponentFlagBits : uint32_t
+{
+    VertexComponentNone = 0,
+    VertexComponentTangentBitangents = 1,
+    VertexComponentUvs = 2,
+    VertexComponentColors = 4
+};
+using VertexComponentFlags = uint32_t;
+
+const inline static uint32_t MESH_MAX_LOD_COUNT = 8;
+// Mirror MAX_VERTICES_COUNT and MAX_TRIANGLES_COUNT in ZPassCommon.hlsli
+const inline static uint32_t MESHLET_VERTEX_COUNT_LIMIT = 64;
+const inline static uint32_t MESHLET_TRIANGLE_COUNT_LIMIT = 84;
+
+// Index and meshlet ranges of one level of detail, the error is its object space deviation from the full mesh
+struct MeshLod
+{
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    uint32_t meshletOffset = 0;
+    uint32_t meshletCount = 0;
+    float error = 0.0f;
+};
+
+// Meshlets whose vertices span more than 16 bits reference them with full 32-bit indices
+const inline static uint32_t MESHLET_WIDE_VERTEX_BASE = UINT32_MAX;
+
+// Vertex references are 16-bit offsets from vertexBase, vertexOffset counts 16-bit words of the meshlet vertex stream.
+// Triangles are three 8-bit local indices packed without padding, triangleOffset counts bytes.
+struct Meshlet
+{
+    float center[3]{};
+    float radius = 0.0f;
+    float coneApex[3]{};
+    float coneAxis[3]{};
+    float cutoff = 0.0f;
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t triangleOffset = 0;
+    uint32_t triangleCount = 0;
+    uint32_t vertexBase = 0;
+};
+
+// Error bounds of a meshlet in the cluster hierarchy, mirrors ClusterLod in ZPassCommon.hlsli.
+// A meshlet is drawn when its own projected error is acceptable and its parent's isn't, the roots have an infinite parent error.
+struct ClusterLod
+{
+    float center[3]{};
+    float radius = 0.0f;
+    float error = 0.0f;
+    float parentCenter[3]{};
+    float parentRadius = 0.0f;
+    float parentError = FLT_MAX;
+};
+
+// Dequantization ranges of the mesh vertices, mirrors MeshInfo in ZPassCommon.hlsli
+struct MeshInfo
+{
+    float positionMin[3]{};
+    float padding0 = 0.0f;
+    float positionExtent[3]{};
+    float padding1 = 0.0f;
+    float uvMin[2]{};
+    float uvExtent[2]{};
+};
@@ -0,0 +1,377 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define OCCLUSION_BUFFER_SSE
+    #include <immintrin.h>
+#endif
+
+// In pixels
+static constexpr float EDGE_BIAS = 1.0f / 256.0f;
+
+OcclusionBuffer::~OcclusionBuffer()
+{
+    StopWorkers();
+}
+
+void OcclusionBuffer::Clear(float aspectRatio)
+{
+    int height = std::max((int)std::lround(WIDTH / aspectRatio), 1);
+    if (m_width != (int)WIDTH || m_height != height)
+    {
+        m_width = (int)WIDTH;
+        m_height = height;
+        m_depth.resize((size_t)m_width * m_height);
+    }
+
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    m_triangles.clear();
+}
+
+void OcclusionBuffer::AddOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4& transform, bool isDoubleSided)
+{
+    m_clipPositions.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        m_clipPositions[i] = transform * glm::vec4(positions[i], 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::vec4* clip[3] = { &m_clipPositions[indices[i + 0]], &m_clipPositions[indices[i + 1]], &m_clipPositions[indices[i + 2]] };
+        // Depth is 0..1, so points closer than the near plane have a negative Z
+        if (clip[0]->z < 0.0f || clip[1]->z < 0.0f || clip[2]->z < 0.0f)
+        {
+            continue;
+        }
+
+        glm::vec2 pixel[3] = { ToPixel(*clip[0]), ToPixel(*clip[1]), ToPixel(*clip[2]) };
+        float depth[3] = { clip[0]->z / clip[0]->w, clip[1]->z / clip[1]->w, clip[2]->z / clip[2]->w };
+
+        // Front faces are counter-clockwise with Y up, so their area is negative in pixel space
+        float area = (pixel[1].x - pixel[0].x) * (pixel[2].y - pixel[0].y) - (pixel[2].x - pixel[0].x) * (pixel[1].y - pixel[0].y);
+        if (area > 0.0f && !isDoubleSided)
+        {
+            continue;
+        }
+        if (area < 0.0f)
+        {
+            std::swap(pixel[1], pixel[2]);
+            std::swap(depth[1], depth[2]);
+            area = -area;
+        }
+        if (area < 1e-6f)
+        {
+            continue;
+        }
+
+        Triangle triangle{};
+        triangle.minX = std::max((int)std::floor(std::min({ pixel[0].x, pixel[1].x, pixel[2].x })), 0);
+        triangle.minY = std::max((int)std::floor(std::min({ pixel[0].y, pixel[1].y, pixel[2].y })), 0);
+        triangle.maxX = std::min((int)std::floor(std::max({ pixel[0].x, pixel[1].x, pixel[2].x })), m_width - 1);
+        triangle.maxY = std::min((int)std::floor(std::max({ pixel[0].y, pixel[1].y, pixel[2].y })), m_height - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        {
+            continue;
+        }
+
+        // The edge opposite to a vertex is zero on the edge and equals the area at that vertex
+        for (int e = 0; e < 3; e++)
+        {
+            const glm::vec2& a = pixel[(e + 1) % 3];
+            const glm::vec2& b = pixel[(e + 2) % 3];
+            triangle.edgeA[e] = a.y - b.y;
+            triangle.edgeB[e] = b.x - a.x;
+            triangle.edgeC[e] = -(triangle.edgeA[e] * a.x + triangle.edgeB[e] * a.y);
+        }
+
+        // Depth is affine in screen space, the barycentrics are the edge functions over the area
+        triangle.depthA = (triangle.edgeA[0] * depth[0] + triangle.edgeA[1] * depth[1] + triangle.edgeA[2] * depth[2]) / area;
+        triangle.depthB = (triangle.edgeB[0] * depth[0] + triangle.edgeB[1] * depth[1] + triangle.edgeB[2] * depth[2]) / area;
+        triangle.depthC = (triangle.edgeC[0] * depth[0] + triangle.edgeC[1] * depth[1] + triangle.edgeC[2] * depth[2]) / area;
+
+        // Edges are pushed out by a fraction of a pixel, otherwise rounding drops pixel centers on edges shared by two triangles
+        for (int e = 0; e < 3; e++)
+        {
+            triangle.edgeC[e] += (std::abs(triangle.edgeA[e]) + std::abs(triangle.edgeB[e])) * EDGE_BIAS;
+        }
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionBuffer::Rasterize()
+{
+    ProfileFunction();
+
+    if (m_triangles.empty())
+    {
+        return;
+    }
+
+    StartWorkers();
+
+    // Every band is a range of rows, so no two threads write the same pixel
+    m_bandHeight = (m_height + m_bandCount - 1) / m_bandCount;
+
+    if (m_bandCount > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_workerMutex);
+            m_rasterizeIndex++;
+            m_pendingBandCount = m_bandCount - 1;
+        }
+        m_workerCondition.notify_all();
+    }
+
+    RasterizeBand(0);
+
+    if (m_bandCount > 1)
+    {
+        std::unique_lock<std::mutex> lock(m_workerMutex);
+        m_bandsDoneCondition.wait(lock, [this] { return m_pendingBandCount == 0; });
+    }
+}
+
+void OcclusionBuffer::RasterizeBand(int band)
+{
+    ProfileFunction();
+
+    int minY = band * m_bandHeight;
+    int maxY = std::min(minY + m_bandHeight, m_height);
+
+    for (const Triangle& triangle : m_triangles)
+    {
+        int startY = std::max(triangle.minY, minY);
+        int endY = std::min(triangle.maxY + 1, maxY);
+        int startX = triangle.minX & ~3;
+
+#if defined(OCCLUSION_BUFFER_SSE)
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 edgeA[3];
+        for (int e = 0; e < 3; e++)
+        {
+            edgeA[e] = _mm_set1_ps(triangle.edgeA[e]);
+        }
+        __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+        for (int y = startY; y < endY; y++)
+        {
+            float pixelY = (float)y + 0.5f;
+            float* row = m_depth.data() + (size_t)y * m_width;
+
+            __m128 rowEdge[3];
+            for (int e = 0; e < 3; e++)
+            {
+                rowEdge[e] = _mm_set1_ps(triangle.edgeB[e] * pixelY + triangle.edgeC[e]);
+            }
+            __m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelY + triangle.depthC);
+
+            for (int x = startX; x <= triangle.maxX; x += 4)
+            {
+                __m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], pixelX), rowEdge[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], pixelX), rowEdge[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], pixelX), rowEdge[2]), zero));
+                if (_mm_movemask_ps(inside) == 0)
+                {
+                    continue;
+                }
+
+                __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 closest = _mm_min_ps(current, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, current)));
+            }
+        }
+#else
+        for (int y = startY; y < endY; y++)
+        {
+            float pixelY = (float)y + 0.5f;
+            float* row = m_depth.data() + (size_t)y * m_width;
+
+            for (int x = startX; x <= triangle.maxX; x++)
+            {
+                float pixelX = (float)x + 0.5f;
+
+                bool isInside = true;
+                for (int e = 0; e < 3; e++)
+                {
+                    isInside &= triangle.edgeA[e] * pixelX + triangle.edgeB[e] * pixelY + triangle.edgeC[e] >= 0.0f;
+                }
+
+                if (isInside)
+                {
+                    row[x] = std::min(row[x], triangle.depthA * pixelX + triangle.depthB * pixelY + triangle.depthC);
+                }
+            }
+        }
+#endif
+    }
+}
+
+// The nearest corner of the bounds is tested against every pixel they cover, rounded out to 4 pixel columns
+bool OcclusionBuffer::IsVisible(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const glm::mat4& transform) const
+{
+    glm::vec2 minPixel = glm::vec2(FLT_MAX);
+    glm::vec2 maxPixel = glm::vec2(-FLT_MAX);
+    float nearestDepth = FLT_MAX;
+
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner = glm::vec3(i & 1 ? aabbMax[0] : aabbMin[0], i & 2 ? aabbMax[1] : aabbMin[1], i & 4 ? aabbMax[2] : aabbMin[2]);
+        glm::vec4 clip = transform * glm::vec4(corner, 1.0f);
+
+        // Bounds crossing the near plane can't be projected
+        if (clip.z < 0.0f || clip.w <= 0.0f)
+        {
+            return true;
+        }
+
+        glm::vec2 pixel = ToPixel(clip);
+        minPixel = glm::min(minPixel, pixel);
+        maxPixel = glm::max(maxPixel, pixel);
+        nearestDepth = std::min(nearestDepth, clip.z / clip.w);
+    }
+
+    int minX = std::max((int)std::floor(minPixel.x), 0) & ~3;
+    int minY = std::max((int)std::floor(minPixel.y), 0);
+    int maxX = std::min((int)std::floor(maxPixel.x), m_width - 1);
+    int maxY = std::min((int)std::floor(maxPixel.y), m_height - 1);
+
+    // Off screen objects are left to frustum culling
+    if (minX > maxX || minY > maxY)
+    {
+        return true;
+    }
+
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float* row = m_depth.data() + (size_t)y * m_width;
+
+#if defined(OCCLUSION_BUFFER_SSE)
+        __m128 nearest = _mm_set1_ps(nearestDepth);
+        for (int x = minX; x <= maxX; x += 4)
+        {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), nearest)) != 0)
+            {
+                return true;
+            }
+        }
+#else
+        for (int x = minX; x <= maxX; x++)
+        {
+            if (row[x] >= nearestDepth)
+            {
+                return true;
+            }
+        }
+#endif
+    }
+
+    return false;
+}
+
+int OcclusionBuffer::GetWidth() const
+{
+    return m_width;
+}
+
+int OcclusionBuffer::GetHeight() const
+{
+    return m_height;
+}
+
+float OcclusionBuffer::GetDepth(int x, int y) const
+{
+    Assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+    return m_depth[(size_t)y * m_width + x];
+}
+
+int OcclusionBuffer::GetTriangleCount() const
+{
+    return (int)m_triangles.size();
+}
+
+glm::vec2 OcclusionBuffer::ToPixel(const glm::vec4& clip) const
+{
+    // Same orientation as the render targets, mesh shaders and vertex shaders flip Y
+    return glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * m_width, (0.5f - clip.y / clip.w * 0.5f) * m_height);
+}
+
+void OcclusionBuffer::StartWorkers()
+{
+    if (m_bandCount != 0)
+    {
+        return;
+    }
+
+    m_bandCount = (int)std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+
+    m_isWorkerStopping = false;
+    for (int band = 1; band < m_bandCount; band++)
+    {
+        m_workers.emplace_back(&OcclusionBuffer::WorkerLoop, this, band);
+    }
+}
+
+void OcclusionBuffer::StopWorkers()
+{
+    if (m_workers.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_workerMutex);
+        m_isWorkerStopping = true;
+    }
+    m_workerCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void OcclusionBuffer::WorkerLoop(int band)
+{
+    ProfileSetThreadName("Occlusion Raster");
+
+    uint64_t rasterizedIndex = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_workerMutex);
+            m_workerCondition.wait(lock, [this, rasterizedIndex] { return m_isWorkerStopping || m_rasterizeIndex != rasterizedIndex; });
+
+            if (m_isWorkerStopping)
+            {
+                return;
+            }
+
+            rasterizedIndex = m_rasterizeIndex;
+        }
+
+        RasterizeBand(band);
+
+        bool isLastBand = false;
+        {
+            std::lock_guard<std::mutex> lock(m_workerMutex);
+            isLastBand = --m_pendingBandCount == 0;
+        }
+        if (isLastBand)
+        {
+            m_bandsDoneCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <Framework/Common.h>
+
+// Low resolution depth buffer for CPU occlusion culling. Occluder triangles are rasterized in horizontal bands, one per
+// worker thread, then bounds are tested against it. Coverage is sampled at pixel centers, so gaps between occluders smaller
+// than a pixel of the buffer are closed. Depth is NDC depth in the 0..1 range, 1 where there is no occluder.
+class OcclusionBuffer
+{
+public:
+    // Rows are processed 4 pixels at a time, so the width must be a multiple of 4
+    static constexpr uint32_t WIDTH = 320;
+
+    NON_COPYABLE_MOVABLE(OcclusionBuffer);
+
+    OcclusionBuffer() = default;
+    ~OcclusionBuffer();
+
+    // Removes the occluders and resets the depth, the height follows the aspect ratio
+    void Clear(float aspectRatio);
+    // Triangles crossing the near plane are skipped rather than clipped, which only makes the occluder smaller
+    void AddOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4& transform, bool isDoubleSided);
+    void Rasterize();
+
+    // Bounds are in object space. Bounds crossing the near plane or off screen are visible
+    bool IsVisible(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const glm::mat4& transform) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    float GetDepth(int x, int y) const;
+    int GetTriangleCount() const;
+
+private:
+    // Edge functions and depth are planes A * x + B * y + C in pixel space, edges are positive inside
+    struct Triangle
+    {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float depthA;
+        float depthB;
+        float depthC;
+        // Inclusive pixel bounds within the buffer
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+private:
+    void RasterizeBand(int band);
+    glm::vec2 ToPixel(const glm::vec4& clip) const;
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(int band);
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<float> m_depth;
+    std::vector<Triangle> m_triangles;
+    std::vector<glm::vec4> m_clipPositions;
+
+    // Workers live as long as the buffer and wake up once per Rasterize, band 0 is rasterized by the calling thread
+    std::vector<std::thread> m_workers;
+    std::mutex m_workerMutex;
+    std::condition_variable m_workerCondition;
+    std::condition_variable m_bandsDoneCondition;
+    uint64_t m_rasterizeIndex = 0;
+    int m_pendingBandCount = 0;
+    // Zero until the workers are started
+    int m_bandCount = 0;
+    int m_bandHeight = 0;
+    bool m_isWorkerStopping = false;
+};
@@ -22,9 +22,22 @@ struct RenderObject
     BufferPtr perInstanceBuffer;
     MeshPtr mesh;
     MaterialPtr material;
+    glm::mat4 globalTransform = glm::mat4(1.0f);
 
     // for internal use
     std::unordered_map<DrawCallType, const PSOGraphics*> drawCallsPSOs;
+    uint32_t lod = 0;
+    // A word per meshlet, nonzero when it passed occlusion culling last time it was tested
+    BufferPtr meshletVisibility;
+    // Vertex path cluster culling, two index ranges and their indirect draws sub-allocated from the pools of ZPassRenderer.
+    // The second range holds the meshlets found visible by the late occlusion phase.
+    BufferPtr clusterIndices;
+    BufferPtr clusterDrawArgs;
+    // In bytes, the draw arguments locate the index ranges with their first index
+    uint32_t clusterDrawArgsOffset = 0;
+    IndexType clusterIndexType = IndexType::Uint32;
+    // Ranges filled this frame
+    uint32_t clusterDrawCount = 0;
 
     const PSOGraphics* GetPSO(DrawCallType type);
 
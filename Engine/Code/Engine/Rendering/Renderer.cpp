@@ -1,5 +1,6 @@
 #include "Renderer.h"
 
+#include "Backend/PSOUsageLog.h"
 #include "Backend/Shader.h"
 
 #include <Application/Application.h>
@@ -10,12 +11,16 @@
 
 Renderer* Renderer::s_renderer = nullptr;
 
+static const char* PSO_USAGE_LOG_PATH = "assets/pso_usage.bin";
+
 Renderer::Renderer()
 {
     ProfileFunction();
 
     m_driver = RenderDriver::Create();
     m_dbt = DescriptorBindingTable::Create();
+
+    Shader::LoadPack("assets/shaders.pack");
     m_swapchain = Swapchain::Create();
 
     m_props.swapchainResolution = m_swapchain->GetSize();
@@ -46,6 +51,13 @@ Renderer::Renderer()
 
 Renderer::~Renderer()
 {
+    if (m_shaderReloadTask.valid())
+    {
+        ApplyShaderReload();
+    }
+
+    PSOUsageLog::Save(PSO_USAGE_LOG_PATH);
+
     m_driver->WaitIdle();
     Texture::ClearCache();
     m_driver->DestroyFramesData();
@@ -65,6 +77,8 @@ void Renderer::Initialize()
     m_cubemapRenderer.CreateBrdfLut(cmdBuffer, m_commonResources.brdfLut);
 
     m_driver->SubmitCommandBuffer(cmdBuffer);
+
+    PSOUsageLog::Prewarm(PSO_USAGE_LOG_PATH);
 }
 
 void Renderer::Resize()
@@ -176,17 +190,37 @@ void Renderer::Render(const PerFrameData& perFrameData)
         CreateRenderTargets();
     }
 
+    // Benchmarks render every frame with all PSOs ready instead of skipping draws while they compile
+    if (m_props.isWaitForPsoPrewarm && PSOGraphics::GetPendingCount() > 0)
+    {
+        PSOGraphics::WaitForPending();
+    }
+
     CommandBufferPtr cmdBuffer = CommandBuffer::Create("RENDER");
     m_dbt->Bind(cmdBuffer);
     {
         cmdBuffer->BeginZone("RENDER");
 
         LoadFrameResources(perFrameData);
+        if (m_props.isUseSoftwareOcclusion)
+        {
+            m_softwareOcclusion.Cull(perFrameData.projViewMat, glm::vec3(perFrameData.cameraPosition), m_props.GetRenderAspectRatio(), m_opaqueRenderObjects, m_transparentRenderObjects);
+        }
+        RequireGeometry(m_opaqueRenderObjects);
+        RequireGeometry(m_transparentRenderObjects);
+        SelectLods(perFrameData, m_opaqueRenderObjects);
+        SelectLods(perFrameData, m_transparentRenderObjects);
 
+        // The prepass culls the clusters of the objects it draws between its occlusion culling phases
         if (m_props.isUseZPrepass)
         {
             m_zpassRenderer.RenderZPrepass(m_opaqueRenderObjects, cmdBuffer);
         }
+        else
+        {
+            m_zpassRenderer.CullClusters(m_opaqueRenderObjects, cmdBuffer);
+        }
+        m_zpassRenderer.CullClusters(m_transparentRenderObjects, cmdBuffer);
 
         HDRRender(cmdBuffer);
 
@@ -209,6 +243,7 @@ void Renderer::Render(const PerFrameData& perFrameData)
     m_transparentRenderObjects.clear();
 
     HotReloadShaders();
+    ApplyPipelineOptimizations();
 
     m_loadCmdBuffer = CommandBuffer::Create("LOAD RESOURCES");
 
@@ -254,7 +289,7 @@ void Renderer::CreateRenderTargets()
     m_commonResources.hdrTarget = Texture::Create2D(TextureUsageSample | TextureUsageStorage | TextureUsageColorRenderTarget, Format::RGBA16_SFLOAT, width, height);
     m_commonResources.hdrTarget->SetName("$HDRTarget");
 
-    m_commonResources.depthTarget = Texture::Create2D(TextureUsageDepthRenderTarget, Format::D32_SFLOAT, width, height);
+    m_commonResources.depthTarget = Texture::Create2D(TextureUsageDepthRenderTarget | TextureUsageSample, Format::D32_SFLOAT, width, height);
     m_commonResources.depthTarget->SetName("$DepthTarget");
     
     m_commonResources.bloomTextures.clear();
@@ -280,10 +315,34 @@ void Renderer::CreateRenderTargets()
 
         m_commonResources.hdrTargetHalfs.push_back(std::move(hdrHalfRes));
     }
+
+    m_commonResources.hiZTextures.clear();
+    int hiZWidth = width;
+    int hiZHeight = height;
+    while ((hiZWidth > 1 || hiZHeight > 1) && m_commonResources.hiZTextures.size() < HI_Z_MAX_LEVEL_COUNT)
+    {
+        hiZWidth = (hiZWidth + 1) / 2;
+        hiZHeight = (hiZHeight + 1) / 2;
+
+        TexturePtr hiZTexture = Texture::Create2D(TextureUsageSample | TextureUsageStorage, Format::R32_SFLOAT, hiZWidth, hiZHeight);
+        hiZTexture->SetName(std::format("$HiZ{}", m_commonResources.hiZTextures.size()));
+
+        m_commonResources.hiZTextures.push_back(std::move(hiZTexture));
+    }
 }
 
 void Renderer::HotReloadShaders()
 {
+    if (m_shaderReloadTask.valid())
+    {
+        if (m_shaderReloadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+
+        ApplyShaderReload();
+    }
+
     if (!m_shaderSourceWatch.IsChanged())
     {
         return;
@@ -298,11 +357,53 @@ void Renderer::HotReloadShaders()
         relativePathes.insert(std::move(std::filesystem::relative(path, rootPath).generic_string()));
     }
 
-    m_driver->WaitIdle();
+    m_shaderRecompilations = Shader::GatherRecompilations(relativePathes);
+    if (m_shaderRecompilations.empty())
+    {
+        return;
+    }
+
+    m_psoGraphicsRecreations = PSOGraphics::GatherRecreations(m_shaderRecompilations);
+    m_psoComputeRecreations = PSOCompute::GatherRecreations(m_shaderRecompilations);
+
+    // Shaders and pipelines are rebuilt in the background while rendering continues with the old ones
+    m_shaderReloadTask = std::async(std::launch::async, [this, changedNames = std::move(relativePathes)]()
+        {
+            ProfileSetThreadName("Shader Reload");
 
-    std::unordered_set<const Shader*> changedShaders = Shader::RecreateOnShaderChanges(relativePathes);
-    PSOGraphics::RecreateOnShaderChanged(changedShaders);
-    PSOCompute::RecreateOnShaderChanged(changedShaders);
+            Shader::Recompile(m_shaderRecompilations, changedNames);
+            PSOGraphics::Recreate(m_psoGraphicsRecreations, m_shaderRecompilations);
+            PSOCompute::Recreate(m_psoComputeRecreations, m_shaderRecompilations);
+        });
+}
+
+void Renderer::ApplyShaderReload()
+{
+    ProfileFunction();
+
+    m_shaderReloadTask.get();
+
+    // Async PSO creation reads shader stages, so it must not run while they are swapped
+    PSOGraphics::WaitForPending();
+
+    std::unordered_set<const Shader*> changedShaders = Shader::ApplyRecompilations(m_shaderRecompilations);
+
+    std::vector<VkPipeline> retiredPipelines;
+    PSOGraphics::ApplyRecreations(m_psoGraphicsRecreations, changedShaders, retiredPipelines);
+    PSOCompute::ApplyRecreations(m_psoComputeRecreations, retiredPipelines);
+
+    m_driver->RetirePipelines(retiredPipelines);
+}
+
+void Renderer::ApplyPipelineOptimizations()
+{
+    std::vector<VkPipeline> retiredPipelines;
+    PSOGraphics::ApplyOptimizations(retiredPipelines);
+
+    if (!retiredPipelines.empty())
+    {
+        m_driver->RetirePipelines(retiredPipelines);
+    }
 }
 
 void Renderer::LoadFrameResources(PerFrameData perFrameData)
@@ -314,10 +415,123 @@ void Renderer::LoadFrameResources(PerFrameData perFrameData)
         perFrameData.prefilteredCubemaps[i] = m_commonResources.prefilteredCubemap[i] ? m_commonResources.prefilteredCubemap[i]->BindSRV() : 0;
     }
     perFrameData.samplerDesc = Sampler::GetLinearAnisotropy().GetBindSlot();
+    perFrameData.lodErrorScale = GetLodErrorScale(perFrameData);
+
+    // Rows of the projection combined with the w row bound the clip volume. The near plane uses z >= -w,
+    // which is conservative for the [0, 1] depth range.
+    const glm::mat4& projView = perFrameData.projViewMat;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(projView[0][i], projView[1][i], projView[2][i], projView[3][i]);
+    }
+
+    perFrameData.frustumPlanes[0] = rows[3] + rows[0];
+    perFrameData.frustumPlanes[1] = rows[3] - rows[0];
+    perFrameData.frustumPlanes[2] = rows[3] + rows[1];
+    perFrameData.frustumPlanes[3] = rows[3] - rows[1];
+    perFrameData.frustumPlanes[4] = rows[3] + rows[2];
+    perFrameData.frustumPlanes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : perFrameData.frustumPlanes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    if (m_props.IsOcclusionCulling())
+    {
+        for (size_t i = 0; i < m_commonResources.hiZTextures.size(); i++)
+        {
+            perFrameData.hiZTextures[i] = m_commonResources.hiZTextures[i]->BindSRV();
+        }
+        perFrameData.hiZLevelCount = (int)m_commonResources.hiZTextures.size();
+    }
+    perFrameData.renderWidth = (int)m_props.renderResolution.x;
+    perFrameData.renderHeight = (int)m_props.renderResolution.y;
 
     m_loadCmdBuffer->CopyToBuffer(m_commonResources.perFrameBuffer, &perFrameData, sizeof(PerFrameData));
 }
 
+MeshGeometryFlags Renderer::GetRequiredGeometry() const
+{
+    if (m_props.isMeshShading)
+    {
+        return MeshGeometryMeshlets;
+    }
+
+    // Meshes the culling pass can't run for fall back to the whole index buffer
+    return m_props.isUseClusterCulling ? MeshGeometryIndices | MeshGeometryMeshlets : MeshGeometryIndices;
+}
+
+// Meshes only keep the geometry of the render path they were drawn with, switching paths creates the other one on first use
+void Renderer::RequireGeometry(std::vector<RenderObjectPtr>& renderObjects)
+{
+    ProfileFunction();
+
+    MeshGeometryFlags geometry = GetRequiredGeometry();
+    for (RenderObjectPtr& renderObject : renderObjects)
+    {
+        renderObject->mesh->RequireGeometry(geometry);
+    }
+}
+
+// Object space error at some distance is acceptable when error * scale <= distance, pixels covered by one unit at distance one over the threshold.
+// Disabled LODs make every nonzero error unacceptable, so the cluster hierarchy falls back to the full detail meshlets too.
+float Renderer::GetLodErrorScale(const PerFrameData& perFrameData) const
+{
+    if (!m_props.isUseLods || m_props.lodErrorThreshold <= 0.0f)
+    {
+        return FLT_MAX;
+    }
+
+    float pixelsPerUnit = perFrameData.projMatrix[1][1] * 0.5f * (float)m_props.renderResolution.y;
+
+    return pixelsPerUnit / m_props.lodErrorThreshold;
+}
+
+// Projects each level's error from the closest point of the object bounds, the scale is the largest one of the transform
+void Renderer::SelectLods(const PerFrameData& perFrameData, std::vector<RenderObjectPtr>& renderObjects)
+{
+    ProfileFunction();
+
+    float lodErrorScale = GetLodErrorScale(perFrameData);
+    glm::vec3 cameraPosition = glm::vec3(perFrameData.cameraPosition);
+
+    for (RenderObjectPtr& renderObject : renderObjects)
+    {
+        const Mesh& mesh = *renderObject->mesh;
+
+        renderObject->lod = 0;
+        if (!m_props.isUseLods || mesh.lods.size() < 2)
+        {
+            continue;
+        }
+
+        const glm::mat4& transform = renderObject->globalTransform;
+        float scale = std::sqrt(std::max({ glm::dot(transform[0], transform[0]), glm::dot(transform[1], transform[1]), glm::dot(transform[2], transform[2]) }));
+
+        glm::vec3 aabbMin = glm::make_vec3(mesh.aabbMin);
+        glm::vec3 aabbMax = glm::make_vec3(mesh.aabbMax);
+        glm::vec3 center = glm::vec3(transform * glm::vec4((aabbMin + aabbMax) * 0.5f, 1.0f));
+        float radius = glm::length(aabbMax - aabbMin) * 0.5f * scale;
+
+        float distance = glm::distance(cameraPosition, center) - radius;
+        if (distance <= 0.0f)
+        {
+            continue;
+        }
+
+        for (uint32_t i = (uint32_t)mesh.lods.size() - 1; i > 0; i--)
+        {
+            if (mesh.lods[i].error * scale * lodErrorScale <= distance)
+            {
+                renderObject->lod = i;
+                break;
+            }
+        }
+    }
+}
+
 void Renderer::HDRRender(CommandBufferPtr& cmdBuffer)
 {
     ProfileFunction();
@@ -401,4 +615,13 @@ void Renderer::GatherStats()
 
     m_stats.gpuZones = m_driver->GetGPUZones();
     m_stats.pipelineStatistics = m_driver->GetPipelineStatistics();
+
+    if (m_props.isUseSoftwareOcclusion)
+    {
+        m_stats.softwareOcclusion = m_softwareOcclusion.GetStats();
+    }
+
+    m_stats.pendingPsoCount = PSOGraphics::GetPendingCount();
+    m_stats.psoHitchesAvoidedCount = PSOGraphics::GetHitchesAvoidedCount();
+    m_stats.prewarmedPsoCount = PSOUsageLog::GetPrewarmedCount();
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <future>
 
 #include <Framework/FileWatch.h>
 
@@ -14,6 +15,7 @@
 #include "SwapchainRenderer.h"
 #include "HDRPostProcessRenderer.h"
 #include "UIRenderer.h"
+#include "SoftwareOcclusion.h"
 #include "RendererCommon.h"
 
 #include "../Camera.h"
@@ -27,10 +29,18 @@ struct PerFrameData
     glm::vec4 cameraPosition = glm::vec4(0.0f);
     glm::vec4 lightDirection = glm::vec4(10.0f, -10.0f, -10.0f, 0.0f);
     glm::vec4 lightColorIntensity = glm::vec4(1.0f, 1.0f, 1.0f, 3.0f);
+    // World space, normalized and pointing inside: left, right, bottom, top, near, far
+    glm::vec4 frustumPlanes[6]{};
     int brdfLutTexture = 0;
     int convolutedCubemapTexture = 0;
     int prefilteredCubemaps[5]{};
     int samplerDesc = 0;
+    float lodErrorScale = 0.0f;
+    // Bound only when occlusion culling is on, levels are separate textures
+    int hiZTextures[HI_Z_MAX_LEVEL_COUNT]{};
+    int hiZLevelCount = 0;
+    int renderWidth = 0;
+    int renderHeight = 0;
 };
 
 struct RendererStats
@@ -38,10 +48,18 @@ struct RendererStats
     RenderStats stats{};
     std::vector<GPUZone> gpuZones;
     std::vector<PipelineStatistics> pipelineStatistics;
+    SoftwareOcclusionStats softwareOcclusion{};
+    int pendingPsoCount = 0;
+    int psoHitchesAvoidedCount = 0;
+    int prewarmedPsoCount = 0;
 
     void Reset()
     {
         stats.Reset();
+        softwareOcclusion = {};
+        pendingPsoCount = 0;
+        psoHitchesAvoidedCount = 0;
+        prewarmedPsoCount = 0;
         gpuZones.clear();
         pipelineStatistics.clear();
     }
@@ -68,6 +86,8 @@ public:
 
     RendererProperties& GetProps();
     const RendererStats& GetStats() const;
+    // Mesh geometry consumed by the current render path
+    MeshGeometryFlags GetRequiredGeometry() const;
 
     void Render(const PerFrameData& perFrameData);
 
@@ -78,8 +98,13 @@ private:
     void CreateRenderTargets();
 
     void HotReloadShaders();
+    void ApplyShaderReload();
+    void ApplyPipelineOptimizations();
 
     void LoadFrameResources(PerFrameData perFrameData);
+    void RequireGeometry(std::vector<RenderObjectPtr>& renderObjects);
+    float GetLodErrorScale(const PerFrameData& perFrameData) const;
+    void SelectLods(const PerFrameData& perFrameData, std::vector<RenderObjectPtr>& renderObjects);
 
     void HDRRender(CommandBufferPtr& cmdBuffer);
     void SwapchainRendering(CommandBufferPtr& cmdBuffer);
@@ -102,12 +127,17 @@ private:
     CubemapRenderer m_cubemapRenderer;
     HDRPostProcessRenderer m_hdrPostProcessRenderer;
     SwapchainRenderer m_swapchainRenderer;
+    SoftwareOcclusion m_softwareOcclusion;
 
     CommandBufferPtr m_loadCmdBuffer;
 
     RendererStats m_stats{};
 
     FileWatch m_shaderSourceWatch;
+    std::future<void> m_shaderReloadTask;
+    std::vector<ShaderRecompilation> m_shaderRecompilations;
+    std::vector<PSOGraphicsRecreation> m_psoGraphicsRecreations;
+    std::vector<PSOComputeRecreation> m_psoComputeRecreations;
 
     static Renderer* s_renderer;
 };
\ No newline at end of file
@@ -7,12 +7,19 @@ struct RenderStats
     int drawCallCount = 0;
     int dispatchCount = 0;
     int drawMeshTasksCount = 0;
+    int skippedDrawCount = 0;
+    int lodTrianglesSavedCount = 0;
+    // Meshlets dispatched to the task shader or the cluster culling pass, the ones the task shader emits are counted by the MS invocations statistic
+    int meshletTestedCount = 0;
 
     void Reset()
     {
         drawCallCount = 0;
         dispatchCount = 0;
         drawMeshTasksCount = 0;
+        skippedDrawCount = 0;
+        lodTrianglesSavedCount = 0;
+        meshletTestedCount = 0;
     }
 
     RenderStats& operator+=(const RenderStats& other)
@@ -20,6 +27,9 @@ struct RenderStats
         drawCallCount += other.drawCallCount;
         dispatchCount += other.dispatchCount;
         drawMeshTasksCount += other.drawMeshTasksCount;
+        skippedDrawCount += other.skippedDrawCount;
+        lodTrianglesSavedCount += other.lodTrianglesSavedCount;
+        meshletTestedCount += other.meshletTestedCount;
         return *this;
     }
 };
@@ -31,6 +41,23 @@ struct RendererProperties
     glm::uvec2 swapchainResolution = glm::uvec2(0, 0);
 
     bool isUseZPrepass = false;
+    bool isWaitForPsoPrewarm = false;
+    // Draws geometry with task and mesh shaders instead of the vertex shader path, meshes create the geometry of a path on first use
+    bool isMeshShading = false;
+    bool isUseLods = true;
+    // Vertex path: a compute pass culls meshlets and the survivors are drawn from a compacted index buffer
+    bool isUseClusterCulling = true;
+    // Meshlets visible last frame are drawn first, the rest are tested against their depth. Needs the Z prepass and meshlet culling.
+    bool isUseOcclusionCulling = true;
+    // Objects behind the largest occluders are rejected on the CPU before any GPU work, see SoftwareOcclusion
+    bool isUseSoftwareOcclusion = false;
+    // Coarsest level of detail whose error projects below this many pixels is drawn
+    float lodErrorThreshold = 1.0f;
+
+    bool IsOcclusionCulling() const
+    {
+        return isUseOcclusionCulling && isUseZPrepass && (isMeshShading || isUseClusterCulling);
+    }
 
     float GetRenderAspectRatio() const
     {
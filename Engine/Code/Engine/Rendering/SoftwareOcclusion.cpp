@@ -0,0 +1,101 @@
+#include "SoftwareOcclusion.h"
+
+#include <Framework/Common.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <glm/gtc/type_ptr.hpp>
+
+void SoftwareOcclusion::Cull(const glm::mat4& projView, const glm::vec3& cameraPosition, float aspectRatio, std::vector<RenderObjectPtr>& opaqueObjects, std::vector<RenderObjectPtr>& transparentObjects)
+{
+    ProfileFunction();
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    m_stats = {};
+
+    m_buffer.Clear(aspectRatio);
+
+    SelectOccluders(cameraPosition, opaqueObjects);
+
+    for (const RenderObject* occluder : m_occluders)
+    {
+        const Mesh& mesh = *occluder->mesh;
+        m_buffer.AddOccluder(mesh.occluderPositions, mesh.occluderIndices, projView * occluder->globalTransform, occluder->material->props.isDoubleSided);
+    }
+
+    m_stats.occluderCount = (int)m_occluders.size();
+    m_stats.occluderTriangleCount = m_buffer.GetTriangleCount();
+
+    if (m_stats.occluderTriangleCount > 0)
+    {
+        m_buffer.Rasterize();
+
+        RemoveOccluded(projView, opaqueObjects);
+        RemoveOccluded(projView, transparentObjects);
+    }
+
+    std::chrono::duration<float, std::milli> cullTime = std::chrono::steady_clock::now() - startTime;
+    m_stats.milliseconds = cullTime.count();
+}
+
+const SoftwareOcclusionStats& SoftwareOcclusion::GetStats() const
+{
+    return m_stats;
+}
+
+// The largest objects on screen cover the most, objects the camera is inside of are the largest
+void SoftwareOcclusion::SelectOccluders(const glm::vec3& cameraPosition, const std::vector<RenderObjectPtr>& opaqueObjects)
+{
+    std::vector<std::pair<float, const RenderObject*>> candidates;
+
+    for (const RenderObjectPtr& renderObject : opaqueObjects)
+    {
+        const Mesh& mesh = *renderObject->mesh;
+        if (mesh.occluderIndices.empty())
+        {
+            continue;
+        }
+
+        const glm::mat4& transform = renderObject->globalTransform;
+        float scale = std::sqrt(std::max({ glm::dot(transform[0], transform[0]), glm::dot(transform[1], transform[1]), glm::dot(transform[2], transform[2]) }));
+
+        glm::vec3 aabbMin = glm::make_vec3(mesh.aabbMin);
+        glm::vec3 aabbMax = glm::make_vec3(mesh.aabbMax);
+        glm::vec3 center = glm::vec3(transform * glm::vec4((aabbMin + aabbMax) * 0.5f, 1.0f));
+        float radius = glm::length(aabbMax - aabbMin) * 0.5f * scale;
+
+        float size = radius / std::max(glm::distance(cameraPosition, center), radius);
+        if (size >= MIN_OCCLUDER_SIZE)
+        {
+            candidates.emplace_back(size, renderObject.get());
+        }
+    }
+
+    size_t occluderCount = std::min(candidates.size(), (size_t)MAX_OCCLUDER_COUNT);
+    std::partial_sort(candidates.begin(), candidates.begin() + occluderCount, candidates.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    m_occluders.clear();
+    for (size_t i = 0; i < occluderCount; i++)
+    {
+        m_occluders.push_back(candidates[i].second);
+    }
+}
+
+void SoftwareOcclusion::RemoveOccluded(const glm::mat4& projView, std::vector<RenderObjectPtr>& renderObjects)
+{
+    ProfileFunction();
+
+    auto it = std::remove_if(renderObjects.begin(), renderObjects.end(),
+        [&](const RenderObjectPtr& renderObject)
+        {
+            const Mesh& mesh = *renderObject->mesh;
+            return !m_buffer.IsVisible(glm::make_vec3(mesh.aabbMin), glm::make_vec3(mesh.aabbMax), projView * renderObject->globalTransform);
+        });
+
+    m_stats.rejectedCount += (int)std::distance(it, renderObjects.end());
+    renderObjects.erase(it, renderObjects.end());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "OcclusionBuffer.h"
+#include "RenderObject.h"
+
+struct SoftwareOcclusionStats
+{
+    int occluderCount = 0;
+    int occluderTriangleCount = 0;
+    int rejectedCount = 0;
+    float milliseconds = 0.0f;
+};
+
+// Coarse CPU occlusion culling in the spirit of Masked Occlusion Culling. The coarsest LODs of the largest opaque objects
+// on screen are rasterized into a low resolution depth buffer, then objects whose bounds are behind it everywhere they
+// cover are removed before any GPU work.
+class SoftwareOcclusion
+{
+public:
+    static constexpr uint32_t MAX_OCCLUDER_COUNT = 32;
+    // Meshes whose coarsest LOD has more triangles don't keep an occluder
+    static constexpr uint32_t MAX_OCCLUDER_TRIANGLE_COUNT = 2048;
+    // Bounding sphere radius over its distance to the camera
+    static constexpr float MIN_OCCLUDER_SIZE = 0.1f;
+
+    // Occluders are picked among the opaque objects, occluded objects are removed from both lists
+    void Cull(const glm::mat4& projView, const glm::vec3& cameraPosition, float aspectRatio, std::vector<RenderObjectPtr>& opaqueObjects, std::vector<RenderObjectPtr>& transparentObjects);
+
+    const SoftwareOcclusionStats& GetStats() const;
+
+private:
+    void SelectOccluders(const glm::vec3& cameraPosition, const std::vector<RenderObjectPtr>& opaqueObjects);
+    void RemoveOccluded(const glm::mat4& projView, std::vector<RenderObjectPtr>& renderObjects);
+
+private:
+    OcclusionBuffer m_buffer;
+    std::vector<const RenderObject*> m_occluders;
+
+    SoftwareOcclusionStats m_stats{};
+};
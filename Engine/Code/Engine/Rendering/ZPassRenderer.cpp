@@ -2,6 +2,57 @@
 
 #include <algorithm>
 
+// Must match the [[vk::constant_id]] declarations in ZPassCommon.hlsli
+enum ZPassConstant : uint32_t
+{
+    ZPassConstantBackFaceCull = 0,
+    ZPassConstantAlphaMask = 1,
+    ZPassConstantSpecularGlossiness = 2
+};
+
+// Mirrors DrawData in ZPassCommon.hlsli, the depth only passes leave the shading resources unbound
+struct ZPassDrawData
+{
+    int positions;
+    int vertices;
+    int meshInfo;
+    int meshlets;
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+    int clusterLods;
+    int meshletIndices;
+    int meshletVertices;
+    int materialProps;
+    int perFrameBuffer;
+    int perInstanceBuffer;
+    int meshletVisibility;
+    uint32_t cullPhase;
+    int clusterIndices;
+    int clusterDrawArgs;
+    uint32_t clusterDrawArgsOffset;
+};
+
+// Mirrors ClusterCull.hlsl, in 32-bit words: a VkDrawIndexedIndirectCommand per index range followed by the capacity of a range
+// and the size of an index in bytes
+static const uint32_t CLUSTER_DRAW_ARGS_STRIDE = 5;
+static const uint32_t CLUSTER_DRAW_ARGS_FIRST_INDEX = 2;
+static const uint32_t CLUSTER_DRAW_ARGS_CAPACITY = 10;
+static const uint32_t CLUSTER_DRAW_ARGS_INDEX_SIZE = 11;
+static const uint32_t CLUSTER_DRAW_ARGS_WORD_COUNT = 12;
+
+// A pool too small for the allocation is replaced by a larger one. Objects keep the pool they were given alive.
+template<typename CreatePool>
+static void ReservePool(BufferPtr& pool, uint64_t& usedSize, uint64_t size, CreatePool createPool)
+{
+    if (pool && usedSize + size <= (uint64_t)pool->GetSize())
+    {
+        return;
+    }
+
+    pool = createPool((int64_t)std::max(size, pool ? (uint64_t)pool->GetSize() * 2 : 0));
+    usedSize = 0;
+}
+
 void ZPassRenderer::Create(const CommonRenderResources* commonResources, const RendererProperties* props)
 {
     m_commonResources = commonResources;
@@ -11,6 +62,9 @@ void ZPassRenderer::Create(const CommonRenderResources* commonResources, const R
 void ZPassRenderer::NewFrame()
 {
     m_stats.Reset();
+
+    m_clusterIndicesUsedSize = 0;
+    m_clusterDrawArgsUsedSize = 0;
 }
 
 void ZPassRenderer::RenderZPrepass(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer)
@@ -24,22 +78,93 @@ void ZPassRenderer::RenderZPrepass(std::vector<RenderObjectPtr>& renderObjects,
 
     cmdBuffer->ResetBindAndRenderStates();
 
+    bool isOcclusionCulling = IsOcclusionCulling();
+    if (isOcclusionCulling)
+    {
+        CreateMeshletVisibility(renderObjects, cmdBuffer);
+        RegisterMeshletVisibility(renderObjects, cmdBuffer, false);
+    }
+
+    if (IsClusterCulling())
+    {
+        ResetClusterDraws(renderObjects, cmdBuffer);
+        DispatchClusterCull(renderObjects, cmdBuffer, isOcclusionCulling ? ZPassCullPhaseVisible : ZPassCullPhaseNone);
+    }
+
     cmdBuffer->SetDepthTargetClear(depthTarget, 1.0f, 0);
     cmdBuffer->BeginRenderPass();
 
     cmdBuffer->SetViewport(0.0f, 0.0f, (float)depthTarget->GetWidth(), (float)depthTarget->GetHeight(), 0.0f, 1.0f);
     cmdBuffer->SetScissor(0, 0, depthTarget->GetWidth(), depthTarget->GetHeight());
 
+    DrawZPrepass(renderObjects, cmdBuffer, isOcclusionCulling ? ZPassCullPhaseVisible : ZPassCullPhaseNone);
+
+    cmdBuffer->EndRenderPass();
+
+    // Everything visible last frame is in the depth target now, the rest is tested against it and drawn if it shows up
+    if (isOcclusionCulling)
+    {
+        BuildHiZ(cmdBuffer);
+
+        RegisterMeshletVisibility(renderObjects, cmdBuffer, true);
+        for (TexturePtr& hiZTexture : m_commonResources->hiZTextures)
+        {
+            cmdBuffer->RegisterSRVUsageTexture(hiZTexture);
+        }
+
+        if (IsClusterCulling())
+        {
+            DispatchClusterCull(renderObjects, cmdBuffer, ZPassCullPhaseLate);
+        }
+
+        cmdBuffer->SetDepthTarget(depthTarget);
+        cmdBuffer->BeginRenderPass();
+
+        cmdBuffer->SetViewport(0.0f, 0.0f, (float)depthTarget->GetWidth(), (float)depthTarget->GetHeight(), 0.0f, 1.0f);
+        cmdBuffer->SetScissor(0, 0, depthTarget->GetWidth(), depthTarget->GetHeight());
+
+        DrawZPrepass(renderObjects, cmdBuffer, ZPassCullPhaseLate);
+
+        cmdBuffer->EndRenderPass();
+
+        // The shading pass only reads the result, the transition can't happen inside its render pass
+        RegisterMeshletVisibility(renderObjects, cmdBuffer, false);
+    }
+
+    cmdBuffer->EndZone();
+    cmdBuffer->MarkerEnd();
+}
+
+void ZPassRenderer::CullClusters(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer)
+{
+    if (!IsClusterCulling() || renderObjects.empty())
+    {
+        return;
+    }
+
+    ResetClusterDraws(renderObjects, cmdBuffer);
+    DispatchClusterCull(renderObjects, cmdBuffer, ZPassCullPhaseNone);
+}
+
+void ZPassRenderer::DrawZPrepass(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, ZPassCullPhase cullPhase)
+{
     for (RenderObjectPtr& rd : renderObjects)
     {
-        const MaterialPtr& material = rd->material;
-        if (material->props.alphaMode != AlphaMode::Opaque)
+        if (!IsDrawnInZPrepass(rd))
         {
             continue;
         }
 
-        if (!Input::IsKeyDown(Key::F))
+        if (!m_renderProps->isMeshShading)
         {
+            bool isClusterDraw = IsClusterCulling() && rd->clusterDrawCount > 0;
+
+            // The late phase only draws what its culling pass found newly visible
+            if (cullPhase == ZPassCullPhaseLate && (!isClusterDraw || rd->clusterDrawCount < 2))
+            {
+                continue;
+            }
+
             const PSOGraphics* pso = rd->GetPSO(DrawCallType::ZPrePass);
             if (!pso)
             {
@@ -51,31 +176,39 @@ void ZPassRenderer::RenderZPrepass(std::vector<RenderObjectPtr>& renderObjects,
                 }
             }
 
-            struct DrawData
+            if (!pso->IsReady())
             {
-                int positions;
-                int indices;
-                int perFrameBuffer;
-                int perInstanceBuffer;
-            };
+                m_stats.skippedDrawCount++;
+                continue;
+            }
 
-            DrawData drawData{};
+            ZPassDrawData drawData{};
             drawData.positions = rd->mesh->positions->BindSRV();
-            drawData.indices = rd->mesh->indexBuffer ? rd->mesh->indexBuffer->BindSRV() : 0;
+            drawData.meshInfo = rd->mesh->infoBuffer->BindSRV();
             drawData.perFrameBuffer = m_commonResources->perFrameBuffer->BindSRV();
             drawData.perInstanceBuffer = rd->perInstanceBuffer->BindSRV();
 
             cmdBuffer->PushConstants(&drawData, sizeof(drawData));
 
             cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->positions);
-            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->indexBuffer);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->infoBuffer);
             cmdBuffer->RegisterSRVUsageBuffer(m_commonResources->perFrameBuffer);
             cmdBuffer->RegisterSRVUsageBuffer(rd->perInstanceBuffer);
 
             cmdBuffer->BindPsoGraphics(pso);
 
+            if (isClusterDraw)
+            {
+                DrawClusters(rd, cmdBuffer, cullPhase == ZPassCullPhaseLate ? 1 : 0, 1);
+                continue;
+            }
+
+            cmdBuffer->BindIndexBuffer(rd->mesh->indexBuffer, rd->mesh->indexType);
+
+            const MeshLod& lod = rd->mesh->lods[rd->lod];
+
             m_stats.drawCallCount++;
-            cmdBuffer->Draw((uint32_t)rd->mesh->indexBuffer->GetSize() / sizeof(uint32_t));
+            cmdBuffer->DrawIndexed(lod.indexCount, 1, lod.indexOffset);
         }
         else
         {
@@ -90,17 +223,58 @@ void ZPassRenderer::RenderZPrepass(std::vector<RenderObjectPtr>& renderObjects,
                 }
             }
 
+            if (!pso->IsReady())
+            {
+                m_stats.skippedDrawCount++;
+                continue;
+            }
+
+            const MeshLod& lod = rd->mesh->lods[rd->lod];
+
+            ZPassDrawData drawData{};
+            drawData.positions = rd->mesh->positions->BindSRV();
+            drawData.meshInfo = rd->mesh->infoBuffer->BindSRV();
+            drawData.meshlets = rd->mesh->meshlets->BindSRV();
+            drawData.meshletOffset = lod.meshletOffset;
+            drawData.meshletCount = lod.meshletCount;
+            drawData.meshletIndices = rd->mesh->meshletTriangles->BindSRV();
+            drawData.meshletVertices = rd->mesh->meshletVertices->BindSRV();
+            drawData.perFrameBuffer = m_commonResources->perFrameBuffer->BindSRV();
+            drawData.perInstanceBuffer = rd->perInstanceBuffer->BindSRV();
+
+            if (rd->mesh->clusterLods)
+            {
+                drawData.meshletOffset = 0;
+                drawData.meshletCount = rd->mesh->clusterCount;
+                drawData.clusterLods = rd->mesh->clusterLods->BindSRV();
+
+                cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->clusterLods);
+            }
+
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->positions);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->infoBuffer);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshlets);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshletTriangles);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshletVertices);
+            cmdBuffer->RegisterSRVUsageBuffer(m_commonResources->perFrameBuffer);
+            cmdBuffer->RegisterSRVUsageBuffer(rd->perInstanceBuffer);
+
+            if (cullPhase != ZPassCullPhaseNone && rd->meshletVisibility)
+            {
+                drawData.meshletVisibility = rd->meshletVisibility->BindUAV();
+                drawData.cullPhase = cullPhase;
+            }
+
             cmdBuffer->BindPsoGraphics(pso);
 
+            cmdBuffer->PushConstants(&drawData, sizeof(drawData));
+
             m_stats.drawCallCount++;
-            cmdBuffer->DrawMeshTasks((rd->mesh->meshletsCount + 31) / 32, 1, 1);
+            m_stats.meshletTestedCount += drawData.meshletCount;
+            cmdBuffer->DrawMeshTasks((drawData.meshletCount + 31) / 32, 1, 1);
         }
     }
 
-    cmdBuffer->EndRenderPass();
-
-    cmdBuffer->EndZone();
-    cmdBuffer->MarkerEnd();
 }
 
 void ZPassRenderer::RenderZPass(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, bool isOpaque)
@@ -122,35 +296,27 @@ void ZPassRenderer::RenderZPass(std::vector<RenderObjectPtr>& renderObjects, Com
 
     for (RenderObjectPtr& rd : renderObjects)
     {
-        struct DrawData
-        {
-            int isUseBackFaceCull;
-            int indices;
-            int vertices;
-            int meshlets;
-            uint32_t meshletCount;
-            int meshletIndices;
-            int meshletVertices;
-            int materialProps;
-            int perFrameBuffer;
-            int perInstanceBuffer;
-        };
+        const MeshLod& lod = rd->mesh->lods[rd->lod];
 
-        DrawData drawData{};
-        drawData.isUseBackFaceCull = (int)!static_cast<bool>(rd->material->props.isDoubleSided);
-        drawData.indices = rd->mesh->indexBuffer ? rd->mesh->indexBuffer->BindSRV() : 0;
+        ZPassDrawData drawData{};
+        drawData.positions = rd->mesh->positions->BindSRV();
         drawData.vertices = rd->mesh->vertices->BindSRV();
-        drawData.meshlets = rd->mesh->meshlets->BindSRV();
-        drawData.meshletCount = rd->mesh->meshletsCount;
-        drawData.meshletIndices = rd->mesh->meshletTriangles->BindSRV();
-        drawData.meshletVertices = rd->mesh->meshletVertices->BindSRV();
+        drawData.meshInfo = rd->mesh->infoBuffer->BindSRV();
+        drawData.meshlets = rd->mesh->meshlets ? rd->mesh->meshlets->BindSRV() : 0;
+        drawData.meshletOffset = lod.meshletOffset;
+        drawData.meshletCount = lod.meshletCount;
+        drawData.meshletIndices = rd->mesh->meshletTriangles ? rd->mesh->meshletTriangles->BindSRV() : 0;
+        drawData.meshletVertices = rd->mesh->meshletVertices ? rd->mesh->meshletVertices->BindSRV() : 0;
         drawData.materialProps = rd->material->propsBuffer->BindSRV();
         drawData.perFrameBuffer = m_commonResources->perFrameBuffer->BindSRV();
         drawData.perInstanceBuffer = rd->perInstanceBuffer->BindSRV();
 
-        cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->indexBuffer);
+        cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->positions);
         cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->vertices);
+        cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->infoBuffer);
         cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshlets);
+        cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshletTriangles);
+        cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->meshletVertices);
         cmdBuffer->RegisterSRVUsageBuffer(rd->material->propsBuffer);
         cmdBuffer->RegisterSRVUsageBuffer(m_commonResources->perFrameBuffer);
         cmdBuffer->RegisterSRVUsageBuffer(rd->perInstanceBuffer);
@@ -162,7 +328,7 @@ void ZPassRenderer::RenderZPass(std::vector<RenderObjectPtr>& renderObjects, Com
         cmdBuffer->RegisterSRVUsageTexture(rd->material->specularTexture);
         cmdBuffer->RegisterSRVUsageTexture(rd->material->occlusionTexture);
 
-        if (!Input::IsKeyDown(Key::F))
+        if (!m_renderProps->isMeshShading)
         {
             const PSOGraphics* pso = rd->GetPSO(DrawCallType::ZPass);
             if (!pso)
@@ -175,12 +341,28 @@ void ZPassRenderer::RenderZPass(std::vector<RenderObjectPtr>& renderObjects, Com
                 }
             }
 
+            if (!pso->IsReady())
+            {
+                m_stats.skippedDrawCount++;
+                continue;
+            }
+
             cmdBuffer->BindPsoGraphics(pso);
 
             cmdBuffer->PushConstants(&drawData, sizeof(drawData));
 
+            // Both ranges, the second one holds what the late occlusion phase found visible this frame
+            if (IsClusterCulling() && rd->clusterDrawCount > 0)
+            {
+                DrawClusters(rd, cmdBuffer, 0, rd->clusterDrawCount);
+                continue;
+            }
+
+            cmdBuffer->BindIndexBuffer(rd->mesh->indexBuffer, rd->mesh->indexType);
+
             m_stats.drawCallCount++;
-            cmdBuffer->Draw((uint32_t)rd->mesh->indexBuffer->GetSize() / sizeof(uint32_t));
+            m_stats.lodTrianglesSavedCount += (rd->mesh->lods[0].indexCount - lod.indexCount) / 3;
+            cmdBuffer->DrawIndexed(lod.indexCount, 1, lod.indexOffset);
         }
         else
         {
@@ -195,10 +377,40 @@ void ZPassRenderer::RenderZPass(std::vector<RenderObjectPtr>& renderObjects, Com
                 }
             }
 
+            if (!pso->IsReady())
+            {
+                m_stats.skippedDrawCount++;
+                continue;
+            }
+
             cmdBuffer->BindPsoGraphics(pso);
 
+            // The task shader picks the cut through the cluster hierarchy itself, so the whole hierarchy is dispatched
+            if (rd->mesh->clusterLods)
+            {
+                drawData.meshletOffset = 0;
+                drawData.meshletCount = rd->mesh->clusterCount;
+                drawData.clusterLods = rd->mesh->clusterLods->BindSRV();
+
+                cmdBuffer->RegisterSRVUsageBuffer(rd->mesh->clusterLods);
+            }
+            else
+            {
+                m_stats.lodTrianglesSavedCount += (rd->mesh->lods[0].indexCount - lod.indexCount) / 3;
+            }
+
+            // Meshlets drawn by the prepass were marked visible, the others can only fail the depth test
+            if (IsOcclusionCulling() && IsDrawnInZPrepass(rd) && rd->meshletVisibility)
+            {
+                drawData.meshletVisibility = rd->meshletVisibility->BindSRV();
+                drawData.cullPhase = ZPassCullPhaseVisible;
+            }
+
+            cmdBuffer->PushConstants(&drawData, sizeof(drawData));
+
             m_stats.drawCallCount++;
-            cmdBuffer->DrawMeshTasks((rd->mesh->meshletsCount + 31) / 32, 1, 1);
+            m_stats.meshletTestedCount += drawData.meshletCount;
+            cmdBuffer->DrawMeshTasks((drawData.meshletCount + 31) / 32, 1, 1);
         }
     }
 
@@ -211,12 +423,314 @@ const RenderStats& ZPassRenderer::GetStats() const
     return m_stats;
 }
 
+bool ZPassRenderer::IsOcclusionCulling() const
+{
+    return m_renderProps->IsOcclusionCulling() && !m_commonResources->hiZTextures.empty();
+}
+
+bool ZPassRenderer::IsDrawnInZPrepass(const RenderObjectPtr& renderObject) const
+{
+    return renderObject->material->props.alphaMode == AlphaMode::Opaque;
+}
+
+// Meshlets start hidden, so the first frame draws them in the late phase
+void ZPassRenderer::CreateMeshletVisibility(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer)
+{
+    for (RenderObjectPtr& rd : renderObjects)
+    {
+        if (rd->meshletVisibility || !IsDrawnInZPrepass(rd) || rd->mesh->meshletsCount == 0)
+        {
+            continue;
+        }
+
+        std::vector<uint32_t> visibility(rd->mesh->meshletsCount, 0);
+
+        rd->meshletVisibility = Buffer::CreateStructured(visibility.size() * sizeof(uint32_t), true);
+        rd->meshletVisibility->SetName("MeshletVisibility");
+
+        cmdBuffer->CopyToBuffer(rd->meshletVisibility, visibility.data(), visibility.size() * sizeof(uint32_t));
+    }
+}
+
+void ZPassRenderer::RegisterMeshletVisibility(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, bool isWritable)
+{
+    for (RenderObjectPtr& rd : renderObjects)
+    {
+        if (isWritable)
+        {
+            cmdBuffer->RegisterUAVUsageBuffer(rd->meshletVisibility);
+        }
+        else
+        {
+            cmdBuffer->RegisterSRVUsageBuffer(rd->meshletVisibility);
+        }
+    }
+}
+
+// Each level keeps the farthest depth of the 2x2 texels below it, odd sizes clamp to the last row and column
+void ZPassRenderer::BuildHiZ(CommandBufferPtr& cmdBuffer)
+{
+    ProfileFunction();
+
+    cmdBuffer->MarkerBegin("HI_Z");
+    cmdBuffer->BeginZone("HI_Z");
+
+    struct DrawData
+    {
+        int source;
+        int destination;
+        uint32_t sourceWidth;
+        uint32_t sourceHeight;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    const PSOCompute* hiZPso = PSOCompute::Get(Shader::GetCompute("assets/shaders/HiZBuild.hlsl"));
+
+    const std::vector<TexturePtr>& hiZTextures = m_commonResources->hiZTextures;
+    for (size_t i = 0; i < hiZTextures.size(); i++)
+    {
+        const TexturePtr& src = i == 0 ? m_commonResources->depthTarget : hiZTextures[i - 1];
+        const TexturePtr& dst = hiZTextures[i];
+
+        cmdBuffer->RegisterSRVUsageTexture(src);
+        cmdBuffer->RegisterUAVUsageTexture(dst);
+
+        DrawData drawData{};
+        drawData.source = src->BindSRV();
+        drawData.destination = dst->BindUAV();
+        drawData.sourceWidth = src->GetWidth();
+        drawData.sourceHeight = src->GetHeight();
+        drawData.width = dst->GetWidth();
+        drawData.height = dst->GetHeight();
+
+        cmdBuffer->PushConstants(&drawData, sizeof(drawData));
+        cmdBuffer->BindPsoCompute(hiZPso);
+
+        m_stats.dispatchCount++;
+        cmdBuffer->Dispatch((drawData.width + 7) / 8, (drawData.height + 7) / 8, 1);
+    }
+
+    cmdBuffer->EndZone();
+    cmdBuffer->MarkerEnd();
+}
+
+bool ZPassRenderer::IsClusterCulling() const
+{
+    return !m_renderProps->isMeshShading && m_renderProps->isUseClusterCulling;
+}
+
+// Both index ranges fit the triangles of the finest level of detail, which bounds every level and every cut through the cluster
+// hierarchy since simplification never adds triangles. Meshes with 16-bit indices get 16-bit ranges, which are filled with pairs
+// of triangles, so a meshlet with an odd triangle count takes a degenerate one too. Triangles past the capacity are dropped.
+// The ranges and draw arguments of all the objects are sub-allocated from pools that restart empty every frame.
+void ZPassRenderer::ResetClusterDraws(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer)
+{
+    std::vector<uint32_t> capacities(renderObjects.size(), 0);
+    uint64_t indicesSize = 0;
+    uint32_t drawCount = 0;
+
+    for (size_t i = 0; i < renderObjects.size(); i++)
+    {
+        RenderObjectPtr& rd = renderObjects[i];
+        rd->clusterIndices = nullptr;
+        rd->clusterDrawArgs = nullptr;
+        rd->clusterDrawCount = 0;
+
+        const Mesh& mesh = *rd->mesh;
+        if (!mesh.meshlets || mesh.meshletsCount == 0)
+        {
+            continue;
+        }
+
+        const MeshLod& finestLod = mesh.lods[0];
+        if (mesh.indexType == IndexType::Uint16)
+        {
+            capacities[i] = (finestLod.indexCount + finestLod.meshletCount * 3 + 5) / 6 * 6;
+            indicesSize += (uint64_t)capacities[i] * 2 * sizeof(uint16_t);
+        }
+        else
+        {
+            capacities[i] = finestLod.indexCount;
+            indicesSize += (uint64_t)capacities[i] * 2 * sizeof(uint32_t);
+        }
+
+        drawCount++;
+    }
+
+    if (drawCount == 0)
+    {
+        return;
+    }
+
+    uint64_t drawArgsSize = (uint64_t)drawCount * CLUSTER_DRAW_ARGS_WORD_COUNT * sizeof(uint32_t);
+
+    ReservePool(m_clusterIndices, m_clusterIndicesUsedSize, indicesSize, [](int64_t size)
+    {
+        BufferPtr pool = Buffer::CreateIndex(size, true);
+        pool->SetName("ClusterIndices");
+        return pool;
+    });
+
+    ReservePool(m_clusterDrawArgs, m_clusterDrawArgsUsedSize, drawArgsSize, [](int64_t size)
+    {
+        BufferPtr pool = Buffer::CreateIndirect(size);
+        pool->SetName("ClusterDrawArgs");
+        return pool;
+    });
+
+    std::vector<uint32_t> drawArgs(drawCount * CLUSTER_DRAW_ARGS_WORD_COUNT, 0);
+    uint32_t* args = drawArgs.data();
+
+    for (size_t i = 0; i < renderObjects.size(); i++)
+    {
+        if (capacities[i] == 0)
+        {
+            continue;
+        }
+
+        RenderObjectPtr& rd = renderObjects[i];
+        rd->clusterIndexType = rd->mesh->indexType;
+        rd->clusterIndices = m_clusterIndices;
+        rd->clusterDrawArgs = m_clusterDrawArgs;
+        rd->clusterDrawArgsOffset = (uint32_t)(m_clusterDrawArgsUsedSize + (args - drawArgs.data()) * sizeof(uint32_t));
+
+        // Every allocation is a multiple of 4 bytes, so the first index is exact in either index size
+        uint32_t indexSize = rd->clusterIndexType == IndexType::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t firstIndex = (uint32_t)(m_clusterIndicesUsedSize / indexSize);
+
+        args[1] = 1;
+        args[CLUSTER_DRAW_ARGS_FIRST_INDEX] = firstIndex;
+        args[CLUSTER_DRAW_ARGS_STRIDE + 1] = 1;
+        args[CLUSTER_DRAW_ARGS_STRIDE + CLUSTER_DRAW_ARGS_FIRST_INDEX] = firstIndex + capacities[i];
+        args[CLUSTER_DRAW_ARGS_CAPACITY] = capacities[i];
+        args[CLUSTER_DRAW_ARGS_INDEX_SIZE] = indexSize;
+        args += CLUSTER_DRAW_ARGS_WORD_COUNT;
+
+        m_clusterIndicesUsedSize += (uint64_t)capacities[i] * 2 * indexSize;
+    }
+
+    cmdBuffer->CopyToBuffers({ { m_clusterDrawArgs, drawArgs.data(), drawArgsSize, m_clusterDrawArgsUsedSize } });
+
+    m_clusterDrawArgsUsedSize += drawArgsSize;
+}
+
+// A thread per meshlet of the drawn level of detail or of the whole cluster hierarchy, like the task shader
+void ZPassRenderer::DispatchClusterCull(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, ZPassCullPhase cullPhase)
+{
+    ProfileFunction();
+
+    cmdBuffer->MarkerBegin("CLUSTER_CULL");
+    cmdBuffer->BeginZone("CLUSTER_CULL");
+
+    ShaderDefines backFaceCullDefines;
+    backFaceCullDefines.Add("USE_BACK_FACE_CULL");
+
+    const PSOCompute* cullPso = PSOCompute::Get(Shader::GetCompute("assets/shaders/ClusterCull.hlsl"));
+    const PSOCompute* backFaceCullPso = PSOCompute::Get(Shader::GetCompute("assets/shaders/ClusterCull.hlsl", backFaceCullDefines));
+
+    // Objects write disjoint parts of the shared pools, so they are registered once rather than with a barrier per dispatch
+    BufferPtr registeredPool;
+    for (RenderObjectPtr& rd : renderObjects)
+    {
+        if (rd->clusterIndices && rd->clusterIndices != registeredPool)
+        {
+            cmdBuffer->RegisterUAVUsageBuffer(rd->clusterIndices);
+            cmdBuffer->RegisterUAVUsageBuffer(rd->clusterDrawArgs);
+            registeredPool = rd->clusterIndices;
+        }
+    }
+
+    for (RenderObjectPtr& rd : renderObjects)
+    {
+        if (!rd->clusterDrawArgs || (cullPhase == ZPassCullPhaseLate && !rd->meshletVisibility))
+        {
+            continue;
+        }
+
+        const PSOCompute* pso = rd->material->props.isDoubleSided ? cullPso : backFaceCullPso;
+        if (!pso)
+        {
+            continue;
+        }
+
+        const Mesh& mesh = *rd->mesh;
+        const MeshLod& lod = mesh.lods[rd->lod];
+
+        ZPassDrawData drawData{};
+        drawData.meshlets = mesh.meshlets->BindSRV();
+        drawData.meshletOffset = lod.meshletOffset;
+        drawData.meshletCount = lod.meshletCount;
+        drawData.meshletIndices = mesh.meshletTriangles->BindSRV();
+        drawData.meshletVertices = mesh.meshletVertices->BindSRV();
+        drawData.perFrameBuffer = m_commonResources->perFrameBuffer->BindSRV();
+        drawData.perInstanceBuffer = rd->perInstanceBuffer->BindSRV();
+        drawData.clusterIndices = rd->clusterIndices->BindUAV();
+        drawData.clusterDrawArgs = rd->clusterDrawArgs->BindUAV();
+        drawData.clusterDrawArgsOffset = rd->clusterDrawArgsOffset / sizeof(uint32_t);
+
+        if (mesh.clusterLods)
+        {
+            drawData.meshletOffset = 0;
+            drawData.meshletCount = mesh.clusterCount;
+            drawData.clusterLods = mesh.clusterLods->BindSRV();
+
+            cmdBuffer->RegisterSRVUsageBuffer(mesh.clusterLods);
+        }
+
+        if (cullPhase != ZPassCullPhaseNone && rd->meshletVisibility)
+        {
+            drawData.meshletVisibility = rd->meshletVisibility->BindUAV();
+            drawData.cullPhase = cullPhase;
+        }
+
+        cmdBuffer->RegisterSRVUsageBuffer(mesh.meshlets);
+        cmdBuffer->RegisterSRVUsageBuffer(mesh.meshletTriangles);
+        cmdBuffer->RegisterSRVUsageBuffer(mesh.meshletVertices);
+        cmdBuffer->RegisterSRVUsageBuffer(m_commonResources->perFrameBuffer);
+        cmdBuffer->RegisterSRVUsageBuffer(rd->perInstanceBuffer);
+
+        cmdBuffer->PushConstants(&drawData, sizeof(drawData));
+        cmdBuffer->BindPsoCompute(pso);
+
+        m_stats.dispatchCount++;
+        m_stats.meshletTestedCount += drawData.meshletCount;
+        cmdBuffer->Dispatch((drawData.meshletCount + 63) / 64, 1, 1);
+
+        rd->clusterDrawCount = drawData.cullPhase == ZPassCullPhaseLate ? 2 : 1;
+    }
+
+    // Render passes can't transition them
+    for (RenderObjectPtr& rd : renderObjects)
+    {
+        if (rd->clusterDrawCount > 0)
+        {
+            cmdBuffer->RegisterIndexUsageBuffer(rd->clusterIndices);
+            cmdBuffer->RegisterIndirectUsageBuffer(rd->clusterDrawArgs);
+        }
+    }
+
+    cmdBuffer->EndZone();
+    cmdBuffer->MarkerEnd();
+}
+
+void ZPassRenderer::DrawClusters(const RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer, uint32_t firstRange, uint32_t rangeCount)
+{
+    cmdBuffer->BindIndexBuffer(renderObject->clusterIndices, renderObject->clusterIndexType);
+
+    for (uint32_t i = firstRange; i < firstRange + rangeCount; i++)
+    {
+        m_stats.drawCallCount++;
+        cmdBuffer->DrawIndexedIndirect(renderObject->clusterDrawArgs, renderObject->clusterDrawArgsOffset + i * CLUSTER_DRAW_ARGS_STRIDE * sizeof(uint32_t));
+    }
+}
+
 const PSOGraphics* ZPassRenderer::CreateZPrePassDrawCallPSO(RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer)
 {
     MeshPtr& mesh = renderObject->mesh;
     MaterialPtr& material = renderObject->material;
 
-    Shader* shader = Shader::GetGraphics("assets/shaders/ZPrepass.hlsl");
+    Shader* shader = Shader::GetGraphicsDeferred("assets/shaders/ZPrepass.hlsl");
 
     PipelineGraphicsState state{};
     state.SetShader(shader);
@@ -225,7 +739,7 @@ const PSOGraphics* ZPassRenderer::CreateZPrePassDrawCallPSO(RenderObjectPtr& ren
 
     cmdBuffer->PropagateRenderingInfo(state);
 
-    const PSOGraphics* pso = PSOGraphics::Get(state);
+    const PSOGraphics* pso = PSOGraphics::GetAsync(state);
     if (!pso)
     {
         return nullptr;
@@ -244,7 +758,7 @@ const PSOGraphics* ZPassRenderer::CreateZPrePassMeshDrawCallPSO(RenderObjectPtr&
     ShaderDefines shaderDefines;
     shaderDefines.Add("USE_MESH_SHADING");
 
-    Shader* shader = Shader::GetGraphics("assets/shaders/ZPrepass.hlsl", shaderDefines, true);
+    Shader* shader = Shader::GetGraphicsDeferred("assets/shaders/ZPrepass.hlsl", shaderDefines, true);
 
     PipelineGraphicsState state{};
     state.SetShader(shader);
@@ -253,7 +767,7 @@ const PSOGraphics* ZPassRenderer::CreateZPrePassMeshDrawCallPSO(RenderObjectPtr&
 
     cmdBuffer->PropagateRenderingInfo(state);
 
-    const PSOGraphics* pso = PSOGraphics::Get(state);
+    const PSOGraphics* pso = PSOGraphics::GetAsync(state);
     if (!pso)
     {
         return nullptr;
@@ -283,7 +797,7 @@ const PSOGraphics* ZPassRenderer::CreateZPassDrawCallPSO(RenderObjectPtr& render
         shaderDefines.Add("USE_VERTEX_COLOR");
     }
 
-    Shader* shader = Shader::GetGraphics("assets/shaders/ZPass.hlsl", shaderDefines);
+    Shader* shader = Shader::GetGraphicsDeferred("assets/shaders/ZPass.hlsl", shaderDefines);
 
     PipelineGraphicsState state{};
     state.SetShader(shader);
@@ -311,9 +825,14 @@ const PSOGraphics* ZPassRenderer::CreateZPassDrawCallPSO(RenderObjectPtr& render
         state.GetBlendState().SetBlendingColor(0, BlendFactor::OneMinusSrcAlpha, BlendFactor::SrcAlpha, BlendOp::Add);
     }
 
+    PipelineSpecializationState& specializationState = state.GetSpecializationState();
+    specializationState.SetConstant(ZPassConstantBackFaceCull, !material->props.isDoubleSided);
+    specializationState.SetConstant(ZPassConstantAlphaMask, material->props.alphaMode == AlphaMode::Mask);
+    specializationState.SetConstant(ZPassConstantSpecularGlossiness, material->props.workflow == Workflow::SpecularGlossiness);
+
     cmdBuffer->PropagateRenderingInfo(state);
 
-    const PSOGraphics* pso = PSOGraphics::Get(state);
+    const PSOGraphics* pso = PSOGraphics::GetAsync(state);
     if (!pso)
     {
         return nullptr;
@@ -344,7 +863,7 @@ const PSOGraphics* ZPassRenderer::CreateZPassMeshDrawCallPSO(RenderObjectPtr& re
     }
     shaderDefines.Add("USE_MESH_SHADING");
 
-    Shader* shader = Shader::GetGraphics("assets/shaders/ZPass.hlsl", shaderDefines, true);
+    Shader* shader = Shader::GetGraphicsDeferred("assets/shaders/ZPass.hlsl", shaderDefines, true);
 
     PipelineGraphicsState state{};
     state.SetShader(shader);
@@ -372,9 +891,14 @@ const PSOGraphics* ZPassRenderer::CreateZPassMeshDrawCallPSO(RenderObjectPtr& re
         state.GetBlendState().SetBlendingColor(0, BlendFactor::OneMinusSrcAlpha, BlendFactor::SrcAlpha, BlendOp::Add);
     }
 
+    PipelineSpecializationState& specializationState = state.GetSpecializationState();
+    specializationState.SetConstant(ZPassConstantBackFaceCull, !material->props.isDoubleSided);
+    specializationState.SetConstant(ZPassConstantAlphaMask, material->props.alphaMode == AlphaMode::Mask);
+    specializationState.SetConstant(ZPassConstantSpecularGlossiness, material->props.workflow == Workflow::SpecularGlossiness);
+
     cmdBuffer->PropagateRenderingInfo(state);
 
-    const PSOGraphics* pso = PSOGraphics::Get(state);
+    const PSOGraphics* pso = PSOGraphics::GetAsync(state);
     if (!pso)
     {
         return nullptr;
@@ -5,6 +5,16 @@
 #include "RendererCommon.h"
 #include "RenderObject.h"
 
+// Must match the CULL_PHASE constants in ZPassCommon.hlsli
+enum ZPassCullPhase : uint32_t
+{
+    ZPassCullPhaseNone = 0,
+    // Meshlets marked visible are drawn
+    ZPassCullPhaseVisible = 1,
+    // Meshlets are tested against the Hi-Z pyramid and marked, the newly visible ones are drawn
+    ZPassCullPhaseLate = 2
+};
+
 class ZPassRenderer
 {
 public:
@@ -16,11 +26,26 @@ public:
     void NewFrame();
 
     void RenderZPrepass(std::vector<RenderObjectPtr>& inRenderObjects, CommandBufferPtr& cmdBuffer);
+    // Vertex path only, culls the meshlets of objects the prepass didn't draw into their compacted index buffers, outside of render passes
+    void CullClusters(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer);
     void RenderZPass(std::vector<RenderObjectPtr>& inRenderObjects, CommandBufferPtr& cmdBuffer, bool isOpaque);
 
     const RenderStats& GetStats() const;
 
 private:
+    void DrawZPrepass(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, ZPassCullPhase cullPhase);
+
+    bool IsOcclusionCulling() const;
+    bool IsDrawnInZPrepass(const RenderObjectPtr& renderObject) const;
+    void CreateMeshletVisibility(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer);
+    void RegisterMeshletVisibility(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, bool isWritable);
+    void BuildHiZ(CommandBufferPtr& cmdBuffer);
+
+    bool IsClusterCulling() const;
+    void ResetClusterDraws(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer);
+    void DispatchClusterCull(std::vector<RenderObjectPtr>& renderObjects, CommandBufferPtr& cmdBuffer, ZPassCullPhase cullPhase);
+    void DrawClusters(const RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer, uint32_t firstRange, uint32_t rangeCount);
+
     const PSOGraphics* CreateZPrePassDrawCallPSO(RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer);
     const PSOGraphics* CreateZPrePassMeshDrawCallPSO(RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer);
     const PSOGraphics* CreateZPassDrawCallPSO(RenderObjectPtr& renderObject, CommandBufferPtr& cmdBuffer);
@@ -31,4 +56,10 @@ private:
     const RendererProperties* m_renderProps = nullptr;
 
     RenderStats m_stats{};
+
+    // Cluster draws of every object culled this frame are sub-allocated from these, in bytes
+    BufferPtr m_clusterIndices;
+    BufferPtr m_clusterDrawArgs;
+    uint64_t m_clusterIndicesUsedSize = 0;
+    uint64_t m_clusterDrawArgsUsedSize = 0;
 };
\ No newline at end of file
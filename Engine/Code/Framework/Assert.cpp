@@ -4,12 +4,18 @@
 
 #if defined(ASSERT_ENABLE)
 
+#if defined(_MSC_VER)
+#define AssertBreak() __debugbreak()
+#else
+#define AssertBreak() __builtin_trap()
+#endif
+
 void Assert(bool expression, std::source_location src)
 {
     if (!expression)
     {
         LogError("{}.{}: Assertion failed", src.file_name(), src.line());
-        __debugbreak();
+        AssertBreak();
     }
 }
 
@@ -18,7 +24,7 @@ void Assert(bool expression, const char* message, std::source_location src)
     if (!expression)
     {
         LogError("{}.{}: Assertion failed", src.file_name(), src.line());
-        __debugbreak();
+        AssertBreak();
     }
 }
 
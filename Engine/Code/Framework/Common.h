@@ -3,7 +3,6 @@
 #include "Assert.h"
 #include "Log.h"
 #include "Profile.h"
-#include "String.h"
 
 #define NON_COPYABLE_MOVABLE(class)          \
     class(const class&) = delete;            \
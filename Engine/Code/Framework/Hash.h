@@ -1,6 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 inline uint64_t JenkinsHashBegin(const void* data, size_t len)
 {
@@ -43,4 +48,100 @@ inline uint32_t JenkinsHash(const void* data, size_t len)
     uint64_t hash = JenkinsHashBegin(data, len);
 
     return JenkinsHashEnd(hash);
-}
\ No newline at end of file
+}
+
+// 64-bit hash for the in-memory caches (wyhash). Consumes 8 bytes per step instead of one,
+// chain calls through the seed to hash several fields.
+
+inline void HashMultiply(uint64_t& a, uint64_t& b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#elif defined(_MSC_VER)
+    uint64_t low = a * b;
+    b = __umulh(a, b);
+    a = low;
+#else
+    __uint128_t result = (__uint128_t)a * b;
+    a = (uint64_t)result;
+    b = (uint64_t)(result >> 64);
+#endif
+}
+
+inline uint64_t HashMix(uint64_t a, uint64_t b)
+{
+    HashMultiply(a, b);
+    return a ^ b;
+}
+
+inline uint64_t HashRead8(const uint8_t* data)
+{
+    uint64_t value = 0;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashRead4(const uint8_t* data)
+{
+    uint32_t value = 0;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint64_t Hash64(const void* data, size_t len, uint64_t seed = 0)
+{
+    constexpr uint64_t secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+    const uint8_t* key = (const uint8_t*)data;
+    seed ^= HashMix(seed ^ secret[0], secret[1]);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (HashRead4(key) << 32) | HashRead4(key + ((len >> 3) << 2));
+            b = (HashRead4(key + len - 4) << 32) | HashRead4(key + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)key[0] << 16) | ((uint64_t)key[len >> 1] << 8) | key[len - 1];
+        }
+    }
+    else
+    {
+        size_t i = len;
+        if (i > 48)
+        {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed = HashMix(HashRead8(key) ^ secret[1], HashRead8(key + 8) ^ seed);
+                seed1 = HashMix(HashRead8(key + 16) ^ secret[2], HashRead8(key + 24) ^ seed1);
+                seed2 = HashMix(HashRead8(key + 32) ^ secret[3], HashRead8(key + 40) ^ seed2);
+                key += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (i > 16)
+        {
+            seed = HashMix(HashRead8(key) ^ secret[1], HashRead8(key + 8) ^ seed);
+            key += 16;
+            i -= 16;
+        }
+
+        a = HashRead8(key + i - 16);
+        b = HashRead8(key + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    HashMultiply(a, b);
+
+    return HashMix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
@@ -3,11 +3,19 @@
 #include <format>
 
 #include <spdlog/spdlog.h>
+#if defined(_WIN32)
 #include <spdlog/sinks/msvc_sink.h>
+#else
+#include <spdlog/sinks/stdout_sinks.h>
+#endif
 
 void InitializeLogger()
 {
+#if defined(_WIN32)
     auto sink = std::make_shared<spdlog::sinks::msvc_sink_mt>();
+#else
+    auto sink = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+#endif
     auto logger = std::make_shared<spdlog::logger>("Debug", sink);
     logger->set_level(spdlog::level::trace);
     logger->set_pattern("[%l] %v");
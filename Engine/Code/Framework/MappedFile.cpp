@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+
+#include <Framework/Common.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+MappedFile::~MappedFile()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+#else
+MappedFile::~MappedFile()
+{
+    if (m_data)
+    {
+        munmap((void*)m_data, m_size);
+        m_data = nullptr;
+    }
+
+    if (m_file != -1)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+}
+#endif
+
+const uint8_t* MappedFile::GetData() const
+{
+    return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return m_size;
+}
+
+MappedFilePtr MappedFile::Open(const std::filesystem::path& path)
+{
+    ProfileFunction();
+
+    MappedFilePtr file = std::make_unique<MappedFile>();
+
+#if defined(_WIN32)
+    file->m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file->m_file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file->m_file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return nullptr;
+    }
+
+    file->m_mapping = CreateFileMappingW(file->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file->m_mapping)
+    {
+        return nullptr;
+    }
+
+    file->m_data = (const uint8_t*)MapViewOfFile(file->m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!file->m_data)
+    {
+        return nullptr;
+    }
+
+    file->m_size = (size_t)fileSize.QuadPart;
+#else
+    file->m_file = open(path.c_str(), O_RDONLY);
+    if (file->m_file == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStat{};
+    if (fstat(file->m_file, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        return nullptr;
+    }
+
+    file->m_size = (size_t)fileStat.st_size;
+
+    void* data = mmap(nullptr, file->m_size, PROT_READ, MAP_PRIVATE, file->m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        file->m_size = 0;
+        return nullptr;
+    }
+
+    file->m_data = (const uint8_t*)data;
+#endif
+
+    return file;
+}
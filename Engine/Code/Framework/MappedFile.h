@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "Common.h"
+
+class MappedFile;
+using MappedFilePtr = std::unique_ptr<MappedFile>;
+
+class MappedFile
+{
+public:
+    NON_COPYABLE_MOVABLE(MappedFile);
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    const uint8_t* GetData() const;
+    size_t GetSize() const;
+
+    static MappedFilePtr Open(const std::filesystem::path& path);
+
+private:
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
@@ -46,6 +46,7 @@ void MeshComponent::Render(const glm::mat4& localTransform, const glm::mat4& par
 
     for (RenderObjectPtr& renderObject : renderObjects)
     {
+        renderObject->globalTransform = currentTransform;
         renderer->SubmitRenderObject(renderObject);
     }
 }
\ No newline at end of file
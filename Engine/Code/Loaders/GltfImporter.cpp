@@ -0,0 +1,606 @@
+#include "GltfImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <numeric>
+#include <thread>
+
+#include <cgltf.h>
+#include <mikktspace.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+#include <meshoptimizer.h>
+
+// Geometry behind these lives in compressed buffers cgltf doesn't decode
+static const std::string_view GLTF_UNSUPPORTED_EXTENSIONS[] = { "KHR_draco_mesh_compression", "EXT_meshopt_compression" };
+
+bool GltfImporter::Import(const std::filesystem::path& sourcePath, std::string_view sceneName, ImportedScene& outScene)
+{
+    ProfileFunction();
+
+    std::string asciiPath = sourcePath.string();
+
+    cgltf_options options{};
+    cgltf_data* data = nullptr;
+    cgltf_result result = cgltf_parse_file(&options, asciiPath.c_str(), &data);
+    if (result == cgltf_result_success)
+    {
+        result = cgltf_load_buffers(&options, data, asciiPath.c_str());
+    }
+    // Checks accessor and buffer view bounds and the node hierarchy, so the reads below stay within the file
+    if (result == cgltf_result_success)
+    {
+        result = cgltf_validate(data);
+    }
+
+    if (result != cgltf_result_success)
+    {
+        LogWarning("glTF scene \'{}\' can't be read natively, cgltf error {}", asciiPath, (int)result);
+        cgltf_free(data);
+        return false;
+    }
+
+    for (cgltf_size i = 0; i < data->extensions_required_count; i++)
+    {
+        if (std::find(std::begin(GLTF_UNSUPPORTED_EXTENSIONS), std::end(GLTF_UNSUPPORTED_EXTENSIONS), data->extensions_required[i]) != std::end(GLTF_UNSUPPORTED_EXTENSIONS))
+        {
+            LogWarning("glTF scene \'{}\' can't be read natively, it requires {}", asciiPath, data->extensions_required[i]);
+            cgltf_free(data);
+            return false;
+        }
+    }
+
+    outScene.materials.reserve(data->materials_count + 1);
+    for (cgltf_size i = 0; i < data->materials_count; i++)
+    {
+        outScene.materials.push_back(RetrieveMaterial(data->materials[i], sceneName));
+    }
+
+    // Every triangle primitive becomes a mesh of its own, named the way assimp names them
+    std::vector<std::vector<uint32_t>> meshPrimitives(data->meshes_count);
+    std::vector<const cgltf_primitive*> primitives;
+    uint32_t defaultMaterialIndex = UINT32_MAX;
+    for (cgltf_size i = 0; i < data->meshes_count; i++)
+    {
+        const cgltf_mesh& gltfMesh = data->meshes[i];
+        std::string meshName = gltfMesh.name ? gltfMesh.name : std::format("Mesh{}", i);
+
+        for (cgltf_size j = 0; j < gltfMesh.primitives_count; j++)
+        {
+            const cgltf_primitive& primitive = gltfMesh.primitives[j];
+
+            bool isTriangles = primitive.type == cgltf_primitive_type_triangles || primitive.type == cgltf_primitive_type_triangle_strip ||
+                primitive.type == cgltf_primitive_type_triangle_fan;
+            if (!isTriangles || !cgltf_find_accessor(&primitive, cgltf_attribute_type_position, 0))
+            {
+                Log("Skipped primitive {} of mesh \'{}\' in \'{}\', it has no triangles", j, meshName, asciiPath);
+                continue;
+            }
+
+            meshPrimitives[i].push_back((uint32_t)outScene.meshes.size());
+            primitives.push_back(&primitive);
+
+            ImportedMesh& mesh = outScene.meshes.emplace_back();
+            mesh.name = gltfMesh.primitives_count > 1 ? std::format("{}-{}", meshName, j) : meshName;
+
+            if (primitive.material)
+            {
+                mesh.materialIndex = (uint32_t)(primitive.material - data->materials);
+                continue;
+            }
+
+            if (defaultMaterialIndex == UINT32_MAX)
+            {
+                cgltf_material defaultMaterial{};
+                std::fill_n(defaultMaterial.pbr_metallic_roughness.base_color_factor, 4, 1.0f);
+                defaultMaterial.pbr_metallic_roughness.metallic_factor = 1.0f;
+                defaultMaterial.pbr_metallic_roughness.roughness_factor = 1.0f;
+                defaultMaterial.has_pbr_metallic_roughness = true;
+
+                defaultMaterialIndex = (uint32_t)outScene.materials.size();
+                outScene.materials.push_back(RetrieveMaterial(defaultMaterial, sceneName));
+                outScene.materials.back().name = std::format("{}.DefaultMaterial", sceneName);
+            }
+            mesh.materialIndex = defaultMaterialIndex;
+        }
+    }
+
+    // Primitives are independent and tangent generation dominates, so they're read on worker threads like the cooker's meshes
+    uint32_t primitiveCount = (uint32_t)primitives.size();
+    std::atomic<uint32_t> nextPrimitive = 0;
+    std::atomic<bool> isCorrupted = false;
+    auto retrievePrimitives = [&]()
+        {
+            for (uint32_t i = nextPrimitive++; i < primitiveCount; i = nextPrimitive++)
+            {
+                if (!RetrievePrimitive(*primitives[i], outScene.meshes[i]))
+                {
+                    isCorrupted = true;
+                }
+            }
+        };
+
+    uint32_t threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), primitiveCount);
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        workers.emplace_back(retrievePrimitives);
+    }
+
+    retrievePrimitives();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (isCorrupted)
+    {
+        LogWarning("glTF scene \'{}\' can't be read natively, it has invalid mesh data", asciiPath);
+        cgltf_free(data);
+        return false;
+    }
+
+    std::vector<bool> animatedNodes(data->nodes_count);
+    for (cgltf_size i = 0; i < data->animations_count; i++)
+    {
+        const cgltf_animation& animation = data->animations[i];
+        for (cgltf_size j = 0; j < animation.channels_count; j++)
+        {
+            if (animation.channels[j].target_node)
+            {
+                animatedNodes[animation.channels[j].target_node - data->nodes] = true;
+            }
+        }
+    }
+
+    // Scenes with several root nodes get a root of their own, as assimp does
+    std::vector<const cgltf_node*> rootNodes;
+    if (const cgltf_scene* scene = data->scene ? data->scene : (data->scenes_count ? &data->scenes[0] : nullptr))
+    {
+        rootNodes.assign(scene->nodes, scene->nodes + scene->nodes_count);
+    }
+    else
+    {
+        for (cgltf_size i = 0; i < data->nodes_count; i++)
+        {
+            if (!data->nodes[i].parent)
+            {
+                rootNodes.push_back(&data->nodes[i]);
+            }
+        }
+    }
+
+    if (rootNodes.size() == 1)
+    {
+        RetrieveNode(data, *rootNodes[0], meshPrimitives, animatedNodes, outScene);
+    }
+    else
+    {
+        outScene.nodes.emplace_back().name = "ROOT";
+
+        std::vector<uint32_t> children;
+        for (const cgltf_node* rootNode : rootNodes)
+        {
+            children.push_back(RetrieveNode(data, *rootNode, meshPrimitives, animatedNodes, outScene));
+        }
+        outScene.nodes[0].children = std::move(children);
+    }
+
+    cgltf_free(data);
+
+    return true;
+}
+
+// Embedded images have no path the renderer could load them from
+std::string GltfImporter::GetTexturePath(const cgltf_texture_view& textureView)
+{
+    if (!textureView.texture || !textureView.texture->image || !textureView.texture->image->uri)
+    {
+        return {};
+    }
+
+    std::string uri = textureView.texture->image->uri;
+    if (uri.starts_with("data:"))
+    {
+        return {};
+    }
+
+    cgltf_decode_uri(uri.data());
+    uri.resize(strlen(uri.c_str()));
+
+    return uri;
+}
+
+// Fills the same properties the cooker reads from assimp's glTF materials
+MeshCacheWriter::MaterialData GltfImporter::RetrieveMaterial(const cgltf_material& gltfMaterial, std::string_view sceneName)
+{
+    ProfileFunction();
+
+    MeshCacheWriter::MaterialData material{};
+    MeshCacheMaterial& props = material.props;
+
+    material.name = std::format("{}.{}", sceneName, gltfMaterial.name ? gltfMaterial.name : "");
+
+    switch (gltfMaterial.alpha_mode)
+    {
+    case cgltf_alpha_mode_mask:
+        props.alphaMode = (int32_t)AlphaMode::Mask;
+        props.alphaCutoff = gltfMaterial.alpha_cutoff;
+        break;
+    case cgltf_alpha_mode_blend:
+        props.alphaMode = (int32_t)AlphaMode::Blend;
+        props.alphaCutoff = 0.0f;
+        break;
+    default:
+        props.alphaMode = (int32_t)AlphaMode::Opaque;
+        props.alphaCutoff = 0.0f;
+        break;
+    }
+
+    props.isDoubleSided = gltfMaterial.double_sided;
+
+    if (gltfMaterial.normal_texture.texture)
+    {
+        props.normalScale = gltfMaterial.normal_texture.scale;
+    }
+
+    const cgltf_pbr_metallic_roughness& metallicRoughness = gltfMaterial.pbr_metallic_roughness;
+    const cgltf_pbr_specular_glossiness& specularGlossiness = gltfMaterial.pbr_specular_glossiness;
+
+    const float* albedo = gltfMaterial.has_pbr_specular_glossiness ? specularGlossiness.diffuse_factor : metallicRoughness.base_color_factor;
+    std::copy_n(albedo, 4, props.albedo);
+
+    std::copy_n(gltfMaterial.emissive_factor, 3, props.emissiveValue);
+    props.emissiveValue[3] = gltfMaterial.has_emissive_strength ? gltfMaterial.emissive_strength.emissive_strength : 1.0f;
+
+    material.textures[MeshCacheTextureNormals] = GetTexturePath(gltfMaterial.normal_texture);
+    material.textures[MeshCacheTextureEmissive] = GetTexturePath(gltfMaterial.emissive_texture);
+    material.textures[MeshCacheTextureOcclusion] = GetTexturePath(gltfMaterial.occlusion_texture);
+
+    props.aoMetRough[0] = 1.0f;
+    props.aoMetRough[1] = 1.0f;
+    props.aoMetRough[2] = 1.0f;
+    props.aoMetRough[3] = 0.0f;
+    props.specular[0] = 1.0f;
+    props.specular[1] = 1.0f;
+    props.specular[2] = 1.0f;
+    props.specular[3] = 1.0f;
+
+    if (gltfMaterial.has_pbr_specular_glossiness)
+    {
+        props.workflow = (int32_t)Workflow::SpecularGlossiness;
+
+        std::copy_n(specularGlossiness.specular_factor, 3, props.specular);
+        props.specular[3] = specularGlossiness.glossiness_factor;
+
+        material.textures[MeshCacheTextureAlbedo] = GetTexturePath(specularGlossiness.diffuse_texture);
+        material.textures[MeshCacheTextureSpecular] = GetTexturePath(specularGlossiness.specular_glossiness_texture);
+    }
+    else
+    {
+        props.workflow = (int32_t)Workflow::MetallicRoughness;
+
+        props.aoMetRough[1] = metallicRoughness.metallic_factor;
+        props.aoMetRough[2] = metallicRoughness.roughness_factor;
+        props.aoMetRough[3] = 1.0f;
+
+        material.textures[MeshCacheTextureAlbedo] = GetTexturePath(metallicRoughness.base_color_texture);
+        material.textures[MeshCacheTextureMetRough] = GetTexturePath(metallicRoughness.metallic_roughness_texture);
+    }
+
+    return material;
+}
+
+// Returns false when an accessor doesn't fit the attribute it's read as or an index is out of range
+bool GltfImporter::RetrievePrimitive(const cgltf_primitive& primitive, ImportedMesh& outMesh)
+{
+    ProfileFunction();
+
+    const cgltf_accessor* positions = cgltf_find_accessor(&primitive, cgltf_attribute_type_position, 0);
+    const cgltf_accessor* normals = cgltf_find_accessor(&primitive, cgltf_attribute_type_normal, 0);
+    const cgltf_accessor* tangents = cgltf_find_accessor(&primitive, cgltf_attribute_type_tangent, 0);
+    const cgltf_accessor* uvs = cgltf_find_accessor(&primitive, cgltf_attribute_type_texcoord, 0);
+    const cgltf_accessor* colors = cgltf_find_accessor(&primitive, cgltf_attribute_type_color, 0);
+
+    size_t vtxCount = positions->count;
+
+    // Converts normalized and sparse accessors on the way
+    auto unpack = [vtxCount](const cgltf_accessor* accessor, size_t componentCount, std::vector<float>& outValues)
+        {
+            outValues.resize(vtxCount * componentCount);
+
+            return accessor->count == vtxCount && cgltf_num_components(accessor->type) == componentCount &&
+                cgltf_accessor_unpack_floats(accessor, outValues.data(), outValues.size()) == outValues.size();
+        };
+
+    // Tangents of a mesh without normals are ignored, as the glTF specification requires
+    if (!unpack(positions, 3, outMesh.positions) ||
+        (normals && !unpack(normals, 3, outMesh.normals)) ||
+        (normals && tangents && !unpack(tangents, 4, outMesh.tangents)) ||
+        (uvs && !unpack(uvs, 2, outMesh.uvs)))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < outMesh.uvs.size(); i += 2)
+    {
+        outMesh.uvs[i + 1] = 1.0f - outMesh.uvs[i + 1];
+    }
+
+    if (colors)
+    {
+        size_t componentCount = cgltf_num_components(colors->type);
+
+        std::vector<float> values;
+        if ((componentCount != 3 && componentCount != 4) || !unpack(colors, componentCount, values))
+        {
+            return false;
+        }
+
+        auto toUnorm8 = [](float value)
+            {
+                return (uint32_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+            };
+
+        outMesh.colors.resize(vtxCount);
+        for (size_t i = 0; i < vtxCount; i++)
+        {
+            const float* color = &values[i * componentCount];
+            float alpha = componentCount == 4 ? color[3] : 1.0f;
+            outMesh.colors[i] = toUnorm8(color[0]) | (toUnorm8(color[1]) << 8) | (toUnorm8(color[2]) << 16) | (toUnorm8(alpha) << 24);
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    if (primitive.indices)
+    {
+        indices.resize(primitive.indices->count);
+        if (cgltf_accessor_unpack_indices(primitive.indices, indices.data(), sizeof(uint32_t), indices.size()) != indices.size())
+        {
+            return false;
+        }
+    }
+    else
+    {
+        indices.resize(vtxCount);
+        std::iota(indices.begin(), indices.end(), 0u);
+    }
+
+    if (std::any_of(indices.begin(), indices.end(), [vtxCount](uint32_t index) { return index >= vtxCount; }))
+    {
+        return false;
+    }
+
+    // Strips and fans keep the winding of their first triangle, see the glTF specification on topology types
+    size_t triangleCount = primitive.type == cgltf_primitive_type_triangles ? indices.size() / 3 : (indices.size() >= 3 ? indices.size() - 2 : 0);
+    if (primitive.type == cgltf_primitive_type_triangles)
+    {
+        indices.resize(triangleCount * 3);
+        outMesh.indices = std::move(indices);
+    }
+    else
+    {
+        outMesh.indices.reserve(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            if (primitive.type == cgltf_primitive_type_triangle_strip)
+            {
+                outMesh.indices.push_back(indices[i]);
+                outMesh.indices.push_back(indices[i + 1 + i % 2]);
+                outMesh.indices.push_back(indices[i + 2 - i % 2]);
+            }
+            else
+            {
+                outMesh.indices.push_back(indices[i + 1]);
+                outMesh.indices.push_back(indices[i + 2]);
+                outMesh.indices.push_back(indices[0]);
+            }
+        }
+    }
+
+    if (!normals)
+    {
+        GenerateNormals(outMesh);
+    }
+
+    if (outMesh.tangents.empty() && !outMesh.uvs.empty())
+    {
+        GenerateTangents(outMesh);
+    }
+
+    return true;
+}
+
+// Smooth area weighted normals over the shared vertices, like assimp's GenSmoothNormals gave glTF meshes without normals
+void GltfImporter::GenerateNormals(ImportedMesh& mesh)
+{
+    ProfileFunction();
+
+    size_t vtxCount = mesh.positions.size() / 3;
+
+    std::vector<glm::vec3> normals(vtxCount, glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        uint32_t triangle[3] = { mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] };
+
+        glm::vec3 p0 = glm::make_vec3(&mesh.positions[triangle[0] * 3]);
+        glm::vec3 p1 = glm::make_vec3(&mesh.positions[triangle[1] * 3]);
+        glm::vec3 p2 = glm::make_vec3(&mesh.positions[triangle[2] * 3]);
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+        for (uint32_t vtx : triangle)
+        {
+            normals[vtx] += normal;
+        }
+    }
+
+    mesh.normals.resize(vtxCount * 3);
+    for (size_t i = 0; i < vtxCount; i++)
+    {
+        float length = glm::length(normals[i]);
+        glm::vec3 normal = length > 0.0f ? normals[i] / length : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        mesh.normals[i * 3 + 0] = normal.x;
+        mesh.normals[i * 3 + 1] = normal.y;
+        mesh.normals[i * 3 + 2] = normal.z;
+    }
+}
+
+// mikktspace gives every face corner a tangent of its own, so the mesh is unwelded for it and welded back afterwards.
+// Corners only stay apart where their tangents differ, at UV seams and mirrored UVs. Runs on the flipped UVs the
+// shaders sample with, so the bitangent sign matches tangents shipped with glTF files.
+void GltfImporter::GenerateTangents(ImportedMesh& mesh)
+{
+    ProfileFunction();
+
+    size_t cornerCount = mesh.indices.size();
+    if (cornerCount == 0)
+    {
+        return;
+    }
+
+    ImportedMesh corners;
+    corners.positions.resize(cornerCount * 3);
+    corners.normals.resize(cornerCount * 3);
+    corners.tangents.resize(cornerCount * 4);
+    corners.uvs.resize(cornerCount * 2);
+    corners.colors.resize(mesh.colors.empty() ? 0 : cornerCount);
+
+    for (size_t i = 0; i < cornerCount; i++)
+    {
+        uint32_t vtx = mesh.indices[i];
+        memcpy(&corners.positions[i * 3], &mesh.positions[vtx * 3], 3 * sizeof(float));
+        memcpy(&corners.normals[i * 3], &mesh.normals[vtx * 3], 3 * sizeof(float));
+        memcpy(&corners.uvs[i * 2], &mesh.uvs[vtx * 2], 2 * sizeof(float));
+        if (!corners.colors.empty())
+        {
+            corners.colors[i] = mesh.colors[vtx];
+        }
+    }
+
+    SMikkTSpaceInterface callbacks{};
+    callbacks.m_getNumFaces = [](const SMikkTSpaceContext* context)
+        {
+            return (int)(((const ImportedMesh*)context->m_pUserData)->positions.size() / 9);
+        };
+    callbacks.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, const int)
+        {
+            return 3;
+        };
+    callbacks.m_getPosition = [](const SMikkTSpaceContext* context, float outPosition[], const int face, const int vertex)
+        {
+            memcpy(outPosition, &((const ImportedMesh*)context->m_pUserData)->positions[(face * 3 + vertex) * 3], 3 * sizeof(float));
+        };
+    callbacks.m_getNormal = [](const SMikkTSpaceContext* context, float outNormal[], const int face, const int vertex)
+        {
+            memcpy(outNormal, &((const ImportedMesh*)context->m_pUserData)->normals[(face * 3 + vertex) * 3], 3 * sizeof(float));
+        };
+    callbacks.m_getTexCoord = [](const SMikkTSpaceContext* context, float outUV[], const int face, const int vertex)
+        {
+            memcpy(outUV, &((const ImportedMesh*)context->m_pUserData)->uvs[(face * 3 + vertex) * 2], 2 * sizeof(float));
+        };
+    callbacks.m_setTSpaceBasic = [](const SMikkTSpaceContext* context, const float tangent[], const float sign, const int face, const int vertex)
+        {
+            float* outTangent = &((ImportedMesh*)context->m_pUserData)->tangents[(face * 3 + vertex) * 4];
+            memcpy(outTangent, tangent, 3 * sizeof(float));
+            outTangent[3] = sign;
+        };
+
+    SMikkTSpaceContext context{ &callbacks, &corners };
+    if (!genTangSpaceDefault(&context))
+    {
+        LogWarning("mikktspace failed to generate tangents of mesh \'{}\'", mesh.name);
+        return;
+    }
+
+    std::vector<meshopt_Stream> streams =
+    {
+        { corners.positions.data(), 3 * sizeof(float), 3 * sizeof(float) },
+        { corners.normals.data(), 3 * sizeof(float), 3 * sizeof(float) },
+        { corners.tangents.data(), 4 * sizeof(float), 4 * sizeof(float) },
+        { corners.uvs.data(), 2 * sizeof(float), 2 * sizeof(float) }
+    };
+    if (!corners.colors.empty())
+    {
+        streams.push_back({ corners.colors.data(), sizeof(uint32_t), sizeof(uint32_t) });
+    }
+
+    std::vector<uint32_t> remap(cornerCount);
+    size_t vtxCount = meshopt_generateVertexRemapMulti(remap.data(), nullptr, cornerCount, cornerCount, streams.data(), streams.size());
+
+    auto weld = [&](auto& stream, const auto& cornerStream, size_t componentCount)
+        {
+            stream.resize(vtxCount * componentCount);
+            meshopt_remapVertexBuffer(stream.data(), cornerStream.data(), cornerCount, componentCount * sizeof(stream[0]), remap.data());
+        };
+
+    weld(mesh.positions, corners.positions, 3);
+    weld(mesh.normals, corners.normals, 3);
+    weld(mesh.tangents, corners.tangents, 4);
+    weld(mesh.uvs, corners.uvs, 2);
+    if (!corners.colors.empty())
+    {
+        weld(mesh.colors, corners.colors, 1);
+    }
+
+    meshopt_remapIndexBuffer(mesh.indices.data(), nullptr, cornerCount, remap.data());
+}
+
+uint32_t GltfImporter::RetrieveNode(const cgltf_data* data, const cgltf_node& gltfNode, const std::vector<std::vector<uint32_t>>& meshPrimitives, const std::vector<bool>& animatedNodes, ImportedScene& outScene)
+{
+    size_t gltfNodeIndex = &gltfNode - data->nodes;
+
+    uint32_t nodeIndex = (uint32_t)outScene.nodes.size();
+    ImportedNode& node = outScene.nodes.emplace_back();
+    node.name = gltfNode.name ? gltfNode.name : std::format("Node{}", gltfNodeIndex);
+    node.isAnimated = animatedNodes[gltfNodeIndex];
+
+    cgltf_node_transform_local(&gltfNode, glm::value_ptr(node.transform));
+
+    if (gltfNode.has_matrix)
+    {
+        glm::quat orientation;
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        glm::decompose(node.transform, node.scale, orientation, node.translation, skew, perspective);
+        node.rotation = glm::eulerAngles(orientation);
+    }
+    else
+    {
+        if (gltfNode.has_translation)
+        {
+            node.translation = glm::make_vec3(gltfNode.translation);
+        }
+        if (gltfNode.has_rotation)
+        {
+            node.rotation = glm::eulerAngles(glm::quat(gltfNode.rotation[3], gltfNode.rotation[0], gltfNode.rotation[1], gltfNode.rotation[2]));
+        }
+        if (gltfNode.has_scale)
+        {
+            node.scale = glm::make_vec3(gltfNode.scale);
+        }
+    }
+
+    if (gltfNode.mesh)
+    {
+        node.meshes = meshPrimitives[gltfNode.mesh - data->meshes];
+    }
+
+    std::vector<uint32_t> children;
+    for (cgltf_size i = 0; i < gltfNode.children_count; i++)
+    {
+        children.push_back(RetrieveNode(data, *gltfNode.children[i], meshPrimitives, animatedNodes, outScene));
+    }
+    outScene.nodes[nodeIndex].children = std::move(children);
+
+    return nodeIndex;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ImportedScene.h"
+
+struct cgltf_data;
+struct cgltf_material;
+struct cgltf_node;
+struct cgltf_primitive;
+struct cgltf_texture_view;
+
+// Native glTF 2.0 and GLB reader built on cgltf, the mesh cooker's fast path past assimp's post-processing.
+// Accessors are unpacked straight into the imported streams, tangents shipped with a mesh are kept and mikktspace only
+// runs for meshes without them. Returns false for files it can't read, compressed geometry included, so the cooker
+// can fall back to assimp.
+class GltfImporter
+{
+public:
+    static bool Import(const std::filesystem::path& sourcePath, std::string_view sceneName, ImportedScene& outScene);
+
+private:
+    static std::string GetTexturePath(const cgltf_texture_view& textureView);
+    static MeshCacheWriter::MaterialData RetrieveMaterial(const cgltf_material& gltfMaterial, std::string_view sceneName);
+    static bool RetrievePrimitive(const cgltf_primitive& primitive, ImportedMesh& outMesh);
+    static void GenerateNormals(ImportedMesh& mesh);
+    static void GenerateTangents(ImportedMesh& mesh);
+    static uint32_t RetrieveNode(const cgltf_data* data, const cgltf_node& gltfNode, const std::vector<std::vector<uint32_t>>& meshPrimitives, const std::vector<bool>& animatedNodes, ImportedScene& outScene);
+};
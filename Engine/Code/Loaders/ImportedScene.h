@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MeshCache.h"
+
+// A scene as read from its source file, the input of the mesh cooker. glTF is read into it by GltfImporter, other formats
+// go through assimp. Streams are tightly packed per vertex, in the layouts VertexPacking quantizes from.
+struct ImportedMesh
+{
+    std::string name;
+    uint32_t materialIndex = 0;
+    // Float3
+    std::vector<float> positions;
+    // Float3, always present
+    std::vector<float> normals;
+    // Float3 tangent and the bitangent sign, empty when the mesh has no tangent space
+    std::vector<float> tangents;
+    // Float2 of the first UV set with V flipped, empty when the mesh has none
+    std::vector<float> uvs;
+    // 8-bit unorm RGBA of the first color set, empty when the mesh has none
+    std::vector<uint32_t> colors;
+    // Triangle list
+    std::vector<uint32_t> indices;
+};
+
+// Translation, rotation and scale are decomposed by the importer, rotation in Euler radians
+struct ImportedNode
+{
+    std::string name;
+    glm::mat4 transform = glm::mat4(1.0f);
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    std::vector<uint32_t> meshes;
+    std::vector<uint32_t> children;
+    // Targeted by an animation, so it's never merged into a static batch
+    bool isAnimated = false;
+};
+
+// The root node is the first one
+struct ImportedScene
+{
+    std::vector<MeshCacheWriter::MaterialData> materials;
+    std::vector<ImportedMesh> meshes;
+    std::vector<ImportedNode> nodes;
+};
@@ -0,0 +1,373 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "VertexCodec.h"
+
+const MeshCacheHeader& MeshCache::GetHeader() const
+{
+    return *m_header;
+}
+
+const MeshCacheMaterial& MeshCache::GetMaterial(uint32_t index) const
+{
+    Assert(index < m_header->materialCount);
+
+    return ((const MeshCacheMaterial*)(m_data + m_header->materialsOffset))[index];
+}
+
+const MeshCacheMesh& MeshCache::GetMesh(uint32_t index) const
+{
+    Assert(index < m_header->meshCount);
+
+    return ((const MeshCacheMesh*)(m_data + m_header->meshesOffset))[index];
+}
+
+const MeshCacheNode& MeshCache::GetNode(uint32_t index) const
+{
+    Assert(index < m_header->nodeCount);
+
+    return ((const MeshCacheNode*)(m_data + m_header->nodesOffset))[index];
+}
+
+uint32_t MeshCache::GetNodeMesh(uint32_t index) const
+{
+    Assert(index < m_header->nodeMeshCount);
+
+    return ((const uint32_t*)(m_data + m_header->nodeMeshesOffset))[index];
+}
+
+std::string_view MeshCache::GetString(const MeshCacheString& string) const
+{
+    return std::string_view((const char*)m_data + m_header->stringsOffset + string.offset, string.size);
+}
+
+const uint8_t* MeshCache::GetBlob(const MeshCacheBlob& blob) const
+{
+    return m_data + m_header->blobsOffset + blob.offset;
+}
+
+MeshCachePtr MeshCache::Load(const std::filesystem::path& path, uint64_t sourceHash, uint64_t settingsHash)
+{
+    ProfileFunction();
+
+    MappedFilePtr file = MappedFile::Open(path);
+    if (!file)
+    {
+        return nullptr;
+    }
+
+    MeshCachePtr cache = std::make_unique<MeshCache>();
+    cache->m_data = file->GetData();
+    cache->m_size = file->GetSize();
+    cache->m_file = std::move(file);
+
+    if (!cache->Validate())
+    {
+        LogError("Mesh cache {} is corrupted", path.string());
+        return nullptr;
+    }
+
+    if (cache->m_header->sourceHash != sourceHash || cache->m_header->settingsHash != settingsHash)
+    {
+        Log("Mesh cache {} is stale", path.string());
+        return nullptr;
+    }
+
+    return cache;
+}
+
+// Wraps data cooked in memory, used when the cache can't be written next to the source
+MeshCachePtr MeshCache::Create(std::vector<uint8_t> data)
+{
+    MeshCachePtr cache = std::make_unique<MeshCache>();
+    cache->m_memory = std::move(data);
+    cache->m_data = cache->m_memory.data();
+    cache->m_size = cache->m_memory.size();
+
+    if (!cache->Validate())
+    {
+        LogError("Cooked mesh data is corrupted");
+        return nullptr;
+    }
+
+    return cache;
+}
+
+bool MeshCache::Validate()
+{
+    if (m_size < sizeof(MeshCacheHeader))
+    {
+        return false;
+    }
+
+    const MeshCacheHeader* header = (const MeshCacheHeader*)m_data;
+    if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION)
+    {
+        return false;
+    }
+
+    auto isInRange = [this](uint64_t offset, uint64_t size)
+        {
+            return offset <= m_size && size <= m_size - offset;
+        };
+
+    if (!isInRange(header->materialsOffset, (uint64_t)header->materialCount * sizeof(MeshCacheMaterial)) ||
+        !isInRange(header->meshesOffset, (uint64_t)header->meshCount * sizeof(MeshCacheMesh)) ||
+        !isInRange(header->nodesOffset, (uint64_t)header->nodeCount * sizeof(MeshCacheNode)) ||
+        !isInRange(header->nodeMeshesOffset, (uint64_t)header->nodeMeshCount * sizeof(uint32_t)) ||
+        !isInRange(header->stringsOffset, header->blobsOffset - header->stringsOffset) ||
+        !isInRange(header->blobsOffset, header->blobsSize))
+    {
+        return false;
+    }
+
+    uint64_t stringsSize = header->blobsOffset - header->stringsOffset;
+    auto isStringValid = [stringsSize](const MeshCacheString& string)
+        {
+            return (uint64_t)string.offset + string.size <= stringsSize;
+        };
+    auto isBlobValid = [header](const MeshCacheBlob& blob)
+        {
+            return blob.offset <= header->blobsSize && blob.size <= header->blobsSize - blob.offset;
+        };
+
+    const MeshCacheMaterial* materials = (const MeshCacheMaterial*)(m_data + header->materialsOffset);
+    for (uint32_t i = 0; i < header->materialCount; i++)
+    {
+        if (!isStringValid(materials[i].name))
+        {
+            return false;
+        }
+
+        for (const MeshCacheString& texture : materials[i].textures)
+        {
+            if (!isStringValid(texture))
+            {
+                return false;
+            }
+        }
+    }
+
+    const MeshCacheMesh* meshes = (const MeshCacheMesh*)(m_data + header->meshesOffset);
+    for (uint32_t i = 0; i < header->meshCount; i++)
+    {
+        const MeshCacheMesh& mesh = meshes[i];
+        if (!isStringValid(mesh.name) || mesh.materialIndex >= header->materialCount ||
+            !isBlobValid(mesh.indices) || !isBlobValid(mesh.positions) || !isBlobValid(mesh.vertices) ||
+            !isBlobValid(mesh.meshlets) || !isBlobValid(mesh.meshletVertices) || !isBlobValid(mesh.meshletTriangles) ||
+            !isBlobValid(mesh.clusterLods) || !isBlobValid(mesh.positionBlocks) || !isBlobValid(mesh.vertexBlocks))
+        {
+            return false;
+        }
+
+        bool isPositionsEncoded = mesh.encodedStreams & MeshCacheStreamEncodedPositions;
+        bool isVerticesEncoded = mesh.encodedStreams & MeshCacheStreamEncodedVertices;
+        bool isIndicesEncoded = mesh.encodedStreams & MeshCacheStreamEncodedIndices;
+
+        // Encoded streams are checked by their decoders, only the block tables the GPU reads blindly are checked here
+        auto isBlockTableValid = [&mesh](const MeshCacheBlob& blocks, uint32_t vertexStride)
+            {
+                return vertexStride % 4 == 0 && vertexStride <= 256 &&
+                    blocks.size == (uint64_t)VertexCodec::GetBlockCount(mesh.vertexCount, vertexStride) * VertexCodec::GetBlockTableStride(vertexStride) * sizeof(uint32_t);
+            };
+
+        if ((isPositionsEncoded && !isBlockTableValid(mesh.positionBlocks, sizeof(uint16_t) * 4)) ||
+            (isVerticesEncoded && !isBlockTableValid(mesh.vertexBlocks, mesh.vertexStride)))
+        {
+            return false;
+        }
+
+        // Raw streams are copied into the vertex and index buffers as they are, so they must cover every vertex and index
+        if ((!isPositionsEncoded && mesh.positions.size < (uint64_t)mesh.vertexCount * sizeof(uint16_t) * 4) ||
+            (!isVerticesEncoded && mesh.vertices.size < (uint64_t)mesh.vertexCount * mesh.vertexStride))
+        {
+            return false;
+        }
+
+        if ((mesh.indexStride != sizeof(uint16_t) && mesh.indexStride != sizeof(uint32_t)) ||
+            (!isIndicesEncoded && mesh.indices.size < (uint64_t)mesh.indexCount * mesh.indexStride) || mesh.meshlets.size < (uint64_t)mesh.meshletCount * sizeof(Meshlet) ||
+            mesh.lodCount == 0 || mesh.lodCount > MESH_MAX_LOD_COUNT ||
+            mesh.clusterCount > mesh.meshletCount || mesh.clusterLods.size < (uint64_t)mesh.clusterCount * sizeof(ClusterLod))
+        {
+            return false;
+        }
+
+        for (uint32_t j = 0; j < mesh.lodCount; j++)
+        {
+            const MeshLod& lod = mesh.lods[j];
+            if ((uint64_t)lod.indexOffset + lod.indexCount > mesh.indexCount ||
+                (uint64_t)lod.meshletOffset + lod.meshletCount > mesh.meshletCount)
+            {
+                return false;
+            }
+        }
+    }
+
+    const MeshCacheNode* nodes = (const MeshCacheNode*)(m_data + header->nodesOffset);
+    for (uint32_t i = 0; i < header->nodeCount; i++)
+    {
+        if (!isStringValid(nodes[i].name) || (uint64_t)nodes[i].meshOffset + nodes[i].meshCount > header->nodeMeshCount)
+        {
+            return false;
+        }
+    }
+
+    const uint32_t* nodeMeshes = (const uint32_t*)(m_data + header->nodeMeshesOffset);
+    for (uint32_t i = 0; i < header->nodeMeshCount; i++)
+    {
+        if (nodeMeshes[i] >= header->meshCount)
+        {
+            return false;
+        }
+    }
+
+    m_header = header;
+
+    return true;
+}
+
+MeshCacheWriter::MeshCacheWriter(uint64_t sourceHash, uint64_t settingsHash)
+    : m_sourceHash(sourceHash), m_settingsHash(settingsHash) {}
+
+void MeshCacheWriter::AddMaterial(MaterialData material)
+{
+    m_materials.push_back(std::move(material));
+}
+
+void MeshCacheWriter::AddMesh(MeshData mesh)
+{
+    m_meshes.push_back(std::move(mesh));
+}
+
+void MeshCacheWriter::AddNode(NodeData node)
+{
+    m_nodes.push_back(std::move(node));
+}
+
+std::vector<uint8_t> MeshCacheWriter::Serialize() const
+{
+    ProfileFunction();
+
+    std::string strings;
+    auto addString = [&strings](std::string_view string, MeshCacheString& outString)
+        {
+            outString.offset = (uint32_t)strings.size();
+            outString.size = (uint32_t)string.size();
+            strings += string;
+        };
+
+    std::vector<uint8_t> blobs;
+    auto addBlob = [&blobs](const void* data, size_t size, MeshCacheBlob& outBlob)
+        {
+            outBlob.offset = blobs.size();
+            outBlob.size = size;
+            blobs.insert(blobs.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+            blobs.resize((blobs.size() + MESH_CACHE_BLOB_ALIGNMENT - 1) & ~(MESH_CACHE_BLOB_ALIGNMENT - 1));
+        };
+
+    std::vector<MeshCacheMaterial> materials;
+    materials.reserve(m_materials.size());
+    for (const MaterialData& material : m_materials)
+    {
+        MeshCacheMaterial& cacheMaterial = materials.emplace_back(material.props);
+        addString(material.name, cacheMaterial.name);
+        for (uint32_t i = 0; i < MeshCacheTextureCount; i++)
+        {
+            addString(material.textures[i], cacheMaterial.textures[i]);
+        }
+    }
+
+    std::vector<MeshCacheMesh> meshes;
+    meshes.reserve(m_meshes.size());
+    for (const MeshData& mesh : m_meshes)
+    {
+        MeshCacheMesh& cacheMesh = meshes.emplace_back(mesh.props);
+        addString(mesh.name, cacheMesh.name);
+        if (mesh.props.encodedStreams & MeshCacheStreamEncodedIndices)
+        {
+            addBlob(mesh.encodedIndices.data(), mesh.encodedIndices.size(), cacheMesh.indices);
+        }
+        else
+        {
+            addBlob(mesh.indices.data(), mesh.indices.size() * sizeof(mesh.indices[0]), cacheMesh.indices);
+        }
+        if (mesh.props.encodedStreams & MeshCacheStreamEncodedPositions)
+        {
+            addBlob(mesh.encodedPositions.data(), mesh.encodedPositions.size(), cacheMesh.positions);
+            addBlob(mesh.positionBlocks.data(), mesh.positionBlocks.size() * sizeof(mesh.positionBlocks[0]), cacheMesh.positionBlocks);
+        }
+        else
+        {
+            addBlob(mesh.positions.data(), mesh.positions.size() * sizeof(mesh.positions[0]), cacheMesh.positions);
+        }
+        if (mesh.props.encodedStreams & MeshCacheStreamEncodedVertices)
+        {
+            addBlob(mesh.encodedVertices.data(), mesh.encodedVertices.size(), cacheMesh.vertices);
+            addBlob(mesh.vertexBlocks.data(), mesh.vertexBlocks.size() * sizeof(mesh.vertexBlocks[0]), cacheMesh.vertexBlocks);
+        }
+        else
+        {
+            addBlob(mesh.vertices.data(), mesh.vertices.size(), cacheMesh.vertices);
+        }
+        addBlob(mesh.meshlets.data(), mesh.meshlets.size() * sizeof(mesh.meshlets[0]), cacheMesh.meshlets);
+        addBlob(mesh.meshletVertices.data(), mesh.meshletVertices.size() * sizeof(mesh.meshletVertices[0]), cacheMesh.meshletVertices);
+        addBlob(mesh.meshletTriangles.data(), mesh.meshletTriangles.size() * sizeof(mesh.meshletTriangles[0]), cacheMesh.meshletTriangles);
+        addBlob(mesh.clusterLods.data(), mesh.clusterLods.size() * sizeof(mesh.clusterLods[0]), cacheMesh.clusterLods);
+    }
+
+    std::vector<MeshCacheNode> nodes;
+    std::vector<uint32_t> nodeMeshes;
+    nodes.reserve(m_nodes.size());
+    for (const NodeData& node : m_nodes)
+    {
+        MeshCacheNode& cacheNode = nodes.emplace_back(node.props);
+        addString(node.name, cacheNode.name);
+        cacheNode.meshOffset = (uint32_t)nodeMeshes.size();
+        cacheNode.meshCount = (uint32_t)node.meshes.size();
+        nodeMeshes.insert(nodeMeshes.end(), node.meshes.begin(), node.meshes.end());
+    }
+
+    MeshCacheHeader header{};
+    header.sourceHash = m_sourceHash;
+    header.settingsHash = m_settingsHash;
+    header.materialCount = (uint32_t)materials.size();
+    header.meshCount = (uint32_t)meshes.size();
+    header.nodeCount = (uint32_t)nodes.size();
+    header.nodeMeshCount = (uint32_t)nodeMeshes.size();
+    header.materialsOffset = sizeof(MeshCacheHeader);
+    header.meshesOffset = header.materialsOffset + materials.size() * sizeof(MeshCacheMaterial);
+    header.nodesOffset = header.meshesOffset + meshes.size() * sizeof(MeshCacheMesh);
+    header.nodeMeshesOffset = header.nodesOffset + nodes.size() * sizeof(MeshCacheNode);
+    header.stringsOffset = header.nodeMeshesOffset + nodeMeshes.size() * sizeof(uint32_t);
+    header.blobsOffset = (header.stringsOffset + strings.size() + MESH_CACHE_BLOB_ALIGNMENT - 1) & ~(MESH_CACHE_BLOB_ALIGNMENT - 1);
+    header.blobsSize = blobs.size();
+
+    std::vector<uint8_t> data(header.blobsOffset + header.blobsSize);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + header.materialsOffset, materials.data(), materials.size() * sizeof(MeshCacheMaterial));
+    memcpy(data.data() + header.meshesOffset, meshes.data(), meshes.size() * sizeof(MeshCacheMesh));
+    memcpy(data.data() + header.nodesOffset, nodes.data(), nodes.size() * sizeof(MeshCacheNode));
+    memcpy(data.data() + header.nodeMeshesOffset, nodeMeshes.data(), nodeMeshes.size() * sizeof(uint32_t));
+    memcpy(data.data() + header.stringsOffset, strings.data(), strings.size());
+    memcpy(data.data() + header.blobsOffset, blobs.data(), blobs.size());
+
+    return data;
+}
+
+bool MeshCacheWriter::Write(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+{
+    ProfileFunction();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        LogError("Failed to open {} for writing", path.string());
+        return false;
+    }
+
+    file.write((const char*)data.data(), data.size());
+
+    return file.good();
+}
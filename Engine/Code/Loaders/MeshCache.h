@@ -0,0 +1,221 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Framework/Common.h>
+#include <Framework/MappedFile.h>
+
+#include <Engine/Rendering/MeshCommon.h>
+
+// Binary layout of a cooked scene, the final output of the mesh cooker:
+// header | materials | meshes | nodes | node meshes | strings | blobs
+// Blobs hold the per-mesh GPU data exactly as it's uploaded, so loading maps the file and copies straight from it.
+// Levels of detail share the vertices, their indices and meshlets are stored one after another in the same blobs.
+// The first clusterCount meshlets form the cluster hierarchy: the full detail meshlets followed by their simplified parents.
+// Nodes are stored in depth-first order, each followed by its children.
+// Positions, vertices and indices may be stored compressed with meshoptimizer's codecs instead, see MeshCacheStreamFlagBits.
+
+const inline static uint32_t MESH_CACHE_MAGIC = 0x4853454D; // "MESH"
+const inline static uint32_t MESH_CACHE_VERSION = 8;
+const inline static uint64_t MESH_CACHE_BLOB_ALIGNMENT = 16;
+
+enum MeshCacheTexture : uint32_t
+{
+    MeshCacheTextureAlbedo = 0,
+    MeshCacheTextureNormals,
+    MeshCacheTextureMetRough,
+    MeshCacheTextureEmissive,
+    MeshCacheTextureSpecular,
+    MeshCacheTextureOcclusion,
+    MeshCacheTextureCount
+};
+
+// Encoded vertex streams come with a block table so they're decoded on the GPU, see VertexCodec
+enum MeshCacheStreamFlagBits : uint32_t
+{
+    MeshCacheStreamNone = 0,
+    MeshCacheStreamEncodedPositions = 1,
+    MeshCacheStreamEncodedVertices = 2,
+    MeshCacheStreamEncodedIndices = 4
+};
+using MeshCacheStreamFlags = uint32_t;
+
+struct MeshCacheHeader
+{
+    uint32_t magic = MESH_CACHE_MAGIC;
+    uint32_t version = MESH_CACHE_VERSION;
+    uint64_t sourceHash = 0;
+    uint64_t settingsHash = 0;
+    uint32_t materialCount = 0;
+    uint32_t meshCount = 0;
+    uint32_t nodeCount = 0;
+    uint32_t nodeMeshCount = 0;
+    uint64_t materialsOffset = 0;
+    uint64_t meshesOffset = 0;
+    uint64_t nodesOffset = 0;
+    uint64_t nodeMeshesOffset = 0;
+    uint64_t stringsOffset = 0;
+    uint64_t blobsOffset = 0;
+    uint64_t blobsSize = 0;
+};
+
+struct MeshCacheString
+{
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
+struct MeshCacheBlob
+{
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+struct MeshCacheMaterial
+{
+    MeshCacheString name{};
+    float albedo[4]{};
+    float aoMetRough[4]{};
+    float emissiveValue[4]{};
+    float specular[4]{};
+    int32_t alphaMode = 0;
+    float alphaCutoff = 0.0f;
+    int32_t isDoubleSided = 0;
+    float normalScale = 1.0f;
+    int32_t workflow = 0;
+    MeshCacheString textures[MeshCacheTextureCount]{};
+};
+
+struct MeshCacheMesh
+{
+    MeshCacheString name{};
+    VertexComponentFlags components = VertexComponentNone;
+    uint32_t vertexCount = 0;
+    uint32_t vertexStride = 0;
+    uint32_t indexCount = 0;
+    // 2 when every vertex fits a 16-bit index, 4 otherwise
+    uint32_t indexStride = 0;
+    uint32_t meshletCount = 0;
+    uint32_t materialIndex = 0;
+    uint32_t lodCount = 0;
+    MeshLod lods[MESH_MAX_LOD_COUNT]{};
+    uint32_t clusterCount = 0;
+    MeshCacheStreamFlags encodedStreams = MeshCacheStreamNone;
+    float aabbMin[3]{};
+    float aabbMax[3]{};
+    float uvMin[2]{};
+    float uvMax[2]{};
+    MeshCacheBlob indices{};
+    MeshCacheBlob positions{};
+    MeshCacheBlob vertices{};
+    MeshCacheBlob meshlets{};
+    MeshCacheBlob meshletVertices{};
+    MeshCacheBlob meshletTriangles{};
+    MeshCacheBlob clusterLods{};
+    MeshCacheBlob positionBlocks{};
+    MeshCacheBlob vertexBlocks{};
+};
+
+struct MeshCacheNode
+{
+    MeshCacheString name{};
+    float translation[3]{};
+    float rotation[3]{};
+    float scale[3]{};
+    uint32_t meshOffset = 0;
+    uint32_t meshCount = 0;
+    uint32_t childCount = 0;
+};
+
+class MeshCache;
+using MeshCachePtr = std::unique_ptr<MeshCache>;
+
+class MeshCache
+{
+public:
+    NON_COPYABLE_MOVABLE(MeshCache);
+
+    MeshCache() = default;
+    ~MeshCache() = default;
+
+    const MeshCacheHeader& GetHeader() const;
+    const MeshCacheMaterial& GetMaterial(uint32_t index) const;
+    const MeshCacheMesh& GetMesh(uint32_t index) const;
+    const MeshCacheNode& GetNode(uint32_t index) const;
+    uint32_t GetNodeMesh(uint32_t index) const;
+
+    std::string_view GetString(const MeshCacheString& string) const;
+    const uint8_t* GetBlob(const MeshCacheBlob& blob) const;
+
+    // Returns null when the file is missing, corrupted or was cooked from a different source or with different settings
+    static MeshCachePtr Load(const std::filesystem::path& path, uint64_t sourceHash, uint64_t settingsHash);
+    static MeshCachePtr Create(std::vector<uint8_t> data);
+
+private:
+    bool Validate();
+
+private:
+    MappedFilePtr m_file;
+    std::vector<uint8_t> m_memory;
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    const MeshCacheHeader* m_header = nullptr;
+};
+
+class MeshCacheWriter
+{
+public:
+    struct MaterialData
+    {
+        MeshCacheMaterial props{};
+        std::string name;
+        std::string textures[MeshCacheTextureCount];
+    };
+
+    struct MeshData
+    {
+        MeshCacheMesh props{};
+        std::string name;
+        std::vector<uint8_t> indices;
+        std::vector<uint16_t> positions;
+        std::vector<uint8_t> vertices;
+        std::vector<Meshlet> meshlets;
+        std::vector<uint16_t> meshletVertices;
+        std::vector<uint8_t> meshletTriangles;
+        std::vector<ClusterLod> clusterLods;
+        // Written instead of the raw streams when props.encodedStreams says so
+        std::vector<uint8_t> encodedIndices;
+        std::vector<uint8_t> encodedPositions;
+        std::vector<uint8_t> encodedVertices;
+        std::vector<uint32_t> positionBlocks;
+        std::vector<uint32_t> vertexBlocks;
+    };
+
+    struct NodeData
+    {
+        MeshCacheNode props{};
+        std::string name;
+        std::vector<uint32_t> meshes;
+    };
+
+public:
+    MeshCacheWriter(uint64_t sourceHash, uint64_t settingsHash);
+
+    void AddMaterial(MaterialData material);
+    void AddMesh(MeshData mesh);
+    void AddNode(NodeData node);
+
+    std::vector<uint8_t> Serialize() const;
+    static bool Write(const std::filesystem::path& path, const std::vector<uint8_t>& data);
+
+private:
+    uint64_t m_sourceHash = 0;
+    uint64_t m_settingsHash = 0;
+    std::vector<MaterialData> m_materials;
+    std::vector<MeshData> m_meshes;
+    std::vector<NodeData> m_nodes;
+};
@@ -0,0 +1,1619 @@
+#include "MeshCooker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#include <assimp/cimport.h>
+#include <assimp/postprocess.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <meshoptimizer.h>
+
+#include <Framework/Hash.h>
+
+#include "GltfImporter.h"
+#include "VertexCodec.h"
+#include "VertexPacking.h"
+
+static const uint32_t MESH_COOK_IMPORT_FLAGS = aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_FlipUVs;
+// glTF is indexed, has normals and usually tangents, and the cooker does its own vertex and cache optimization,
+// so only the steps the cooker can't do without are kept. Tangent space is only calculated for meshes that lack it.
+static const uint32_t MESH_COOK_GLTF_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace | aiProcess_FlipUVs;
+static const float MESHLET_CONE_WEIGHT = 1.0f;
+static const float MESH_LOD_REDUCTION = 0.5f;
+static const float MESH_LOD_MIN_REDUCTION = 0.85f;
+static const uint32_t MESH_LOD_MIN_TRIANGLE_COUNT = 128;
+static const float MESH_LOD_TARGET_ERROR = 0.05f;
+static const float MESH_LOD_NORMAL_WEIGHT = 0.5f;
+static const uint32_t CLUSTER_GROUP_SIZE = 4;
+static const float CLUSTER_GROUP_REDUCTION = 0.5f;
+static const uint32_t CLUSTER_MAX_DEPTH = 16;
+static const bool MESH_STATIC_BATCHING = true;
+static const uint32_t MESH_BATCH_CELLS_PER_AXIS = 8;
+static const uint32_t MESH_BATCH_VERTEX_LIMIT = 65536;
+static const uint32_t MESH_BATCH_SOURCE_VERTEX_LIMIT = 8192;
+static const bool MESH_ENCODE_STREAMS = true;
+static const bool MESH_IMPORT_NATIVE_GLTF = true;
+
+std::filesystem::path MeshCooker::GetCachePath(const std::filesystem::path& sourcePath)
+{
+    std::filesystem::path cachePath = sourcePath;
+    cachePath.replace_extension(".meshcache");
+
+    return cachePath;
+}
+
+// glTF keeps geometry in external buffers, so the .bin files next to the scene are part of its source
+uint64_t MeshCooker::CalculateSourceHash(const std::filesystem::path& sourcePath)
+{
+    ProfileFunction();
+
+    MappedFilePtr file = MappedFile::Open(sourcePath);
+    if (!file)
+    {
+        return 0;
+    }
+
+    uint64_t hash = Hash64(file->GetData(), file->GetSize());
+
+    std::filesystem::path sceneFolder = sourcePath.has_parent_path() ? sourcePath.parent_path() : ".";
+
+    std::vector<std::filesystem::path> buffers;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(sceneFolder, error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".bin")
+        {
+            buffers.push_back(entry.path());
+        }
+    }
+    std::sort(buffers.begin(), buffers.end());
+
+    for (const std::filesystem::path& bufferPath : buffers)
+    {
+        if (MappedFilePtr buffer = MappedFile::Open(bufferPath))
+        {
+            hash = Hash64(buffer->GetData(), buffer->GetSize(), hash);
+        }
+    }
+
+    return hash;
+}
+
+uint64_t MeshCooker::GetSettingsHash()
+{
+    const uint32_t settings[] =
+    {
+        MESH_CACHE_VERSION, MESH_COOK_IMPORT_FLAGS, MESH_COOK_GLTF_IMPORT_FLAGS, MESHLET_VERTEX_COUNT_LIMIT, MESHLET_TRIANGLE_COUNT_LIMIT,
+        std::bit_cast<uint32_t>(MESHLET_CONE_WEIGHT), std::bit_cast<uint32_t>(MESH_LOD_REDUCTION), std::bit_cast<uint32_t>(MESH_LOD_MIN_REDUCTION), MESH_LOD_MIN_TRIANGLE_COUNT,
+        std::bit_cast<uint32_t>(MESH_LOD_TARGET_ERROR), std::bit_cast<uint32_t>(MESH_LOD_NORMAL_WEIGHT),
+        CLUSTER_GROUP_SIZE, std::bit_cast<uint32_t>(CLUSTER_GROUP_REDUCTION), CLUSTER_MAX_DEPTH,
+        MESH_STATIC_BATCHING, MESH_BATCH_CELLS_PER_AXIS, MESH_BATCH_VERTEX_LIMIT, MESH_BATCH_SOURCE_VERTEX_LIMIT,
+        MESH_ENCODE_STREAMS, MESH_IMPORT_NATIVE_GLTF
+    };
+
+    return Hash64(settings, sizeof(settings));
+}
+
+bool MeshCooker::IsGltf(const std::filesystem::path& sourcePath)
+{
+    std::filesystem::path extension = sourcePath.extension();
+
+    return extension == ".gltf" || extension == ".glb";
+}
+
+// Logs how long the import took, so the import paths can be compared on the same scene
+bool MeshCooker::ImportScene(const std::filesystem::path& sourcePath, std::string_view sceneName, ImportedScene& outScene)
+{
+    ProfileFunction();
+
+    if (MESH_IMPORT_NATIVE_GLTF && IsGltf(sourcePath))
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        bool isImported = GltfImporter::Import(sourcePath, sceneName, outScene);
+        std::chrono::duration<float, std::milli> importTime = std::chrono::steady_clock::now() - startTime;
+
+        if (isImported)
+        {
+            Log("Imported scene \'{}\' in {:.1f} ms with the native glTF importer", sourcePath.string(), importTime.count());
+            return true;
+        }
+
+        Log("Scene \'{}\' falls back to assimp", sourcePath.string());
+        outScene = {};
+    }
+
+    return ImportAssimpScene(sourcePath, IsGltf(sourcePath) ? MESH_COOK_GLTF_IMPORT_FLAGS : MESH_COOK_IMPORT_FLAGS, sceneName, outScene);
+}
+
+bool MeshCooker::ImportAssimpScene(const std::filesystem::path& sourcePath, uint32_t importFlags, std::string_view sceneName, ImportedScene& outScene)
+{
+    ProfileFunction();
+
+    std::string asciiPath = sourcePath.string();
+
+    auto startTime = std::chrono::steady_clock::now();
+    const aiScene* assetScene = aiImportFile(asciiPath.c_str(), importFlags);
+    if (!assetScene)
+    {
+        LogError("Scene \'{}\' loading failed: {}", asciiPath, aiGetErrorString());
+        return false;
+    }
+
+    for (uint32_t i = 0; i < assetScene->mNumMaterials; i++)
+    {
+        outScene.materials.push_back(RetrieveMaterial(assetScene->mMaterials[i], sceneName));
+    }
+
+    for (uint32_t i = 0; i < assetScene->mNumMeshes; i++)
+    {
+        const aiMesh* assetMesh = assetScene->mMeshes[i];
+
+        ImportedMesh& mesh = outScene.meshes.emplace_back();
+        mesh.name = assetMesh->mName.data;
+        mesh.materialIndex = assetMesh->mMaterialIndex;
+        mesh.positions = RetrievePositions(assetMesh);
+        mesh.normals = RetrieveNormals(assetMesh);
+        mesh.tangents = RetrieveTangentsBitangents(assetMesh);
+        mesh.uvs = RetrieveUV0(assetMesh);
+        mesh.colors = RetrieveColors(assetMesh);
+        mesh.indices = RetrieveIndices(assetMesh);
+    }
+
+    std::unordered_set<std::string> animatedNodes;
+    for (uint32_t i = 0; i < assetScene->mNumAnimations; i++)
+    {
+        const aiAnimation* animation = assetScene->mAnimations[i];
+        for (uint32_t j = 0; j < animation->mNumChannels; j++)
+        {
+            animatedNodes.insert(animation->mChannels[j]->mNodeName.C_Str());
+        }
+    }
+
+    if (assetScene->mRootNode)
+    {
+        RetrieveAssimpNode(assetScene->mRootNode, animatedNodes, outScene);
+    }
+
+    aiReleaseImport(assetScene);
+
+    std::chrono::duration<float, std::milli> importTime = std::chrono::steady_clock::now() - startTime;
+    Log("Imported scene \'{}\' in {:.1f} ms with assimp and {} post-processing", asciiPath, importTime.count(),
+        importFlags == MESH_COOK_GLTF_IMPORT_FLAGS ? "glTF" : "full");
+
+    return true;
+}
+
+uint32_t MeshCooker::RetrieveAssimpNode(const aiNode* assetNode, const std::unordered_set<std::string>& animatedNodes, ImportedScene& outScene)
+{
+    uint32_t nodeIndex = (uint32_t)outScene.nodes.size();
+    ImportedNode& node = outScene.nodes.emplace_back();
+
+    aiVector3D translation, scale, rotation;
+    assetNode->mTransformation.Decompose(scale, rotation, translation);
+
+    node.name = assetNode->mName.data;
+    // assimp matrices are row-major
+    node.transform = glm::transpose(glm::make_mat4(&assetNode->mTransformation.a1));
+    node.translation = glm::make_vec3(&translation.x);
+    node.rotation = glm::make_vec3(&rotation.x);
+    node.scale = glm::make_vec3(&scale.x);
+    node.meshes.assign(assetNode->mMeshes, assetNode->mMeshes + assetNode->mNumMeshes);
+    node.isAnimated = animatedNodes.contains(assetNode->mName.C_Str());
+
+    std::vector<uint32_t> children;
+    for (uint32_t i = 0; i < assetNode->mNumChildren; i++)
+    {
+        children.push_back(RetrieveAssimpNode(assetNode->mChildren[i], animatedNodes, outScene));
+    }
+    outScene.nodes[nodeIndex].children = std::move(children);
+
+    return nodeIndex;
+}
+
+// Both importers produce the cooker's input, so their times cover the same work. The mesh and vertex counts of both are
+// logged as well, they differ where the importers split primitives or weld vertices differently.
+void MeshCooker::BenchmarkImport(const std::filesystem::path& sourcePath)
+{
+    std::string sceneName = sourcePath.filename().replace_extension("").string();
+
+    if (!IsGltf(sourcePath))
+    {
+        ImportedScene scene;
+        ImportAssimpScene(sourcePath, MESH_COOK_IMPORT_FLAGS, sceneName, scene);
+        return;
+    }
+
+    auto getVertexCount = [](const ImportedScene& scene)
+        {
+            size_t vtxCount = 0;
+            for (const ImportedMesh& mesh : scene.meshes)
+            {
+                vtxCount += mesh.positions.size() / 3;
+            }
+
+            return vtxCount;
+        };
+
+    ImportedScene nativeScene;
+    auto startTime = std::chrono::steady_clock::now();
+    bool isNativeImported = GltfImporter::Import(sourcePath, sceneName, nativeScene);
+    std::chrono::duration<float, std::milli> nativeTime = std::chrono::steady_clock::now() - startTime;
+
+    ImportedScene assimpScene;
+    startTime = std::chrono::steady_clock::now();
+    bool isAssimpImported = ImportAssimpScene(sourcePath, MESH_COOK_GLTF_IMPORT_FLAGS, sceneName, assimpScene);
+    std::chrono::duration<float, std::milli> assimpTime = std::chrono::steady_clock::now() - startTime;
+
+    if (!isNativeImported || !isAssimpImported)
+    {
+        LogError("Scene \'{}\' failed to import with {}", sourcePath.string(), isNativeImported ? "assimp" : "the native glTF importer");
+        return;
+    }
+
+    LogInfo("Imported scene \'{}\': native {:.1f} ms, assimp {:.1f} ms ({:.1f}x), {} and {} meshes, {} and {} vertices",
+        sourcePath.string(), nativeTime.count(), assimpTime.count(), nativeTime.count() > 0.0f ? assimpTime.count() / nativeTime.count() : 0.0f,
+        nativeScene.meshes.size(), assimpScene.meshes.size(), getVertexCount(nativeScene), getVertexCount(assimpScene));
+}
+
+bool MeshCooker::Cook(const std::filesystem::path& sourcePath, uint64_t sourceHash, std::vector<uint8_t>& outData)
+{
+    ProfileFunction();
+
+    std::string sceneName = sourcePath.filename().replace_extension("").string();
+
+    ImportedScene scene;
+    if (!ImportScene(sourcePath, sceneName, scene))
+    {
+        return false;
+    }
+
+    MeshCacheWriter writer(sourceHash, GetSettingsHash());
+
+    for (MeshCacheWriter::MaterialData& material : scene.materials)
+    {
+        writer.AddMaterial(std::move(material));
+    }
+
+    SceneMeshes sceneMeshes = BatchStaticMeshes(scene);
+    if (sceneMeshes.batchedInstanceCount)
+    {
+        Log("Static batching of scene \'{}\': {} mesh instances merged into {} meshes",
+            sceneName, sceneMeshes.batchedInstanceCount, sceneMeshes.batchCount);
+    }
+
+    QuantizationError error{};
+    for (MeshCacheWriter::MeshData& mesh : RetrieveMeshes(sceneMeshes.meshes, sceneName, error))
+    {
+        writer.AddMesh(std::move(mesh));
+    }
+
+    Log("Quantized scene \'{}\': position error {:.6f} ({:.5f}% of bounds), normal error {:.3f} deg, tangent error {:.3f} deg, uv error {:.6f}, {:.1f} bytes per vertex, {} packing",
+        sceneName, error.position, error.relativePosition * 100.0f, error.normal, error.tangent, error.uv,
+        error.vertexCount ? (double)error.vertexBytes / error.vertexCount : 0.0, VertexPacking::GetKernelName(VertexPacking::GetKernel()));
+
+    Log("Meshlet data of scene \'{}\': {:.1f} KiB, {:.1f}% of the uncompressed size, {} meshlets with 32-bit vertex references",
+        sceneName, error.meshletBytes / 1024.0, error.uncompressedMeshletBytes ? 100.0 * error.meshletBytes / error.uncompressedMeshletBytes : 0.0,
+        error.wideMeshletCount);
+
+    if (MESH_ENCODE_STREAMS)
+    {
+        Log("Encoded geometry of scene '{}': {:.1f} KiB, {:.1f}% of the raw size",
+            sceneName, error.encodedBytes / 1024.0, error.rawBytes ? 100.0 * error.encodedBytes / error.rawBytes : 0.0);
+    }
+
+    if (!scene.nodes.empty())
+    {
+        RetrieveNodes(scene, 0, sceneMeshes, writer);
+    }
+
+    outData = writer.Serialize();
+
+    return true;
+}
+
+std::string MeshCooker::GetTexturePath(const aiMaterial* assetMaterial, aiTextureType textureType)
+{
+    uint32_t uvSet = 0;
+    aiString textureName;
+    aiReturn ret = assetMaterial->GetTexture(textureType, 0, &textureName, nullptr, &uvSet);
+
+    if (ret != aiReturn_SUCCESS)
+    {
+        return {};
+    }
+
+    return textureName.data;
+}
+
+MeshCacheWriter::MaterialData MeshCooker::RetrieveMaterial(const aiMaterial* assetMaterial, std::string_view sceneName)
+{
+    ProfileFunction();
+
+    MeshCacheWriter::MaterialData material{};
+    MeshCacheMaterial& props = material.props;
+
+    aiString materialName;
+    assetMaterial->Get(AI_MATKEY_NAME, materialName);
+
+    material.name = std::format("{}.{}", sceneName, materialName.data);
+
+    aiString alphaMode;
+    if (aiReturn_SUCCESS == assetMaterial->Get("$mat.gltf.alphaMode", 0, 0, alphaMode))
+    {
+        if (strcmp(alphaMode.data, "OPAQUE") == 0)
+        {
+            props.alphaMode = (int32_t)AlphaMode::Opaque;
+            props.alphaCutoff = 0.0f;
+        }
+        else if (strcmp(alphaMode.data, "BLEND") == 0)
+        {
+            props.alphaMode = (int32_t)AlphaMode::Blend;
+            props.alphaCutoff = 0.0f;
+        }
+        else if (strcmp(alphaMode.data, "MASK") == 0)
+        {
+            props.alphaMode = (int32_t)AlphaMode::Mask;
+            assetMaterial->Get("$mat.gltf.alphaCutoff", 0, 0, props.alphaCutoff);
+        }
+    }
+
+    uint8_t isDoubleSided = 0;
+    assetMaterial->Get(AI_MATKEY_TWOSIDED, isDoubleSided);
+    props.isDoubleSided = isDoubleSided;
+
+    assetMaterial->Get("$tex.scale", aiTextureType_NORMALS, 0, props.normalScale);
+
+    aiColor3D albedo;
+    assetMaterial->Get(AI_MATKEY_BASE_COLOR, albedo);
+    props.albedo[0] = albedo.r;
+    props.albedo[1] = albedo.g;
+    props.albedo[2] = albedo.b;
+    props.albedo[3] = 1.0f;
+    assetMaterial->Get(AI_MATKEY_OPACITY, props.albedo[3]);
+
+    aiColor3D emissive;
+    assetMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, emissive);
+    props.emissiveValue[0] = emissive.r;
+    props.emissiveValue[1] = emissive.g;
+    props.emissiveValue[2] = emissive.b;
+    props.emissiveValue[3] = 1.0f;
+    assetMaterial->Get(AI_MATKEY_EMISSIVE_INTENSITY, props.emissiveValue[3]);
+
+    material.textures[MeshCacheTextureNormals] = GetTexturePath(assetMaterial, aiTextureType_NORMALS);
+    material.textures[MeshCacheTextureEmissive] = GetTexturePath(assetMaterial, aiTextureType_EMISSIVE);
+    material.textures[MeshCacheTextureOcclusion] = GetTexturePath(assetMaterial, aiTextureType_LIGHTMAP);
+
+    props.aoMetRough[0] = 1.0f;
+    props.aoMetRough[1] = 1.0f;
+    props.aoMetRough[2] = 1.0f;
+    props.aoMetRough[3] = 0.0f;
+    props.specular[0] = 1.0f;
+    props.specular[1] = 1.0f;
+    props.specular[2] = 1.0f;
+    props.specular[3] = 1.0f;
+
+    float glossiness = 1.0f;
+    if (aiReturn_SUCCESS == assetMaterial->Get(AI_MATKEY_GLOSSINESS_FACTOR, glossiness))
+    {
+        props.workflow = (int32_t)Workflow::SpecularGlossiness;
+        props.specular[3] = glossiness;
+
+        aiColor4D specular;
+        if (aiReturn_SUCCESS == assetMaterial->Get(AI_MATKEY_COLOR_SPECULAR, specular))
+        {
+            props.specular[0] = specular.r;
+            props.specular[1] = specular.g;
+            props.specular[2] = specular.b;
+        }
+
+        material.textures[MeshCacheTextureAlbedo] = GetTexturePath(assetMaterial, aiTextureType_DIFFUSE);
+        material.textures[MeshCacheTextureSpecular] = GetTexturePath(assetMaterial, aiTextureType_SPECULAR);
+    }
+    else
+    {
+        props.workflow = (int32_t)Workflow::MetallicRoughness;
+
+        props.aoMetRough[3] = 1.0f;
+        assetMaterial->Get(AI_MATKEY_METALLIC_FACTOR, props.aoMetRough[1]);
+        assetMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, props.aoMetRough[2]);
+
+        material.textures[MeshCacheTextureAlbedo] = GetTexturePath(assetMaterial, aiTextureType_BASE_COLOR);
+        material.textures[MeshCacheTextureMetRough] = GetTexturePath(assetMaterial, aiTextureType_METALNESS);
+    }
+
+    return material;
+}
+
+std::vector<uint32_t> MeshCooker::RetrieveIndices(const aiMesh* assetMesh)
+{
+    uint32_t idxCount = assetMesh->mNumFaces;
+
+    std::vector<uint32_t> indices;
+    indices.reserve(idxCount);
+
+    const aiFace* facesPtr = assetMesh->mFaces;
+    for (uint32_t idx = 0; idx < idxCount; idx++)
+    {
+        // Points and lines left by SortByPType aren't drawn
+        if (facesPtr[idx].mNumIndices != 3)
+        {
+            continue;
+        }
+
+        indices.push_back(facesPtr[idx].mIndices[0]);
+        indices.push_back(facesPtr[idx].mIndices[1]);
+        indices.push_back(facesPtr[idx].mIndices[2]);
+    }
+
+    return indices;
+}
+
+std::vector<float> MeshCooker::RetrievePositions(const aiMesh* assetMesh)
+{
+    uint32_t vtxCount = assetMesh->mNumVertices;
+
+    std::vector<float> vertices;
+    vertices.reserve(vtxCount * 3);
+
+    const aiVector3D* vtxPtr = assetMesh->mVertices;
+    for (uint32_t vtxId = 0; vtxId < vtxCount; vtxId++)
+    {
+        aiVector3D vtx = vtxPtr[vtxId];
+        vertices.push_back(vtx.x);
+        vertices.push_back(vtx.y);
+        vertices.push_back(vtx.z);
+    }
+
+    return vertices;
+}
+
+std::vector<float> MeshCooker::RetrieveNormals(const aiMesh* assetMesh)
+{
+    uint32_t vtxCount = assetMesh->mNumVertices;
+
+    std::vector<float> normals;
+    normals.reserve(vtxCount * 3);
+
+    const aiVector3D* normalsPtr = assetMesh->mNormals;
+    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    {
+        aiVector3D normal = normalsPtr ? normalsPtr[vtx] : aiVector3D(0.0f, 0.0f, 1.0f);
+        normals.push_back(normal.x);
+        normals.push_back(normal.y);
+        normals.push_back(normal.z);
+    }
+
+    return normals;
+}
+
+// Tangent and the bitangent sign, the bitangent is reconstructed in the shaders
+std::vector<float> MeshCooker::RetrieveTangentsBitangents(const aiMesh* assetMesh)
+{
+    if (!assetMesh->mTangents || !assetMesh->mBitangents || !assetMesh->mNormals)
+    {
+        return {};
+    }
+
+    uint32_t vtxCount = assetMesh->mNumVertices;
+
+    std::vector<float> tangents;
+    tangents.reserve(vtxCount * 4);
+
+    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    {
+        glm::vec3 normal = glm::make_vec3(&assetMesh->mNormals[vtx].x);
+        glm::vec3 tangent = glm::make_vec3(&assetMesh->mTangents[vtx].x);
+        glm::vec3 bitangent = glm::make_vec3(&assetMesh->mBitangents[vtx].x);
+
+        tangents.push_back(tangent.x);
+        tangents.push_back(tangent.y);
+        tangents.push_back(tangent.z);
+        tangents.push_back(glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f);
+    }
+
+    return tangents;
+}
+
+std::vector<float> MeshCooker::RetrieveUV0(const aiMesh* assetMesh)
+{
+    if (!assetMesh->HasTextureCoords(0))
+    {
+        return {};
+    }
+
+    uint32_t vtxCount = assetMesh->mNumVertices;
+
+    std::vector<float> uvs;
+    uvs.reserve(vtxCount * 2);
+
+    const aiVector3D* uvsPtr = assetMesh->mTextureCoords[0];
+    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    {
+        uvs.push_back(uvsPtr[vtx].x);
+        uvs.push_back(uvsPtr[vtx].y);
+    }
+
+    return uvs;
+}
+
+// Colors are packed as 8-bit unorm RGBA
+std::vector<uint32_t> MeshCooker::RetrieveColors(const aiMesh* assetMesh)
+{
+    if (!assetMesh->HasVertexColors(0))
+    {
+        return {};
+    }
+
+    uint32_t vtxCount = assetMesh->mNumVertices;
+
+    std::vector<uint32_t> colors;
+    colors.reserve(vtxCount);
+
+    auto toUnorm8 = [](float value)
+        {
+            return (uint32_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+        };
+
+    const aiColor4D* colorPtr = assetMesh->mColors[0];
+    for (uint32_t colorId = 0; colorId < vtxCount; colorId++)
+    {
+        aiColor4D color = colorPtr[colorId];
+        colors.push_back(toUnorm8(color.r) | (toUnorm8(color.g) << 8) | (toUnorm8(color.b) << 16) | (toUnorm8(color.a) << 24));
+    }
+
+    return colors;
+}
+
+// Matches DecodeOctahedral in ZPassCommon.hlsli, used to measure the quantization error
+glm::vec3 MeshCooker::DecodeOctahedral(uint32_t encoded)
+{
+    glm::vec2 e(std::max((int16_t)(encoded & 0xffff) / 32767.0f, -1.0f), std::max((int16_t)(encoded >> 16) / 32767.0f, -1.0f));
+
+    glm::vec3 direction(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::clamp(-direction.z, 0.0f, 1.0f);
+    direction.x += direction.x >= 0.0f ? -t : t;
+    direction.y += direction.y >= 0.0f ? -t : t;
+
+    return glm::normalize(direction);
+}
+
+MeshCooker::MeshletData MeshCooker::BuildMeshlets(const std::vector<float>& positions, size_t vtxCount, const std::vector<uint32_t>& indices)
+{
+    const uint32_t vertexCountLimit = MESHLET_VERTEX_COUNT_LIMIT;
+    const uint32_t triangleCountLimit = MESHLET_TRIANGLE_COUNT_LIMIT;
+
+    MeshletData meshletData;
+
+    size_t meshletsCount = meshopt_buildMeshletsBound(indices.size(), vertexCountLimit, triangleCountLimit);
+
+    std::vector<meshopt_Meshlet> meshlets(meshletsCount);
+    std::vector<uint32_t> meshletVertices(meshletsCount * vertexCountLimit);
+    std::vector<uint8_t> meshletTriangles(meshletsCount * triangleCountLimit * 3);
+
+    meshletsCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
+        indices.data(), indices.size(), positions.data(), vtxCount, 12, vertexCountLimit, triangleCountLimit, MESHLET_CONE_WEIGHT);
+
+    meshletData.meshlets.reserve(meshletsCount);
+
+    for (size_t i = 0; i < meshletsCount; i++)
+    {
+        Meshlet meshlet{};
+        meshlet.vertexOffset = (uint32_t)meshletData.meshletVertices.size();
+        meshlet.vertexCount = meshlets[i].vertex_count;
+        meshlet.triangleOffset = (uint32_t)meshletData.meshletTriangles.size();
+        meshlet.triangleCount = meshlets[i].triangle_count;
+
+        uint32_t vertOffset = meshlets[i].vertex_offset;
+        for (size_t j = 0; j < meshlet.vertexCount; j++)
+        {
+            meshletData.meshletVertices.push_back(meshletVertices[vertOffset + j]);
+        }
+
+        uint32_t triOffset = meshlets[i].triangle_offset;
+        for (size_t j = 0; j < meshlet.triangleCount; j++)
+        {
+            uint32_t index =
+                 meshletTriangles[triOffset + j * 3] |
+                (meshletTriangles[triOffset + j * 3 + 1] << 8) |
+                (meshletTriangles[triOffset + j * 3 + 2] << 16);
+
+            meshletData.meshletTriangles.push_back(index);
+        }
+
+        meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshletVertices[meshlets[i].vertex_offset], &meshletTriangles[meshlets[i].triangle_offset],
+            meshlet.triangleCount, positions.data(), vtxCount, 12);
+
+        meshlet.center[0] = bounds.center[0];
+        meshlet.center[1] = bounds.center[1];
+        meshlet.center[2] = bounds.center[2];
+        meshlet.radius = bounds.radius;
+
+        meshlet.coneApex[0] = bounds.cone_apex[0];
+        meshlet.coneApex[1] = bounds.cone_apex[1];
+        meshlet.coneApex[2] = bounds.cone_apex[2];
+
+        meshlet.coneAxis[0] = bounds.cone_axis[0];
+        meshlet.coneAxis[1] = bounds.cone_axis[1];
+        meshlet.coneAxis[2] = bounds.cone_axis[2];
+
+        meshlet.cutoff = bounds.cone_cutoff;
+
+        meshletData.meshlets.push_back(meshlet);
+    }
+
+    return meshletData;
+}
+
+void MeshCooker::AppendMeshlets(MeshletData& meshletData, const MeshletData& other)
+{
+    for (Meshlet meshlet : other.meshlets)
+    {
+        meshlet.vertexOffset += (uint32_t)meshletData.meshletVertices.size();
+        meshlet.triangleOffset += (uint32_t)meshletData.meshletTriangles.size();
+        meshletData.meshlets.push_back(meshlet);
+    }
+    meshletData.meshletVertices.insert(meshletData.meshletVertices.end(), other.meshletVertices.begin(), other.meshletVertices.end());
+    meshletData.meshletTriangles.insert(meshletData.meshletTriangles.end(), other.meshletTriangles.begin(), other.meshletTriangles.end());
+}
+
+// Triangle list of a meshlet in mesh vertex indices
+std::vector<uint32_t> MeshCooker::GetMeshletIndices(const MeshletData& meshletData, const Meshlet& meshlet)
+{
+    std::vector<uint32_t> indices;
+    indices.reserve(meshlet.triangleCount * 3);
+
+    for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+    {
+        uint32_t triangle = meshletData.meshletTriangles[meshlet.triangleOffset + i];
+        indices.push_back(meshletData.meshletVertices[meshlet.vertexOffset + (triangle & 0xff)]);
+        indices.push_back(meshletData.meshletVertices[meshlet.vertexOffset + ((triangle >> 8) & 0xff)]);
+        indices.push_back(meshletData.meshletVertices[meshlet.vertexOffset + ((triangle >> 16) & 0xff)]);
+    }
+
+    return indices;
+}
+
+// Clusters are sorted along a Morton curve through their centers and split into runs, so every group is spatially compact
+std::vector<std::vector<uint32_t>> MeshCooker::GroupClusters(const std::vector<ClusterLod>& lods, const std::vector<uint32_t>& clusters)
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+    for (uint32_t cluster : clusters)
+    {
+        glm::vec3 center = glm::make_vec3(lods[cluster].center);
+        min = glm::min(min, center);
+        max = glm::max(max, center);
+    }
+
+    glm::vec3 extent = glm::max(max - min, glm::vec3(FLT_EPSILON));
+
+    auto spreadBits = [](uint32_t value)
+    {
+        value &= 0x3ff;
+        value = (value | (value << 16)) & 0x030000ff;
+        value = (value | (value << 8)) & 0x0300f00f;
+        value = (value | (value << 4)) & 0x030c30c3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> sortedClusters;
+    sortedClusters.reserve(clusters.size());
+    for (uint32_t cluster : clusters)
+    {
+        glm::vec3 cell = (glm::make_vec3(lods[cluster].center) - min) / extent * 1023.0f;
+        uint32_t code = spreadBits((uint32_t)cell.x) | (spreadBits((uint32_t)cell.y) << 1) | (spreadBits((uint32_t)cell.z) << 2);
+        sortedClusters.emplace_back(code, cluster);
+    }
+
+    std::sort(sortedClusters.begin(), sortedClusters.end());
+
+    std::vector<std::vector<uint32_t>> groups;
+    for (size_t i = 0; i < sortedClusters.size(); i += CLUSTER_GROUP_SIZE)
+    {
+        std::vector<uint32_t>& group = groups.emplace_back();
+        for (size_t j = i; j < std::min(i + CLUSTER_GROUP_SIZE, sortedClusters.size()); j++)
+        {
+            group.push_back(sortedClusters[j].second);
+        }
+    }
+
+    return groups;
+}
+
+static glm::vec4 MergeSpheres(const glm::vec4& a, const glm::vec4& b)
+{
+    glm::vec3 offset = glm::vec3(b) - glm::vec3(a);
+    float distance = glm::length(offset);
+
+    if (distance + b.w <= a.w)
+    {
+        return a;
+    }
+    if (distance + a.w <= b.w)
+    {
+        return b;
+    }
+
+    float radius = 0.5f * (distance + a.w + b.w);
+    glm::vec3 center = glm::vec3(a) + offset * ((radius - a.w) / distance);
+
+    return glm::vec4(center, radius);
+}
+
+// Builds the cluster hierarchy level by level: neighbouring clusters are grouped, every group is simplified with its border locked
+// so it still matches the adjacent groups, and the result is split into parent clusters shared by the whole group.
+// Parent bounds contain the bounds of their children and parent errors aren't smaller, so the drawn cut is always watertight.
+MeshCooker::ClusterHierarchy MeshCooker::BuildClusterHierarchy(const std::vector<float>& positions, const std::vector<float>& normals, size_t vtxCount, const MeshletData& leaves)
+{
+    ProfileFunction();
+
+    ClusterHierarchy hierarchy;
+
+    std::vector<std::vector<uint32_t>> clusterIndices;
+    std::vector<uint32_t> level;
+    for (const Meshlet& meshlet : leaves.meshlets)
+    {
+        ClusterLod& lod = hierarchy.lods.emplace_back();
+        std::copy_n(meshlet.center, 3, lod.center);
+        lod.radius = meshlet.radius;
+
+        level.push_back((uint32_t)clusterIndices.size());
+        clusterIndices.push_back(GetMeshletIndices(leaves, meshlet));
+    }
+
+    const float normalWeights[3] = { MESH_LOD_NORMAL_WEIGHT, MESH_LOD_NORMAL_WEIGHT, MESH_LOD_NORMAL_WEIGHT };
+
+    // Groups are simplified on their own vertices, simplifying against the whole vertex buffer would be quadratic for dense meshes
+    std::vector<uint32_t> localVertices(vtxCount, UINT32_MAX);
+
+    for (uint32_t depth = 0; depth < CLUSTER_MAX_DEPTH && level.size() > 1; depth++)
+    {
+        std::vector<uint32_t> nextLevel;
+        for (const std::vector<uint32_t>& group : GroupClusters(hierarchy.lods, level))
+        {
+            if (group.size() == 1)
+            {
+                nextLevel.push_back(group[0]);
+                continue;
+            }
+
+            std::vector<uint32_t> globalVertices;
+            std::vector<float> groupPositions;
+            std::vector<float> groupNormals;
+            std::vector<uint32_t> groupIndices;
+            for (uint32_t cluster : group)
+            {
+                for (uint32_t index : clusterIndices[cluster])
+                {
+                    if (localVertices[index] == UINT32_MAX)
+                    {
+                        localVertices[index] = (uint32_t)globalVertices.size();
+                        globalVertices.push_back(index);
+                        groupPositions.insert(groupPositions.end(), &positions[index * 3], &positions[index * 3] + 3);
+                        groupNormals.insert(groupNormals.end(), &normals[index * 3], &normals[index * 3] + 3);
+                    }
+
+                    groupIndices.push_back(localVertices[index]);
+                }
+            }
+
+            for (uint32_t index : globalVertices)
+            {
+                localVertices[index] = UINT32_MAX;
+            }
+
+            size_t targetIndexCount = (size_t)(groupIndices.size() / 3 * CLUSTER_GROUP_REDUCTION) * 3;
+
+            std::vector<uint32_t> simplifiedIndices(groupIndices.size());
+
+            float simplifyError = 0.0f;
+            size_t simplifiedIndexCount = meshopt_simplifyWithAttributes(simplifiedIndices.data(), groupIndices.data(), groupIndices.size(),
+                groupPositions.data(), globalVertices.size(), 3 * sizeof(float), groupNormals.data(), 3 * sizeof(float), normalWeights, 3, nullptr,
+                targetIndexCount, FLT_MAX, meshopt_SimplifyLockBorder, &simplifyError);
+
+            // The group can't be reduced without touching its border, its clusters stay roots
+            if (simplifiedIndexCount == 0 || simplifiedIndexCount > groupIndices.size() * MESH_LOD_MIN_REDUCTION)
+            {
+                continue;
+            }
+
+            simplifiedIndices.resize(simplifiedIndexCount);
+
+            glm::vec4 bounds = glm::vec4(glm::make_vec3(hierarchy.lods[group[0]].center), hierarchy.lods[group[0]].radius);
+            float error = 0.0f;
+            for (uint32_t cluster : group)
+            {
+                const ClusterLod& lod = hierarchy.lods[cluster];
+                bounds = MergeSpheres(bounds, glm::vec4(glm::make_vec3(lod.center), lod.radius));
+                error = std::max(error, lod.error);
+            }
+
+            // Simplification errors are relative to the group extents
+            error += simplifyError * meshopt_simplifyScale(groupPositions.data(), globalVertices.size(), 3 * sizeof(float));
+
+            for (uint32_t cluster : group)
+            {
+                ClusterLod& lod = hierarchy.lods[cluster];
+                std::copy_n(glm::value_ptr(bounds), 3, lod.parentCenter);
+                lod.parentRadius = bounds.w;
+                lod.parentError = error;
+            }
+
+            MeshletData parents = BuildMeshlets(groupPositions, globalVertices.size(), simplifiedIndices);
+            for (uint32_t& vertex : parents.meshletVertices)
+            {
+                vertex = globalVertices[vertex];
+            }
+
+            for (const Meshlet& meshlet : parents.meshlets)
+            {
+                ClusterLod& lod = hierarchy.lods.emplace_back();
+                std::copy_n(glm::value_ptr(bounds), 3, lod.center);
+                lod.radius = bounds.w;
+                lod.error = error;
+
+                nextLevel.push_back((uint32_t)clusterIndices.size());
+                clusterIndices.push_back(GetMeshletIndices(parents, meshlet));
+            }
+
+            AppendMeshlets(hierarchy.meshlets, parents);
+        }
+
+        if (nextLevel.size() >= level.size())
+        {
+            break;
+        }
+
+        level = std::move(nextLevel);
+    }
+
+    return hierarchy;
+}
+
+// Meshes with at most 65536 vertices, nearly all of them, get 16-bit indices for half the index fetch bandwidth
+void MeshCooker::EncodeIndices(const std::vector<uint32_t>& indices, size_t vtxCount, MeshCacheWriter::MeshData& mesh)
+{
+    if (vtxCount <= 65536)
+    {
+        std::vector<uint16_t> narrowIndices(indices.begin(), indices.end());
+        mesh.indices.resize(narrowIndices.size() * sizeof(uint16_t));
+        memcpy(mesh.indices.data(), narrowIndices.data(), mesh.indices.size());
+        mesh.props.indexStride = sizeof(uint16_t);
+    }
+    else
+    {
+        mesh.indices.resize(indices.size() * sizeof(uint32_t));
+        memcpy(mesh.indices.data(), indices.data(), mesh.indices.size());
+        mesh.props.indexStride = sizeof(uint32_t);
+    }
+}
+
+// Vertex streams are decoded on the GPU at upload and indices on the CPU at load, see MeshLoader.
+// A stream stays raw when encoding doesn't make it smaller or the encoded stream can't be decoded on the GPU.
+void MeshCooker::EncodeStreams(const std::vector<uint32_t>& indices, MeshCacheWriter::MeshData& mesh, QuantizationError& outError)
+{
+    size_t vtxCount = mesh.props.vertexCount;
+
+    size_t positionsSize = mesh.positions.size() * sizeof(uint16_t);
+    if (VertexCodec::Encode(mesh.positions.data(), vtxCount, sizeof(uint16_t) * 4, mesh.encodedPositions, mesh.positionBlocks) &&
+        mesh.encodedPositions.size() + mesh.positionBlocks.size() * sizeof(uint32_t) < positionsSize)
+    {
+        mesh.props.encodedStreams |= MeshCacheStreamEncodedPositions;
+        outError.encodedBytes += mesh.encodedPositions.size() + mesh.positionBlocks.size() * sizeof(uint32_t);
+    }
+    else
+    {
+        mesh.encodedPositions.clear();
+        mesh.positionBlocks.clear();
+        outError.encodedBytes += positionsSize;
+    }
+
+    if (VertexCodec::Encode(mesh.vertices.data(), vtxCount, mesh.props.vertexStride, mesh.encodedVertices, mesh.vertexBlocks) &&
+        mesh.encodedVertices.size() + mesh.vertexBlocks.size() * sizeof(uint32_t) < mesh.vertices.size())
+    {
+        mesh.props.encodedStreams |= MeshCacheStreamEncodedVertices;
+        outError.encodedBytes += mesh.encodedVertices.size() + mesh.vertexBlocks.size() * sizeof(uint32_t);
+    }
+    else
+    {
+        mesh.encodedVertices.clear();
+        mesh.vertexBlocks.clear();
+        outError.encodedBytes += mesh.vertices.size();
+    }
+
+    mesh.encodedIndices.resize(meshopt_encodeIndexBufferBound(indices.size(), vtxCount));
+    mesh.encodedIndices.resize(meshopt_encodeIndexBuffer(mesh.encodedIndices.data(), mesh.encodedIndices.size(), indices.data(), indices.size()));
+    if (!mesh.encodedIndices.empty() && mesh.encodedIndices.size() < mesh.indices.size())
+    {
+        mesh.props.encodedStreams |= MeshCacheStreamEncodedIndices;
+        outError.encodedBytes += mesh.encodedIndices.size();
+    }
+    else
+    {
+        mesh.encodedIndices.clear();
+        outError.encodedBytes += mesh.indices.size();
+    }
+
+    outError.rawBytes += positionsSize + mesh.vertices.size() + mesh.indices.size();
+}
+
+// Vertex references become 16-bit offsets from the smallest vertex of the meshlet, which covers almost every meshlet
+// since the vertex buffer is in first use order. Triangles drop the padding byte of their 32-bit words.
+void MeshCooker::EncodeMeshlets(const MeshletData& meshletData, MeshCacheWriter::MeshData& mesh, QuantizationError& outError)
+{
+    mesh.meshlets.reserve(meshletData.meshlets.size());
+    mesh.meshletVertices.reserve(meshletData.meshletVertices.size());
+    mesh.meshletTriangles.reserve(meshletData.meshletTriangles.size() * 3 + 3);
+
+    for (const Meshlet& source : meshletData.meshlets)
+    {
+        const uint32_t* vertices = &meshletData.meshletVertices[source.vertexOffset];
+        auto [vertexMin, vertexMax] = std::minmax_element(vertices, vertices + source.vertexCount);
+
+        Meshlet& meshlet = mesh.meshlets.emplace_back(source);
+        if (source.vertexCount && *vertexMax - *vertexMin > UINT16_MAX)
+        {
+            // 32-bit references are read as whole words, keep them aligned
+            if (mesh.meshletVertices.size() % 2)
+            {
+                mesh.meshletVertices.push_back(0);
+            }
+
+            meshlet.vertexBase = MESHLET_WIDE_VERTEX_BASE;
+            meshlet.vertexOffset = (uint32_t)mesh.meshletVertices.size();
+            for (uint32_t i = 0; i < source.vertexCount; i++)
+            {
+                mesh.meshletVertices.push_back((uint16_t)(vertices[i] & 0xffff));
+                mesh.meshletVertices.push_back((uint16_t)(vertices[i] >> 16));
+            }
+
+            outError.wideMeshletCount++;
+        }
+        else
+        {
+            meshlet.vertexBase = source.vertexCount ? *vertexMin : 0;
+            meshlet.vertexOffset = (uint32_t)mesh.meshletVertices.size();
+            for (uint32_t i = 0; i < source.vertexCount; i++)
+            {
+                mesh.meshletVertices.push_back((uint16_t)(vertices[i] - meshlet.vertexBase));
+            }
+        }
+
+        meshlet.triangleOffset = (uint32_t)mesh.meshletTriangles.size();
+        for (uint32_t i = 0; i < source.triangleCount; i++)
+        {
+            uint32_t triangle = meshletData.meshletTriangles[source.triangleOffset + i];
+            mesh.meshletTriangles.push_back((uint8_t)(triangle & 0xff));
+            mesh.meshletTriangles.push_back((uint8_t)((triangle >> 8) & 0xff));
+            mesh.meshletTriangles.push_back((uint8_t)((triangle >> 16) & 0xff));
+        }
+    }
+
+    // Shaders read both streams as whole words
+    mesh.meshletVertices.resize((mesh.meshletVertices.size() + 1) / 2 * 2);
+    mesh.meshletTriangles.resize((mesh.meshletTriangles.size() + 3) / 4 * 4);
+
+    outError.meshletBytes = mesh.meshletVertices.size() * sizeof(uint16_t) + mesh.meshletTriangles.size();
+    outError.uncompressedMeshletBytes = (meshletData.meshletVertices.size() + meshletData.meshletTriangles.size()) * sizeof(uint32_t);
+}
+
+// Each level is simplified from the previous one, so its error accumulates the errors of the levels before it.
+// The chain stops when a level can't be reduced enough without exceeding the target error.
+std::vector<MeshCooker::LodData> MeshCooker::BuildLods(const std::vector<float>& positions, const std::vector<float>& normals, size_t vtxCount, std::vector<uint32_t> indices)
+{
+    ProfileFunction();
+
+    std::vector<LodData> lods;
+    lods.push_back({ std::move(indices), 0.0f });
+
+    const float normalWeights[3] = { MESH_LOD_NORMAL_WEIGHT, MESH_LOD_NORMAL_WEIGHT, MESH_LOD_NORMAL_WEIGHT };
+
+    // Simplification errors are relative to the mesh extents
+    float errorScale = meshopt_simplifyScale(positions.data(), vtxCount, 3 * sizeof(float));
+
+    while (lods.size() < MESH_MAX_LOD_COUNT)
+    {
+        const LodData& source = lods.back();
+
+        size_t targetIndexCount = (size_t)(source.indices.size() / 3 * MESH_LOD_REDUCTION) * 3;
+        if (targetIndexCount < MESH_LOD_MIN_TRIANGLE_COUNT * 3)
+        {
+            break;
+        }
+
+        LodData lod{};
+        lod.indices.resize(source.indices.size());
+
+        float lodError = 0.0f;
+        size_t lodIndexCount = meshopt_simplifyWithAttributes(lod.indices.data(), source.indices.data(), source.indices.size(),
+            positions.data(), vtxCount, 3 * sizeof(float), normals.data(), 3 * sizeof(float), normalWeights, 3, nullptr,
+            targetIndexCount, MESH_LOD_TARGET_ERROR, 0, &lodError);
+
+        if (lodIndexCount == 0 || lodIndexCount > source.indices.size() * MESH_LOD_MIN_REDUCTION)
+        {
+            break;
+        }
+
+        lod.indices.resize(lodIndexCount);
+        meshopt_optimizeVertexCache(lod.indices.data(), lod.indices.data(), lodIndexCount, vtxCount);
+        lod.error = source.error + lodError * errorScale;
+
+        lods.push_back(std::move(lod));
+    }
+
+    return lods;
+}
+
+// Vertices are quantized and split in two streams. Positions are 4x16-bit: XYZ and the bitangent sign, shared by every pass.
+// Shading attributes take a 32-bit word each in this order: normal, tangent, UV, color.
+// Positions are 16-bit unorm within the mesh AABB, UVs 16-bit unorm within the mesh UV bounds,
+// normals and tangents octahedral 2x16-bit snorm, colors 8-bit unorm.
+MeshCacheWriter::MeshData MeshCooker::RetrieveMesh(ImportedMesh sourceMesh, std::string_view sceneName, QuantizationError& outError)
+{
+    ProfileFunction();
+
+    size_t srcVtxCount = sourceMesh.positions.size() / 3;
+    uint32_t idxCount = (uint32_t)sourceMesh.indices.size();
+
+    VertexComponentFlags components = VertexComponentNone;
+
+    std::vector<float> positions = std::move(sourceMesh.positions);
+    std::vector<float> normals = std::move(sourceMesh.normals);
+    std::vector<float> tangents = std::move(sourceMesh.tangents);
+    std::vector<float> uvs = std::move(sourceMesh.uvs);
+    std::vector<uint32_t> colors = std::move(sourceMesh.colors);
+
+    std::vector<uint32_t> indices(idxCount);
+    std::vector<uint32_t> remap(srcVtxCount);
+    size_t vtxCount = 0;
+    {
+        std::vector<uint32_t> rawIndices = std::move(sourceMesh.indices);
+        meshopt_optimizeVertexCache(rawIndices.data(), rawIndices.data(), idxCount, srcVtxCount);
+
+        vtxCount = meshopt_optimizeVertexFetchRemap(remap.data(), rawIndices.data(), idxCount, srcVtxCount);
+        meshopt_remapIndexBuffer(indices.data(), rawIndices.data(), idxCount, remap.data());
+    }
+
+    // Remapping reads every source vertex, unreferenced ones are dropped and the streams are trimmed after
+    meshopt_remapVertexBuffer(positions.data(), positions.data(), srcVtxCount, 3 * sizeof(positions[0]), remap.data());
+    positions.resize(vtxCount * 3);
+    meshopt_remapVertexBuffer(normals.data(), normals.data(), srcVtxCount, 3 * sizeof(normals[0]), remap.data());
+    if (!tangents.empty())
+    {
+        meshopt_remapVertexBuffer(tangents.data(), tangents.data(), srcVtxCount, 4 * sizeof(tangents[0]), remap.data());
+    }
+    if (!uvs.empty())
+    {
+        meshopt_remapVertexBuffer(uvs.data(), uvs.data(), srcVtxCount, 2 * sizeof(uvs[0]), remap.data());
+    }
+    if (!colors.empty())
+    {
+        meshopt_remapVertexBuffer(colors.data(), colors.data(), srcVtxCount, sizeof(colors[0]), remap.data());
+    }
+
+    glm::vec3 aabbMin = glm::vec3(FLT_MAX);
+    glm::vec3 aabbMax = glm::vec3(-FLT_MAX);
+    for (size_t i = 0; i < vtxCount; i++)
+    {
+        glm::vec3 position = glm::make_vec3(&positions[i * 3]);
+        aabbMin = glm::min(aabbMin, position);
+        aabbMax = glm::max(aabbMax, position);
+    }
+    if (vtxCount == 0)
+    {
+        aabbMin = aabbMax = glm::vec3(0.0f);
+    }
+
+    glm::vec2 uvMin = glm::vec2(0.0f);
+    glm::vec2 uvMax = glm::vec2(0.0f);
+    if (!uvs.empty() && vtxCount)
+    {
+        uvMin = glm::vec2(FLT_MAX);
+        uvMax = glm::vec2(-FLT_MAX);
+        for (size_t i = 0; i < vtxCount; i++)
+        {
+            glm::vec2 uv = glm::make_vec2(&uvs[i * 2]);
+            uvMin = glm::min(uvMin, uv);
+            uvMax = glm::max(uvMax, uv);
+        }
+    }
+
+    std::vector<LodData> lods = BuildLods(positions, normals, vtxCount, std::move(indices));
+
+    MeshCacheWriter::MeshData mesh{};
+    MeshletData meshletData;
+    std::vector<uint32_t> meshIndices;
+    for (size_t i = 0; i < lods.size(); i++)
+    {
+        MeshletData lodMeshletData = BuildMeshlets(positions, vtxCount, lods[i].indices);
+
+        MeshLod& lod = mesh.props.lods[i];
+        lod.indexOffset = (uint32_t)meshIndices.size();
+        lod.indexCount = (uint32_t)lods[i].indices.size();
+        lod.meshletOffset = (uint32_t)meshletData.meshlets.size();
+        lod.meshletCount = (uint32_t)lodMeshletData.meshlets.size();
+        lod.error = lods[i].error;
+
+        meshIndices.insert(meshIndices.end(), lods[i].indices.begin(), lods[i].indices.end());
+
+        AppendMeshlets(meshletData, lodMeshletData);
+
+        // The parents of the full detail meshlets go right after them, so the hierarchy is a single meshlet range
+        if (i == 0)
+        {
+            ClusterHierarchy hierarchy = BuildClusterHierarchy(positions, normals, vtxCount, lodMeshletData);
+            AppendMeshlets(meshletData, hierarchy.meshlets);
+
+            mesh.props.clusterCount = (uint32_t)hierarchy.lods.size();
+            mesh.clusterLods = std::move(hierarchy.lods);
+        }
+    }
+
+    glm::vec3 positionExtent = aabbMax - aabbMin;
+    glm::vec2 uvExtent = uvMax - uvMin;
+
+    // Bounds are built from the source positions, grow them by half a quantization step so culling stays conservative
+    float positionStepRadius = 0.5f * glm::length(positionExtent / 65535.0f);
+    for (Meshlet& meshlet : meshletData.meshlets)
+    {
+        meshlet.radius += positionStepRadius;
+    }
+
+    uint32_t vertexStride = sizeof(uint32_t);
+    if (!tangents.empty())
+    {
+        components |= VertexComponentTangentBitangents;
+        vertexStride += sizeof(uint32_t);
+    }
+    if (!uvs.empty())
+    {
+        components |= VertexComponentUvs;
+        vertexStride += sizeof(uint32_t);
+    }
+    if (!colors.empty())
+    {
+        components |= VertexComponentColors;
+        vertexStride += sizeof(uint32_t);
+    }
+
+    auto angleBetween = [](const glm::vec3& a, const glm::vec3& b)
+        {
+            return glm::degrees(std::acos(std::clamp(glm::dot(a, b), -1.0f, 1.0f)));
+        };
+
+    mesh.vertices.resize(vtxCount * vertexStride);
+    mesh.positions.resize(vtxCount * 4);
+
+    // Streams are quantized in bulk by the SIMD kernels, then the shading attributes are interleaved
+    std::vector<uint32_t> packedNormals(vtxCount);
+    std::vector<uint32_t> packedTangents(tangents.empty() ? 0 : vtxCount);
+    std::vector<uint32_t> packedUVs(uvs.empty() ? 0 : vtxCount);
+
+    VertexPacking::PackPositions(positions.data(), vtxCount, glm::value_ptr(aabbMin), glm::value_ptr(positionExtent), mesh.positions.data());
+    VertexPacking::PackDirections(normals.data(), 3, vtxCount, packedNormals.data());
+    if (!tangents.empty())
+    {
+        VertexPacking::PackDirections(tangents.data(), 4, vtxCount, packedTangents.data());
+    }
+    if (!uvs.empty())
+    {
+        VertexPacking::PackUnorm16x2(uvs.data(), vtxCount, glm::value_ptr(uvMin), glm::value_ptr(uvExtent), packedUVs.data());
+    }
+
+    QuantizationError error{};
+
+    for (size_t i = 0; i < vtxCount; i++)
+    {
+        uint32_t words[4]{};
+        uint32_t wordCount = 0;
+
+        uint16_t* quantizedPosition = &mesh.positions[i * 4];
+        quantizedPosition[3] = !tangents.empty() && tangents[i * 4 + 3] < 0.0f;
+
+        words[wordCount++] = packedNormals[i];
+        if (!tangents.empty())
+        {
+            words[wordCount++] = packedTangents[i];
+        }
+        if (!uvs.empty())
+        {
+            words[wordCount++] = packedUVs[i];
+        }
+        if (!colors.empty())
+        {
+            words[wordCount++] = colors[i];
+        }
+
+        memcpy(mesh.vertices.data() + i * vertexStride, words, vertexStride);
+
+        glm::vec3 position = glm::make_vec3(&positions[i * 3]);
+        glm::vec3 decodedPosition = aabbMin + glm::vec3(quantizedPosition[0], quantizedPosition[1], quantizedPosition[2]) / 65535.0f * positionExtent;
+        error.position = std::max(error.position, glm::length(decodedPosition - position));
+
+        glm::vec3 normal = glm::make_vec3(&normals[i * 3]);
+        if (glm::length(normal) > 0.0f)
+        {
+            error.normal = std::max(error.normal, angleBetween(glm::normalize(normal), DecodeOctahedral(packedNormals[i])));
+        }
+
+        if (!tangents.empty())
+        {
+            glm::vec3 tangent = glm::make_vec3(&tangents[i * 4]);
+            if (glm::length(tangent) > 0.0f)
+            {
+                error.tangent = std::max(error.tangent, angleBetween(glm::normalize(tangent), DecodeOctahedral(packedTangents[i])));
+            }
+        }
+        if (!uvs.empty())
+        {
+            glm::vec2 uv = glm::make_vec2(&uvs[i * 2]);
+            glm::vec2 decodedUV = uvMin + glm::vec2(packedUVs[i] & 0xffff, packedUVs[i] >> 16) / 65535.0f * uvExtent;
+            error.uv = std::max(error.uv, std::max(std::abs(decodedUV.x - uv.x), std::abs(decodedUV.y - uv.y)));
+        }
+    }
+
+    float aabbDiagonal = glm::length(positionExtent);
+    error.relativePosition = aabbDiagonal > 0.0f ? error.position / aabbDiagonal : 0.0f;
+    error.vertexCount = vtxCount;
+    error.vertexBytes = mesh.positions.size() * sizeof(uint16_t) + mesh.vertices.size();
+
+    mesh.name = std::format("{}.{}", sceneName, sourceMesh.name);
+    mesh.props.components = components;
+    mesh.props.vertexCount = (uint32_t)vtxCount;
+    mesh.props.vertexStride = vertexStride;
+    mesh.props.indexCount = (uint32_t)meshIndices.size();
+    mesh.props.meshletCount = (uint32_t)meshletData.meshlets.size();
+    mesh.props.lodCount = (uint32_t)lods.size();
+    mesh.props.materialIndex = sourceMesh.materialIndex;
+    memcpy(mesh.props.aabbMin, &aabbMin, sizeof(mesh.props.aabbMin));
+    memcpy(mesh.props.aabbMax, &aabbMax, sizeof(mesh.props.aabbMax));
+    memcpy(mesh.props.uvMin, &uvMin, sizeof(mesh.props.uvMin));
+    memcpy(mesh.props.uvMax, &uvMax, sizeof(mesh.props.uvMax));
+
+    EncodeIndices(meshIndices, vtxCount, mesh);
+    EncodeMeshlets(meshletData, mesh, error);
+    if (MESH_ENCODE_STREAMS)
+    {
+        EncodeStreams(meshIndices, mesh, error);
+    }
+    outError.Merge(error);
+
+    return mesh;
+}
+
+void MeshCooker::QuantizationError::Merge(const QuantizationError& other)
+{
+    position = std::max(position, other.position);
+    relativePosition = std::max(relativePosition, other.relativePosition);
+    normal = std::max(normal, other.normal);
+    tangent = std::max(tangent, other.tangent);
+    uv = std::max(uv, other.uv);
+    vertexCount += other.vertexCount;
+    vertexBytes += other.vertexBytes;
+    meshletBytes += other.meshletBytes;
+    uncompressedMeshletBytes += other.uncompressedMeshletBytes;
+    wideMeshletCount += other.wideMeshletCount;
+    encodedBytes += other.encodedBytes;
+    rawBytes += other.rawBytes;
+}
+
+// Meshes are independent, so worker threads take them one at a time. Each result goes to the slot of its
+// source mesh, which keeps the output identical to a sequential cook regardless of scheduling.
+std::vector<MeshCacheWriter::MeshData> MeshCooker::RetrieveMeshes(std::vector<ImportedMesh>& sourceMeshes, std::string_view sceneName, QuantizationError& outError)
+{
+    ProfileFunction();
+
+    uint32_t meshCount = (uint32_t)sourceMeshes.size();
+    std::vector<MeshCacheWriter::MeshData> meshes(meshCount);
+    std::vector<QuantizationError> errors(meshCount);
+
+    std::atomic<uint32_t> nextMesh = 0;
+    auto processMeshes = [&]()
+        {
+            for (uint32_t i = nextMesh++; i < meshCount; i = nextMesh++)
+            {
+                meshes[i] = RetrieveMesh(std::move(sourceMeshes[i]), sceneName, errors[i]);
+            }
+        };
+
+    uint32_t threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), meshCount);
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        workers.emplace_back(processMeshes);
+    }
+
+    processMeshes();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (const QuantizationError& error : errors)
+    {
+        outError.Merge(error);
+    }
+
+    return meshes;
+}
+
+void MeshCooker::CollectStaticInstances(const ImportedScene& scene, uint32_t nodeIndex, const glm::mat4& transform, std::vector<MeshInstance>& outInstances)
+{
+    const ImportedNode& node = scene.nodes[nodeIndex];
+    if (node.isAnimated)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < (uint32_t)node.meshes.size(); i++)
+    {
+        outInstances.push_back({ nodeIndex, i, node.meshes[i], transform });
+    }
+
+    for (uint32_t child : node.children)
+    {
+        CollectStaticInstances(scene, child, transform * scene.nodes[child].transform, outInstances);
+    }
+}
+
+// Bakes the instance transforms into one mesh. Mirroring transforms flip the winding back so front faces stay front faces.
+ImportedMesh MeshCooker::MergeInstances(const ImportedScene& scene, const std::vector<MeshInstance>& instances, uint32_t batchIndex)
+{
+    const ImportedMesh& firstMesh = scene.meshes[instances[0].meshIndex];
+
+    ImportedMesh batch;
+    batch.name = std::format("StaticBatch{}", batchIndex);
+    batch.materialIndex = firstMesh.materialIndex;
+
+    auto normalizeSafe = [](const glm::vec3& direction)
+        {
+            float length = glm::length(direction);
+            return length > 0.0f ? direction / length : direction;
+        };
+
+    for (const MeshInstance& instance : instances)
+    {
+        const ImportedMesh& sourceMesh = scene.meshes[instance.meshIndex];
+        uint32_t vtxOffset = (uint32_t)(batch.positions.size() / 3);
+        size_t srcVtxCount = sourceMesh.positions.size() / 3;
+
+        glm::mat3 directionTransform = glm::mat3(instance.transform);
+        glm::mat3 normalTransform = glm::transpose(glm::inverse(directionTransform));
+        bool isMirrored = glm::determinant(directionTransform) < 0.0f;
+
+        for (size_t i = 0; i < srcVtxCount; i++)
+        {
+            glm::vec3 position = glm::vec3(instance.transform * glm::vec4(glm::make_vec3(&sourceMesh.positions[i * 3]), 1.0f));
+            glm::vec3 normal = normalizeSafe(normalTransform * glm::make_vec3(&sourceMesh.normals[i * 3]));
+            batch.positions.insert(batch.positions.end(), { position.x, position.y, position.z });
+            batch.normals.insert(batch.normals.end(), { normal.x, normal.y, normal.z });
+
+            if (!firstMesh.tangents.empty())
+            {
+                // The bitangent is rebuilt from the normal and tangent, a mirror flips its side
+                glm::vec3 tangent = normalizeSafe(directionTransform * glm::make_vec3(&sourceMesh.tangents[i * 4]));
+                float sign = isMirrored ? -sourceMesh.tangents[i * 4 + 3] : sourceMesh.tangents[i * 4 + 3];
+                batch.tangents.insert(batch.tangents.end(), { tangent.x, tangent.y, tangent.z, sign });
+            }
+        }
+
+        batch.uvs.insert(batch.uvs.end(), sourceMesh.uvs.begin(), sourceMesh.uvs.end());
+        batch.colors.insert(batch.colors.end(), sourceMesh.colors.begin(), sourceMesh.colors.end());
+
+        for (size_t i = 0; i < sourceMesh.indices.size(); i += 3)
+        {
+            batch.indices.push_back(vtxOffset + sourceMesh.indices[i]);
+            batch.indices.push_back(vtxOffset + sourceMesh.indices[i + (isMirrored ? 2 : 1)]);
+            batch.indices.push_back(vtxOffset + sourceMesh.indices[i + (isMirrored ? 1 : 2)]);
+        }
+    }
+
+    return batch;
+}
+
+// Source meshes get a cache index on first use in node order, so meshes left without a node after batching aren't cooked
+void MeshCooker::AssignNodeMeshes(ImportedScene& scene, uint32_t nodeIndex, const std::vector<std::vector<bool>>& batchedSlots, std::vector<uint32_t>& meshRemap, SceneMeshes& outMeshes)
+{
+    const ImportedNode& node = scene.nodes[nodeIndex];
+    const std::vector<bool>& batched = batchedSlots[nodeIndex];
+
+    std::vector<uint32_t>& nodeMeshes = outMeshes.nodeMeshes[nodeIndex];
+    for (uint32_t i = 0; i < (uint32_t)node.meshes.size(); i++)
+    {
+        if (!batched.empty() && batched[i])
+        {
+            continue;
+        }
+
+        uint32_t meshIndex = node.meshes[i];
+        if (meshRemap[meshIndex] == UINT32_MAX)
+        {
+            meshRemap[meshIndex] = (uint32_t)outMeshes.meshes.size();
+            outMeshes.meshes.push_back(std::move(scene.meshes[meshIndex]));
+        }
+
+        nodeMeshes.push_back(meshRemap[meshIndex]);
+    }
+
+    for (uint32_t child : node.children)
+    {
+        AssignNodeMeshes(scene, child, batchedSlots, meshRemap, outMeshes);
+    }
+}
+
+// Imported scenes often consist of hundreds of small static nodes, each a draw of its own. Instances sharing a material and
+// vertex layout are merged per cell of a uniform grid over the scene, the cell keeps the merged bounds tight for culling.
+// Batches stay within 16-bit indices and go through the same meshlet and LOD processing as any other mesh.
+// Source meshes are moved out of the scene into the result.
+MeshCooker::SceneMeshes MeshCooker::BatchStaticMeshes(ImportedScene& scene)
+{
+    ProfileFunction();
+
+    SceneMeshes sceneMeshes;
+    if (scene.nodes.empty())
+    {
+        return sceneMeshes;
+    }
+
+    sceneMeshes.nodeMeshes.resize(scene.nodes.size());
+
+    std::vector<std::vector<bool>> batchedSlots(scene.nodes.size());
+    std::vector<ImportedMesh> batches;
+
+    if (MESH_STATIC_BATCHING)
+    {
+        // Transforms are relative to the root node, whose own transform is kept on its entity
+        std::vector<MeshInstance> instances;
+        CollectStaticInstances(scene, 0, glm::mat4(1.0f), instances);
+
+        std::erase_if(instances, [&scene](const MeshInstance& instance)
+            {
+                const ImportedMesh& sourceMesh = scene.meshes[instance.meshIndex];
+                return sourceMesh.indices.empty() || sourceMesh.positions.size() / 3 > MESH_BATCH_SOURCE_VERTEX_LIMIT;
+            });
+
+        std::vector<glm::vec3> meshCenters(scene.meshes.size());
+        for (size_t i = 0; i < scene.meshes.size(); i++)
+        {
+            const std::vector<float>& positions = scene.meshes[i].positions;
+
+            glm::vec3 min(FLT_MAX);
+            glm::vec3 max(-FLT_MAX);
+            for (size_t j = 0; j < positions.size(); j += 3)
+            {
+                glm::vec3 position = glm::make_vec3(&positions[j]);
+                min = glm::min(min, position);
+                max = glm::max(max, position);
+            }
+
+            meshCenters[i] = (min + max) * 0.5f;
+        }
+
+        // An affine transform keeps the center of a box at the center of its bounds, so instances are binned by it
+        std::vector<glm::vec3> centers(instances.size());
+        glm::vec3 sceneMin(FLT_MAX);
+        glm::vec3 sceneMax(-FLT_MAX);
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            centers[i] = glm::vec3(instances[i].transform * glm::vec4(meshCenters[instances[i].meshIndex], 1.0f));
+            sceneMin = glm::min(sceneMin, centers[i]);
+            sceneMax = glm::max(sceneMax, centers[i]);
+        }
+
+        glm::vec3 sceneExtent = sceneMax - sceneMin;
+        float cellSize = std::max(std::max(sceneExtent.x, sceneExtent.y), sceneExtent.z) / MESH_BATCH_CELLS_PER_AXIS;
+
+        // Ordered by material, vertex layout and cell, so the batches don't depend on hashing
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> groups;
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            const ImportedMesh& sourceMesh = scene.meshes[instances[i].meshIndex];
+
+            VertexComponentFlags components = VertexComponentNone;
+            components |= !sourceMesh.tangents.empty() ? VertexComponentTangentBitangents : VertexComponentNone;
+            components |= !sourceMesh.uvs.empty() ? VertexComponentUvs : VertexComponentNone;
+            components |= !sourceMesh.colors.empty() ? VertexComponentColors : VertexComponentNone;
+
+            uint32_t cell = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                uint32_t coord = cellSize > 0.0f ? (uint32_t)((centers[i][axis] - sceneMin[axis]) / cellSize) : 0;
+                cell = cell * MESH_BATCH_CELLS_PER_AXIS + std::min(coord, MESH_BATCH_CELLS_PER_AXIS - 1);
+            }
+
+            groups[{ sourceMesh.materialIndex, components, cell }].push_back((uint32_t)i);
+        }
+
+        for (const auto& [key, group] : groups)
+        {
+            std::vector<MeshInstance> batch;
+            uint32_t batchVtxCount = 0;
+
+            auto flushBatch = [&]()
+                {
+                    if (batch.size() > 1)
+                    {
+                        for (const MeshInstance& instance : batch)
+                        {
+                            std::vector<bool>& slots = batchedSlots[instance.node];
+                            slots.resize(scene.nodes[instance.node].meshes.size());
+                            slots[instance.slot] = true;
+                        }
+
+                        batches.push_back(MergeInstances(scene, batch, (uint32_t)batches.size()));
+                        sceneMeshes.batchedInstanceCount += (uint32_t)batch.size();
+                    }
+
+                    batch.clear();
+                    batchVtxCount = 0;
+                };
+
+            for (uint32_t instanceIndex : group)
+            {
+                const MeshInstance& instance = instances[instanceIndex];
+                uint32_t vtxCount = (uint32_t)(scene.meshes[instance.meshIndex].positions.size() / 3);
+
+                if (batchVtxCount + vtxCount > MESH_BATCH_VERTEX_LIMIT)
+                {
+                    flushBatch();
+                }
+
+                batch.push_back(instance);
+                batchVtxCount += vtxCount;
+            }
+
+            flushBatch();
+        }
+    }
+
+    std::vector<uint32_t> meshRemap(scene.meshes.size(), UINT32_MAX);
+    AssignNodeMeshes(scene, 0, batchedSlots, meshRemap, sceneMeshes);
+
+    sceneMeshes.batchCount = (uint32_t)batches.size();
+    for (ImportedMesh& batch : batches)
+    {
+        sceneMeshes.nodeMeshes[0].push_back((uint32_t)sceneMeshes.meshes.size());
+        sceneMeshes.meshes.push_back(std::move(batch));
+    }
+
+    return sceneMeshes;
+}
+
+void MeshCooker::RetrieveNodes(const ImportedScene& scene, uint32_t nodeIndex, const SceneMeshes& sceneMeshes, MeshCacheWriter& writer)
+{
+    const ImportedNode& sourceNode = scene.nodes[nodeIndex];
+
+    MeshCacheWriter::NodeData node{};
+    node.name = sourceNode.name;
+    node.props.translation[0] = sourceNode.translation.x;
+    node.props.translation[1] = sourceNode.translation.y;
+    node.props.translation[2] = sourceNode.translation.z;
+    node.props.rotation[0] = sourceNode.rotation.x;
+    node.props.rotation[1] = sourceNode.rotation.y;
+    node.props.rotation[2] = sourceNode.rotation.z;
+    node.props.scale[0] = sourceNode.scale.x;
+    node.props.scale[1] = sourceNode.scale.y;
+    node.props.scale[2] = sourceNode.scale.z;
+    node.props.childCount = (uint32_t)sourceNode.children.size();
+    node.meshes = sceneMeshes.nodeMeshes[nodeIndex];
+
+    writer.AddNode(std::move(node));
+
+    for (uint32_t child : sourceNode.children)
+    {
+        RetrieveNodes(scene, child, sceneMeshes, writer);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include <assimp/scene.h>
+#include <glm/glm.hpp>
+
+#include "ImportedScene.h"
+#include "MeshCache.h"
+
+// Imports a scene, glTF with GltfImporter and other formats with assimp, and runs the whole CPU side of mesh processing,
+// producing the cooked mesh cache. Doesn't touch the renderer, so the standalone MeshCooker tool shares it with the runtime.
+class MeshCooker
+{
+public:
+    static std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath);
+    static uint64_t CalculateSourceHash(const std::filesystem::path& sourcePath);
+    static uint64_t GetSettingsHash();
+
+    static bool Cook(const std::filesystem::path& sourcePath, uint64_t sourceHash, std::vector<uint8_t>& outData);
+    // Imports a glTF scene with GltfImporter and with assimp and logs both times, other formats with assimp only
+    static void BenchmarkImport(const std::filesystem::path& sourcePath);
+
+private:
+    struct MeshletData
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint32_t> meshletTriangles;
+    };
+
+    // Parents of the full detail meshlets, the leaves of the hierarchy, and the error bounds of the leaves followed by the parents
+    struct ClusterHierarchy
+    {
+        MeshletData meshlets;
+        std::vector<ClusterLod> lods;
+    };
+
+    struct LodData
+    {
+        std::vector<uint32_t> indices;
+        float error = 0.0f;
+    };
+
+    // A mesh referenced by a node, the transform is relative to the root node
+    struct MeshInstance
+    {
+        uint32_t node = 0;
+        uint32_t slot = 0;
+        uint32_t meshIndex = 0;
+        glm::mat4 transform = glm::mat4(1.0f);
+    };
+
+    // Meshes to cook in cache order and the cache meshes of every node. Static batches go last and belong to the root node.
+    struct SceneMeshes
+    {
+        std::vector<ImportedMesh> meshes;
+        std::vector<std::vector<uint32_t>> nodeMeshes;
+        uint32_t batchCount = 0;
+        uint32_t batchedInstanceCount = 0;
+    };
+
+    // Largest difference between the source attributes and what the shaders decode, normals and tangents in degrees
+    struct QuantizationError
+    {
+        float position = 0.0f;
+        float relativePosition = 0.0f;
+        float normal = 0.0f;
+        float tangent = 0.0f;
+        float uv = 0.0f;
+        uint64_t vertexCount = 0;
+        uint64_t vertexBytes = 0;
+        uint64_t meshletBytes = 0;
+        uint64_t uncompressedMeshletBytes = 0;
+        uint64_t wideMeshletCount = 0;
+        // Positions, vertices and indices as stored and before encoding
+        uint64_t encodedBytes = 0;
+        uint64_t rawBytes = 0;
+
+        void Merge(const QuantizationError& other);
+    };
+
+private:
+    static bool IsGltf(const std::filesystem::path& sourcePath);
+    static bool ImportScene(const std::filesystem::path& sourcePath, std::string_view sceneName, ImportedScene& outScene);
+    static bool ImportAssimpScene(const std::filesystem::path& sourcePath, uint32_t importFlags, std::string_view sceneName, ImportedScene& outScene);
+    static uint32_t RetrieveAssimpNode(const aiNode* assetNode, const std::unordered_set<std::string>& animatedNodes, ImportedScene& outScene);
+    static std::string GetTexturePath(const aiMaterial* assetMaterial, aiTextureType textureType);
+    static MeshCacheWriter::MaterialData RetrieveMaterial(const aiMaterial* assetMaterial, std::string_view sceneName);
+    static std::vector<uint32_t> RetrieveIndices(const aiMesh* assetMesh);
+    static std::vector<float> RetrievePositions(const aiMesh* assetMesh);
+    static std::vector<float> RetrieveNormals(const aiMesh* assetMesh);
+    static std::vector<float> RetrieveTangentsBitangents(const aiMesh* assetMesh);
+    static std::vector<float> RetrieveUV0(const aiMesh* assetMesh);
+    static std::vector<uint32_t> RetrieveColors(const aiMesh* assetMesh);
+    static glm::vec3 DecodeOctahedral(uint32_t encoded);
+    static MeshletData BuildMeshlets(const std::vector<float>& positions, size_t vtxCount, const std::vector<uint32_t>& indices);
+    static void AppendMeshlets(MeshletData& meshletData, const MeshletData& other);
+    static std::vector<uint32_t> GetMeshletIndices(const MeshletData& meshletData, const Meshlet& meshlet);
+    static std::vector<std::vector<uint32_t>> GroupClusters(const std::vector<ClusterLod>& lods, const std::vector<uint32_t>& clusters);
+    static ClusterHierarchy BuildClusterHierarchy(const std::vector<float>& positions, const std::vector<float>& normals, size_t vtxCount, const MeshletData& leaves);
+    static void EncodeIndices(const std::vector<uint32_t>& indices, size_t vtxCount, MeshCacheWriter::MeshData& mesh);
+    static void EncodeStreams(const std::vector<uint32_t>& indices, MeshCacheWriter::MeshData& mesh, QuantizationError& outError);
+    static void EncodeMeshlets(const MeshletData& meshletData, MeshCacheWriter::MeshData& mesh, QuantizationError& outError);
+    static std::vector<LodData> BuildLods(const std::vector<float>& positions, const std::vector<float>& normals, size_t vtxCount, std::vector<uint32_t> indices);
+    static MeshCacheWriter::MeshData RetrieveMesh(ImportedMesh sourceMesh, std::string_view sceneName, QuantizationError& outError);
+    static std::vector<MeshCacheWriter::MeshData> RetrieveMeshes(std::vector<ImportedMesh>& sourceMeshes, std::string_view sceneName, QuantizationError& outError);
+    static void CollectStaticInstances(const ImportedScene& scene, uint32_t nodeIndex, const glm::mat4& transform, std::vector<MeshInstance>& outInstances);
+    static ImportedMesh MergeInstances(const ImportedScene& scene, const std::vector<MeshInstance>& instances, uint32_t batchIndex);
+    static void AssignNodeMeshes(ImportedScene& scene, uint32_t nodeIndex, const std::vector<std::vector<bool>>& batchedSlots, std::vector<uint32_t>& meshRemap, SceneMeshes& outMeshes);
+    static SceneMeshes BatchStaticMeshes(ImportedScene& scene);
+    static void RetrieveNodes(const ImportedScene& scene, uint32_t nodeIndex, const SceneMeshes& sceneMeshes, MeshCacheWriter& writer);
+};
@@ -1,143 +1,117 @@
 #include "MeshLoader.h"
 
-#include <assimp/scene.h>
-#include <assimp/cimport.h>
-#include <assimp/postprocess.h>
-
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <stb_image.h>
-#include <meshoptimizer.h>
 
 #include <Application/Application.h>
 
+#include <meshoptimizer.h>
+
+#include "MeshCooker.h"
+#include "VertexCodec.h"
+
 Entity MeshLoader::Load(const std::filesystem::path& path)
 {
-    std::string asciiPath = path.string();
-    const aiScene* assetScene = aiImportFile(asciiPath.c_str(), aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_FlipUVs);
-    if (!assetScene)
+    ProfileFunction();
+
+    // Meshes keep the cache to create the geometry of another render path later
+    std::shared_ptr<const MeshCache> cache = LoadCache(path);
+    if (!cache)
     {
-        LogError("Scene \'{}\' loading failed: {}", asciiPath, aiGetErrorString());
         return {};
     }
 
     std::string sceneFolder = path.parent_path().string() + '/';
     std::string sceneName = path.filename().replace_extension("").string();
 
-    std::vector<MaterialPtr> materials = RetrieveMaterials(assetScene, sceneFolder, sceneName);
-    std::vector<MeshPtr> meshes = RetrieveMeshes(assetScene, sceneName);
-    Entity rootEntity = RetrieveNodes(assetScene, materials, meshes, sceneName);
-
-    aiReleaseImport(assetScene);
+    std::vector<MaterialPtr> materials = CreateMaterials(*cache, sceneFolder);
+    std::vector<MeshPtr> meshes = CreateMeshes(cache);
+    Entity rootEntity = CreateNodes(*cache, materials, meshes, sceneName);
 
     return rootEntity;
 }
 
-TexturePtr MeshLoader::LoadMaterialTexture(aiMaterial* assetMaterial, aiTextureType textureType, std::string_view sceneFolder, CommandBufferPtr& cmdBuffer)
+MeshCachePtr MeshLoader::LoadCache(const std::filesystem::path& path)
 {
     ProfileFunction();
 
-    uint32_t uvSet = 0;
-    aiString textureName;
-    aiReturn ret = assetMaterial->GetTexture(textureType, 0, &textureName, nullptr, &uvSet);
+    std::filesystem::path cachePath = MeshCooker::GetCachePath(path);
+    uint64_t sourceHash = MeshCooker::CalculateSourceHash(path);
 
-    if (ret != aiReturn_SUCCESS)
+    MeshCachePtr cache = MeshCache::Load(cachePath, sourceHash, MeshCooker::GetSettingsHash());
+    if (cache)
     {
-        return nullptr;
+        return cache;
     }
 
-    std::filesystem::path texturePath = std::string(sceneFolder) + textureName.data;
-    TexturePtr texture = Texture::LoadFromFile(texturePath);
+    LogInfo("Cooking scene \'{}\'", path.string());
 
-    return texture;
-}
-
-std::vector<MaterialPtr> MeshLoader::RetrieveMaterials(const aiScene* assetScene, std::string_view sceneFolder, std::string_view sceneName)
-{
-    ProfileFunction();
-
-    std::vector<MaterialPtr> materials;
-
-    CommandBufferPtr cmdBuffer = Renderer::Get()->GetLoadCmdBuffer();
-
-    for (uint32_t i = 0; i < assetScene->mNumMaterials; i++)
+    std::vector<uint8_t> data;
+    if (!MeshCooker::Cook(path, sourceHash, data))
     {
-        aiMaterial* assetMaterial = assetScene->mMaterials[i];
-
-        aiString materialName;
-        assetMaterial->Get(AI_MATKEY_NAME, materialName);
-
-        MaterialPtr material = Material::Create();
-        material->name = std::format("{}.{}", sceneName, materialName.data);
+        return nullptr;
+    }
 
-        aiString alphaMode;
-        if (aiReturn_SUCCESS == assetMaterial->Get("$mat.gltf.alphaMode", 0, 0, alphaMode))
+    // Failing to write the cache only costs the next launch another cook. A written one is mapped
+    // instead of keeping the cooked data in memory, meshes hold on to it for as long as they live.
+    if (MeshCacheWriter::Write(cachePath, data))
+    {
+        cache = MeshCache::Load(cachePath, sourceHash, MeshCooker::GetSettingsHash());
+        if (cache)
         {
-            if (strcmp(alphaMode.data, "OPAQUE") == 0)
-            {
-                material->props.alphaMode = AlphaMode::Opaque;
-                material->props.alphaCutoff = 0.0f;
-            }
-            else if (strcmp(alphaMode.data, "BLEND") == 0)
-            {
-                material->props.alphaMode = AlphaMode::Blend;
-                material->props.alphaCutoff = 0.0f;
-            }
-            else if (strcmp(alphaMode.data, "MASK") == 0)
-            {
-                material->props.alphaMode = AlphaMode::Mask;
-                assetMaterial->Get("$mat.gltf.alphaCutoff", 0, 0, material->props.alphaCutoff);
-            }
+            return cache;
         }
+    }
 
-        uint8_t isDoubleSided = 0;
-        assetMaterial->Get(AI_MATKEY_TWOSIDED, isDoubleSided);
-        material->props.isDoubleSided = isDoubleSided;
+    return MeshCache::Create(std::move(data));
+}
 
-        assetMaterial->Get("$tex.scale", aiTextureType_NORMALS, 0, material->props.normalScale);
+TexturePtr MeshLoader::LoadMaterialTexture(const MeshCache& cache, const MeshCacheMaterial& cacheMaterial, MeshCacheTexture texture, std::string_view sceneFolder)
+{
+    ProfileFunction();
 
-        aiColor3D albedo;
-        aiReturn hr = assetMaterial->Get(AI_MATKEY_BASE_COLOR, albedo);
-        material->props.albedo = glm::vec4(albedo.r, albedo.g, albedo.b, 1.0f);
-        hr = assetMaterial->Get(AI_MATKEY_OPACITY, material->props.albedo.a);
+    std::string_view textureName = cache.GetString(cacheMaterial.textures[texture]);
+    if (textureName.empty())
+    {
+        return nullptr;
+    }
 
-        aiColor3D emissive;
-        assetMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, emissive);
-        material->props.emissiveValue = glm::vec4(emissive.r, emissive.g, emissive.b, 1.0f);
-        assetMaterial->Get(AI_MATKEY_EMISSIVE_INTENSITY, material->props.emissiveValue.a);
+    std::filesystem::path texturePath = std::string(sceneFolder) + std::string(textureName);
 
-        material->normalsTexture = LoadMaterialTexture(assetMaterial, aiTextureType_NORMALS, sceneFolder, cmdBuffer);
-        material->emissiveTexture = LoadMaterialTexture(assetMaterial, aiTextureType_EMISSIVE, sceneFolder, cmdBuffer);
-        material->occlusionTexture = LoadMaterialTexture(assetMaterial, aiTextureType_LIGHTMAP, sceneFolder, cmdBuffer);
+    return Texture::LoadFromFile(texturePath);
+}
 
-        float glossiness = 1.0f;
-        if (aiReturn_SUCCESS == assetMaterial->Get(AI_MATKEY_GLOSSINESS_FACTOR, glossiness))
-        {
-            material->props.workflow = Workflow::SpecularGlossiness;
-            material->props.specular.a = glossiness;
+std::vector<MaterialPtr> MeshLoader::CreateMaterials(const MeshCache& cache, std::string_view sceneFolder)
+{
+    ProfileFunction();
 
-            aiColor4D specular;
-            if (aiReturn_SUCCESS == assetMaterial->Get(AI_MATKEY_COLOR_SPECULAR, specular))
-            {
-                material->props.specular.r = specular.r;
-                material->props.specular.g = specular.g;
-                material->props.specular.b = specular.b;
-            }
+    std::vector<MaterialPtr> materials;
 
-            material->albedoTexture = LoadMaterialTexture(assetMaterial, aiTextureType_DIFFUSE, sceneFolder, cmdBuffer);
-            material->specularTexture = LoadMaterialTexture(assetMaterial, aiTextureType_SPECULAR, sceneFolder, cmdBuffer);
-        }
-        else
-        {
-            material->props.workflow = Workflow::MetallicRoughness;
+    CommandBufferPtr cmdBuffer = Renderer::Get()->GetLoadCmdBuffer();
 
-            material->props.aoMetRough = glm::vec4(1.0f);
-            assetMaterial->Get(AI_MATKEY_METALLIC_FACTOR, material->props.aoMetRough.g);
-            assetMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, material->props.aoMetRough.b);
+    for (uint32_t i = 0; i < cache.GetHeader().materialCount; i++)
+    {
+        const MeshCacheMaterial& cacheMaterial = cache.GetMaterial(i);
 
-            material->albedoTexture = LoadMaterialTexture(assetMaterial, aiTextureType_BASE_COLOR, sceneFolder, cmdBuffer);
-            material->metRoughTexture = LoadMaterialTexture(assetMaterial, aiTextureType_METALNESS, sceneFolder, cmdBuffer);
-        }
+        MaterialPtr material = Material::Create();
+        material->name = cache.GetString(cacheMaterial.name);
+
+        material->props.albedo = glm::make_vec4(cacheMaterial.albedo);
+        material->props.aoMetRough = glm::make_vec4(cacheMaterial.aoMetRough);
+        material->props.emissiveValue = glm::make_vec4(cacheMaterial.emissiveValue);
+        material->props.specular = glm::make_vec4(cacheMaterial.specular);
+        material->props.alphaMode = (AlphaMode)cacheMaterial.alphaMode;
+        material->props.alphaCutoff = cacheMaterial.alphaCutoff;
+        material->props.isDoubleSided = cacheMaterial.isDoubleSided;
+        material->props.normalScale = cacheMaterial.normalScale;
+        material->props.workflow = (Workflow)cacheMaterial.workflow;
+
+        material->albedoTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureAlbedo, sceneFolder);
+        material->normalsTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureNormals, sceneFolder);
+        material->metRoughTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureMetRough, sceneFolder);
+        material->emissiveTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureEmissive, sceneFolder);
+        material->specularTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureSpecular, sceneFolder);
+        material->occlusionTexture = LoadMaterialTexture(cache, cacheMaterial, MeshCacheTextureOcclusion, sceneFolder);
 
         material->propsBuffer = Buffer::CreateStructured(sizeof(material->props), false);
         material->propsBuffer->SetName(material->name);
@@ -160,366 +134,343 @@ std::vector<MaterialPtr> MeshLoader::RetrieveMaterials(const aiScene* assetScene
     return materials;
 }
 
-std::vector<uint32_t> MeshLoader::RetrieveIndices(const aiMesh* assetMesh)
+BufferPtr MeshLoader::CreateBuffer(const MeshCache& cache, const MeshCacheBlob& blob, const std::string& name, MeshUploads& uploads)
 {
-    uint32_t idxCount = assetMesh->mNumFaces;
-
-    std::vector<uint32_t> indices;
-    indices.reserve(idxCount);
+    BufferPtr buffer = Buffer::CreateStructured(blob.size, false);
+    buffer->SetName(name);
 
-    const aiFace* facesPtr = assetMesh->mFaces;
-    for (uint32_t idx = 0; idx < idxCount; idx++)
+    if (blob.size)
     {
-        indices.push_back(facesPtr[idx].mIndices[0]);
-        indices.push_back(facesPtr[idx].mIndices[1]);
-        indices.push_back(facesPtr[idx].mIndices[2]);
+        uploads.copies.push_back({ buffer, cache.GetBlob(blob), blob.size });
     }
 
-    return indices;
+    return buffer;
 }
 
-std::vector<float> MeshLoader::RetrievePositions(const aiMesh* assetMesh)
+// Encoded streams are uploaded as they are and decoded into the final buffer by a compute pass, which keeps
+// the upload small. Without the decode pipeline they are decoded on the CPU and uploaded like raw streams.
+BufferPtr MeshLoader::CreateVertexStream(const MeshCache& cache, const MeshCacheBlob& blob, const MeshCacheBlob& blocks, bool isEncoded, uint32_t vertexCount, uint32_t vertexStride, const std::string& name, MeshUploads& uploads)
 {
-    uint32_t vtxCount = assetMesh->mNumVertices;
+    if (!isEncoded)
+    {
+        return CreateBuffer(cache, blob, name, uploads);
+    }
 
-    std::vector<float> vertices;
-    vertices.reserve(vtxCount * 3);
+    uint64_t decodedSize = (uint64_t)vertexCount * vertexStride;
 
-    const aiVector3D* vtxPtr = assetMesh->mVertices;
-    for (uint32_t vtxId = 0; vtxId < vtxCount; vtxId++)
+    if (PSOCompute::Get(Shader::GetCompute("assets/shaders/VertexDecode.hlsl")))
     {
-        aiVector3D vtx = vtxPtr[vtxId];
-        vertices.push_back(vtx.x);
-        vertices.push_back(vtx.y);
-        vertices.push_back(vtx.z);
-    }
+        VertexDecode& decode = uploads.decodes.emplace_back();
+        decode.vertexCount = vertexCount;
+        decode.vertexStride = vertexStride;
 
-    return vertices;
-}
+        // The shader reads whole words, so the encoded buffer is padded to a multiple of 4 bytes
+        decode.encoded = Buffer::CreateStructured((blob.size + 3) & ~3ull, false);
+        decode.encoded->SetName("Encoded " + name);
+        uploads.copies.push_back({ decode.encoded, cache.GetBlob(blob), blob.size });
 
-std::vector<int16_t> MeshLoader::RetrieveNormals(const aiMesh* assetMesh)
-{
-    uint32_t vtxCount = assetMesh->mNumVertices;
+        decode.blocks = CreateBuffer(cache, blocks, "Blocks " + name, uploads);
+
+        decode.decoded = Buffer::CreateStructured(decodedSize, true);
+        decode.decoded->SetName(name);
 
-    std::vector<int16_t> normals;
-    normals.reserve(vtxCount * 3);
+        return decode.decoded;
+    }
 
-    const aiVector3D* normalsPtr = assetMesh->mNormals;
-    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    std::vector<uint8_t>& decoded = uploads.decodedData.emplace_back(decodedSize);
+    if (!VertexCodec::Decode(decoded.data(), vertexCount, vertexStride, cache.GetBlob(blob), blob.size))
     {
-        normals.push_back(glm::detail::toFloat16(normalsPtr[vtx].x));
-        normals.push_back(glm::detail::toFloat16(normalsPtr[vtx].y));
-        normals.push_back(glm::detail::toFloat16(normalsPtr[vtx].z));
+        LogError("Failed to decode vertex stream {}", name);
     }
 
-    return normals;
+    BufferPtr buffer = Buffer::CreateStructured(decodedSize, false);
+    buffer->SetName(name);
+    uploads.copies.push_back({ buffer, decoded.data(), decoded.size() });
+
+    return buffer;
 }
 
-std::vector<int16_t> MeshLoader::RetrieveTangentsBitangents(const aiMesh* assetMesh)
+void MeshLoader::CreateGeometry(const MeshCache& cache, uint32_t meshIndex, Mesh& mesh, MeshGeometryFlags geometry, MeshUploads& uploads)
 {
-    if (!assetMesh->mTangents || !assetMesh->mBitangents)
+    const MeshCacheMesh& cacheMesh = cache.GetMesh(meshIndex);
+
+    std::string meshName(cache.GetString(cacheMesh.name));
+
+    if (geometry & MeshGeometryIndices)
     {
-        return {};
-    }
+        uint64_t indicesSize = (uint64_t)cacheMesh.indexCount * cacheMesh.indexStride;
+
+        mesh.indexBuffer = Buffer::CreateIndex(indicesSize);
+        mesh.indexBuffer->SetName("VtxIndices: " + meshName);
+        mesh.indexType = cacheMesh.indexStride == sizeof(uint16_t) ? IndexType::Uint16 : IndexType::Uint32;
 
-    uint32_t vtxCount = assetMesh->mNumVertices;
+        // Every triangle of the index codec depends on the ones before it, so indices are decoded on the CPU
+        if (cacheMesh.encodedStreams & MeshCacheStreamEncodedIndices)
+        {
+            std::vector<uint8_t>& indices = uploads.decodedData.emplace_back(indicesSize);
+            if (meshopt_decodeIndexBuffer(indices.data(), cacheMesh.indexCount, cacheMesh.indexStride, cache.GetBlob(cacheMesh.indices), cacheMesh.indices.size) != 0)
+            {
+                LogError("Failed to decode indices of mesh {}", meshName);
+            }
 
-    std::vector<int16_t> tangentsBitangents;
-    tangentsBitangents.reserve(vtxCount * 6);
+            uploads.copies.push_back({ mesh.indexBuffer, indices.data(), indices.size() });
+        }
+        else if (cacheMesh.indices.size)
+        {
+            uploads.copies.push_back({ mesh.indexBuffer, cache.GetBlob(cacheMesh.indices), indicesSize });
+        }
+    }
 
-    const aiVector3D* tangentsPtr = assetMesh->mTangents;
-    const aiVector3D* bitangentsPtr = assetMesh->mBitangents;
-    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    if (geometry & MeshGeometryMeshlets)
     {
-        tangentsBitangents.push_back(glm::detail::toFloat16(tangentsPtr[vtx].x));
-        tangentsBitangents.push_back(glm::detail::toFloat16(tangentsPtr[vtx].y));
-        tangentsBitangents.push_back(glm::detail::toFloat16(tangentsPtr[vtx].z));
-        tangentsBitangents.push_back(glm::detail::toFloat16(bitangentsPtr[vtx].x));
-        tangentsBitangents.push_back(glm::detail::toFloat16(bitangentsPtr[vtx].y));
-        tangentsBitangents.push_back(glm::detail::toFloat16(bitangentsPtr[vtx].z));
+        mesh.meshlets = CreateBuffer(cache, cacheMesh.meshlets, "Meshlets: " + meshName, uploads);
+        mesh.meshletVertices = CreateBuffer(cache, cacheMesh.meshletVertices, "MeshletVertices: " + meshName, uploads);
+        mesh.meshletTriangles = CreateBuffer(cache, cacheMesh.meshletTriangles, "MeshletTriangles: " + meshName, uploads);
+
+        if (cacheMesh.clusterCount)
+        {
+            mesh.clusterCount = cacheMesh.clusterCount;
+            mesh.clusterLods = CreateBuffer(cache, cacheMesh.clusterLods, "ClusterLods: " + meshName, uploads);
+        }
     }
 
-    return tangentsBitangents;
+    mesh.geometry |= geometry;
 }
 
-std::vector<int16_t> MeshLoader::RetrieveUV0(const aiMesh* assetMesh)
+// The coarsest LOD is decoded from the cache once and only the vertices it references are kept
+void MeshLoader::CreateOccluder(const MeshCache& cache, uint32_t meshIndex, Mesh& mesh)
 {
-    if (!assetMesh->HasTextureCoords(0))
+    const MeshCacheMesh& cacheMesh = cache.GetMesh(meshIndex);
+    if (cacheMesh.lodCount == 0 || !cacheMesh.indices.size || !cacheMesh.positions.size)
     {
-        return {};
+        return;
     }
 
-    uint32_t vtxCount = assetMesh->mNumVertices;
-
-    std::vector<int16_t> uvs;
-    uvs.reserve(vtxCount * 2);
-
-    const aiVector3D* uvsPtr = assetMesh->mTextureCoords[0];
-    for (uint32_t vtx = 0; vtx < vtxCount; vtx++)
+    const MeshLod& lod = cacheMesh.lods[cacheMesh.lodCount - 1];
+    if (lod.indexCount / 3 > SoftwareOcclusion::MAX_OCCLUDER_TRIANGLE_COUNT)
     {
-        uvs.push_back(glm::detail::toFloat16(uvsPtr[vtx].x));
-        uvs.push_back(glm::detail::toFloat16(uvsPtr[vtx].y));
+        return;
     }
 
-    return uvs;
-}
+    std::string_view meshName = cache.GetString(cacheMesh.name);
 
-std::vector<int16_t> MeshLoader::RetrieveColors(const aiMesh* assetMesh)
-{
-    if (!assetMesh->HasVertexColors(0))
+    std::vector<uint8_t> decodedIndices;
+    const uint8_t* indices = cache.GetBlob(cacheMesh.indices);
+    if (cacheMesh.encodedStreams & MeshCacheStreamEncodedIndices)
     {
-        return {};
+        decodedIndices.resize((size_t)cacheMesh.indexCount * cacheMesh.indexStride);
+        if (meshopt_decodeIndexBuffer(decodedIndices.data(), cacheMesh.indexCount, cacheMesh.indexStride, indices, cacheMesh.indices.size) != 0)
+        {
+            LogError("Failed to decode indices of occluder {}", meshName);
+            return;
+        }
+        indices = decodedIndices.data();
     }
 
-    uint32_t vtxCount = assetMesh->mNumVertices;
-
-    std::vector<int16_t> colors;
-    colors.reserve(vtxCount * 4);
-
-    const aiColor4D* colorPtr = assetMesh->mColors[0];
-    for (uint32_t colorId = 0; colorId < vtxCount; colorId++)
+    std::vector<uint8_t> decodedPositions;
+    const uint8_t* positions = cache.GetBlob(cacheMesh.positions);
+    if (cacheMesh.encodedStreams & MeshCacheStreamEncodedPositions)
     {
-        aiColor4D color = colorPtr[colorId];
-        colors.push_back(glm::detail::toFloat16(color.r));
-        colors.push_back(glm::detail::toFloat16(color.g));
-        colors.push_back(glm::detail::toFloat16(color.b));
-        colors.push_back(glm::detail::toFloat16(color.a));
+        decodedPositions.resize((size_t)cacheMesh.vertexCount * sizeof(uint16_t) * 4);
+        if (!VertexCodec::Decode(decodedPositions.data(), cacheMesh.vertexCount, sizeof(uint16_t) * 4, positions, cacheMesh.positions.size))
+        {
+            LogError("Failed to decode positions of occluder {}", meshName);
+            return;
+        }
+        positions = decodedPositions.data();
     }
 
-    return colors;
-}
-
-MeshLoader::MeshletData MeshLoader::BuildMeshlets(const std::vector<float>& positions, size_t vtxCount, const std::vector<uint32_t>& indices)
-{
-    const uint32_t vertexCountLimit = 64;
-    const uint32_t triangleCountLimit = 84;
-
-    MeshletData meshletData;
-
-    size_t meshletsCount = meshopt_buildMeshletsBound(indices.size(), vertexCountLimit, triangleCountLimit);
+    glm::vec3 positionMin = glm::make_vec3(cacheMesh.aabbMin);
+    glm::vec3 positionExtent = glm::make_vec3(cacheMesh.aabbMax) - positionMin;
 
-    std::vector<meshopt_Meshlet> meshlets(meshletsCount);
-    std::vector<uint32_t> meshletVertices(meshletsCount * vertexCountLimit);
-    std::vector<uint8_t> meshletTriangles(meshletsCount * triangleCountLimit * 3);
+    std::vector<uint32_t> remap(cacheMesh.vertexCount, UINT32_MAX);
+    mesh.occluderIndices.reserve(lod.indexCount);
 
-    meshletsCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
-        indices.data(), indices.size(), positions.data(), vtxCount, 12, vertexCountLimit, triangleCountLimit, 1.0f);
-
-    const meshopt_Meshlet& lastMeshlet = meshlets[meshletsCount - 1];
-
-    meshletData.meshlets.reserve(meshletsCount);
-
-    for (size_t i = 0; i < meshletsCount; i++)
+    for (uint32_t i = lod.indexOffset; i < lod.indexOffset + lod.indexCount; i++)
     {
-        Meshlet meshlet{};
-        meshlet.vertexOffset = (uint32_t)meshletData.meshletVertices.size();
-        meshlet.vertexCount = meshlets[i].vertex_count;
-        meshlet.triangleOffset = (uint32_t)meshletData.meshletTriangles.size();
-        meshlet.triangleCount = meshlets[i].triangle_count;
-
-        uint32_t vertOffset = meshlets[i].vertex_offset;
-        for (size_t j = 0; j < meshlet.vertexCount; j++)
+        uint32_t index = 0;
+        memcpy(&index, indices + (size_t)i * cacheMesh.indexStride, cacheMesh.indexStride);
+        if (index >= cacheMesh.vertexCount)
         {
-            meshletData.meshletVertices.push_back(meshletVertices[vertOffset + j]);
+            LogError("Occluder {} references vertex {} out of {}", meshName, index, cacheMesh.vertexCount);
+            mesh.occluderPositions.clear();
+            mesh.occluderIndices.clear();
+            return;
         }
 
-        uint32_t triOffset = meshlets[i].triangle_offset;
-        for (size_t j = 0; j < meshlet.triangleCount; j++)
+        if (remap[index] == UINT32_MAX)
         {
-            uint32_t index =
-                 meshletTriangles[triOffset + j * 3] |
-                (meshletTriangles[triOffset + j * 3 + 1] << 8) |
-                (meshletTriangles[triOffset + j * 3 + 2] << 16);
+            uint16_t position[4]{};
+            memcpy(position, positions + (size_t)index * sizeof(position), sizeof(position));
 
-            meshletData.meshletTriangles.push_back(index);
+            remap[index] = (uint32_t)mesh.occluderPositions.size();
+            mesh.occluderPositions.push_back(positionMin + glm::vec3(position[0], position[1], position[2]) / 65535.0f * positionExtent);
         }
 
-        meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshletVertices[meshlets[i].vertex_offset], &meshletTriangles[meshlets[i].triangle_offset],
-            meshlet.triangleCount, positions.data(), positions.size(), 12);
+        mesh.occluderIndices.push_back(remap[index]);
+    }
+}
+
+void MeshLoader::SubmitUploads(const MeshUploads& uploads)
+{
+    ProfileFunction();
+
+    CommandBufferPtr cmdBuffer = Renderer::Get()->GetLoadCmdBuffer();
 
-        meshlet.center[0] = bounds.center[0];
-        meshlet.center[1] = bounds.center[1];
-        meshlet.center[2] = bounds.center[2];
-        meshlet.radius = bounds.radius;
+    if (!uploads.copies.empty())
+    {
+        cmdBuffer->CopyToBuffers(uploads.copies);
+    }
 
-        meshlet.coneApex[0] = bounds.cone_apex[0];
-        meshlet.coneApex[1] = bounds.cone_apex[1];
-        meshlet.coneApex[2] = bounds.cone_apex[2];
+    if (uploads.decodes.empty())
+    {
+        return;
+    }
 
-        meshlet.coneAxis[0] = bounds.cone_axis[0];
-        meshlet.coneAxis[1] = bounds.cone_axis[1];
-        meshlet.coneAxis[2] = bounds.cone_axis[2];
+    struct DrawData
+    {
+        int encoded;
+        int blocks;
+        int decoded;
+        uint32_t vertexCount;
+        uint32_t vertexStride;
+        uint32_t blockVertexCount;
+        uint32_t blockCount;
+    };
+
+    cmdBuffer->MarkerBegin("VERTEX_DECODE");
 
-        meshlet.cutoff = bounds.cone_cutoff;
+    const PSOCompute* decodePso = PSOCompute::Get(Shader::GetCompute("assets/shaders/VertexDecode.hlsl"));
+    cmdBuffer->BindPsoCompute(decodePso);
 
-        meshletData.meshlets.push_back(meshlet);
+    for (const VertexDecode& decode : uploads.decodes)
+    {
+        DrawData drawData{};
+        drawData.encoded = decode.encoded->BindSRV();
+        drawData.blocks = decode.blocks->BindSRV();
+        drawData.decoded = decode.decoded->BindUAV();
+        drawData.vertexCount = decode.vertexCount;
+        drawData.vertexStride = decode.vertexStride;
+        drawData.blockVertexCount = VertexCodec::GetBlockVertexCount(decode.vertexStride);
+        drawData.blockCount = VertexCodec::GetBlockCount(decode.vertexCount, decode.vertexStride);
+
+        cmdBuffer->RegisterSRVUsageBuffer(decode.encoded);
+        cmdBuffer->RegisterSRVUsageBuffer(decode.blocks);
+        cmdBuffer->RegisterUAVUsageBuffer(decode.decoded);
+
+        cmdBuffer->PushConstants(&drawData, sizeof(drawData));
+
+        // A thread per 32-bit word of the vertex in every block
+        uint32_t threadCount = drawData.blockCount * (decode.vertexStride / 4);
+        cmdBuffer->Dispatch((threadCount + 63) / 64, 1, 1);
     }
 
-    return meshletData;
+    cmdBuffer->MarkerEnd();
 }
 
-std::vector<MeshPtr> MeshLoader::RetrieveMeshes(const aiScene* assetScene, std::string_view sceneName)
+// Blobs are already in their GPU layout, so they are copied from the mapped cache as is, encoded ones are decoded after the copy.
+// Every mesh is uploaded through one staging buffer once all buffers are created.
+// Only the geometry of the current render path is created, the other one is created from the cache when it's first drawn.
+std::vector<MeshPtr> MeshLoader::CreateMeshes(const std::shared_ptr<const MeshCache>& cache)
 {
     ProfileFunction();
 
     std::vector<MeshPtr> meshes;
+    meshes.reserve(cache->GetHeader().meshCount);
 
-    CommandBufferPtr cmdBuffer = Renderer::Get()->GetLoadCmdBuffer();
+    // Uploads point into this, so it must not reallocate
+    std::vector<MeshInfo> meshInfos;
+    meshInfos.reserve(cache->GetHeader().meshCount);
 
-    for (uint32_t i = 0; i < assetScene->mNumMeshes; i++)
+    MeshUploads uploads;
+    uploads.copies.reserve(cache->GetHeader().meshCount * 8);
+
+    MeshGeometryFlags geometry = Renderer::Get()->GetRequiredGeometry();
+
+    for (uint32_t i = 0; i < cache->GetHeader().meshCount; i++)
     {
-        aiMesh* assetMesh = assetScene->mMeshes[i];
+        const MeshCacheMesh& cacheMesh = cache->GetMesh(i);
 
-        size_t vtxCount = assetMesh->mNumVertices;
-        uint32_t idxCount = 3 * assetMesh->mNumFaces;
+        std::string meshName(cache->GetString(cacheMesh.name));
 
-        VertexComponentFlags components = VertexComponentNone;
+        MeshPtr mesh = Mesh::Create();
+        mesh->components = cacheMesh.components;
+        mesh->meshletsCount = (int)cacheMesh.meshletCount;
+        mesh->lods.assign(cacheMesh.lods, cacheMesh.lods + cacheMesh.lodCount);
+        memcpy(mesh->aabbMin, cacheMesh.aabbMin, sizeof(mesh->aabbMin));
+        memcpy(mesh->aabbMax, cacheMesh.aabbMax, sizeof(mesh->aabbMax));
 
-        std::vector<float> positions = RetrievePositions(assetMesh);
-        std::vector<int16_t> normals = RetrieveNormals(assetMesh);
-        std::vector<int16_t> tangentsBitangents = RetrieveTangentsBitangents(assetMesh);
-        std::vector<int16_t> uvs = RetrieveUV0(assetMesh);
-        std::vector<int16_t> colors = RetrieveColors(assetMesh);
+        mesh->positions = CreateVertexStream(*cache, cacheMesh.positions, cacheMesh.positionBlocks, cacheMesh.encodedStreams & MeshCacheStreamEncodedPositions,
+            cacheMesh.vertexCount, sizeof(uint16_t) * 4, "VtxPos: " + meshName, uploads);
+        mesh->vertices = CreateVertexStream(*cache, cacheMesh.vertices, cacheMesh.vertexBlocks, cacheMesh.encodedStreams & MeshCacheStreamEncodedVertices,
+            cacheMesh.vertexCount, cacheMesh.vertexStride, "Vertices: " + meshName, uploads);
 
-        std::vector<uint32_t> indices(idxCount);
-        std::vector<uint32_t> remap(idxCount);
-        {
-            std::vector<uint32_t> rawIndices = RetrieveIndices(assetMesh);
-            meshopt_optimizeVertexCache(rawIndices.data(), rawIndices.data(), idxCount, vtxCount);
+        CreateGeometry(*cache, i, *mesh, geometry, uploads);
+        CreateOccluder(*cache, i, *mesh);
 
-            vtxCount = meshopt_optimizeVertexFetchRemap(remap.data(), rawIndices.data(), idxCount, vtxCount);
-            meshopt_remapIndexBuffer(indices.data(), rawIndices.data(), idxCount, remap.data());
-        }
+        mesh->createGeometry = [cache, i](Mesh& mesh, MeshGeometryFlags geometry)
+            {
+                ProfileFunction();
 
-        meshopt_remapVertexBuffer(positions.data(), positions.data(), vtxCount, 3 * sizeof(positions[0]), remap.data());
-        if (!normals.empty())
-        {
-            meshopt_remapVertexBuffer(normals.data(), normals.data(), vtxCount, 3 * sizeof(normals[0]), remap.data());
-        }
-        if (!tangentsBitangents.empty())
-        {
-            meshopt_remapVertexBuffer(tangentsBitangents.data(), tangentsBitangents.data(), vtxCount, 6 * sizeof(tangentsBitangents[0]), remap.data());
-        }
-        if (!uvs.empty())
-        {
-            meshopt_remapVertexBuffer(uvs.data(), uvs.data(), vtxCount, 2 * sizeof(uvs[0]), remap.data());
-        }
-        if (!colors.empty())
-        {
-            meshopt_remapVertexBuffer(colors.data(), colors.data(), vtxCount, 4 * sizeof(colors[0]), remap.data());
-        }
+                MeshUploads uploads;
+                CreateGeometry(*cache, i, mesh, geometry, uploads);
 
-        MeshletData meshletData = BuildMeshlets(positions, vtxCount, indices);
+                SubmitUploads(uploads);
+            };
 
-        int vertexStride = 3 * sizeof(positions[0]);
-        vertexStride += 3 * sizeof(normals[0]);
-        if (!tangentsBitangents.empty())
-        {
-            components |= VertexComponentTangentBitangents;
-            vertexStride += 6 * sizeof(tangentsBitangents[0]);
-        }
-        if (!uvs.empty())
-        {
-            components |= VertexComponentUvs;
-            vertexStride += 2 * sizeof(uvs[0]);
-        }
-        if (!colors.empty())
+        MeshInfo& meshInfo = meshInfos.emplace_back();
+        for (int c = 0; c < 3; c++)
         {
-            components |= VertexComponentColors;
-            vertexStride += 4 * sizeof(colors[0]);
+            meshInfo.positionMin[c] = cacheMesh.aabbMin[c];
+            meshInfo.positionExtent[c] = cacheMesh.aabbMax[c] - cacheMesh.aabbMin[c];
         }
-        vertexStride = (vertexStride + 3) & ~3;
-
-        std::vector<uint8_t> vertices;
-        vertices.resize(vtxCount * vertexStride);
-
-        for (int i = 0; i < vtxCount; i++)
+        for (int c = 0; c < 2; c++)
         {
-            uint8_t* dstPtr = vertices.data() + i * vertexStride;
-
-            memcpy(dstPtr, &positions[i * 3], 3 * sizeof(positions[0]));
-            dstPtr += 3 * sizeof(positions[0]);
-
-            memcpy(dstPtr, &normals[i * 3], 3 * sizeof(normals[0]));
-            dstPtr += 3 * sizeof(normals[0]);
-
-            if (!tangentsBitangents.empty())
-            {
-                memcpy(dstPtr, &tangentsBitangents[i * 6], 6 * sizeof(tangentsBitangents[0]));
-                dstPtr += 6 * sizeof(tangentsBitangents[0]);
-            }
-            if (!uvs.empty())
-            {
-                memcpy(dstPtr, &uvs[i * 2], 2 * sizeof(uvs[0]));
-                dstPtr += 2 * sizeof(uvs[0]);
-            }
-            if (!colors.empty())
-            {
-                memcpy(dstPtr, &colors[i * 4], 4 * sizeof(colors[0]));
-                dstPtr += 4 * sizeof(colors[0]);
-            }
+            meshInfo.uvMin[c] = cacheMesh.uvMin[c];
+            meshInfo.uvExtent[c] = cacheMesh.uvMax[c] - cacheMesh.uvMin[c];
         }
 
-        std::string meshName = std::format("{}.{}", sceneName, assetMesh->mName.data);
-
-        MeshPtr mesh = Mesh::Create();
-        mesh->components = components;
-        mesh->meshletsCount = (int)meshletData.meshlets.size();
-        mesh->indexBuffer = Buffer::CreateStructured(sizeof(uint32_t) * idxCount, false);
-        mesh->meshlets = Buffer::CreateStructured(sizeof(Meshlet) * meshletData.meshlets.size(), false);
-        mesh->meshletVertices = Buffer::CreateStructured(meshletData.meshletVertices.size() * sizeof(meshletData.meshletVertices[0]), false);
-        mesh->meshletTriangles = Buffer::CreateStructured(meshletData.meshletTriangles.size() * sizeof(meshletData.meshletTriangles[0]), false);
-        mesh->positions = Buffer::CreateStructured(vtxCount * sizeof(positions[0]) * 3, false);
-        mesh->vertices = Buffer::CreateStructured(vtxCount * vertexStride, false);
-
-        mesh->indexBuffer->SetName("VtxIndices: " + meshName);
-        mesh->meshlets->SetName("Meshlets: " + meshName);
-        mesh->meshletVertices->SetName("MeshletVertices: " + meshName);
-        mesh->meshletTriangles->SetName("MeshletTriangles: " + meshName);
-        mesh->positions->SetName("VtxPos: " + meshName);
-        mesh->vertices->SetName("Vertices: " + meshName);
-
-        cmdBuffer->CopyToBuffer(mesh->indexBuffer, indices.data(), mesh->indexBuffer->GetSize());
-        cmdBuffer->CopyToBuffer(mesh->meshlets, meshletData.meshlets.data(), mesh->meshlets->GetSize());
-        cmdBuffer->CopyToBuffer(mesh->meshletVertices, meshletData.meshletVertices.data(), mesh->meshletVertices->GetSize());
-        cmdBuffer->CopyToBuffer(mesh->meshletTriangles, meshletData.meshletTriangles.data(), mesh->meshletTriangles->GetSize());
-        cmdBuffer->CopyToBuffer(mesh->positions, positions.data(), mesh->positions->GetSize());
-        cmdBuffer->CopyToBuffer(mesh->vertices, vertices.data(), mesh->vertices->GetSize());
+        mesh->infoBuffer = Buffer::CreateStructured(sizeof(MeshInfo), false);
+        mesh->infoBuffer->SetName("MeshInfo: " + meshName);
+        uploads.copies.push_back({ mesh->infoBuffer, &meshInfo, sizeof(MeshInfo) });
 
         meshes.push_back(mesh);
     }
 
+    SubmitUploads(uploads);
+
     return meshes;
 }
 
-void MeshLoader::PopulateNode(const aiScene* assetScene, const aiNode* assetNode, std::string_view sceneName, Entity node, const glm::mat4& parentTransform, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes)
+// Returns the index of the node following this one and all of its descendants
+uint32_t MeshLoader::PopulateNode(const MeshCache& cache, uint32_t nodeIndex, std::string_view sceneName, Entity node, const glm::mat4& parentTransform, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes)
 {
-    node.GetComponent<TagComponent>().tag = assetNode->mName.data;
+    const MeshCacheNode& cacheNode = cache.GetNode(nodeIndex);
+
+    node.GetComponent<TagComponent>().tag = cache.GetString(cacheNode.name);
     TransformComponent& transformComponent = node.GetComponent<TransformComponent>();
-    aiVector3D translation, scale, rotation;
-    assetNode->mTransformation.Decompose(scale, rotation, translation);
 
-    transformComponent.UpdateTranslation(glm::vec3(translation[0], translation[1], translation[2]));
-    transformComponent.UpdateScale(glm::vec3(scale[0], scale[1], scale[2]));
-    transformComponent.UpdateRotation(glm::degrees(glm::vec3(rotation[0], rotation[1], rotation[2])));
+    transformComponent.UpdateTranslation(glm::make_vec3(cacheNode.translation));
+    transformComponent.UpdateScale(glm::make_vec3(cacheNode.scale));
+    transformComponent.UpdateRotation(glm::degrees(glm::make_vec3(cacheNode.rotation)));
 
-    glm::mat4 globalTransform = parentTransform * transformComponent.transform;;
+    glm::mat4 globalTransform = parentTransform * transformComponent.transform;
 
-    if (assetNode->mNumMeshes)
+    if (cacheNode.meshCount)
     {
         MeshComponent& meshComponent = node.GetOrAddComponent<MeshComponent>();
         meshComponent.transforms.localTransform = transformComponent.transform;
         meshComponent.transforms.globalTransform = globalTransform;
         meshComponent.transforms.transposeInverseGlobalTransform = glm::transpose(glm::inverse(globalTransform));
         meshComponent.transformsBuffer = Buffer::CreateStructured(sizeof(MeshComponent::Transforms), false);
-        meshComponent.transformsBuffer->SetName(std::format("Node matrices: {}.{}", sceneName, assetNode->mName.data));
+        meshComponent.transformsBuffer->SetName(std::format("Node matrices: {}.{}", sceneName, cache.GetString(cacheNode.name)));
 
         Renderer::Get()->GetLoadCmdBuffer()->CopyToBuffer(meshComponent.transformsBuffer, &meshComponent.transforms, sizeof(MeshComponent::Transforms));
 
-        for (int i = 0; i < (int)assetNode->mNumMeshes; i++)
+        for (uint32_t i = 0; i < cacheNode.meshCount; i++)
         {
-            int meshIndex = assetNode->mMeshes[i];
-            int materialIndex = assetScene->mMeshes[meshIndex]->mMaterialIndex;
+            uint32_t meshIndex = cache.GetNodeMesh(cacheNode.meshOffset + i);
+            uint32_t materialIndex = cache.GetMesh(meshIndex).materialIndex;
 
             MaterialPtr& material = materials[materialIndex];
 
@@ -531,30 +482,31 @@ void MeshLoader::PopulateNode(const aiScene* assetScene, const aiNode* assetNode
         }
     }
 
-    for (uint32_t i = 0; i < assetNode->mNumChildren; i++)
+    uint32_t childIndex = nodeIndex + 1;
+    for (uint32_t i = 0; i < cacheNode.childCount && childIndex < cache.GetHeader().nodeCount; i++)
     {
         Entity child = Application::Get()->GetLevel()->CreateEntity("", node);
 
-        PopulateNode(assetScene, assetNode->mChildren[i], sceneName, child, globalTransform, materials, meshes);
+        childIndex = PopulateNode(cache, childIndex, sceneName, child, globalTransform, materials, meshes);
     }
+
+    return childIndex;
 }
 
-Entity MeshLoader::RetrieveNodes(const aiScene* assetScene, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes, std::string_view sceneName)
+Entity MeshLoader::CreateNodes(const MeshCache& cache, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes, std::string_view sceneName)
 {
     ProfileFunction();
 
-    glm::mat4 scale = glm::mat4(1.0f);
-
     Entity root = Application::Get()->GetLevel()->CreateEntity(sceneName);
     TransformComponent& transformComponent = root.GetComponent<TransformComponent>();
     transformComponent.UpdateRotation(glm::vec3(90.0f, 0.0f, 0.0f));
 
-    if (assetScene->mRootNode)
+    if (cache.GetHeader().nodeCount > 0)
     {
         Entity secondaryRoot = Application::Get()->GetLevel()->CreateEntity("", root);
 
-        PopulateNode(assetScene, assetScene->mRootNode, sceneName, secondaryRoot, transformComponent.transform, materials, meshes);
+        PopulateNode(cache, 0, sceneName, secondaryRoot, transformComponent.transform, materials, meshes);
     }
 
     return root;
-}
\ No newline at end of file
+}
@@ -2,34 +2,46 @@
 
 #include <filesystem>
 
-#include <assimp/scene.h>
-
 #include <Level/Entity.h>
 
+#include "MeshCache.h"
+
+// Scenes are loaded from the cooked mesh cache next to the source file. A missing or stale cache is cooked
+// from the source with assimp first and written back, so the processing cost is paid once per change.
 class MeshLoader
 {
 public:
     static Entity Load(const std::filesystem::path& path);
 
 private:
-    struct MeshletData
+    // A vertex stream decoded on the GPU once its encoded form is uploaded
+    struct VertexDecode
+    {
+        BufferPtr encoded;
+        BufferPtr blocks;
+        BufferPtr decoded;
+        uint32_t vertexCount = 0;
+        uint32_t vertexStride = 0;
+    };
+
+    // Copies point into the cache or into streams decoded on the CPU
+    struct MeshUploads
     {
-        std::vector<Meshlet> meshlets;
-        std::vector<uint32_t> meshletVertices;
-        std::vector<uint32_t> meshletTriangles;
+        std::vector<BufferUpload> copies;
+        std::vector<std::vector<uint8_t>> decodedData;
+        std::vector<VertexDecode> decodes;
     };
 
 private:
-    static TexturePtr LoadMaterialTexture(aiMaterial* assetMaterial, aiTextureType textureType, std::string_view sceneFolder, CommandBufferPtr& cmdBuffer);
-    static std::vector<MaterialPtr> RetrieveMaterials(const aiScene* assetScene, std::string_view sceneFolder, std::string_view sceneName);
-    static std::vector<uint32_t> RetrieveIndices(const aiMesh* assetMesh);
-    static std::vector<float> RetrievePositions(const aiMesh* assetMesh);
-    static std::vector<int16_t> RetrieveNormals(const aiMesh* assetMesh);
-    static std::vector<int16_t> RetrieveTangentsBitangents(const aiMesh* assetMesh);
-    static std::vector<int16_t> RetrieveUV0(const aiMesh* assetMesh);
-    static std::vector<int16_t> RetrieveColors(const aiMesh* assetMesh);
-    static MeshletData BuildMeshlets(const std::vector<float>& positions, size_t vtxCount, const std::vector<uint32_t>& indices);
-    static std::vector<MeshPtr> RetrieveMeshes(const aiScene* assetScene, std::string_view sceneName);
-    static void PopulateNode(const aiScene* assetScene, const aiNode* assetNode, std::string_view sceneName, Entity node, const glm::mat4& parentTransform, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes);
-    static Entity RetrieveNodes(const aiScene* assetScene, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes, std::string_view sceneName);
-};
\ No newline at end of file
+    static MeshCachePtr LoadCache(const std::filesystem::path& path);
+    static TexturePtr LoadMaterialTexture(const MeshCache& cache, const MeshCacheMaterial& cacheMaterial, MeshCacheTexture texture, std::string_view sceneFolder);
+    static std::vector<MaterialPtr> CreateMaterials(const MeshCache& cache, std::string_view sceneFolder);
+    static BufferPtr CreateBuffer(const MeshCache& cache, const MeshCacheBlob& blob, const std::string& name, MeshUploads& uploads);
+    static BufferPtr CreateVertexStream(const MeshCache& cache, const MeshCacheBlob& blob, const MeshCacheBlob& blocks, bool isEncoded, uint32_t vertexCount, uint32_t vertexStride, const std::string& name, MeshUploads& uploads);
+    static void CreateGeometry(const MeshCache& cache, uint32_t meshIndex, Mesh& mesh, MeshGeometryFlags geometry, MeshUploads& uploads);
+    static void CreateOccluder(const MeshCache& cache, uint32_t meshIndex, Mesh& mesh);
+    static void SubmitUploads(const MeshUploads& uploads);
+    static std::vector<MeshPtr> CreateMeshes(const std::shared_ptr<const MeshCache>& cache);
+    static uint32_t PopulateNode(const MeshCache& cache, uint32_t nodeIndex, std::string_view sceneName, Entity node, const glm::mat4& parentTransform, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes);
+    static Entity CreateNodes(const MeshCache& cache, std::vector<MaterialPtr>& materials, std::vector<MeshPtr>& meshes, std::string_view sceneName);
+};
@@ -0,0 +1,188 @@
+#include "VertexCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include <meshoptimizer.h>
+
+// Constants of meshoptimizer's vertex codec, version 0
+static const uint8_t VERTEX_CODEC_HEADER = 0xa0;
+static const size_t VERTEX_CODEC_BLOCK_SIZE_BYTES = 8192;
+static const size_t VERTEX_CODEC_BLOCK_MAX_VERTEX_COUNT = 256;
+static const size_t VERTEX_CODEC_GROUP_SIZE = 16;
+static const size_t VERTEX_CODEC_TAIL_SIZE = 32;
+
+static uint8_t Unzigzag(uint8_t value)
+{
+    return (uint8_t)(-(value & 1) ^ (value >> 1));
+}
+
+// Group modes are all zeros, 2-bit or 4-bit values with the largest one escaping to a full byte stored after the group, or raw bytes
+static bool DecodeGroup(const uint8_t* data, size_t dataEnd, uint32_t mode, size_t& offset, uint8_t* outDeltas)
+{
+    if (mode == 0)
+    {
+        memset(outDeltas, 0, VERTEX_CODEC_GROUP_SIZE);
+        return true;
+    }
+
+    if (mode == 3)
+    {
+        if (offset + VERTEX_CODEC_GROUP_SIZE > dataEnd)
+        {
+            return false;
+        }
+
+        memcpy(outDeltas, data + offset, VERTEX_CODEC_GROUP_SIZE);
+        offset += VERTEX_CODEC_GROUP_SIZE;
+        return true;
+    }
+
+    uint32_t bits = mode == 1 ? 2 : 4;
+    uint32_t sentinel = (1u << bits) - 1;
+    uint32_t valuesPerByte = 8 / bits;
+
+    size_t escape = offset + VERTEX_CODEC_GROUP_SIZE / valuesPerByte;
+    if (escape > dataEnd)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < VERTEX_CODEC_GROUP_SIZE; i++)
+    {
+        uint32_t value = (data[offset + i / valuesPerByte] >> (8 - bits * (i % valuesPerByte + 1))) & sentinel;
+        if (value == sentinel)
+        {
+            if (escape >= dataEnd)
+            {
+                return false;
+            }
+
+            value = data[escape++];
+        }
+
+        outDeltas[i] = (uint8_t)value;
+    }
+
+    offset = escape;
+
+    return true;
+}
+
+bool VertexCodec::Encode(const void* vertices, size_t vertexCount, size_t vertexStride, std::vector<uint8_t>& outEncoded, std::vector<uint32_t>& outBlocks)
+{
+    if (vertexCount == 0 || vertexStride == 0 || vertexStride % 4 != 0 || vertexStride > 256)
+    {
+        return false;
+    }
+
+    // Later versions of the format aren't block independent, the version is global so it's set once for every thread
+    static std::once_flag s_versionFlag;
+    std::call_once(s_versionFlag, []() { meshopt_encodeVertexVersion(0); });
+
+    outEncoded.resize(meshopt_encodeVertexBufferBound(vertexCount, vertexStride));
+    outEncoded.resize(meshopt_encodeVertexBuffer(outEncoded.data(), outEncoded.size(), vertices, vertexCount, vertexStride));
+    if (outEncoded.empty())
+    {
+        return false;
+    }
+
+    return BuildBlockTable((const uint8_t*)vertices, vertexCount, vertexStride, outEncoded, outBlocks);
+}
+
+bool VertexCodec::Decode(void* outVertices, size_t vertexCount, size_t vertexStride, const uint8_t* encoded, size_t encodedSize)
+{
+    return meshopt_decodeVertexBuffer(outVertices, vertexCount, vertexStride, encoded, encodedSize) == 0;
+}
+
+uint32_t VertexCodec::GetBlockVertexCount(size_t vertexStride)
+{
+    size_t count = (VERTEX_CODEC_BLOCK_SIZE_BYTES / vertexStride) & ~(VERTEX_CODEC_GROUP_SIZE - 1);
+
+    return (uint32_t)std::min(count, VERTEX_CODEC_BLOCK_MAX_VERTEX_COUNT);
+}
+
+uint32_t VertexCodec::GetBlockCount(size_t vertexCount, size_t vertexStride)
+{
+    uint32_t blockVertexCount = GetBlockVertexCount(vertexStride);
+
+    return (uint32_t)((vertexCount + blockVertexCount - 1) / blockVertexCount);
+}
+
+uint32_t VertexCodec::GetBlockTableStride(size_t vertexStride)
+{
+    return (uint32_t)(vertexStride + vertexStride / 4);
+}
+
+// Walks the stream the way the decode shader does and compares every decoded byte with the source.
+// An encoder that writes anything but format version 0 fails here, and the stream is stored raw instead.
+bool VertexCodec::BuildBlockTable(const uint8_t* vertices, size_t vertexCount, size_t vertexStride, const std::vector<uint8_t>& encoded, std::vector<uint32_t>& outBlocks)
+{
+    size_t tailSize = std::max(vertexStride, VERTEX_CODEC_TAIL_SIZE);
+    if (encoded.size() < 1 + tailSize || encoded[0] != VERTEX_CODEC_HEADER)
+    {
+        return false;
+    }
+
+    size_t dataEnd = encoded.size() - tailSize;
+
+    uint32_t blockVertexCount = GetBlockVertexCount(vertexStride);
+    uint32_t blockCount = GetBlockCount(vertexCount, vertexStride);
+    uint32_t tableStride = GetBlockTableStride(vertexStride);
+
+    outBlocks.assign((size_t)blockCount * tableStride, 0);
+
+    size_t offset = 1;
+    for (uint32_t block = 0; block < blockCount; block++)
+    {
+        size_t firstVertex = (size_t)block * blockVertexCount;
+        size_t blockVertices = std::min<size_t>(blockVertexCount, vertexCount - firstVertex);
+        size_t groupCount = (blockVertices + VERTEX_CODEC_GROUP_SIZE - 1) / VERTEX_CODEC_GROUP_SIZE;
+        size_t headerSize = (groupCount + 3) / 4;
+
+        // The first block is predicted from the first vertex, every other one from the last vertex of the block before
+        const uint8_t* baseVertex = vertices + (block == 0 ? 0 : firstVertex - 1) * vertexStride;
+
+        uint32_t* table = &outBlocks[(size_t)block * tableStride];
+        memcpy(table + vertexStride, baseVertex, vertexStride);
+
+        for (size_t k = 0; k < vertexStride; k++)
+        {
+            table[k] = (uint32_t)offset;
+
+            if (offset + headerSize > dataEnd)
+            {
+                return false;
+            }
+
+            const uint8_t* header = &encoded[offset];
+            offset += headerSize;
+
+            uint8_t value = baseVertex[k];
+            for (size_t group = 0; group < groupCount; group++)
+            {
+                uint32_t mode = (header[group / 4] >> ((group % 4) * 2)) & 3;
+
+                uint8_t deltas[VERTEX_CODEC_GROUP_SIZE];
+                if (!DecodeGroup(encoded.data(), dataEnd, mode, offset, deltas))
+                {
+                    return false;
+                }
+
+                for (size_t i = 0; i < VERTEX_CODEC_GROUP_SIZE; i++)
+                {
+                    value += Unzigzag(deltas[i]);
+
+                    size_t vertex = group * VERTEX_CODEC_GROUP_SIZE + i;
+                    if (vertex < blockVertices && value != vertices[(firstVertex + vertex) * vertexStride + k])
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return offset == dataEnd;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vertex streams compressed with meshopt_encodeVertexBuffer, format version 0. The vertices are split into blocks and
+// every byte of the vertex is a separate stream of zigzag deltas within a block, packed in groups of 16.
+// The block table stores where each byte stream of a block starts and the vertex the block is predicted from,
+// which makes blocks independent so the GPU decodes them in parallel, see VertexDecode.hlsl.
+class VertexCodec
+{
+public:
+    // Fails when the stream can't be decoded on the GPU, the stride must be a multiple of 4
+    static bool Encode(const void* vertices, size_t vertexCount, size_t vertexStride, std::vector<uint8_t>& outEncoded, std::vector<uint32_t>& outBlocks);
+    // CPU fallback, meshoptimizer's decoder is SIMD
+    static bool Decode(void* outVertices, size_t vertexCount, size_t vertexStride, const uint8_t* encoded, size_t encodedSize);
+
+    static uint32_t GetBlockVertexCount(size_t vertexStride);
+    static uint32_t GetBlockCount(size_t vertexCount, size_t vertexStride);
+    // In 32-bit words: the offsets of the byte streams followed by the base vertex
+    static uint32_t GetBlockTableStride(size_t vertexStride);
+
+private:
+    static bool BuildBlockTable(const uint8_t* vertices, size_t vertexCount, size_t vertexStride, const std::vector<uint8_t>& encoded, std::vector<uint32_t>& outBlocks);
+};
@@ -0,0 +1,447 @@
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define VERTEX_PACKING_X64
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+// MSVC emits AVX2 intrinsics anywhere, GCC and Clang need the target enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+    #define AVX2_TARGET __attribute__((target("avx2")))
+#else
+    #define AVX2_TARGET
+#endif
+
+// Kernels take the quantization scale instead of the extent so the division happens once per stream
+struct VertexPackingKernels
+{
+    void (*packPositions)(const float* positions, size_t count, const float* min, const float* scale, uint16_t* outPositions);
+    void (*packDirections)(const float* directions, size_t stride, size_t count, uint32_t* outDirections);
+    void (*packUnorm16x2)(const float* values, size_t count, const float* min, const float* scale, uint32_t* outValues);
+};
+
+// The SIMD kernels must follow the same operation order, lrint rounds to nearest even just like cvtps2dq
+
+static uint32_t QuantizeUnorm16(float value, float min, float scale)
+{
+    return (uint32_t)std::lrint(std::clamp((value - min) * scale, 0.0f, 65535.0f));
+}
+
+static uint32_t QuantizeSnorm16(float value)
+{
+    return (uint32_t)std::lrint(std::clamp(value, -1.0f, 1.0f) * 32767.0f) & 0xffff;
+}
+
+static uint32_t EncodeOctahedral(float x, float y, float z)
+{
+    float length = std::abs(x) + std::abs(y) + std::abs(z);
+    if (length == 0.0f)
+    {
+        return 0;
+    }
+
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float encodedX = x;
+    float encodedY = y;
+    if (z < 0.0f)
+    {
+        encodedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        encodedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return QuantizeSnorm16(encodedX) | (QuantizeSnorm16(encodedY) << 16);
+}
+
+static void PackPositionsScalar(const float* positions, size_t count, const float* min, const float* scale, uint16_t* outPositions)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        outPositions[i * 4 + 0] = (uint16_t)QuantizeUnorm16(positions[i * 3 + 0], min[0], scale[0]);
+        outPositions[i * 4 + 1] = (uint16_t)QuantizeUnorm16(positions[i * 3 + 1], min[1], scale[1]);
+        outPositions[i * 4 + 2] = (uint16_t)QuantizeUnorm16(positions[i * 3 + 2], min[2], scale[2]);
+        outPositions[i * 4 + 3] = 0;
+    }
+}
+
+static void PackDirectionsScalar(const float* directions, size_t stride, size_t count, uint32_t* outDirections)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* direction = directions + i * stride;
+        outDirections[i] = EncodeOctahedral(direction[0], direction[1], direction[2]);
+    }
+}
+
+static void PackUnorm16x2Scalar(const float* values, size_t count, const float* min, const float* scale, uint32_t* outValues)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        outValues[i] = QuantizeUnorm16(values[i * 2], min[0], scale[0]) | (QuantizeUnorm16(values[i * 2 + 1], min[1], scale[1]) << 16);
+    }
+}
+
+#if defined(VERTEX_PACKING_X64)
+
+static __m128 LoadStrided4(const float* data, size_t stride)
+{
+    return _mm_setr_ps(data[0], data[stride], data[2 * stride], data[3 * stride]);
+}
+
+static __m128i QuantizeUnorm16SSE2(__m128 value, __m128 min, __m128 scale)
+{
+    __m128 normalized = _mm_mul_ps(_mm_sub_ps(value, min), scale);
+    normalized = _mm_min_ps(_mm_max_ps(normalized, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+
+    return _mm_cvtps_epi32(normalized);
+}
+
+static __m128i QuantizeSnorm16SSE2(__m128 value)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+
+    return _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(32767.0f))), _mm_set1_epi32(0xffff));
+}
+
+static __m128i EncodeOctahedralSSE2(__m128 x, __m128 y, __m128 z)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128 length = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+    __m128 isZero = _mm_cmpeq_ps(length, zero);
+
+    x = _mm_div_ps(x, length);
+    y = _mm_div_ps(y, length);
+    z = _mm_div_ps(z, length);
+
+    __m128 signX = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(x, zero), signMask));
+    __m128 signY = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(y, zero), signMask));
+    __m128 foldedX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), signX);
+    __m128 foldedY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), signY);
+
+    __m128 isLowerHemisphere = _mm_cmplt_ps(z, zero);
+    __m128 encodedX = _mm_or_ps(_mm_and_ps(isLowerHemisphere, foldedX), _mm_andnot_ps(isLowerHemisphere, x));
+    __m128 encodedY = _mm_or_ps(_mm_and_ps(isLowerHemisphere, foldedY), _mm_andnot_ps(isLowerHemisphere, y));
+
+    __m128i encoded = _mm_or_si128(QuantizeSnorm16SSE2(encodedX), _mm_slli_epi32(QuantizeSnorm16SSE2(encodedY), 16));
+
+    return _mm_andnot_si128(_mm_castps_si128(isZero), encoded);
+}
+
+static void PackPositionsSSE2(const float* positions, size_t count, const float* min, const float* scale, uint16_t* outPositions)
+{
+    const __m128 minX = _mm_set1_ps(min[0]);
+    const __m128 minY = _mm_set1_ps(min[1]);
+    const __m128 minZ = _mm_set1_ps(min[2]);
+    const __m128 scaleX = _mm_set1_ps(scale[0]);
+    const __m128 scaleY = _mm_set1_ps(scale[1]);
+    const __m128 scaleZ = _mm_set1_ps(scale[2]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* src = positions + i * 3;
+
+        __m128i x = QuantizeUnorm16SSE2(LoadStrided4(src + 0, 3), minX, scaleX);
+        __m128i y = QuantizeUnorm16SSE2(LoadStrided4(src + 1, 3), minY, scaleY);
+        __m128i z = QuantizeUnorm16SSE2(LoadStrided4(src + 2, 3), minZ, scaleZ);
+
+        // Z words keep W as zero in their high half
+        __m128i xy = _mm_or_si128(x, _mm_slli_epi32(y, 16));
+
+        _mm_storeu_si128((__m128i*)(outPositions + i * 4), _mm_unpacklo_epi32(xy, z));
+        _mm_storeu_si128((__m128i*)(outPositions + i * 4 + 8), _mm_unpackhi_epi32(xy, z));
+    }
+
+    PackPositionsScalar(positions + i * 3, count - i, min, scale, outPositions + i * 4);
+}
+
+static void PackDirectionsSSE2(const float* directions, size_t stride, size_t count, uint32_t* outDirections)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* src = directions + i * stride;
+
+        __m128i encoded = EncodeOctahedralSSE2(LoadStrided4(src + 0, stride), LoadStrided4(src + 1, stride), LoadStrided4(src + 2, stride));
+
+        _mm_storeu_si128((__m128i*)(outDirections + i), encoded);
+    }
+
+    PackDirectionsScalar(directions + i * stride, stride, count - i, outDirections + i);
+}
+
+static void PackUnorm16x2SSE2(const float* values, size_t count, const float* min, const float* scale, uint32_t* outValues)
+{
+    const __m128 minX = _mm_set1_ps(min[0]);
+    const __m128 minY = _mm_set1_ps(min[1]);
+    const __m128 scaleX = _mm_set1_ps(scale[0]);
+    const __m128 scaleY = _mm_set1_ps(scale[1]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* src = values + i * 2;
+
+        __m128i x = QuantizeUnorm16SSE2(LoadStrided4(src + 0, 2), minX, scaleX);
+        __m128i y = QuantizeUnorm16SSE2(LoadStrided4(src + 1, 2), minY, scaleY);
+
+        _mm_storeu_si128((__m128i*)(outValues + i), _mm_or_si128(x, _mm_slli_epi32(y, 16)));
+    }
+
+    PackUnorm16x2Scalar(values + i * 2, count - i, min, scale, outValues + i);
+}
+
+AVX2_TARGET static __m256 LoadStrided8(const float* data, size_t stride)
+{
+    __m256i indices = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)stride));
+
+    return _mm256_i32gather_ps(data, indices, 4);
+}
+
+AVX2_TARGET static __m256i QuantizeUnorm16AVX2(__m256 value, __m256 min, __m256 scale)
+{
+    __m256 normalized = _mm256_mul_ps(_mm256_sub_ps(value, min), scale);
+    normalized = _mm256_min_ps(_mm256_max_ps(normalized, _mm256_setzero_ps()), _mm256_set1_ps(65535.0f));
+
+    return _mm256_cvtps_epi32(normalized);
+}
+
+AVX2_TARGET static __m256i QuantizeSnorm16AVX2(__m256 value)
+{
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+
+    return _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(32767.0f))), _mm256_set1_epi32(0xffff));
+}
+
+AVX2_TARGET static __m256i EncodeOctahedralAVX2(__m256 x, __m256 y, __m256 z)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 length = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(signMask, x), _mm256_andnot_ps(signMask, y)), _mm256_andnot_ps(signMask, z));
+    __m256 isZero = _mm256_cmp_ps(length, zero, _CMP_EQ_OQ);
+
+    x = _mm256_div_ps(x, length);
+    y = _mm256_div_ps(y, length);
+    z = _mm256_div_ps(z, length);
+
+    __m256 signX = _mm256_or_ps(one, _mm256_andnot_ps(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), signMask));
+    __m256 signY = _mm256_or_ps(one, _mm256_andnot_ps(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), signMask));
+    __m256 foldedX = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, y)), signX);
+    __m256 foldedY = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, x)), signY);
+
+    __m256 isLowerHemisphere = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+    __m256 encodedX = _mm256_blendv_ps(x, foldedX, isLowerHemisphere);
+    __m256 encodedY = _mm256_blendv_ps(y, foldedY, isLowerHemisphere);
+
+    __m256i encoded = _mm256_or_si256(QuantizeSnorm16AVX2(encodedX), _mm256_slli_epi32(QuantizeSnorm16AVX2(encodedY), 16));
+
+    return _mm256_andnot_si256(_mm256_castps_si256(isZero), encoded);
+}
+
+AVX2_TARGET static void PackPositionsAVX2(const float* positions, size_t count, const float* min, const float* scale, uint16_t* outPositions)
+{
+    const __m256 minX = _mm256_set1_ps(min[0]);
+    const __m256 minY = _mm256_set1_ps(min[1]);
+    const __m256 minZ = _mm256_set1_ps(min[2]);
+    const __m256 scaleX = _mm256_set1_ps(scale[0]);
+    const __m256 scaleY = _mm256_set1_ps(scale[1]);
+    const __m256 scaleZ = _mm256_set1_ps(scale[2]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const float* src = positions + i * 3;
+
+        __m256i x = QuantizeUnorm16AVX2(LoadStrided8(src + 0, 3), minX, scaleX);
+        __m256i y = QuantizeUnorm16AVX2(LoadStrided8(src + 1, 3), minY, scaleY);
+        __m256i z = QuantizeUnorm16AVX2(LoadStrided8(src + 2, 3), minZ, scaleZ);
+
+        __m256i xy = _mm256_or_si256(x, _mm256_slli_epi32(y, 16));
+
+        // Unpacking works within 128-bit lanes, so the halves are swapped back into vertex order
+        __m256i low = _mm256_unpacklo_epi32(xy, z);
+        __m256i high = _mm256_unpackhi_epi32(xy, z);
+
+        _mm256_storeu_si256((__m256i*)(outPositions + i * 4), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256((__m256i*)(outPositions + i * 4 + 16), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+
+    PackPositionsScalar(positions + i * 3, count - i, min, scale, outPositions + i * 4);
+}
+
+AVX2_TARGET static void PackDirectionsAVX2(const float* directions, size_t stride, size_t count, uint32_t* outDirections)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const float* src = directions + i * stride;
+
+        __m256i encoded = EncodeOctahedralAVX2(LoadStrided8(src + 0, stride), LoadStrided8(src + 1, stride), LoadStrided8(src + 2, stride));
+
+        _mm256_storeu_si256((__m256i*)(outDirections + i), encoded);
+    }
+
+    PackDirectionsScalar(directions + i * stride, stride, count - i, outDirections + i);
+}
+
+AVX2_TARGET static void PackUnorm16x2AVX2(const float* values, size_t count, const float* min, const float* scale, uint32_t* outValues)
+{
+    const __m256 minX = _mm256_set1_ps(min[0]);
+    const __m256 minY = _mm256_set1_ps(min[1]);
+    const __m256 scaleX = _mm256_set1_ps(scale[0]);
+    const __m256 scaleY = _mm256_set1_ps(scale[1]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const float* src = values + i * 2;
+
+        __m256i x = QuantizeUnorm16AVX2(LoadStrided8(src + 0, 2), minX, scaleX);
+        __m256i y = QuantizeUnorm16AVX2(LoadStrided8(src + 1, 2), minY, scaleY);
+
+        _mm256_storeu_si256((__m256i*)(outValues + i), _mm256_or_si256(x, _mm256_slli_epi32(y, 16)));
+    }
+
+    PackUnorm16x2Scalar(values + i * 2, count - i, min, scale, outValues + i);
+}
+
+#endif // VERTEX_PACKING_X64
+
+static VertexPackingKernel DetectKernel()
+{
+#if defined(VERTEX_PACKING_X64)
+    #if defined(_MSC_VER)
+        int info[4]{};
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool hasAVX = (info[2] & (1 << 28)) != 0;
+        bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+
+        bool hasAVX2 = false;
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            hasAVX2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        // The OS must also preserve the YMM registers
+        bool isYmmEnabled = hasOSXSave && (_xgetbv(0) & 0x6) == 0x6;
+
+        if (hasAVX && hasAVX2 && isYmmEnabled)
+        {
+            return VertexPackingKernel::AVX2;
+        }
+    #else
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return VertexPackingKernel::AVX2;
+        }
+    #endif
+
+    // Every x64 CPU has SSE2
+    return VertexPackingKernel::SSE2;
+#else
+    return VertexPackingKernel::Scalar;
+#endif
+}
+
+static const VertexPackingKernels& GetKernels(VertexPackingKernel kernel)
+{
+    static const VertexPackingKernels scalarKernels{ PackPositionsScalar, PackDirectionsScalar, PackUnorm16x2Scalar };
+#if defined(VERTEX_PACKING_X64)
+    static const VertexPackingKernels sse2Kernels{ PackPositionsSSE2, PackDirectionsSSE2, PackUnorm16x2SSE2 };
+    static const VertexPackingKernels avx2Kernels{ PackPositionsAVX2, PackDirectionsAVX2, PackUnorm16x2AVX2 };
+#endif
+
+    switch (kernel)
+    {
+#if defined(VERTEX_PACKING_X64)
+    case VertexPackingKernel::AVX2:
+        return avx2Kernels;
+    case VertexPackingKernel::SSE2:
+        return sse2Kernels;
+#endif
+    default:
+        return scalarKernels;
+    }
+}
+
+static std::atomic<VertexPackingKernel>& GetCurrentKernel()
+{
+    static std::atomic<VertexPackingKernel> kernel = DetectKernel();
+
+    return kernel;
+}
+
+void VertexPacking::PackPositions(const float* positions, size_t count, const float min[3], const float extent[3], uint16_t* outPositions)
+{
+    float scale[3];
+    for (int c = 0; c < 3; c++)
+    {
+        scale[c] = extent[c] > 0.0f ? 65535.0f / extent[c] : 0.0f;
+    }
+
+    GetKernels(GetKernel()).packPositions(positions, count, min, scale, outPositions);
+}
+
+void VertexPacking::PackDirections(const float* directions, size_t stride, size_t count, uint32_t* outDirections)
+{
+    GetKernels(GetKernel()).packDirections(directions, stride, count, outDirections);
+}
+
+void VertexPacking::PackUnorm16x2(const float* values, size_t count, const float min[2], const float extent[2], uint32_t* outValues)
+{
+    float scale[2];
+    for (int c = 0; c < 2; c++)
+    {
+        scale[c] = extent[c] > 0.0f ? 65535.0f / extent[c] : 0.0f;
+    }
+
+    GetKernels(GetKernel()).packUnorm16x2(values, count, min, scale, outValues);
+}
+
+VertexPackingKernel VertexPacking::GetKernel()
+{
+    return GetCurrentKernel();
+}
+
+bool VertexPacking::SetKernel(VertexPackingKernel kernel)
+{
+    if (kernel > DetectKernel())
+    {
+        return false;
+    }
+
+    GetCurrentKernel() = kernel;
+
+    return true;
+}
+
+const char* VertexPacking::GetKernelName(VertexPackingKernel kernel)
+{
+    switch (kernel)
+    {
+    case VertexPackingKernel::AVX2:
+        return "AVX2";
+    case VertexPackingKernel::SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
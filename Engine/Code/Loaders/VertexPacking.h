@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Ordered by width, a CPU supporting a kernel supports every narrower one
+enum class VertexPackingKernel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Bulk vertex attribute quantization used by the mesh cooker.
+// Every kernel produces bit identical results, the widest one supported by the CPU is picked on first use.
+class VertexPacking
+{
+public:
+    // 16-bit unorm XYZ within [min, min + extent] from tightly packed float3, W is zero
+    static void PackPositions(const float* positions, size_t count, const float min[3], const float extent[3], uint16_t* outPositions);
+    // Octahedral 2x16-bit snorm with X in the low half, stride is in floats
+    static void PackDirections(const float* directions, size_t stride, size_t count, uint32_t* outDirections);
+    // 2x16-bit unorm within [min, min + extent] from tightly packed float2, X in the low half
+    static void PackUnorm16x2(const float* values, size_t count, const float min[2], const float extent[2], uint32_t* outValues);
+
+    static VertexPackingKernel GetKernel();
+    // Forces a narrower kernel, used to compare kernels against each other. Not safe while packing is in flight
+    static bool SetKernel(VertexPackingKernel kernel);
+    static const char* GetKernelName(VertexPackingKernel kernel);
+};
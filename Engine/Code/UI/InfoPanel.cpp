@@ -95,6 +95,13 @@ void InfoPanel::Update()
 
     static bool value = true;
     ImGui::Checkbox("ZPrepass", &engine->GetRenderer()->GetProps().isUseZPrepass);
+    ImGui::Checkbox("Wait for PSOs", &engine->GetRenderer()->GetProps().isWaitForPsoPrewarm);
+    ImGui::Checkbox("Mesh shading", &engine->GetRenderer()->GetProps().isMeshShading);
+    ImGui::Checkbox("LODs", &engine->GetRenderer()->GetProps().isUseLods);
+    ImGui::Checkbox("Cluster culling", &engine->GetRenderer()->GetProps().isUseClusterCulling);
+    ImGui::Checkbox("Occlusion culling", &engine->GetRenderer()->GetProps().isUseOcclusionCulling);
+    ImGui::Checkbox("Software occlusion", &engine->GetRenderer()->GetProps().isUseSoftwareOcclusion);
+    ImGui::SliderFloat("LOD error (px)", &engine->GetRenderer()->GetProps().lodErrorThreshold, 0.25f, 16.0f, "%.2f");
 
     ImGui::PopFont();
     ImGui::PopFont();
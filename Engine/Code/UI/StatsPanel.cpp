@@ -28,6 +28,14 @@ void StatsPanel::Update()
     ImGui::Text("Draw calls: %d", renderStats.stats.drawCallCount);
     ImGui::Text("Dispatch calls: %d", renderStats.stats.dispatchCount);
     ImGui::Text("DrawMeshTasks calls: %d", renderStats.stats.drawMeshTasksCount);
+    ImGui::Text("Skipped draws: %d", renderStats.stats.skippedDrawCount);
+    ImGui::Text("Triangles saved by LODs: %d", renderStats.stats.lodTrianglesSavedCount);
+    ImGui::Text("Meshlets tested: %d", renderStats.stats.meshletTestedCount);
+    ImGui::Text("Software occlusion: %d occluders, %d rejected, %.2fms", renderStats.softwareOcclusion.occluderCount,
+        renderStats.softwareOcclusion.rejectedCount, renderStats.softwareOcclusion.milliseconds);
+    ImGui::Text("Pending PSOs: %d", renderStats.pendingPsoCount);
+    ImGui::Text("PSO hitches avoided: %d", renderStats.psoHitchesAvoidedCount);
+    ImGui::Text("Prewarmed PSOs: %d", renderStats.prewarmedPsoCount);
     
     ImGui::Separator();
 
@@ -47,6 +55,19 @@ void StatsPanel::Update()
         {
             ImGui::Text("%s - %d", stat.name.c_str(), stat.count);
         }
+
+        // Below 1 when indexed draws reuse shaded vertices from the post-transform cache
+        const std::vector<PipelineStatistics>& stats = renderStats.pipelineStatistics;
+        if (stats.size() > 2 && stats[0].count > 0)
+        {
+            ImGui::Text("VS invocations per vertex - %.2f", (float)stats[2].count / stats[0].count);
+        }
+
+        // Every meshlet the task shader emits is one mesh shader group of 32 threads, see THREADS_PER_GROUP in ZPassCommon.hlsli
+        if (stats.size() > 8)
+        {
+            ImGui::Text("Meshlets emitted - %d of %d", stats[8].count / 32, renderStats.stats.meshletTestedCount);
+        }
     }
 
     if (!renderStats.gpuZones.empty())
@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <Framework/Common.h>
+
+#include <TestCheck.h>
+#include <Framework/Hash.h>
+
+#include <Engine/Rendering/Backend/PipelineGraphicsState.h>
+
+// Microbenchmark of the PSO cache key. Hashes a set of graphics pipeline states with PipelineGraphicsState::CalculateHash
+// and compares Hash64 against the byte-at-a-time Jenkins hash it replaced, on the same serialized state bytes.
+// Only collisions fail the benchmark: neither CalculateHash nor Hash64 may collide on the set, so a faster hash doesn't
+// trade away cache lookups.
+
+const static int ITERATION_COUNT = 2000;
+
+static std::vector<PipelineGraphicsState> CreateStates()
+{
+    const VkFormat colorFormats[] = { VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_R16G16_SFLOAT };
+    const CullMode cullModes[] = { CullMode::None, CullMode::Front, CullMode::Back };
+    const CompareOp compareOps[] = { CompareOp::LessOrEqual, CompareOp::GreaterOrEqual, CompareOp::Always };
+
+    std::vector<PipelineGraphicsState> states;
+
+    for (uintptr_t shader = 1; shader <= 8; shader++)
+    {
+        for (uint32_t colorCount = 0; colorCount <= 4; colorCount++)
+        {
+            for (CullMode cullMode : cullModes)
+            {
+                for (CompareOp compareOp : compareOps)
+                {
+                    for (uint32_t constants = 0; constants < 8; constants++)
+                    {
+                        PipelineGraphicsState& state = states.emplace_back();
+                        // Only the address takes part in the hash, the shader is never dereferenced
+                        state.SetShader((Shader*)(shader * 256));
+
+                        PipelineRenderingState& rendering = state.GetRenderingState();
+                        rendering.state.colorAttachmentCount = colorCount;
+                        for (uint32_t i = 0; i < colorCount; i++)
+                        {
+                            rendering.formats[i] = colorFormats[(i + shader) % std::size(colorFormats)];
+                        }
+                        rendering.state.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
+
+                        state.GetRasterizationState().SetCull(cullMode, FrontFace::Clockwise);
+                        state.GetDepthStencilState().SetDepthTest(compareOp != CompareOp::Always, compareOp);
+
+                        PipelineBlendState& blend = state.GetBlendState();
+                        blend.state.attachmentCount = colorCount;
+                        if (colorCount > 0 && constants % 2 == 1)
+                        {
+                            blend.SetBlendingColor(0, BlendFactor::SrcAlpha, BlendFactor::OneMinusSrcAlpha, BlendOp::Add);
+                        }
+
+                        PipelineSpecializationState& specialization = state.GetSpecializationState();
+                        for (uint32_t i = 0; i < 3; i++)
+                        {
+                            specialization.SetConstant(i, (constants >> i & 1) != 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return states;
+}
+
+template<typename Function>
+static double MeasureNanosecondsPerState(size_t stateCount, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATION_COUNT; i++)
+    {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)ITERATION_COUNT * stateCount);
+}
+
+int main()
+{
+    std::vector<PipelineGraphicsState> states = CreateStates();
+
+    std::vector<std::vector<uint8_t>> keys(states.size());
+    size_t keysSize = 0;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        uintptr_t shader = (uintptr_t)states[i].GetShader();
+        keys[i].insert(keys[i].end(), (const uint8_t*)&shader, (const uint8_t*)&shader + sizeof(shader));
+        states[i].Serialize(keys[i]);
+        keysSize += keys[i].size();
+    }
+
+    // Summed into a volatile so the optimizer can't drop the hashing
+    volatile uint64_t sink = 0;
+
+    double stateHashTime = MeasureNanosecondsPerState(states.size(), [&]()
+        {
+            uint64_t sum = 0;
+            for (const PipelineGraphicsState& state : states)
+            {
+                sum += state.CalculateHash();
+            }
+            sink = sink + sum;
+        });
+
+    double hash64Time = MeasureNanosecondsPerState(keys.size(), [&]()
+        {
+            uint64_t sum = 0;
+            for (const std::vector<uint8_t>& key : keys)
+            {
+                sum += Hash64(key.data(), key.size());
+            }
+            sink = sink + sum;
+        });
+
+    double jenkinsTime = MeasureNanosecondsPerState(keys.size(), [&]()
+        {
+            uint64_t sum = 0;
+            for (const std::vector<uint8_t>& key : keys)
+            {
+                sum += JenkinsHash(key.data(), key.size());
+            }
+            sink = sink + sum;
+        });
+
+    std::unordered_set<uint64_t> stateHashes;
+    std::unordered_set<uint64_t> hash64Hashes;
+    std::unordered_set<uint32_t> jenkinsHashes;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        stateHashes.insert(states[i].CalculateHash());
+        hash64Hashes.insert(Hash64(keys[i].data(), keys[i].size()));
+        jenkinsHashes.insert(JenkinsHash(keys[i].data(), keys[i].size()));
+    }
+
+    LogInfo("{} states, {:.1f} bytes per serialized key", states.size(), (double)keysSize / keys.size());
+    LogInfo("PipelineGraphicsState::CalculateHash: {:.1f} ns per state", stateHashTime);
+    LogInfo("Hash64 over serialized state: {:.1f} ns per state", hash64Time);
+    LogInfo("JenkinsHash over serialized state: {:.1f} ns per state ({:.1f}x slower than Hash64)", jenkinsTime, jenkinsTime / hash64Time);
+    LogInfo("Collisions: CalculateHash {}, Hash64 {}, JenkinsHash {}",
+        states.size() - stateHashes.size(), states.size() - hash64Hashes.size(), states.size() - jenkinsHashes.size());
+
+    Check(stateHashes.size() == states.size(), "CalculateHash has no collisions");
+    Check(hash64Hashes.size() == states.size(), "Hash64 has no collisions");
+
+    // Timings depend on the machine and its load, so they are only reported
+    if (hash64Time >= jenkinsTime)
+    {
+        LogWarning("Hash64 wasn't faster than JenkinsHash on this run");
+    }
+
+    if (s_failedCount != 0)
+    {
+        LogError("{} hash benchmark checks failed", s_failedCount);
+        return 1;
+    }
+
+    return 0;
+}
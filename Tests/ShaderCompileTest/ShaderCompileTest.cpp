@@ -0,0 +1,132 @@
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <Framework/Common.h>
+
+#include <TestCheck.h>
+
+#include <Engine/Rendering/Backend/ShaderCompiler.h>
+#include <Engine/Rendering/Backend/ShaderPack.h>
+
+// Headless test of the HLSL to SPIR-V path through DXC, run from the repository root. Compiles every stage of every
+// permutation ShaderPacker packs, and checks that a broken shader fails cleanly and still reports its includes.
+
+const static uint32_t SPIRV_MAGIC = 0x07230203;
+const static size_t SPIRV_HEADER_SIZE = 5 * sizeof(uint32_t);
+
+static bool IsSpirv(const std::vector<uint8_t>& spirv)
+{
+    return spirv.size() >= SPIRV_HEADER_SIZE && spirv.size() % sizeof(uint32_t) == 0 && *(const uint32_t*)spirv.data() == SPIRV_MAGIC;
+}
+
+static std::string GetPermutationName(const std::string& shaderName, const ShaderPackedStage& stage, const ShaderDefines& defines)
+{
+    std::string name = std::format("{}:{}", shaderName, stage.entryPoint);
+    for (const std::string& define : defines.Get())
+    {
+        name += " " + define;
+    }
+
+    return name;
+}
+
+// Stages whose entry point is defined, for the checks of stages that must be present
+static std::unordered_set<std::string> CheckShader(ShaderCompiler& compiler, const std::string& shaderName, const std::string& source)
+{
+    std::unordered_set<std::string> compiledStages;
+
+    for (const ShaderDefines& defines : ShaderPack::GetPermutations(source))
+    {
+        for (const ShaderPackedStage& stage : ShaderPack::GetStages(source, defines))
+        {
+            std::unordered_set<std::string> dependencies;
+            bool isEntryPointMissing = false;
+            std::vector<uint8_t> spirv = compiler.CompileToSpirv(shaderName, stage.stage, stage.entryPoint, defines, dependencies, &isEntryPointMissing);
+
+            std::string permutationName = GetPermutationName(shaderName, stage, defines);
+            if (isEntryPointMissing && !stage.isRequired)
+            {
+                continue;
+            }
+
+            Check(IsSpirv(spirv), std::format("{} compiles to SPIR-V", permutationName));
+            compiledStages.insert(permutationName);
+        }
+    }
+
+    return compiledStages;
+}
+
+static void WriteFile(const std::filesystem::path& path, std::string_view content)
+{
+    std::ofstream file(path, std::ios::trunc);
+    file << content;
+}
+
+int main()
+{
+    if (!std::filesystem::is_directory("assets/shaders"))
+    {
+        LogError("Run from the repository root, assets/shaders not found");
+        return 1;
+    }
+
+    ShaderCompiler compiler;
+
+    std::unordered_set<std::string> compiledStages;
+    for (const auto& file : std::filesystem::recursive_directory_iterator("assets/shaders"))
+    {
+        if (!file.is_regular_file() || file.path().extension() != ".hlsl")
+        {
+            continue;
+        }
+
+        std::ifstream sourceFile(file.path());
+        std::string source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+
+        std::unordered_set<std::string> shaderStages = CheckShader(compiler, file.path().generic_string(), source);
+        compiledStages.insert(shaderStages.begin(), shaderStages.end());
+    }
+
+    // Optional stages defined in includes, the pack must not take them for missing
+    Check(compiledStages.contains("assets/shaders/ZPass.hlsl:MainTS USE_MESH_SHADING"), "ZPass.hlsl has a task stage with USE_MESH_SHADING");
+    Check(compiledStages.contains("assets/shaders/ZPass.hlsl:MainPS"), "ZPass.hlsl has a pixel stage");
+    Check(compiledStages.contains("assets/shaders/ZPrepass.hlsl:MainMS USE_MESH_SHADING"), "ZPrepass.hlsl has a USE_MESH_SHADING permutation");
+    Check(compiledStages.contains("assets/shaders/ZPrepass.hlsl:MainTS USE_MESH_SHADING"), "ZPrepass.hlsl has a task stage with USE_MESH_SHADING");
+
+    std::unordered_set<std::string> dependencies;
+    compiler.CompileToSpirv("assets/shaders/ZPass.hlsl", ShaderStageVertex, "MainVS", {}, dependencies);
+    Check(dependencies.contains("assets/shaders/ZPassCommon.hlsli"), "ZPass.hlsl reports ZPassCommon.hlsli as a dependency");
+
+    // Hot reload retries a failed shader when one of its includes changes, so the includes must be known even on failure
+    std::filesystem::path brokenDirectory = std::filesystem::temp_directory_path() / "ShaderCompileTest";
+    std::filesystem::create_directories(brokenDirectory);
+    WriteFile(brokenDirectory / "Broken.hlsli", "static const float VALUE = 1.0f;\n");
+    WriteFile(brokenDirectory / "Broken.hlsl", "#include \"Broken.hlsli\"\n[numthreads(1, 1, 1)]\nvoid MainCS() { undeclared = VALUE; }\n");
+
+    std::string brokenShader = (brokenDirectory / "Broken.hlsl").generic_string();
+    std::unordered_set<std::string> brokenDependencies;
+    bool isEntryPointMissing = false;
+    std::vector<uint8_t> brokenSpirv = compiler.CompileToSpirv(brokenShader, ShaderStageCompute, "MainCS", {}, brokenDependencies, &isEntryPointMissing);
+
+    Check(brokenSpirv.empty(), "a shader with errors produces no SPIR-V");
+    Check(!isEntryPointMissing, "a shader with errors isn't taken for a missing stage");
+    Check(brokenDependencies.contains((brokenDirectory / "Broken.hlsli").generic_string()), "a shader with errors still reports its includes");
+
+    std::filesystem::remove_all(brokenDirectory);
+
+    if (s_failedCount != 0)
+    {
+        LogError("{} shader compile checks failed", s_failedCount);
+        return 1;
+    }
+
+    LogInfo("All shader compile checks passed, {} stages", compiledStages.size());
+
+    return 0;
+}
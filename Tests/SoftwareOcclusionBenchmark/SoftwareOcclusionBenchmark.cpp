@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Framework/Common.h>
+
+#include <Engine/Rendering/OcclusionBuffer.h>
+
+// Times a frame of CPU occlusion culling at the renderer's limits: the maximum number of occluders, each at the maximum
+// triangle count, in front of a field of objects. Setup, rasterization and the bounds tests are reported separately.
+
+const static int FRAME_COUNT = 200;
+const static int OBJECT_GRID_SIZE = 100;
+// SoftwareOcclusion::MAX_OCCLUDER_COUNT, its header needs the whole renderer
+const static int OCCLUDER_COUNT = 32;
+// Quads per side, two triangles each, kept under SoftwareOcclusion::MAX_OCCLUDER_TRIANGLE_COUNT
+const static int OCCLUDER_DIVISIONS = 31;
+
+struct Occluder
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    glm::mat4 transform = glm::mat4(1.0f);
+};
+
+// Unit grid in the XY plane facing +Z
+static Occluder CreateOccluder(const glm::vec3& position, float halfSize)
+{
+    Occluder occluder;
+
+    for (int y = 0; y <= OCCLUDER_DIVISIONS; y++)
+    {
+        for (int x = 0; x <= OCCLUDER_DIVISIONS; x++)
+        {
+            occluder.positions.emplace_back(-1.0f + 2.0f * x / OCCLUDER_DIVISIONS, -1.0f + 2.0f * y / OCCLUDER_DIVISIONS, 0.0f);
+        }
+    }
+
+    for (int y = 0; y < OCCLUDER_DIVISIONS; y++)
+    {
+        for (int x = 0; x < OCCLUDER_DIVISIONS; x++)
+        {
+            uint32_t corner = (uint32_t)(y * (OCCLUDER_DIVISIONS + 1) + x);
+            uint32_t quad[4] = { corner, corner + 1, corner + OCCLUDER_DIVISIONS + 2, corner + OCCLUDER_DIVISIONS + 1 };
+            occluder.indices.insert(occluder.indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+        }
+    }
+
+    occluder.transform = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(halfSize));
+
+    return occluder;
+}
+
+int main()
+{
+    glm::mat4 proj = glm::perspective(glm::radians(80.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projView = proj * view;
+
+    // A row of walls with gaps between them, like buildings along a street
+    std::vector<Occluder> occluders;
+    for (int i = 0; i < OCCLUDER_COUNT; i++)
+    {
+        float x = ((float)(i % 8) - 3.5f) * 6.0f;
+        float z = -15.0f - (float)(i / 8) * 10.0f;
+        occluders.push_back(CreateOccluder(glm::vec3(x, 2.0f, z), 2.5f));
+    }
+
+    std::vector<glm::vec3> objectCenters;
+    for (int z = 0; z < OBJECT_GRID_SIZE; z++)
+    {
+        for (int x = 0; x < OBJECT_GRID_SIZE; x++)
+        {
+            objectCenters.emplace_back(((float)x - OBJECT_GRID_SIZE * 0.5f) * 2.0f, 1.0f, -20.0f - (float)z * 2.0f);
+        }
+    }
+
+    OcclusionBuffer buffer;
+
+    double setupTime = 0.0;
+    double rasterizeTime = 0.0;
+    double visibilityTime = 0.0;
+    int occludedCount = 0;
+
+    for (int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        buffer.Clear(16.0f / 9.0f);
+        for (const Occluder& occluder : occluders)
+        {
+            buffer.AddOccluder(occluder.positions, occluder.indices, projView * occluder.transform, false);
+        }
+
+        auto setupEndTime = std::chrono::steady_clock::now();
+
+        buffer.Rasterize();
+
+        auto rasterizeEndTime = std::chrono::steady_clock::now();
+
+        occludedCount = 0;
+        for (const glm::vec3& center : objectCenters)
+        {
+            occludedCount += buffer.IsVisible(center - glm::vec3(0.5f), center + glm::vec3(0.5f), projView) ? 0 : 1;
+        }
+
+        auto endTime = std::chrono::steady_clock::now();
+
+        setupTime += std::chrono::duration<double, std::milli>(setupEndTime - startTime).count();
+        rasterizeTime += std::chrono::duration<double, std::milli>(rasterizeEndTime - setupEndTime).count();
+        visibilityTime += std::chrono::duration<double, std::milli>(endTime - rasterizeEndTime).count();
+    }
+
+    LogInfo("{} occluders, {} triangles after setup, {}x{} buffer", occluders.size(), buffer.GetTriangleCount(), buffer.GetWidth(), buffer.GetHeight());
+    LogInfo("Triangle setup: {:.3f} ms per frame", setupTime / FRAME_COUNT);
+    LogInfo("Rasterization: {:.3f} ms per frame", rasterizeTime / FRAME_COUNT);
+    LogInfo("Bounds tests: {:.3f} ms per frame, {} of {} objects occluded", visibilityTime / FRAME_COUNT, occludedCount, objectCenters.size());
+    LogInfo("Total: {:.3f} ms per frame", (setupTime + rasterizeTime + visibilityTime) / FRAME_COUNT);
+
+    return 0;
+}
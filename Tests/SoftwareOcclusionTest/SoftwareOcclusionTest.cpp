@@ -0,0 +1,212 @@
+#include <cmath>
+#include <format>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Framework/Common.h>
+
+#include <TestCheck.h>
+
+#include <Engine/Rendering/OcclusionBuffer.h>
+
+// Unit tests of the CPU occlusion rasterizer and bounds tests. The camera sits at the origin looking down -Z with the
+// engine's projection, so depth is in the 0..1 range.
+
+const static float NEAR_PLANE = 0.1f;
+const static float FAR_PLANE = 1000.0f;
+const static float ASPECT_RATIO = 16.0f / 9.0f;
+
+struct Occluder
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
+// Grid of quads in the XY plane facing +Z, counter-clockwise when seen from the camera
+static Occluder CreateWall(float halfSize, float z, int divisions = 1)
+{
+    Occluder wall;
+
+    for (int y = 0; y <= divisions; y++)
+    {
+        for (int x = 0; x <= divisions; x++)
+        {
+            wall.positions.emplace_back(-halfSize + 2.0f * halfSize * x / divisions, -halfSize + 2.0f * halfSize * y / divisions, z);
+        }
+    }
+
+    for (int y = 0; y < divisions; y++)
+    {
+        for (int x = 0; x < divisions; x++)
+        {
+            uint32_t corner = (uint32_t)(y * (divisions + 1) + x);
+            uint32_t quad[4] = { corner, corner + 1, corner + divisions + 2, corner + divisions + 1 };
+            wall.indices.insert(wall.indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+        }
+    }
+
+    return wall;
+}
+
+static Occluder Flip(Occluder occluder)
+{
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+    {
+        std::swap(occluder.indices[i + 1], occluder.indices[i + 2]);
+    }
+
+    return occluder;
+}
+
+static glm::mat4 GetProjView()
+{
+    glm::mat4 proj = glm::perspective(glm::radians(80.0f), ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    return proj * view;
+}
+
+static void Rasterize(OcclusionBuffer& buffer, const std::vector<Occluder>& occluders, bool isDoubleSided = false)
+{
+    buffer.Clear(ASPECT_RATIO);
+    for (const Occluder& occluder : occluders)
+    {
+        buffer.AddOccluder(occluder.positions, occluder.indices, GetProjView(), isDoubleSided);
+    }
+    buffer.Rasterize();
+}
+
+static bool IsBoxVisible(const OcclusionBuffer& buffer, const glm::vec3& center, float halfSize)
+{
+    return buffer.IsVisible(center - glm::vec3(halfSize), center + glm::vec3(halfSize), GetProjView());
+}
+
+static int CountCoveredPixels(const OcclusionBuffer& buffer)
+{
+    int count = 0;
+    for (int y = 0; y < buffer.GetHeight(); y++)
+    {
+        for (int x = 0; x < buffer.GetWidth(); x++)
+        {
+            count += buffer.GetDepth(x, y) < 1.0f ? 1 : 0;
+        }
+    }
+
+    return count;
+}
+
+static void TestEmpty(OcclusionBuffer& buffer)
+{
+    Rasterize(buffer, {});
+
+    Check(buffer.GetWidth() == (int)OcclusionBuffer::WIDTH && buffer.GetHeight() == 180, "buffer height follows the aspect ratio");
+    Check(CountCoveredPixels(buffer) == 0, "empty buffer has no depth");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 1.0f), "nothing is occluded by an empty buffer");
+}
+
+static void TestDepth(OcclusionBuffer& buffer)
+{
+    Rasterize(buffer, { CreateWall(100.0f, -10.0f) });
+
+    // Projection with 0..1 depth, the wall is parallel to the near plane so its depth is the same everywhere
+    float expectedDepth = FAR_PLANE / (FAR_PLANE - NEAR_PLANE) * (1.0f - NEAR_PLANE / 10.0f);
+
+    Check(CountCoveredPixels(buffer) == buffer.GetWidth() * buffer.GetHeight(), "screen filling wall covers every pixel");
+    Check(std::abs(buffer.GetDepth(0, 0) - expectedDepth) < 1e-5f, "wall depth matches the projection at a corner");
+    Check(std::abs(buffer.GetDepth(buffer.GetWidth() / 2, buffer.GetHeight() / 2) - expectedDepth) < 1e-5f, "wall depth matches the projection at the center");
+}
+
+static void TestVisibility(OcclusionBuffer& buffer)
+{
+    Rasterize(buffer, { CreateWall(2.0f, -10.0f) });
+
+    Check(!IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 1.0f), "box behind the wall is occluded");
+    Check(!IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 3.0f), "box behind the wall and covered on screen is occluded");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 6.0f), "box larger than the wall on screen is visible");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -5.0f), 1.0f), "box in front of the wall is visible");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -10.0f), 0.5f), "box intersecting the wall is visible");
+    Check(IsBoxVisible(buffer, glm::vec3(8.0f, 0.0f, -20.0f), 1.0f), "box beside the wall is visible");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, 20.0f), 1.0f), "box behind the camera is visible");
+    Check(IsBoxVisible(buffer, glm::vec3(1000.0f, 0.0f, -20.0f), 1.0f), "off screen box is visible");
+}
+
+static void TestBackFaces(OcclusionBuffer& buffer)
+{
+    Occluder backFacing = Flip(CreateWall(2.0f, -10.0f));
+
+    Rasterize(buffer, { backFacing });
+    Check(CountCoveredPixels(buffer) == 0, "back facing single sided occluder isn't rasterized");
+
+    Rasterize(buffer, { backFacing }, true);
+    Check(CountCoveredPixels(buffer) > 0, "back facing double sided occluder is rasterized");
+    Check(!IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 1.0f), "back facing double sided occluder occludes");
+}
+
+// Pixel centers on edges shared by two triangles must be covered by one of them
+static void TestWatertight(OcclusionBuffer& buffer)
+{
+    Rasterize(buffer, { CreateWall(100.0f, -10.0f, 37) });
+    Check(CountCoveredPixels(buffer) == buffer.GetWidth() * buffer.GetHeight(), "subdivided wall leaves no cracks");
+    Check(!IsBoxVisible(buffer, glm::vec3(3.0f, -2.0f, -20.0f), 2.0f), "subdivided wall occludes");
+}
+
+static void TestNearPlane(OcclusionBuffer& buffer)
+{
+    // The apex is in front of the camera but closer than the near plane, where the clip space Z is negative yet above -W.
+    // Rasterizing it would write negative depth and occlude everything
+    Occluder triangle;
+    triangle.positions = { glm::vec3(-20.0f, -20.0f, -10.0f), glm::vec3(20.0f, -20.0f, -10.0f), glm::vec3(0.0f, 0.0f, -0.7f * NEAR_PLANE) };
+    triangle.indices = { 0, 1, 2 };
+
+    Rasterize(buffer, { triangle }, true);
+    Check(CountCoveredPixels(buffer) == 0, "triangle crossing the near plane is skipped");
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, -5.0f, -20.0f), 1.0f), "triangle crossing the near plane occludes nothing");
+
+    Rasterize(buffer, { CreateWall(100.0f, -10.0f) });
+    Check(IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -NEAR_PLANE), 0.5f * NEAR_PLANE), "bounds crossing the near plane are visible");
+}
+
+// Workers are reused between frames, every frame must see its own occluders only
+static void TestFrames(OcclusionBuffer& buffer)
+{
+    for (int frame = 0; frame < 100; frame++)
+    {
+        float z = frame % 2 == 0 ? -10.0f : -30.0f;
+        Rasterize(buffer, { CreateWall(100.0f, z, 4) });
+
+        float expectedDepth = FAR_PLANE / (FAR_PLANE - NEAR_PLANE) * (1.0f + NEAR_PLANE / z);
+        if (std::abs(buffer.GetDepth(buffer.GetWidth() - 1, buffer.GetHeight() - 1) - expectedDepth) > 1e-5f ||
+            IsBoxVisible(buffer, glm::vec3(0.0f, 0.0f, -20.0f), 1.0f) != (z < -20.0f))
+        {
+            Check(false, std::format("frame {} sees the occluders of another frame", frame));
+            break;
+        }
+    }
+}
+
+int main()
+{
+    OcclusionBuffer buffer;
+
+    TestEmpty(buffer);
+    TestDepth(buffer);
+    TestVisibility(buffer);
+    TestBackFaces(buffer);
+    TestWatertight(buffer);
+    TestNearPlane(buffer);
+    TestFrames(buffer);
+
+    if (s_failedCount != 0)
+    {
+        LogError("{} software occlusion checks failed", s_failedCount);
+        return 1;
+    }
+
+    LogInfo("All software occlusion checks passed");
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include <Framework/Common.h>
+
+// Check fixture shared by the tests. A failed check is logged and counted, tests return non-zero if s_failedCount isn't zero.
+
+inline int s_failedCount = 0;
+
+inline void Check(bool condition, const std::string& description)
+{
+    if (!condition)
+    {
+        LogError("FAILED: {}", description);
+        s_failedCount++;
+    }
+}
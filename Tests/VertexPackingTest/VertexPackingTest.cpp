@@ -0,0 +1,225 @@
+#include <cmath>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Framework/Common.h>
+
+#include <TestCheck.h>
+
+#include <Loaders/VertexPacking.h>
+
+// Checks that every vertex packing kernel the CPU supports is bit exact with the scalar one.
+// Counts aren't multiples of the SIMD width, so the scalar tails run too. Edge cases go first, followed by random data.
+
+// Interleaved like a mesh vertex, directions are read with a stride
+const static size_t DIRECTION_STRIDE = 7;
+
+struct PackingInput
+{
+    std::vector<float> positions;
+    std::vector<float> directions;
+    std::vector<float> values;
+    float positionsMin[3] = { -2.0f, 0.0f, -0.5f };
+    float positionsExtent[3] = { 4.0f, 0.0f, 1.0f };
+    // Scale of exactly one on X, so rounding ties survive the quantization math
+    float valuesMin[2] = { 0.0f, -1.0f };
+    float valuesExtent[2] = { 65535.0f, 3.0f };
+};
+
+struct PackingOutput
+{
+    std::vector<uint16_t> positions;
+    std::vector<uint32_t> directions;
+    std::vector<uint32_t> values;
+};
+
+static void AddDirection(PackingInput& input, float x, float y, float z)
+{
+    size_t first = input.directions.size();
+    input.directions.resize(first + DIRECTION_STRIDE, 123.0f);
+    input.directions[first + 0] = x;
+    input.directions[first + 1] = y;
+    input.directions[first + 2] = z;
+}
+
+static PackingInput CreateInput()
+{
+    PackingInput input;
+
+    // Zero length, signed zeros and axes, the lower hemisphere folds
+    const float directions[][3] =
+    {
+        { 0.0f, 0.0f, 0.0f },
+        { -0.0f, -0.0f, -0.0f },
+        { 0.0f, -0.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { -1.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, -1.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { -0.0f, 0.0f, -1.0f },
+        { 0.0f, -0.0f, -1.0f },
+        { -0.0f, -0.0f, -1.0f },
+        { 0.0f, 0.0f, -0.0f },
+        { 0.5f, 0.5f, -0.5f },
+        { -0.5f, 0.5f, -0.5f },
+        { 0.5f, -0.5f, -0.5f },
+        { -0.5f, -0.5f, -0.5f },
+        { 0.3f, -0.7f, -1e-30f },
+        { 1e-30f, 1e-30f, -1e-30f },
+        { 1e30f, -1e30f, -1e30f },
+        { 3.0f, 4.0f, -5.0f }
+    };
+
+    for (const float* direction : directions)
+    {
+        AddDirection(input, direction[0], direction[1], direction[2]);
+    }
+
+    // Below, at and above the range, signed zero and a zero extent axis
+    const float positions[][3] =
+    {
+        { -2.0f, 0.0f, -0.5f },
+        { 2.0f, 0.0f, 0.5f },
+        { -3.0f, -1.0f, -1.0f },
+        { 5.0f, 1.0f, 1.0f },
+        { -0.0f, -0.0f, -0.0f },
+        { 0.25f, 7.0f, 0.125f },
+        { 1e30f, -1e30f, 1e30f },
+        { -1e30f, 1e30f, -1e30f }
+    };
+
+    for (const float* position : positions)
+    {
+        input.positions.insert(input.positions.end(), position, position + 3);
+    }
+
+    const float values[][2] =
+    {
+        { 0.0f, -1.0f },
+        { 65535.0f, 2.0f },
+        { -0.5f, -5.0f },
+        { 70000.0f, 5.0f },
+        { -0.0f, -0.0f },
+        { 2.5f, 0.5f },
+        { 3.5f, 0.5f },
+        { 1e30f, -1e30f }
+    };
+
+    for (const float* value : values)
+    {
+        input.values.insert(input.values.end(), value, value + 2);
+    }
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-1.5f, 1.5f);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        AddDirection(input, distribution(random), distribution(random), distribution(random));
+        input.positions.push_back(distribution(random) * 2.0f);
+        input.positions.push_back(distribution(random));
+        input.positions.push_back(distribution(random) * 0.5f);
+        input.values.push_back(distribution(random) * 65535.0f);
+        input.values.push_back(distribution(random) * 3.0f);
+    }
+
+    return input;
+}
+
+static PackingOutput Pack(const PackingInput& input)
+{
+    size_t positionsCount = input.positions.size() / 3;
+    size_t directionsCount = input.directions.size() / DIRECTION_STRIDE;
+    size_t valuesCount = input.values.size() / 2;
+
+    PackingOutput output;
+    output.positions.resize(positionsCount * 4);
+    output.directions.resize(directionsCount);
+    output.values.resize(valuesCount);
+
+    VertexPacking::PackPositions(input.positions.data(), positionsCount, input.positionsMin, input.positionsExtent, output.positions.data());
+    VertexPacking::PackDirections(input.directions.data(), DIRECTION_STRIDE, directionsCount, output.directions.data());
+    VertexPacking::PackUnorm16x2(input.values.data(), valuesCount, input.valuesMin, input.valuesExtent, output.values.data());
+
+    return output;
+}
+
+template<typename T>
+static void CheckEqual(const std::vector<T>& values, const std::vector<T>& expected, const char* kernelName, const char* streamName)
+{
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        if (values[i] != expected[i])
+        {
+            Check(false, std::format("{} {} element {} is {:#x}, scalar packs {:#x}", kernelName, streamName, i, values[i], expected[i]));
+            return;
+        }
+    }
+}
+
+// Known values, so the scalar reference itself is checked and not only the SIMD kernels against it
+static void CheckScalar(const PackingOutput& output)
+{
+    Check(output.directions[0] == 0, "zero length direction packs to zero");
+    Check(output.directions[1] == 0, "negative zero length direction packs to zero");
+    Check(output.directions[3] == 0x00007fff, "+X packs to (1, 0)");
+    Check(output.directions[4] == 0x00008001, "-X packs to (-1, 0)");
+    Check(output.directions[7] == 0x00000000, "+Z packs to (0, 0)");
+    Check(output.directions[8] == 0x7fff7fff, "-Z folds to (1, 1)");
+    Check(output.directions[11] == 0x7fff7fff, "-Z with negative zero X and Y folds to (1, 1)");
+    Check(output.directions[16] == 0xaaabaaab, "(-1, -1, -1) folds to (-2/3, -2/3)");
+
+    Check(output.positions[0] == 0 && output.positions[1] == 0 && output.positions[2] == 0, "minimum position packs to zero");
+    Check(output.positions[4] == 65535 && output.positions[6] == 65535, "maximum position packs to 65535");
+    Check(output.positions[8] == 0 && output.positions[10] == 0, "position below the range clamps to zero");
+    Check(output.positions[12] == 65535 && output.positions[14] == 65535, "position above the range clamps to 65535");
+    Check(output.positions[13] == 0 && output.positions[21] == 0, "zero extent axis packs to zero");
+    Check(output.positions[3] == 0 && output.positions[7] == 0, "W is zero");
+
+    Check(output.values[2] == 0 && output.values[3] == 0xffffffff, "values clamp to the range");
+    Check((output.values[4] & 0xffff) == 0, "negative zero at the minimum packs to zero");
+    Check((output.values[5] & 0xffff) == 2 && (output.values[6] & 0xffff) == 4, "rounding ties go to even");
+}
+
+int main()
+{
+    VertexPackingKernel widestKernel = VertexPacking::GetKernel();
+
+    PackingInput input = CreateInput();
+
+    VertexPacking::SetKernel(VertexPackingKernel::Scalar);
+    PackingOutput expected = Pack(input);
+    CheckScalar(expected);
+
+    for (VertexPackingKernel kernel : { VertexPackingKernel::SSE2, VertexPackingKernel::AVX2 })
+    {
+        const char* kernelName = VertexPacking::GetKernelName(kernel);
+
+        if (!VertexPacking::SetKernel(kernel))
+        {
+            LogWarning("{} kernel isn't supported by this CPU, skipped", kernelName);
+            continue;
+        }
+
+        PackingOutput output = Pack(input);
+        CheckEqual(output.positions, expected.positions, kernelName, "positions");
+        CheckEqual(output.directions, expected.directions, kernelName, "directions");
+        CheckEqual(output.values, expected.values, kernelName, "unorm16x2");
+    }
+
+    VertexPacking::SetKernel(widestKernel);
+
+    if (s_failedCount != 0)
+    {
+        LogError("{} vertex packing checks failed", s_failedCount);
+        return 1;
+    }
+
+    LogInfo("All vertex packing kernels match the scalar one");
+
+    return 0;
+}
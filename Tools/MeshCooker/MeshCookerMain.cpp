@@ -0,0 +1,85 @@
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include <Framework/Common.h>
+
+#include <Loaders/MeshCache.h>
+#include <Loaders/MeshCooker.h>
+
+// Cooks every scene under the given directory into the mesh cache next to it, so the first launch doesn't pay for it.
+// Caches that are already up to date with their source and the cooking settings are skipped.
+// With --benchmark-import nothing is cooked, glTF scenes are imported with both the native importer and assimp instead.
+
+static bool IsSceneFile(const std::filesystem::path& path)
+{
+    std::filesystem::path extension = path.extension();
+
+    return extension == ".gltf" || extension == ".glb" || extension == ".fbx" || extension == ".obj";
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path assetsDirectory = "assets";
+    bool isBenchmarkImport = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view(argv[i]) == "--benchmark-import")
+        {
+            isBenchmarkImport = true;
+        }
+        else
+        {
+            assetsDirectory = argv[i];
+        }
+    }
+
+    if (!std::filesystem::is_directory(assetsDirectory))
+    {
+        LogError("Assets directory {} not found", assetsDirectory.string());
+        return 1;
+    }
+
+    int cookedCount = 0;
+    int upToDateCount = 0;
+    int failedCount = 0;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(assetsDirectory))
+    {
+        if (!file.is_regular_file() || !IsSceneFile(file.path()))
+        {
+            continue;
+        }
+
+        if (isBenchmarkImport)
+        {
+            MeshCooker::BenchmarkImport(file.path());
+            continue;
+        }
+
+        std::filesystem::path cachePath = MeshCooker::GetCachePath(file.path());
+        uint64_t sourceHash = MeshCooker::CalculateSourceHash(file.path());
+
+        if (MeshCache::Load(cachePath, sourceHash, MeshCooker::GetSettingsHash()))
+        {
+            upToDateCount++;
+            continue;
+        }
+
+        std::vector<uint8_t> data;
+        if (!MeshCooker::Cook(file.path(), sourceHash, data) || !MeshCacheWriter::Write(cachePath, data))
+        {
+            LogError("Failed to cook {}", file.path().string());
+            failedCount++;
+            continue;
+        }
+
+        LogInfo("Cooked {} into {}", file.path().string(), cachePath.string());
+        cookedCount++;
+    }
+
+    LogInfo("Cooked {} scenes, {} up to date, {} failed", cookedCount, upToDateCount, failedCount);
+
+    return failedCount == 0 ? 0 : 1;
+}
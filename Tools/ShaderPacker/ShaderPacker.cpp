@@ -0,0 +1,74 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Framework/Common.h>
+
+#include <Engine/Rendering/Backend/ShaderCompiler.h>
+#include <Engine/Rendering/Backend/ShaderPack.h>
+
+// Compiles every permutation of every shader under the shaders directory and writes them into a single pack.
+// Permutations and stages are listed by ShaderPack::GetPermutations and ShaderPack::GetStages.
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path shadersDirectory = argc > 1 ? argv[1] : "assets/shaders";
+    std::filesystem::path outputPath = argc > 2 ? argv[2] : "assets/shaders.pack";
+
+    if (!std::filesystem::is_directory(shadersDirectory))
+    {
+        LogError("Shaders directory {} not found", shadersDirectory.string());
+        return 1;
+    }
+
+    ShaderCompiler compiler;
+    ShaderPackWriter writer;
+
+    int compiledCount = 0;
+    int failedCount = 0;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(shadersDirectory))
+    {
+        if (!file.is_regular_file() || file.path().extension() != ".hlsl")
+        {
+            continue;
+        }
+
+        std::ifstream sourceFile(file.path());
+        std::string source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+
+        std::string shaderName = file.path().generic_string();
+
+        for (const ShaderDefines& defines : ShaderPack::GetPermutations(source))
+        {
+            for (const ShaderPackedStage& stage : ShaderPack::GetStages(source, defines))
+            {
+                std::unordered_set<std::string> dependencies;
+                bool isEntryPointMissing = false;
+                std::vector<uint8_t> spirv = compiler.CompileToSpirv(shaderName, stage.stage, stage.entryPoint, defines, dependencies, &isEntryPointMissing);
+
+                // Entry points may come from includes or depend on the defines, so only the compiler knows whether the stage exists.
+                // Missing optional stages are packed empty so the runtime doesn't fall back to DXC for them.
+                if (spirv.empty() && (stage.isRequired || !isEntryPointMissing))
+                {
+                    LogError("Failed to compile {}:{}", shaderName, stage.entryPoint);
+                    failedCount++;
+                    continue;
+                }
+
+                compiledCount += isEntryPointMissing ? 0 : 1;
+                writer.Add(shaderName, defines, stage.stage, stage.entryPoint, std::move(spirv), dependencies);
+            }
+        }
+    }
+
+    if (!writer.Write(outputPath))
+    {
+        return 1;
+    }
+
+    LogInfo("Packed {} shader stages into {}, {} failed", compiledCount, outputPath.string(), failedCount);
+
+    return failedCount == 0 ? 0 : 1;
+}
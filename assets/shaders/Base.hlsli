@@ -152,7 +152,25 @@ struct RWArrayBuffer : ArrayBuffer
     {
         VALIDATE_HANDLE();
         RWByteAddressBuffer buffer = DESCRIPTOR_HEAP(RWByteBufferHandle, handle.Read());
-        WriteStructure result = buffer.Store<WriteStructure>(sizeof(WriteStructure) * index, data);
+        buffer.Store<WriteStructure>(sizeof(WriteStructure) * index, data);
+    }
+
+    // Adds to the 32-bit word at the index and returns its previous value
+    uint InterlockedAdd(uint index, uint value)
+    {
+        VALIDATE_HANDLE_RET(uint);
+        RWByteAddressBuffer buffer = DESCRIPTOR_HEAP(RWByteBufferHandle, handle.Read());
+        uint original;
+        buffer.InterlockedAdd(index * 4, value, original);
+        return original;
+    }
+
+    // Lowers the 32-bit word at the index to the value if it's greater
+    void InterlockedMin(uint index, uint value)
+    {
+        VALIDATE_HANDLE();
+        RWByteAddressBuffer buffer = DESCRIPTOR_HEAP(RWByteBufferHandle, handle.Read());
+        buffer.InterlockedMin(index * 4, value);
     }
 };
 
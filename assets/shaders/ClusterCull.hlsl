@@ -0,0 +1,96 @@
+// Permutations: USE_BACK_FACE_CULL
+#define USE_CLUSTER_CULLING
+#include "ZPassCommon.hlsli"
+
+// Culls the meshlets of one object for the vertex path and appends the triangles of the accepted ones to its compacted
+// index ranges. The draw arguments are two VkDrawIndexedIndirectCommand, one per index range, followed by the capacity
+// of a range and the size of an index, see ZPassRenderer::ResetClusterDraws. The late occlusion phase fills the second range.
+
+static const uint DRAW_ARGS_STRIDE = 5;
+static const uint DRAW_ARGS_FIRST_INDEX = 2;
+static const uint DRAW_ARGS_CAPACITY = 10;
+static const uint DRAW_ARGS_INDEX_SIZE = 11;
+
+uint3 LoadTriangle(Meshlet meshlet, uint index)
+{
+    uint3 localIndices = LoadMeshletTriangle(meshlet, index);
+
+    return uint3(LoadMeshletVertex(meshlet, localIndices.x), LoadMeshletVertex(meshlet, localIndices.y), LoadMeshletVertex(meshlet, localIndices.z));
+}
+
+[numthreads(64, 1, 1)]
+void MainCS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint meshletId = drawData.meshletOffset + DTid.x;
+
+    Meshlet meshlet = (Meshlet)0;
+    bool accept = false;
+    if (DTid.x < drawData.meshletCount)
+    {
+        meshlet = drawData.meshlets.Load<Meshlet>(meshletId);
+        accept = IsMeshletAccepted(meshlet, meshletId, DTid.x);
+    }
+
+    uint argsOffset = drawData.clusterDrawArgsOffset;
+    uint capacity = drawData.clusterDrawArgs.Load<uint>(argsOffset + DRAW_ARGS_CAPACITY);
+    bool isShortIndex = drawData.clusterDrawArgs.Load<uint>(argsOffset + DRAW_ARGS_INDEX_SIZE) == 2;
+
+    // 16-bit indices are stored a pair of triangles per three words, odd triangle counts are padded with a degenerate one
+    uint triangleCount = isShortIndex ? (meshlet.triangleCount + 1) & ~1u : meshlet.triangleCount;
+
+    // One atomic per wave reserves the indices of all of its accepted meshlets
+    uint indexCount = accept ? triangleCount * 3 : 0;
+    uint waveOffset = WavePrefixSum(indexCount);
+    uint waveIndexCount = WaveActiveSum(indexCount);
+
+    uint range = drawData.cullPhase == CULL_PHASE_LATE ? 1 : 0;
+    uint countIndex = argsOffset + range * DRAW_ARGS_STRIDE;
+
+    uint waveBase = 0;
+    if (WaveIsFirstLane() && waveIndexCount > 0)
+    {
+        waveBase = drawData.clusterDrawArgs.InterlockedAdd(countIndex, waveIndexCount);
+
+        // Every wave that takes the count past the capacity lowers it back, so the draw never reads past the range
+        if (waveBase + waveIndexCount > capacity)
+        {
+            drawData.clusterDrawArgs.InterlockedMin(countIndex, capacity);
+        }
+    }
+    waveBase = WaveReadLaneFirst(waveBase);
+
+    uint start = waveBase + waveOffset;
+    if (!accept || start >= capacity)
+    {
+        return;
+    }
+
+    // Ranges, reservations and the capacity are multiples of a whole store, a meshlet crossing the capacity stores what fits
+    uint storeCount = min(indexCount, capacity - start);
+    uint firstIndex = drawData.clusterDrawArgs.Load<uint>(countIndex + DRAW_ARGS_FIRST_INDEX) + start;
+
+    if (isShortIndex)
+    {
+        uint firstWord = firstIndex / 2;
+        for (uint i = 0; i < storeCount / 6; i++)
+        {
+            uint3 first = LoadTriangle(meshlet, i * 2);
+            uint3 second = i * 2 + 1 < meshlet.triangleCount ? LoadTriangle(meshlet, i * 2 + 1) : first.xxx;
+
+            drawData.clusterIndices.Store<uint>(firstWord + i * 3 + 0, first.x | (first.y << 16));
+            drawData.clusterIndices.Store<uint>(firstWord + i * 3 + 1, first.z | (second.x << 16));
+            drawData.clusterIndices.Store<uint>(firstWord + i * 3 + 2, second.y | (second.z << 16));
+        }
+    }
+    else
+    {
+        for (uint i = 0; i < storeCount / 3; i++)
+        {
+            uint3 indices = LoadTriangle(meshlet, i);
+
+            drawData.clusterIndices.Store<uint>(firstIndex + i * 3 + 0, indices.x);
+            drawData.clusterIndices.Store<uint>(firstIndex + i * 3 + 1, indices.y);
+            drawData.clusterIndices.Store<uint>(firstIndex + i * 3 + 2, indices.z);
+        }
+    }
+}
@@ -18,10 +18,16 @@ struct PerFrameData
     float4 cameraPosition;
     float4 lightDirection;
     float4 lightColorIntensity;
+    float4 frustumPlanes[6];
     Texture brdfLutTexture;
     Texture convolutedCubemapTexture;
     Texture prefilteredCubemapTextures[5];
     Sampler samplerDesc;
+    float lodErrorScale;
+    Texture hiZTextures[16];
+    uint hiZLevelCount;
+    uint renderWidth;
+    uint renderHeight;
 };
 
 float2 ToDixectXCoordSystem(float2 pos)
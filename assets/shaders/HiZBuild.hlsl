@@ -0,0 +1,32 @@
+#include "Common.hlsli"
+
+struct DrawData
+{
+    Texture source;
+    RWTexture destination;
+    uint sourceWidth;
+    uint sourceHeight;
+    uint width;
+    uint height;
+};
+
+PUSH_CONSTANTS(DrawData, drawData);
+
+// Keeps the farthest depth of the 2x2 source texels, the last row and column of odd sources are clamped
+[numthreads(8, 8, 1)]
+void MainCS(uint3 DTid : SV_DispatchThreadID)
+{
+    if (DTid.x >= drawData.width || DTid.y >= drawData.height)
+    {
+        return;
+    }
+
+    uint2 sourceMax = uint2(drawData.sourceWidth, drawData.sourceHeight) - 1;
+    uint2 texel = DTid.xy * 2;
+
+    float depth = max(
+        max(drawData.source.Load2D<float>(min(texel, sourceMax)), drawData.source.Load2D<float>(min(texel + uint2(1, 0), sourceMax))),
+        max(drawData.source.Load2D<float>(min(texel + uint2(0, 1), sourceMax)), drawData.source.Load2D<float>(min(texel + uint2(1, 1), sourceMax))));
+
+    drawData.destination.Store2D<float>(DTid.xy, depth);
+}
@@ -0,0 +1,146 @@
+#include "Common.hlsli"
+
+// Decodes vertex streams written by meshopt_encodeVertexBuffer, format version 0, into their final buffer.
+// Each thread decodes one 32-bit word of every vertex in a block: four byte streams of zigzag deltas,
+// starting from where the block table says they begin and from the vertex the block is predicted from.
+// Mirrors VertexCodec::BuildBlockTable.
+
+struct DrawData
+{
+    ArrayBuffer encoded;
+    ArrayBuffer blocks;
+    RWArrayBuffer decoded;
+    uint vertexCount;
+    uint vertexStride;
+    uint blockVertexCount;
+    uint blockCount;
+};
+
+PUSH_CONSTANTS(DrawData, drawData);
+
+static const uint GROUP_SIZE = 16;
+
+uint LoadByte(uint offset)
+{
+    return (drawData.encoded.Load<uint>(offset / 4) >> ((offset % 4) * 8)) & 0xff;
+}
+
+// Modes are all zeros, 2-bit or 4-bit values where the largest one escapes to a byte after the group, or raw bytes
+void DecodeGroup(uint mode, inout uint cursor, out uint deltas[GROUP_SIZE])
+{
+    if (mode == 0)
+    {
+        [unroll]
+        for (uint i = 0; i < GROUP_SIZE; i++)
+        {
+            deltas[i] = 0;
+        }
+        return;
+    }
+
+    if (mode == 3)
+    {
+        [unroll]
+        for (uint i = 0; i < GROUP_SIZE; i++)
+        {
+            deltas[i] = LoadByte(cursor + i);
+        }
+        cursor += GROUP_SIZE;
+        return;
+    }
+
+    uint bits = mode == 1 ? 2 : 4;
+    uint sentinel = (1u << bits) - 1;
+    uint valuesPerByte = 8 / bits;
+
+    uint escape = cursor + GROUP_SIZE / valuesPerByte;
+
+    [unroll]
+    for (uint i = 0; i < GROUP_SIZE; i++)
+    {
+        uint value = (LoadByte(cursor + i / valuesPerByte) >> (8 - bits * (i % valuesPerByte + 1))) & sentinel;
+        if (value == sentinel)
+        {
+            value = LoadByte(escape);
+            escape++;
+        }
+
+        deltas[i] = value;
+    }
+
+    cursor = escape;
+}
+
+uint Unzigzag(uint value)
+{
+    return (0u - (value & 1)) ^ (value >> 1);
+}
+
+[numthreads(64, 1, 1)]
+void MainCS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint wordCount = drawData.vertexStride / 4;
+    uint block = DTid.x / wordCount;
+    uint word = DTid.x % wordCount;
+    if (block >= drawData.blockCount)
+    {
+        return;
+    }
+
+    uint firstVertex = block * drawData.blockVertexCount;
+    uint vertexCount = min(drawData.blockVertexCount, drawData.vertexCount - firstVertex);
+    uint groupCount = (vertexCount + GROUP_SIZE - 1) / GROUP_SIZE;
+    uint headerSize = (groupCount + 3) / 4;
+
+    uint tableOffset = block * (drawData.vertexStride + wordCount);
+
+    uint headers[4];
+    uint cursors[4];
+    [unroll]
+    for (uint k = 0; k < 4; k++)
+    {
+        headers[k] = drawData.blocks.Load<uint>(tableOffset + word * 4 + k);
+        cursors[k] = headers[k] + headerSize;
+    }
+
+    uint previous = drawData.blocks.Load<uint>(tableOffset + drawData.vertexStride + word);
+
+    for (uint group = 0; group < groupCount; group++)
+    {
+        uint words[GROUP_SIZE];
+        [unroll]
+        for (uint i = 0; i < GROUP_SIZE; i++)
+        {
+            words[i] = 0;
+        }
+
+        [unroll]
+        for (uint k = 0; k < 4; k++)
+        {
+            uint mode = (LoadByte(headers[k] + group / 4) >> ((group % 4) * 2)) & 3;
+
+            uint deltas[GROUP_SIZE];
+            DecodeGroup(mode, cursors[k], deltas);
+
+            uint value = (previous >> (k * 8)) & 0xff;
+            [unroll]
+            for (uint i = 0; i < GROUP_SIZE; i++)
+            {
+                value = (value + Unzigzag(deltas[i])) & 0xff;
+                words[i] |= value << (k * 8);
+            }
+        }
+
+        previous = words[GROUP_SIZE - 1];
+
+        [unroll]
+        for (uint i = 0; i < GROUP_SIZE; i++)
+        {
+            uint vertex = group * GROUP_SIZE + i;
+            if (vertex < vertexCount)
+            {
+                drawData.decoded.Store<uint>((firstVertex + vertex) * wordCount + word, words[i]);
+            }
+        }
+    }
+}
@@ -1,3 +1,5 @@
+// Permutations: USE_TANGENTS_BITANGENTS USE_UV USE_VERTEX_COLOR USE_MESH_SHADING
+
 #include "Common.hlsli"
 #include "ZPassCommon.hlsli"
 
@@ -56,7 +58,7 @@ void MainMS(in uint3 groupId : SV_GroupID,
 {
     const uint meshletId = pl.meshletIndices[groupId.x];
 
-    if (meshletId >= drawData.meshletCount)
+    if (meshletId - drawData.meshletOffset >= drawData.meshletCount)
     {
         return;
     }
@@ -73,29 +75,30 @@ void MainMS(in uint3 groupId : SV_GroupID,
 
     const ModelMatrix model = drawData.perInstanceBuffer.Load<ModelMatrix>();
     const float4x4 projView = drawData.perFrameBuffer.Load<PerFrameData>().projView;
+    const MeshInfo meshInfo = drawData.meshInfo.Load<MeshInfo>();
 
-    const uint vertexOffset = meshlet.vertexOffset;
     for (uint i = groupThreadId.x; i < vtxCount; i += THREADS_PER_GROUP)
     {
-        const uint vertexIndex = drawData.meshletVertices.Load<uint>(vertexOffset + i);
+        const uint vertexIndex = LoadMeshletVertex(meshlet, i);
 
         VertToPix OUT = (VertToPix)0;
 
+        uint2 position = drawData.positions.Load<uint2>(vertexIndex);
         Vertex vertex = drawData.vertices.Load<Vertex>(vertexIndex);
 
-        float3 localPos = vertex.Position;
+        float3 localPos = DecodePosition(position.x, position.y, meshInfo);
         float4 worldPosition = mul(model.globalTransform, float4(localPos, 1.0f));
         OUT.Position = mul(projView, worldPosition);
         OUT.Position.y *= -1.0f;
         OUT.WorldPosition = worldPosition.xyz / worldPosition.w;
 
-        half3 localNormal = half3(vertex.NormalX, vertex.NormalY, vertex.NormalZ);
+        half3 localNormal = half3(DecodeOctahedral(vertex.Normal));
         half4 worldNormal = half4(mul(model.globalTransform, half4(localNormal, 0.0f)));
         OUT.Normal = normalize(worldNormal.xyz);
 
         #if defined(USE_TANGENTS_BITANGENTS)
-            half3 tangent = half3(vertex.TangentX, vertex.TangentY, vertex.TangentZ);
-            half3 bitangent = half3(vertex.BitangentX, vertex.BitangentY, vertex.BitangentZ);
+            half3 tangent = half3(DecodeOctahedral(vertex.Tangent));
+            half3 bitangent = cross(localNormal, tangent) * half(DecodeBitangentSign(position.y));
 
             half3 T = normalize(half3(mul(model.transpInvGlobalTransform, half4(tangent, 0.0f)).xyz));
             half3 B = normalize(half3(mul(model.transpInvGlobalTransform, half4(bitangent, 0.0f)).xyz));
@@ -105,11 +108,11 @@ void MainMS(in uint3 groupId : SV_GroupID,
         #endif
 
         #if defined(USE_UV)
-            OUT.TC = float2(vertex.TC_U, vertex.TC_V);
+            OUT.TC = DecodeUV(vertex.TC, meshInfo);
         #endif
 
         #if defined(USE_VERTEX_COLOR)
-            OUT.Color = float4(vertex.ColorR, vertex.ColorG, vertex.ColorB, vertex.ColorA);
+            OUT.Color = DecodeColor(vertex.Color);
         #endif
 
         #if defined(MESH_DEBUG)
@@ -120,11 +123,9 @@ void MainMS(in uint3 groupId : SV_GroupID,
         vertices[i] = OUT;
     }
 
-    const uint triangleOffset = meshlet.triangleOffset;
     for (uint i = groupThreadId.x; i < triangleCount; i += THREADS_PER_GROUP)
     {
-        uint indices = drawData.meshletIndices.Load<uint>(triangleOffset + i);
-        triangles[i] = uint3(indices & 0xff, (indices >> 8) & 0xff, (indices >> 16) & 0xff);
+        triangles[i] = LoadMeshletTriangle(meshlet, i);
     }
 }
 
@@ -134,27 +135,24 @@ VertToPix MainVS(in uint vertexId : SV_VertexID)
 {
     VertToPix OUT = (VertToPix)0;
 
-    uint vertexIndex = vertexId;
-    if (drawData.indices.IsValid())
-    {
-        vertexIndex = drawData.indices.Load<uint>(vertexId);
-    }
-
-    Vertex vertex = drawData.vertices.Load<Vertex>(vertexIndex);
+    // Indexed draw, so the id is the vertex fetched by the input assembler and repeated vertices hit the post-transform cache
+    uint2 position = drawData.positions.Load<uint2>(vertexId);
+    Vertex vertex = drawData.vertices.Load<Vertex>(vertexId);
     ModelMatrix model = drawData.perInstanceBuffer.Load<ModelMatrix>();
+    MeshInfo meshInfo = drawData.meshInfo.Load<MeshInfo>();
 
-    float3 localPos = vertex.Position;
+    float3 localPos = DecodePosition(position.x, position.y, meshInfo);
     float4 worldPosition = mul(model.globalTransform, float4(localPos, 1.0f));
     OUT.Position = mul(drawData.perFrameBuffer.Load<PerFrameData>().projView, worldPosition);
     OUT.WorldPosition = worldPosition.xyz / worldPosition.w;
 
-    half3 localNormal = half3(vertex.NormalX, vertex.NormalY, vertex.NormalZ);
+    half3 localNormal = half3(DecodeOctahedral(vertex.Normal));
     half4 worldNormal = half4(mul(model.globalTransform, half4(localNormal, 0.0f)));
     OUT.Normal = normalize(worldNormal.xyz);
 
     #if defined(USE_TANGENTS_BITANGENTS)
-        half3 tangent = half3(vertex.TangentX, vertex.TangentY, vertex.TangentZ);
-        half3 bitangent = half3(vertex.BitangentX, vertex.BitangentY, vertex.BitangentZ);
+        half3 tangent = half3(DecodeOctahedral(vertex.Tangent));
+        half3 bitangent = cross(localNormal, tangent) * half(DecodeBitangentSign(position.y));
 
         half3 T = normalize(half3(mul(model.transpInvGlobalTransform, half4(tangent, 0.0f)).xyz));
         half3 B = normalize(half3(mul(model.transpInvGlobalTransform, half4(bitangent, 0.0f)).xyz));
@@ -164,11 +162,11 @@ VertToPix MainVS(in uint vertexId : SV_VertexID)
     #endif
 
     #if defined(USE_UV)
-        OUT.TC = float2(vertex.TC_U, vertex.TC_V);
+        OUT.TC = DecodeUV(vertex.TC, meshInfo);
     #endif
 
     #if defined(USE_VERTEX_COLOR)
-        OUT.Color = float4(vertex.ColorR, vertex.ColorG, vertex.ColorB, vertex.ColorA);
+        OUT.Color = DecodeColor(vertex.Color);
     #endif
 
     return OUT;
@@ -196,7 +194,7 @@ float4 GetAldebo(in VertToPix IN, in MaterialProps materialProps)
 
 void GetAoRoughMet(in VertToPix IN, in MaterialProps materialProps, out float rough, out float met)
 {
-    if (materialProps.workflow == (int)Workflow::MetallicRoughness)
+    if (!IS_SPECULAR_GLOSSINESS)
     {
         rough = materialProps.aoMetRough.g;
         met = materialProps.aoMetRough.b;
@@ -256,7 +254,7 @@ float3 GetNormal(in VertToPix IN, in MaterialProps materialProps)
 
 float3 GetSpecularColor(in VertToPix IN, in MaterialProps materialProps)
 {
-    if (materialProps.workflow == (int)Workflow::MetallicRoughness)
+    if (!IS_SPECULAR_GLOSSINESS)
     {
         return materialProps.aoMetRough.b;
     }
@@ -337,7 +335,7 @@ PixOut MainPS(VertToPix IN)
     MaterialProps materialProps = drawData.materialProps.Load<MaterialProps>();
 
     float4 albedo = GetAldebo(IN, materialProps);
-    if (materialProps.alphaMode == (int)AlphaMode::Mask && albedo.a < materialProps.alphaCutoff)
+    if (IS_ALPHA_MASK && albedo.a < materialProps.alphaCutoff)
     {
         discard;
     }
@@ -348,7 +346,7 @@ PixOut MainPS(VertToPix IN)
     float ao = GetOcclusion(IN, materialProps);
 
     float3 F0 = 0.04f;
-    if (materialProps.workflow == (int)Workflow::MetallicRoughness)
+    if (!IS_SPECULAR_GLOSSINESS)
     {
         F0 = lerp(F0, albedo.rgb, metallness);
     }
@@ -10,42 +10,119 @@ struct ModelMatrix
     float4x4 transpInvGlobalTransform;
 };
 
+// Quantized shading attributes, written by MeshCooker::RetrieveMesh.
+// Positions are a separate stream of uint2 (XY, Z with the bitangent sign in the high half) shared with the depth only passes.
 struct Vertex
 {
-    float3 Position;
-    half NormalX, NormalY, NormalZ;
+    uint Normal;
 
     #if defined(USE_TANGENTS_BITANGENTS)
-        half TangentX, TangentY, TangentZ;
-        half BitangentX, BitangentY, BitangentZ;
+        uint Tangent;
     #endif
 
     #if defined(USE_UV)
-        half TC_U, TC_V;
+        uint TC;
     #endif
 
     #if defined(USE_VERTEX_COLOR)
-        half ColorR, ColorG, ColorB, ColorA;
+        uint Color;
     #endif
 };
 
+struct MeshInfo
+{
+    float3 positionMin;
+    float padding0;
+    float3 positionExtent;
+    float padding1;
+    float2 uvMin;
+    float2 uvExtent;
+};
+
+float2 UnpackUnorm16x2(uint packed)
+{
+    return float2(packed & 0xffff, packed >> 16) / 65535.0f;
+}
+
+float3 DecodePosition(uint xy, uint z, MeshInfo meshInfo)
+{
+    float3 position = float3(UnpackUnorm16x2(xy), float(z & 0xffff) / 65535.0f);
+
+    return meshInfo.positionMin + position * meshInfo.positionExtent;
+}
+
+// Octahedral mapping stored as two 16-bit snorm values
+float3 DecodeOctahedral(uint packed)
+{
+    float2 encoded = max(float2(asint(uint2(packed << 16, packed)) >> 16) / 32767.0f, -1.0f);
+
+    float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-direction.z);
+    direction.x += direction.x >= 0.0f ? -t : t;
+    direction.y += direction.y >= 0.0f ? -t : t;
+
+    return normalize(direction);
+}
+
+float DecodeBitangentSign(uint z)
+{
+    return (z >> 16) != 0 ? -1.0f : 1.0f;
+}
+
+float2 DecodeUV(uint packed, MeshInfo meshInfo)
+{
+    return meshInfo.uvMin + UnpackUnorm16x2(packed) * meshInfo.uvExtent;
+}
+
+float4 DecodeColor(uint packed)
+{
+    return float4(packed & 0xff, (packed >> 8) & 0xff, (packed >> 16) & 0xff, packed >> 24) / 255.0f;
+}
+
+// Material toggles are specialization constants so they don't multiply the permutations compiled from defines.
+// Compute pipelines take none, so cluster culling is compiled with a define per toggle instead.
+#if defined(USE_CLUSTER_CULLING)
+    #if defined(USE_BACK_FACE_CULL)
+        static const bool IS_BACK_FACE_CULL = true;
+    #else
+        static const bool IS_BACK_FACE_CULL = false;
+    #endif
+#else
+    [[vk::constant_id(0)]] const bool IS_BACK_FACE_CULL = false;
+#endif
+[[vk::constant_id(1)]] const bool IS_ALPHA_MASK = false;
+[[vk::constant_id(2)]] const bool IS_SPECULAR_GLOSSINESS = false;
+
+// Shared by the depth only and the shading passes, mirrors ZPassDrawData in ZPassRenderer.cpp
 struct DrawData
 {
-    int isBackFaceCull;
-    ArrayBuffer indices;
+    ArrayBuffer positions;
     ArrayBuffer vertices;
+    ArrayBuffer meshInfo;
     ArrayBuffer meshlets;
+    uint meshletOffset;
     uint meshletCount;
+    ArrayBuffer clusterLods;
     ArrayBuffer meshletIndices;
     ArrayBuffer meshletVertices;
     ArrayBuffer materialProps;
     ArrayBuffer perFrameBuffer;
     ArrayBuffer perInstanceBuffer;
+    RWArrayBuffer meshletVisibility;
+    uint cullPhase;
+    RWArrayBuffer clusterIndices;
+    RWArrayBuffer clusterDrawArgs;
+    uint clusterDrawArgsOffset;
 };
 
+// Mirrors ZPassCullPhase in ZPassRenderer.h
+static const uint CULL_PHASE_NONE = 0;
+static const uint CULL_PHASE_VISIBLE = 1;
+static const uint CULL_PHASE_LATE = 2;
+
 PUSH_CONSTANTS(DrawData, drawData);
 
-#if defined(USE_MESH_SHADING)
+#if defined(USE_MESH_SHADING) || defined(USE_CLUSTER_CULLING)
 
 #define THREADS_PER_GROUP 32
 #define MAX_VERTICES_COUNT 64
@@ -62,48 +139,221 @@ struct Meshlet
     uint vertexCount;
     uint triangleOffset;
     uint triangleCount;
+    uint vertexBase;
 };
 
-struct Payload
+static const uint MESHLET_WIDE_VERTEX_BASE = 0xffffffff;
+
+// Written by MeshCooker::EncodeMeshlets: 16-bit offsets from the meshlet's base vertex, or full 32-bit indices for wide meshlets
+uint LoadMeshletVertex(Meshlet meshlet, uint index)
 {
-    uint meshletIndices[32];
-};
+    if (meshlet.vertexBase == MESHLET_WIDE_VERTEX_BASE)
+    {
+        return drawData.meshletVertices.Load<uint>(meshlet.vertexOffset / 2 + index);
+    }
 
-groupshared Payload payload;
+    uint offset = meshlet.vertexOffset + index;
+    uint word = drawData.meshletVertices.Load<uint>(offset / 2);
+
+    return meshlet.vertexBase + ((word >> ((offset & 1) * 16)) & 0xffff);
+}
+
+// Three 8-bit local indices without padding, the last ones may be in the next word
+uint3 LoadMeshletTriangle(Meshlet meshlet, uint index)
+{
+    uint offset = meshlet.triangleOffset + index * 3;
+    uint shift = (offset & 3) * 8;
+
+    uint packed = drawData.meshletIndices.Load<uint>(offset / 4) >> shift;
+    if (shift > 8)
+    {
+        packed |= drawData.meshletIndices.Load<uint>(offset / 4 + 1) << (32 - shift);
+    }
+
+    return uint3(packed & 0xff, (packed >> 8) & 0xff, (packed >> 16) & 0xff);
+}
+
+// Written by MeshCooker::BuildClusterHierarchy, the roots have an infinite parent error
+struct ClusterLod
+{
+    float3 center;
+    float radius;
+    float error;
+    float3 parentCenter;
+    float parentRadius;
+    float parentError;
+};
 
 bool ConeCull(float3 coneApex, float3 coneAxis, float coneCutoff, float3 cameraPosition)
 {
     return dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff;
 }
 
-[numthreads(THREADS_PER_GROUP, 1, 1)]
-void MainTS(in uint3 groupThreadId : SV_GroupThreadID,
-            in uint3 groupId : SV_GroupID,
-            in uint3 dispatchThreadId : SV_DispatchThreadID)
+bool IsSphereInFrustum(float3 center, float radius, PerFrameData perFrameData)
+{
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        if (dot(perFrameData.frustumPlanes[i].xyz, center) + perFrameData.frustumPlanes[i].w < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Projects the bounding box of the sphere and compares its nearest depth with the farthest one under it.
+// The level is picked so the projected rectangle spans at most 2x2 texels, a texel of level n covers 2^(n + 1) pixels.
+bool IsOccluded(float3 center, float radius, PerFrameData perFrameData)
 {
-    uint meshletId = dispatchThreadId.x;
+    if (perFrameData.hiZLevelCount == 0)
+    {
+        return false;
+    }
 
-    if (meshletId >= drawData.meshletCount)
+    float2 renderSize = float2(perFrameData.renderWidth, perFrameData.renderHeight);
+    float2 minPixel = POS_INFINITY;
+    float2 maxPixel = NEG_INFINITY;
+    float minDepth = 1.0f;
+
+    [unroll]
+    for (uint i = 0; i < 8; i++)
     {
-        return;
+        float3 corner = center + radius * float3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+        float4 clipPosition = mul(perFrameData.projView, float4(corner, 1.0f));
+
+        // Bounds crossing the camera plane can't be projected
+        if (clipPosition.w <= 0.0f)
+        {
+            return false;
+        }
+
+        float3 ndc = clipPosition.xyz / clipPosition.w;
+
+        // Y is flipped when the vertices are output
+        float2 pixel = float2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * renderSize;
+
+        minPixel = min(minPixel, pixel);
+        maxPixel = max(maxPixel, pixel);
+        minDepth = min(minDepth, ndc.z);
     }
 
-    bool accept = true;
-    if (drawData.isBackFaceCull)
+    minPixel = clamp(minPixel, 0.0f, renderSize - 1.0f);
+    maxPixel = clamp(maxPixel, 0.0f, renderSize - 1.0f);
+
+    float extent = max(maxPixel.x - minPixel.x, maxPixel.y - minPixel.y);
+    uint level = min((uint)max(ceil(log2(max(extent, 1.0f))) - 1.0f, 0.0f), perFrameData.hiZLevelCount - 1);
+
+    uint2 minTexel = uint2(minPixel) >> (level + 1);
+    uint2 maxTexel = uint2(maxPixel) >> (level + 1);
+
+    Texture hiZ = perFrameData.hiZTextures[level];
+    float maxDepth = max(
+        max(hiZ.Load2D<float>(minTexel), hiZ.Load2D<float>(uint2(maxTexel.x, minTexel.y))),
+        max(hiZ.Load2D<float>(uint2(minTexel.x, maxTexel.y)), hiZ.Load2D<float>(maxTexel)));
+
+    return minDepth > maxDepth;
+}
+
+// Largest axis scale of the transform, bounds stay conservative under non-uniform scale
+float GetMaxScale(float4x4 transform)
+{
+    float3 axisScales = float3(
+        dot(transform._m00_m10_m20, transform._m00_m10_m20),
+        dot(transform._m01_m11_m21, transform._m01_m11_m21),
+        dot(transform._m02_m12_m22, transform._m02_m12_m22));
+
+    return sqrt(max(axisScales.x, max(axisScales.y, axisScales.z)));
+}
+
+// Error is acceptable when it projects below the threshold from the closest point of the bounds, see Renderer::GetLodErrorScale
+bool IsLodErrorAcceptable(float3 center, float radius, float error, float4x4 globalTransform, float scale, PerFrameData perFrameData)
+{
+    float3 worldCenter = mul(globalTransform, float4(center, 1.0f)).xyz;
+    float distance = max(length(worldCenter - perFrameData.cameraPosition.xyz) - radius * scale, 0.0f);
+
+    return error * scale * perFrameData.lodErrorScale <= distance;
+}
+
+// Frustum, cluster hierarchy cut, occlusion culling phase and normal cone, shared by the task shader and ClusterCull.hlsl.
+// The draw index is the position of the meshlet in the dispatched range.
+bool IsMeshletAccepted(Meshlet meshlet, uint meshletId, uint drawIndex)
+{
+    PerFrameData perFrameData = drawData.perFrameBuffer.Load<PerFrameData>();
+    const ModelMatrix modelMatrix = drawData.perInstanceBuffer.Load<ModelMatrix>();
+    const float4x4 globalTransform = modelMatrix.globalTransform;
+    float scale = GetMaxScale(globalTransform);
+
+    float3 worldCenter = mul(globalTransform, float4(meshlet.center, 1.0f)).xyz;
+    bool accept = IsSphereInFrustum(worldCenter, meshlet.radius * scale, perFrameData);
+
+    // Parent bounds and errors contain those of their children, so exactly one cluster is drawn on every path from a leaf to a root
+    if (accept && drawData.clusterLods.IsValid())
     {
-        Meshlet meshlet = drawData.meshlets.Load<Meshlet>(meshletId);
-        const float4x4 globalTransform = drawData.perInstanceBuffer.Load<ModelMatrix>().globalTransform;
+        ClusterLod lod = drawData.clusterLods.Load<ClusterLod>(drawIndex);
 
-        float4 coneApex = mul(globalTransform, float4(meshlet.coneApex, 1.0f));
-        coneApex.xyz /= coneApex.w;
+        accept = IsLodErrorAcceptable(lod.center, lod.radius, lod.error, globalTransform, scale, perFrameData) &&
+            !IsLodErrorAcceptable(lod.parentCenter, lod.parentRadius, lod.parentError, globalTransform, scale, perFrameData);
+    }
 
-        float3 coneAxis = normalize(mul(globalTransform, float4(meshlet.coneAxis, 0.0f)).xyz);
-        float coneCutoff = meshlet.coneCutoff;
-        float3 cameraPosition = drawData.perFrameBuffer.Load<PerFrameData>().cameraPosition.xyz;
+    // Meshlets visible last frame are drawn first. The late phase tests the rest against the depth they produced
+    // and marks every meshlet for the next frame.
+    if (drawData.cullPhase != CULL_PHASE_NONE)
+    {
+        bool wasVisible = drawData.meshletVisibility.Load<uint>(meshletId) != 0;
 
-        bool accept = !ConeCull(coneApex.xyz, coneAxis, coneCutoff, cameraPosition);
+        if (drawData.cullPhase == CULL_PHASE_LATE)
+        {
+            bool isVisible = accept && !IsOccluded(worldCenter, meshlet.radius * scale, perFrameData);
+            drawData.meshletVisibility.Store<uint>(meshletId, isVisible ? 1 : 0);
+
+            accept = isVisible && !wasVisible;
+        }
+        else
+        {
+            accept = accept && wasVisible;
+        }
+    }
+
+    // The normal cone is built in object space, so the axis goes through the normal matrix
+    if (accept && IS_BACK_FACE_CULL)
+    {
+        float3 coneApex = mul(globalTransform, float4(meshlet.coneApex, 1.0f)).xyz;
+        float3 coneAxis = normalize(mul(modelMatrix.transpInvGlobalTransform, float4(meshlet.coneAxis, 0.0f)).xyz);
+
+        accept = !ConeCull(coneApex, coneAxis, meshlet.coneCutoff, perFrameData.cameraPosition.xyz);
+    }
+
+    return accept;
+}
+
+#endif // USE_MESH_SHADING || USE_CLUSTER_CULLING
+
+#if defined(USE_MESH_SHADING)
+
+struct Payload
+{
+    uint meshletIndices[32];
+};
+
+groupshared Payload payload;
+
+[numthreads(THREADS_PER_GROUP, 1, 1)]
+void MainTS(in uint3 groupThreadId : SV_GroupThreadID,
+            in uint3 groupId : SV_GroupID,
+            in uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    if (dispatchThreadId.x >= drawData.meshletCount)
+    {
+        return;
     }
 
+    // Meshlets of the drawn level of detail or the whole cluster hierarchy
+    uint meshletId = drawData.meshletOffset + dispatchThreadId.x;
+
+    bool accept = IsMeshletAccepted(drawData.meshlets.Load<Meshlet>(meshletId), meshletId, dispatchThreadId.x);
+
     uint arrayIndex = WavePrefixCountBits(accept);
     uint result = WaveActiveCountBits(accept);
 
@@ -1,3 +1,5 @@
+// Permutations: USE_MESH_SHADING
+
 #include "Common.hlsli"
 #include "ZPassCommon.hlsli"
 
@@ -18,68 +20,56 @@ void MainMS(in uint3 groupId : SV_GroupID,
 {
     const uint meshletId = pl.meshletIndices[groupId.x];
 
-    if (meshletId >= MeshInfo.meshletCount)
+    if (meshletId - drawData.meshletOffset >= drawData.meshletCount)
     {
         return;
     }
 
-    const uint vtxCount = Meshlets[meshletId].vertexCount;
-    const uint triangleCount = Meshlets[meshletId].triangleCount;
+    Meshlet meshlet = drawData.meshlets.Load<Meshlet>(meshletId);
+
+    const uint vtxCount = meshlet.vertexCount;
+    const uint triangleCount = meshlet.triangleCount;
 
     if (groupThreadId.x == 0)
     {
         SetMeshOutputCounts(vtxCount, triangleCount);
     }
 
-    const float4x4 globalTransform = Model.globalTransform;
-    const float4x4 projView = PerFrame.projView;
-    const float3x3 transpInvGlobalTransform = Model.transpInvGlobalTransform;
+    const float4x4 globalTransform = drawData.perInstanceBuffer.Load<ModelMatrix>().globalTransform;
+    const float4x4 projView = drawData.perFrameBuffer.Load<PerFrameData>().projView;
+    const MeshInfo meshInfo = drawData.meshInfo.Load<MeshInfo>();
 
-    const uint vertexOffset = Meshlets[meshletId].vertexOffset;
     for (uint i = groupThreadId.x; i < vtxCount; i += THREADS_PER_GROUP)
     {
-        const uint vertexIndex = MeshletVertices[vertexOffset + i];
+        uint2 position = drawData.positions.Load<uint2>(LoadMeshletVertex(meshlet, i));
+        float3 localPos = DecodePosition(position.x, position.y, meshInfo);
 
         VertToPix OUT = (VertToPix)0;
 
-        float4 worldPosition = mul(globalTransform, float4(Positions[vertexIndex], 1.0f));
+        float4 worldPosition = mul(globalTransform, float4(localPos, 1.0f));
         OUT.Position = mul(projView, worldPosition);
         OUT.Position.y *= -1.0f;
 
         vertices[i] = OUT;
     }
 
-    const uint triangleOffset = Meshlets[meshletId].triangleOffset;
     for (uint i = groupThreadId.x; i < triangleCount; i += THREADS_PER_GROUP)
     {
-        uint indices = MeshletIndices[triangleOffset + i];
-        triangles[i] = uint3(indices & 0xff, (indices >> 8) & 0xff, (indices >> 16) & 0xff);
+        triangles[i] = LoadMeshletTriangle(meshlet, i);
     }
 }
 
 #else // USE_MESH_SHADING
 
-struct DrawData
-{
-    ArrayBuffer positions;
-    ArrayBuffer indices;
-    ArrayBuffer perFrameBuffer;
-    ArrayBuffer perInstanceBuffer;
-};
-
-PUSH_CONSTANTS(DrawData, drawData);
-
 VertToPix MainVS(uint vertexId : SV_VertexID)
 {
     VertToPix OUT = (VertToPix)0;
 
-    uint vertexIndex = vertexId;
-    if (drawData.indices.IsValid())
-    {
-        vertexIndex = drawData.indices.Load<uint>(vertexId);
-    }
+    // Indexed draw, so the id is the vertex fetched by the input assembler and repeated vertices hit the post-transform cache
+    uint2 position = drawData.positions.Load<uint2>(vertexId);
+    float3 localPos = DecodePosition(position.x, position.y, drawData.meshInfo.Load<MeshInfo>());
 
-    float4 worldPosition = mul(drawData.perInstanceBuffer.Load<ModelMatrix>(0).globalTransform, float4(drawData.positions.Load<float3>(vertexIndex), 1.0f));
+    float4 worldPosition = mul(drawData.perInstanceBuffer.Load<ModelMatrix>(0).globalTransform, float4(localPos, 1.0f));
     OUT.Position = mul(drawData.perFrameBuffer.Load<PerFrameData>(0).projView, worldPosition);
 
     return OUT;
@@ -1,5 +1,4 @@
 workspace "GameEngine"
-    system "windows"
     architecture "x64"
     startproject "Engine"
 
@@ -16,11 +15,16 @@ includeDirs = {}
 
 include "3dparty/premake5.lua"
 
+-- Single file libraries, compiled as part of the projects using them
+includeDirs["cgltf"] = "cgltf"
+includeDirs["MikkTSpace"] = "MikkTSpace"
+
 
 project "Engine"
     filter {}
 
     kind "WindowedApp"
+    system "windows"
 
     location "Engine"
 
@@ -46,7 +50,8 @@ project "Engine"
         path.getabsolute("%{prj.location}/Code/**.h", ""),
         "%{prj.location}/Code/**.h",
         "%{prj.location}/Code/**.cpp",
-        "%{wks.location}/3dparty/ImGuizmo/ImGuizmo.cpp"
+        "%{wks.location}/3dparty/ImGuizmo/ImGuizmo.cpp",
+        "%{wks.location}/3dparty/MikkTSpace/mikktspace.c"
     }
 
     -- Include directories
@@ -67,6 +72,8 @@ project "Engine"
     includedirs(thirdpartyDir .. includeDirs["entt"])
     includedirs(thirdpartyDir .. includeDirs["ImGuizmo"])
     includedirs(thirdpartyDir .. includeDirs["meshoptimizer"])
+    includedirs(thirdpartyDir .. includeDirs["cgltf"])
+    includedirs(thirdpartyDir .. includeDirs["MikkTSpace"])
 
     dependson { "imgui", "meshoptimizer" }
 
@@ -123,4 +130,259 @@ project "Engine"
     filter "Release"
         rtti "Off"
         defines { "ENTT_DISABLE_ASSERT" }
-    filter {}
\ No newline at end of file
+    filter {}
+
+project "ShaderPacker"
+    filter {}
+
+    kind "ConsoleApp"
+
+    location "Tools/ShaderPacker"
+
+    language "C++"
+    cppdialect "C++20"
+
+    staticruntime "On"
+    systemversion "latest"
+
+    filter "Debug"
+        objdir("%{wks.location}/Bin/Debug/Intermediate/%{prj.name}")
+    filter "Profile"
+        objdir("%{wks.location}/Bin/Profile/Intermediate/%{prj.name}")
+    filter "Release"
+        objdir("%{wks.location}/Bin/Release/Intermediate/%{prj.name}")
+    filter {}
+
+    targetdir("%{wks.location}/Bin/")
+    debugdir("")
+
+    files
+    {
+        "%{prj.location}/**.cpp",
+        "%{wks.location}/Engine/Code/Framework/Assert.cpp",
+        "%{wks.location}/Engine/Code/Framework/Log.cpp",
+        "%{wks.location}/Engine/Code/Framework/MappedFile.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderCompiler.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderPack.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderUtils.cpp"
+    }
+
+    includedirs "%{wks.location}/Engine/Code"
+    includedirs(thirdpartyDir .. includeDirs["spdlog"])
+    includedirs(thirdpartyDir .. includeDirs["tracy"])
+
+    filter "system:windows"
+        includedirs { "$(VK_SDK_PATH)/Include", "$(VULKAN_SDK)/Include" }
+        libdirs { "$(VK_SDK_PATH)/Lib", "$(VULKAN_SDK)/Lib" }
+        links { "dxcompiler.lib" }
+    -- Linux build uses the portable libdxcompiler.so shipped with the Vulkan SDK
+    filter "system:linux"
+        includedirs(os.getenv("VULKAN_SDK") and (os.getenv("VULKAN_SDK") .. "/include") or "/usr/include")
+        libdirs(os.getenv("VULKAN_SDK") and (os.getenv("VULKAN_SDK") .. "/lib") or "/usr/lib")
+        links { "dxcompiler", "pthread" }
+    filter {}
+
+    defines { "SPDLOG_NO_EXCEPTIONS", "LOG_ENABLE", "NOMINMAX" }
+    filter "Debug"
+        defines { "DEBUG_BUILD", "ASSERT_ENABLE" }
+    filter "Release"
+        defines { "RELEASE_BUILD" }
+
+    filter "Debug"
+        optimize "Off"
+        symbols "Full"
+    filter "Profile or Release"
+        optimize "Full"
+        symbols "On"
+    filter {}
+
+project "MeshCooker"
+    filter {}
+
+    kind "ConsoleApp"
+
+    location "Tools/MeshCooker"
+
+    language "C++"
+    cppdialect "C++20"
+
+    staticruntime "On"
+    systemversion "latest"
+
+    filter "Debug"
+        objdir("%{wks.location}/Bin/Debug/Intermediate/%{prj.name}")
+    filter "Profile"
+        objdir("%{wks.location}/Bin/Profile/Intermediate/%{prj.name}")
+    filter "Release"
+        objdir("%{wks.location}/Bin/Release/Intermediate/%{prj.name}")
+    filter {}
+
+    targetdir("%{wks.location}/Bin/")
+    debugdir("")
+
+    files
+    {
+        "%{prj.location}/**.cpp",
+        "%{wks.location}/Engine/Code/Framework/Assert.cpp",
+        "%{wks.location}/Engine/Code/Framework/Log.cpp",
+        "%{wks.location}/Engine/Code/Framework/MappedFile.cpp",
+        "%{wks.location}/Engine/Code/3dparty/single-headers/cgltf.cpp",
+        "%{wks.location}/Engine/Code/Loaders/GltfImporter.cpp",
+        "%{wks.location}/Engine/Code/Loaders/MeshCache.cpp",
+        "%{wks.location}/Engine/Code/Loaders/MeshCooker.cpp",
+        "%{wks.location}/Engine/Code/Loaders/VertexCodec.cpp",
+        "%{wks.location}/Engine/Code/Loaders/VertexPacking.cpp",
+        "%{wks.location}/3dparty/MikkTSpace/mikktspace.c"
+    }
+
+    includedirs "%{wks.location}/Engine/Code"
+    includedirs(thirdpartyDir .. includeDirs["spdlog"])
+    includedirs(thirdpartyDir .. includeDirs["tracy"])
+    includedirs(thirdpartyDir .. includeDirs["glm"])
+    includedirs(thirdpartyDir .. includeDirs["assimp"])
+    includedirs(thirdpartyDir .. includeDirs["meshoptimizer"])
+    includedirs(thirdpartyDir .. includeDirs["cgltf"])
+    includedirs(thirdpartyDir .. includeDirs["MikkTSpace"])
+
+    dependson { "meshoptimizer" }
+
+    filter "Debug"
+        libdirs("%{wks.location}/Bin/Debug")
+    filter "Profile"
+        libdirs("%{wks.location}/Bin/Profile")
+    filter "Release"
+        libdirs("%{wks.location}/Bin/Release")
+    filter {}
+
+    links { "meshoptimizer" }
+    filter "system:windows and Debug"
+        links(thirdpartyDir .. "assimp/Debug/assimp.lib")
+        links(thirdpartyDir .. "assimp/Debug/zlib.lib")
+    filter { "system:windows", "Profile or Release" }
+        links(thirdpartyDir .. "assimp/Release/assimp.lib")
+        links(thirdpartyDir .. "assimp/Release/zlib.lib")
+    filter "system:linux"
+        links { "assimp", "pthread" }
+    filter {}
+
+    defines { "SPDLOG_NO_EXCEPTIONS", "LOG_ENABLE", "NOMINMAX", "GLM_FORCE_INTRINSICS", "GLM_FORCE_INLINE", "GLM_ENABLE_EXPERIMENTAL", "GLM_FORCE_DEPTH_ZERO_TO_ONE", "GLM_FORCE_RADIANS", "GLM_FORCE_DEFAULT_ALIGNED_GENTYPES" }
+    filter "Debug"
+        defines { "DEBUG_BUILD", "ASSERT_ENABLE" }
+    filter "Release"
+        defines { "RELEASE_BUILD" }
+
+    filter "Debug"
+        optimize "Off"
+        symbols "Full"
+    filter "Profile or Release"
+        optimize "Full"
+        symbols "On"
+    filter {}
+
+-- Tests are console programs run from the repository root, they exit with a non-zero code when a check fails
+function TestProject(name)
+    project(name)
+        filter {}
+
+        kind "ConsoleApp"
+
+        location("Tests/" .. name)
+
+        language "C++"
+        cppdialect "C++20"
+
+        staticruntime "On"
+        systemversion "latest"
+
+        filter "Debug"
+            objdir("%{wks.location}/Bin/Debug/Intermediate/%{prj.name}")
+        filter "Profile"
+            objdir("%{wks.location}/Bin/Profile/Intermediate/%{prj.name}")
+        filter "Release"
+            objdir("%{wks.location}/Bin/Release/Intermediate/%{prj.name}")
+        filter {}
+
+        targetdir("%{wks.location}/Bin/")
+        debugdir("")
+
+        files
+        {
+            "%{prj.location}/**.cpp",
+            "%{wks.location}/Tests/TestCheck.h",
+            "%{wks.location}/Engine/Code/Framework/Assert.cpp",
+            "%{wks.location}/Engine/Code/Framework/Log.cpp"
+        }
+
+        includedirs "%{wks.location}/Engine/Code"
+        includedirs "%{wks.location}/Tests"
+        includedirs(thirdpartyDir .. includeDirs["spdlog"])
+        includedirs(thirdpartyDir .. includeDirs["tracy"])
+        includedirs(thirdpartyDir .. includeDirs["glm"])
+
+        filter "system:linux"
+            links { "pthread" }
+        filter {}
+
+        defines { "SPDLOG_NO_EXCEPTIONS", "LOG_ENABLE", "NOMINMAX", "GLM_FORCE_INTRINSICS", "GLM_FORCE_INLINE", "GLM_ENABLE_EXPERIMENTAL", "GLM_FORCE_DEPTH_ZERO_TO_ONE", "GLM_FORCE_RADIANS", "GLM_FORCE_DEFAULT_ALIGNED_GENTYPES" }
+        filter "Debug"
+            defines { "DEBUG_BUILD", "ASSERT_ENABLE" }
+        filter "Release"
+            defines { "RELEASE_BUILD" }
+
+        filter "Debug"
+            optimize "Off"
+            symbols "Full"
+        filter "Profile or Release"
+            optimize "Full"
+            symbols "On"
+        filter {}
+end
+
+TestProject "ShaderCompileTest"
+    files
+    {
+        "%{wks.location}/Engine/Code/Framework/MappedFile.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderCompiler.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderPack.cpp",
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/ShaderUtils.cpp"
+    }
+
+    filter "system:windows"
+        includedirs { "$(VK_SDK_PATH)/Include", "$(VULKAN_SDK)/Include" }
+        libdirs { "$(VK_SDK_PATH)/Lib", "$(VULKAN_SDK)/Lib" }
+        links { "dxcompiler.lib" }
+    filter "system:linux"
+        includedirs(os.getenv("VULKAN_SDK") and (os.getenv("VULKAN_SDK") .. "/include") or "/usr/include")
+        libdirs(os.getenv("VULKAN_SDK") and (os.getenv("VULKAN_SDK") .. "/lib") or "/usr/lib")
+        links { "dxcompiler" }
+    filter {}
+
+TestProject "VertexPackingTest"
+    files
+    {
+        "%{wks.location}/Engine/Code/Loaders/VertexPacking.cpp"
+    }
+
+TestProject "SoftwareOcclusionTest"
+    files
+    {
+        "%{wks.location}/Engine/Code/Engine/Rendering/OcclusionBuffer.cpp"
+    }
+
+TestProject "SoftwareOcclusionBenchmark"
+    files
+    {
+        "%{wks.location}/Engine/Code/Engine/Rendering/OcclusionBuffer.cpp"
+    }
+
+TestProject "HashBenchmark"
+    files
+    {
+        "%{wks.location}/Engine/Code/Engine/Rendering/Backend/PipelineGraphicsState.cpp"
+    }
+
+    filter "system:windows"
+        includedirs { "$(VK_SDK_PATH)/Include", "$(VULKAN_SDK)/Include" }
+    filter "system:linux"
+        includedirs(os.getenv("VULKAN_SDK") and (os.getenv("VULKAN_SDK") .. "/include") or "/usr/include")
+    filter {}